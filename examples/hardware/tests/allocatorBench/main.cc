@@ -0,0 +1,155 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**@file Benchmark of the heap allocators
+ *
+ * Allocates and frees objects with the sizes of typical messages and frames
+ * of the communication stack. Build once per allocator to compare them,
+ * e.g.,
+ *
+ *     scons allocator=block
+ *     scons allocator=surm
+ *     scons allocator=malloc
+ *     scons allocator=slab
+ *
+ * The throughput phase reports the number of operations per second with at
+ * most BENCH_LIVE objects allocated at the same time. The fragmentation
+ * phase keeps the objects left over from the throughput phase and then
+ * allocates frames until the heap is exhausted.
+ */
+
+#include "cometos.h"
+#include "OutputStream.h"
+#include "palLocalTime.h"
+#include "memory.h"
+#include "Airframe.h"
+#include "DataRequest.h"
+#ifdef BENCH_SLAB_STATS
+#include "SlabAllocator.h"
+#endif
+
+using namespace cometos;
+
+#ifndef BENCH_OPERATIONS
+#define BENCH_OPERATIONS 20000
+#endif
+
+#ifndef BENCH_LIVE
+#define BENCH_LIVE 48
+#endif
+
+#define BENCH_MAX_FILL 128
+
+static const uint16_t sizes[] = {
+    sizeof(Message),
+    sizeof(DataRequest),
+    sizeof(Airframe),
+    12,
+    24,
+    40
+};
+
+static void* live[BENCH_LIVE];
+static void* fill[BENCH_MAX_FILL];
+
+static void throughput() {
+    uint16_t failed = 0;
+    time_ms_t start = palLocalTime_get();
+    for (uint16_t i = 0; i < BENCH_OPERATIONS; i++) {
+        uint8_t slot = intrand(BENCH_LIVE);
+        if (live[slot] != NULL) {
+            ::operator delete(live[slot]);
+            live[slot] = NULL;
+        } else {
+            live[slot] = ::operator new(sizes[intrand(sizeof(sizes) / sizeof(sizes[0]))]);
+            if (live[slot] == NULL) {
+                failed++;
+            }
+        }
+    }
+    time_ms_t duration = palLocalTime_get() - start;
+
+    getCout() << "ops=" << (uint32_t) BENCH_OPERATIONS << " ms=" << duration
+              << " failed=" << failed << endl;
+}
+
+static void fragmentation() {
+    uint8_t remaining = 0;
+    for (uint8_t i = 0; i < BENCH_LIVE; i++) {
+        if (live[i] != NULL) {
+            remaining++;
+        }
+    }
+
+    uint8_t frames = 0;
+    while (frames < BENCH_MAX_FILL) {
+        fill[frames] = ::operator new(sizeof(Airframe));
+        if (fill[frames] == NULL) {
+            break;
+        }
+        frames++;
+    }
+
+    getCout() << "live=" << remaining << " frames=" << frames
+              << " util=" << heapGetUtilization() << endl;
+
+#ifdef BENCH_SLAB_STATS
+    for (uint8_t c = 0; c < slabGetNumClasses(); c++) {
+        const SlabClassStats& stats = slabGetStats(c);
+        getCout() << "class=" << stats.size << " objects=" << stats.objects
+                  << " highWater=" << stats.highWater << " pages=" << stats.pages
+                  << " failed=" << stats.failed << endl;
+    }
+#endif
+
+    for (uint8_t i = 0; i < frames; i++) {
+        ::operator delete(fill[i]);
+    }
+    for (uint8_t i = 0; i < BENCH_LIVE; i++) {
+        if (live[i] != NULL) {
+            ::operator delete(live[i]);
+            live[i] = NULL;
+        }
+    }
+}
+
+int main() {
+    cometos::initialize();
+
+    getCout() << "heap=" << (uint16_t) MEMORY_HEAP_SIZE << " frame="
+              << (uint16_t) sizeof(Airframe) << endl;
+    throughput();
+    fragmentation();
+
+    cometos::run();
+    return 0;
+}
@@ -0,0 +1,123 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**@file Benchmark of the CRC implementations
+ *
+ * Computes the reflected crc16 (frames) and the xmodem crc (files) over
+ * blocks of different sizes, once bytewise and once with the block
+ * functions. Build once per implementation to compare them, e.g.,
+ *
+ *     scons CRC_MODE=0
+ *     scons CRC_MODE=1
+ *     scons CRC_MODE=2
+ *
+ * Reports the number of bytes processed per millisecond.
+ */
+
+#include "cometos.h"
+#include "OutputStream.h"
+#include "palLocalTime.h"
+#include "crc16.h"
+
+using namespace cometos;
+
+#ifndef BENCH_BYTES
+#define BENCH_BYTES 65536UL
+#endif
+
+#define BENCH_MAX_BLOCK 1024
+
+static const uint16_t blockSizes[] = { 16, 128, BENCH_MAX_BLOCK };
+
+static uint8_t buffer[BENCH_MAX_BLOCK];
+
+static volatile uint16_t result;
+
+static void report(const char* name, uint16_t blockSize, time_ms_t duration) {
+    getCout() << name << " block=" << blockSize << " ms=" << duration;
+    if (duration > 0) {
+        getCout() << " bytes/ms=" << (uint32_t) (BENCH_BYTES / duration);
+    }
+    getCout() << endl;
+}
+
+static void benchmark(uint16_t blockSize) {
+    uint32_t rounds = BENCH_BYTES / blockSize;
+
+    time_ms_t start = palLocalTime_get();
+    for (uint32_t r = 0; r < rounds; r++) {
+        uint16_t crc = 0xFFFF;
+        for (uint16_t i = 0; i < blockSize; i++) {
+            crc = crc16_update(crc, buffer[i]);
+        }
+        result = crc;
+    }
+    report("crc16", blockSize, palLocalTime_get() - start);
+
+    start = palLocalTime_get();
+    for (uint32_t r = 0; r < rounds; r++) {
+        result = crc16_updateBlock(0xFFFF, buffer, blockSize);
+    }
+    report("crc16Block", blockSize, palLocalTime_get() - start);
+
+    start = palLocalTime_get();
+    for (uint32_t r = 0; r < rounds; r++) {
+        uint16_t crc = 0;
+        for (uint16_t i = 0; i < blockSize; i++) {
+            crc = crc16xmodem_update(crc, buffer[i]);
+        }
+        result = crc;
+    }
+    report("xmodem", blockSize, palLocalTime_get() - start);
+
+    start = palLocalTime_get();
+    for (uint32_t r = 0; r < rounds; r++) {
+        result = crc16xmodem_updateBlock(0, buffer, blockSize);
+    }
+    report("xmodemBlock", blockSize, palLocalTime_get() - start);
+}
+
+int main() {
+    cometos::initialize();
+
+    for (uint16_t i = 0; i < BENCH_MAX_BLOCK; i++) {
+        buffer[i] = intrand(256);
+    }
+
+    getCout() << "mode=" << (uint8_t) CRC_MODE << " bytes=" << (uint32_t) BENCH_BYTES << endl;
+    for (uint8_t i = 0; i < sizeof(blockSizes) / sizeof(blockSizes[0]); i++) {
+        benchmark(blockSizes[i]);
+    }
+
+    cometos::run();
+    return 0;
+}
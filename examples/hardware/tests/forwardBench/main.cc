@@ -0,0 +1,214 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**@file Benchmark of the burst processing mode of IpForward
+ *
+ * A link module injects bursts of datagrams to be forwarded, as the 6LoWPAN
+ * layer does when several frames were received in a row, and takes the
+ * forwarded datagrams back. For each burst size, prints the average and
+ * maximum latency from injection to the forwarded datagram leaving
+ * IpForward, and the forwarding throughput.
+ */
+
+#include "cometos.h"
+#include "OutputStream.h"
+#include "IpForward.h"
+#include "RoutingTable.h"
+#include "StaticRouting.h"
+#include "NeighborDiscovery.h"
+#include "IPv6InterfaceTable.h"
+#include "ICMPv6.h"
+#include <time.h>
+
+using namespace cometos;
+using namespace cometos_v6;
+
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 10000
+#endif
+
+/** datagrams per burst, bounded by the request pool of IpForward */
+#define BENCH_BURST IPFWD_MAX_REQUESTS
+
+static const uint8_t burstSizes[] = {1, 2, 4, 8};
+static const uint8_t destinationCounts[] = {1, 2, 8};
+
+static uint64_t getTimeNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static IPv6Address destination(uint8_t node) {
+    return IPv6Address(0x2001, 0xdb8, 0, 1, 0, 0xff, 0xfe00, node + 1);
+}
+
+static const IPv6Address nextHop(0xfe80, 0, 0, 0, 0, 0xff, 0xfe00, 0x100);
+
+class Link : public Module {
+public:
+    Link() :
+            Module("link"),
+            toIP(this, "toIP"),
+            fromIP(this, &Link::handleRequest, "fromIP"),
+            forwarded(0),
+            responses(0),
+            failed(0),
+            latencySum(0),
+            latencyMax(0),
+            flushed(false),
+            injected(0) {
+        for (uint8_t i = 0; i < BENCH_BURST; i++) {
+            requests[i].data.datagram = &datagrams[i];
+            requests[i].setResponseDelegate(createCallback(&Link::handleResponse));
+        }
+    }
+
+    void inject(uint8_t numDestinations) {
+        injected = getTimeNs();
+        for (uint8_t i = 0; i < BENCH_BURST; i++) {
+            datagrams[i].src.set(0x2001, 0xdb8, 0, 2, 0, 0xff, 0xfe00, 1);
+            datagrams[i].dst = destination(i % numDestinations);
+            datagrams[i].setHopLimit(64);
+            toIP.send(&requests[i]);
+        }
+    }
+
+    void handleRequest(IPv6Request* req) {
+        uint64_t latency = getTimeNs() - injected;
+        latencySum += latency;
+        if (latency > latencyMax) {
+            latencyMax = latency;
+        }
+        forwarded++;
+        req->response(new IPv6Response(req, IPv6Response::IPV6_RC_SUCCESS));
+    }
+
+    void handleResponse(IPv6Response* resp) {
+        responses++;
+        if (resp->success != IPv6Response::IPV6_RC_SUCCESS) {
+            failed++;
+        }
+        delete resp;
+    }
+
+    /**
+     * Runs the scheduler until the responses to the forwarded datagrams,
+     * which are queued before the marker, returned the pool entries of
+     * IpForward.
+     */
+    void flush() {
+        flushed = false;
+        schedule(&marker, &Link::handleMarker);
+        while (!flushed) {
+            run_once();
+        }
+    }
+
+    void handleMarker(Message* msg) {
+        flushed = true;
+    }
+
+    OutputGate<IPv6Request> toIP;
+    InputGate<IPv6Request> fromIP;
+
+    uint32_t forwarded;
+    uint32_t responses;
+    uint32_t failed;
+    uint64_t latencySum;
+    uint64_t latencyMax;
+
+private:
+    Message marker;
+    bool flushed;
+    uint64_t injected;
+    IPv6Datagram datagrams[BENCH_BURST];
+    IPv6Request requests[BENCH_BURST];
+};
+
+static IPv6InterfaceTable it(INTERFACE_TABLE_MODULE_NAME);
+static RoutingTable rt(ROUTING_TABLE_MODULE_NAME);
+static StaticRouting sr(ROUTING_MODULE_NAME);
+static NeighborDiscovery nd(NEIGHBOR_DISCOVERY_MODULE_NAME);
+static ICMPv6 icmp(ICMP_MODULE_NAME);
+static IpForward ipfwd(IPFWD_MODULE_NAME);
+static Link link;
+
+static void benchmark(uint8_t burstSize, uint8_t numDestinations) {
+    ipfwd.setBurstSize(burstSize);
+    link.forwarded = 0;
+    link.responses = 0;
+    link.failed = 0;
+    link.latencySum = 0;
+    link.latencyMax = 0;
+    uint32_t routeHits = ipfwd.getNumRouteHits();
+
+    uint64_t start = getTimeNs();
+    for (uint32_t i = 0; i < BENCH_ROUNDS; i++) {
+        link.inject(numDestinations);
+        while (link.forwarded < (i + 1) * BENCH_BURST
+                || link.responses < (i + 1) * BENCH_BURST) {
+            run_once();
+        }
+        link.flush();
+    }
+    uint64_t duration = getTimeNs() - start;
+
+    uint32_t datagrams = (uint32_t) BENCH_ROUNDS * BENCH_BURST;
+    getCout() << "burst=" << (int) burstSize
+              << " destinations=" << (int) numDestinations
+              << " avgLatencyNs=" << (uint32_t) (link.latencySum / link.forwarded)
+              << " maxLatencyNs=" << (uint32_t) link.latencyMax
+              << " datagramsPerSec=" << (uint32_t) ((uint64_t) datagrams * 1000000000 / duration)
+              << " routeHits=" << (ipfwd.getNumRouteHits() - routeHits)
+              << " failed=" << link.failed << endl;
+}
+
+int main() {
+    icmp.toIP.connectTo(ipfwd.fromICMP);
+    ipfwd.toICMP.connectTo(icmp.fromIP);
+    link.toIP.connectTo(ipfwd.fromLowpan);
+    ipfwd.toLowpan.connectTo(link.fromIP);
+
+    cometos::initialize();
+
+    IPv6Address prefix = destination(0);
+    rt.addRoute(&prefix, 64, &nextHop, 0);
+    nd.addNeighbor(nextHop, Ieee802154MacAddress((uint16_t) 0x100));
+
+    for (uint8_t i = 0; i < sizeof(burstSizes) / sizeof(burstSizes[0]); i++) {
+        for (uint8_t j = 0; j < sizeof(destinationCounts) / sizeof(destinationCounts[0]); j++) {
+            benchmark(burstSizes[i], destinationCounts[j]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**@file Stack traversal benchmark
+ *
+ * Passes messages through a chain of modules connected by gates, similar to
+ * a frame traversing MAC, 6LoWPAN, IP, UDP and CoAP, while a varying number
+ * of timers is armed. Prints the average latency per hop.
+ */
+
+#include "cometos.h"
+#include "Module.h"
+#include "OutputStream.h"
+#include <stdlib.h>
+#include <time.h>
+
+using namespace cometos;
+
+#ifndef BENCH_HOPS
+#define BENCH_HOPS 5
+#endif
+
+#ifndef BENCH_TRAVERSALS
+#define BENCH_TRAVERSALS 10000
+#endif
+
+#define BENCH_MIN_EXPIRATION 1000
+#define BENCH_EXPIRATION_RANGE 60000
+
+class Hop : public Module {
+public:
+    Hop() :
+            gateIn(this, &Hop::handle, "gateIn"),
+            gateOut(this, "gateOut"),
+            arrived(0) {
+    }
+
+    void handle(Message* msg) {
+        if (gateOut.isConnected()) {
+            gateOut.send(msg);
+        } else {
+            arrived++;
+        }
+    }
+
+    InputGate<Message> gateIn;
+    OutputGate<Message> gateOut;
+    uint32_t arrived;
+};
+
+class ArmedTimer : public Task {
+public:
+    virtual void invoke() {
+    }
+};
+
+static const uint16_t armedCounts[] = {0, 10, 100, 1000, 10000};
+
+static Hop hops[BENCH_HOPS];
+
+static uint64_t getTimeNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void benchmark(uint16_t armed) {
+    TaskScheduler& scheduler = getScheduler();
+    ArmedTimer* timers = new ArmedTimer[armed];
+    for (uint16_t i = 0; i < armed; i++) {
+        scheduler.add(timers[i], BENCH_MIN_EXPIRATION + rand() % BENCH_EXPIRATION_RANGE);
+    }
+
+    Message msg;
+    Hop& last = hops[BENCH_HOPS - 1];
+    last.arrived = 0;
+
+    uint64_t start = getTimeNs();
+    for (uint32_t i = 0; i < BENCH_TRAVERSALS; i++) {
+        hops[0].gateIn.receive(&msg);
+        while (last.arrived <= i) {
+            run_once();
+        }
+    }
+    uint64_t duration = getTimeNs() - start;
+
+    for (uint16_t i = 0; i < armed; i++) {
+        scheduler.remove(timers[i]);
+    }
+    delete[] timers;
+
+    getCout() << "armed=" << armed << " hop="
+              << (uint32_t)(duration / ((uint64_t) BENCH_TRAVERSALS * BENCH_HOPS))
+              << "ns" << endl;
+}
+
+int main() {
+    for (uint8_t i = 0; i < BENCH_HOPS - 1; i++) {
+        hops[i].gateOut.connectTo(hops[i + 1].gateIn);
+    }
+    cometos::initialize();
+
+    for (uint8_t i = 0; i < sizeof(armedCounts) / sizeof(armedCounts[0]); i++) {
+        benchmark(armedCounts[i]);
+    }
+    return 0;
+}
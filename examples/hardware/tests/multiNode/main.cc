@@ -0,0 +1,122 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**@file Runs many CometOS nodes within one process
+ *
+ * Every node has its own scheduler and module instances. The nodes are run
+ * by a NodePool on a few worker threads. Each node runs a Ticker module
+ * that schedules a message for itself periodically. At the end, the
+ * number of executed ticks is printed.
+ */
+
+#include "cometos.h"
+#include "NodeContext.h"
+#include "NodePool.h"
+#include "OutputStream.h"
+#include "palLocalTime.h"
+#include "palId.h"
+
+using namespace cometos;
+
+#ifndef NUM_NODES
+#define NUM_NODES 200
+#endif
+
+#ifndef NUM_WORKERS
+#define NUM_WORKERS 4
+#endif
+
+#define TICK_INTERVAL 10
+#define DURATION 5000
+
+static NodePool pool(NUM_WORKERS);
+static uint32_t ticks = 0;
+
+class Ticker : public Module {
+public:
+    Ticker() : Module("tick") {
+    }
+
+    void initialize() {
+        schedule(new Message, &Ticker::tick, palId_id() % TICK_INTERVAL);
+    }
+
+    void tick(Message* msg) {
+        __sync_fetch_and_add(&ticks, 1);
+        schedule(msg, &Ticker::tick, TICK_INTERVAL);
+    }
+};
+
+class Stopper : public Module {
+public:
+    Stopper() : Module("stop") {
+    }
+
+    void initialize() {
+        schedule(new Message, &Stopper::stop, DURATION);
+    }
+
+    void stop(Message* msg) {
+        delete msg;
+        pool.stop();
+    }
+};
+
+int main() {
+    cometos::initialize();
+
+    NodeContext* nodes[NUM_NODES];
+    for (uint16_t i = 0; i < NUM_NODES; i++) {
+        nodes[i] = new NodeContext(i + 1);
+        NodeContext::Scope scope(*nodes[i]);
+        new Ticker();
+        if (i == 0) {
+            new Stopper();
+        }
+        Module::initializeAll();
+    }
+
+    for (uint16_t i = 0; i < NUM_NODES; i++) {
+        pool.add(*nodes[i]);
+    }
+
+    time_ms_t start = palLocalTime_get();
+    pool.run();
+    time_ms_t duration = palLocalTime_get() - start;
+
+    getCout() << "nodes: " << (uint32_t) NUM_NODES
+              << " workers: " << (uint32_t) NUM_WORKERS
+              << " ticks: " << ticks
+              << " expected: " << (uint32_t) NUM_NODES * duration / TICK_INTERVAL
+              << endl;
+    return 0;
+}
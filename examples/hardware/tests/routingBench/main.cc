@@ -0,0 +1,130 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**@file Benchmark of the forwarding lookup
+ *
+ * Compares the longest prefix match of the PrefixIndex used by the
+ * RoutingTable with a linear scan over all routes, as done before. The
+ * routes resemble the source routing table at the root of a non-storing
+ * RPL network: one host route per node and an on-link /64 prefix.
+ */
+
+#include "cometos.h"
+#include "OutputStream.h"
+#include "IPv6Route.h"
+#include "PrefixIndex.h"
+#include <time.h>
+
+using namespace cometos;
+using namespace cometos_v6;
+
+#ifndef BENCH_LOOKUPS
+#define BENCH_LOOKUPS 100000
+#endif
+
+#define BENCH_MAX_ROUTES 1000
+
+static const uint16_t routeCounts[] = {10, 100, BENCH_MAX_ROUTES};
+
+static IPv6Route* routes[BENCH_MAX_ROUTES];
+static PrefixIndex<uint16_t, BENCH_MAX_ROUTES> routeIndex;
+static volatile uint16_t result;
+
+static uint64_t getTimeNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static IPv6Address nodeAddress(uint16_t node) {
+    return IPv6Address(0x2001, 0xdb8, 0, 0, 0, 0xff, 0xfe00, node);
+}
+
+static uint16_t linearLookup(const IPv6Address& dest, uint16_t numRoutes) {
+    uint16_t route = 0xFFFF;
+    int16_t prefixLength = -1;
+    for (uint16_t i = 0; i < numRoutes; i++) {
+        if (prefixLength < routes[i]->getPrefixLength()
+                && dest.matches(routes[i]->getDestPrefix(), routes[i]->getPrefixLength())) {
+            prefixLength = routes[i]->getPrefixLength();
+            route = i;
+            if (prefixLength == 128) {
+                break;
+            }
+        }
+    }
+    return route;
+}
+
+static void benchmark(uint16_t numRoutes) {
+    routeIndex.clear();
+    for (uint16_t i = 0; i < numRoutes; i++) {
+        // the prefix comes last, as in a table filled by DAOs
+        if (i == numRoutes - 1) {
+            routes[i] = new IPv6Route(nodeAddress(0), 64, IPv6Route::STATIC);
+        } else {
+            routes[i] = new IPv6Route(nodeAddress(i + 1), 128, IPv6Route::STATIC);
+        }
+        routeIndex.add(i, routes);
+    }
+
+    uint64_t start = getTimeNs();
+    for (uint32_t i = 0; i < BENCH_LOOKUPS; i++) {
+        result = linearLookup(nodeAddress(i % (numRoutes + 1)), numRoutes);
+    }
+    uint64_t linear = getTimeNs() - start;
+
+    start = getTimeNs();
+    for (uint32_t i = 0; i < BENCH_LOOKUPS; i++) {
+        result = routeIndex.find(nodeAddress(i % (numRoutes + 1)), routes);
+    }
+    uint64_t indexed = getTimeNs() - start;
+
+    getCout() << "routes=" << numRoutes
+              << " linearNs=" << (uint32_t) (linear / BENCH_LOOKUPS)
+              << " indexNs=" << (uint32_t) (indexed / BENCH_LOOKUPS) << endl;
+
+    for (uint16_t i = 0; i < numRoutes; i++) {
+        delete routes[i];
+    }
+}
+
+int main() {
+    cometos::initialize();
+
+    for (uint8_t i = 0; i < sizeof(routeCounts) / sizeof(routeCounts[0]); i++) {
+        benchmark(routeCounts[i]);
+    }
+
+    cometos::run();
+    return 0;
+}
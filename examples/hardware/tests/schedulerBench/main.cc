@@ -0,0 +1,110 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**@file Micro-benchmark of the TaskScheduler
+ *
+ * Measures the average cost of rescheduling a task (TaskScheduler::replace)
+ * while a varying number of tasks is pending. Build once with
+ * scheduler=list and once with scheduler=wheel to compare the backends:
+ *
+ *     scons scheduler=list
+ *     scons scheduler=wheel
+ */
+
+#include "cometos.h"
+#include "TaskScheduler.h"
+#include "OutputStream.h"
+#include <stdlib.h>
+#include <time.h>
+
+using namespace cometos;
+
+#ifndef BENCH_OPERATIONS
+#define BENCH_OPERATIONS 100000
+#endif
+
+#define BENCH_MIN_EXPIRATION 1000
+#define BENCH_EXPIRATION_RANGE 60000
+
+class BenchTask : public Task {
+public:
+    virtual void invoke() {
+    }
+};
+
+static const uint16_t pendingCounts[] = {10, 100, 1000, 10000};
+
+static uint16_t indices[BENCH_OPERATIONS];
+static time_ms_t expirations[BENCH_OPERATIONS];
+
+static uint64_t getTimeNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void benchmark(uint16_t pending) {
+    TaskScheduler& scheduler = getScheduler();
+    BenchTask* tasks = new BenchTask[pending];
+
+    for (uint32_t i = 0; i < BENCH_OPERATIONS; i++) {
+        indices[i] = rand() % pending;
+        expirations[i] = BENCH_MIN_EXPIRATION + rand() % BENCH_EXPIRATION_RANGE;
+    }
+
+    for (uint16_t i = 0; i < pending; i++) {
+        scheduler.add(tasks[i], expirations[i]);
+    }
+
+    uint64_t start = getTimeNs();
+    for (uint32_t i = 0; i < BENCH_OPERATIONS; i++) {
+        scheduler.replace(tasks[indices[i]], expirations[i]);
+    }
+    uint64_t duration = getTimeNs() - start;
+
+    for (uint16_t i = 0; i < pending; i++) {
+        scheduler.remove(tasks[i]);
+    }
+    delete[] tasks;
+
+    getCout() << "pending=" << pending << " replace="
+              << (uint32_t)(duration / BENCH_OPERATIONS) << "ns" << endl;
+}
+
+int main() {
+    cometos::initialize();
+
+    for (uint8_t i = 0; i < sizeof(pendingCounts) / sizeof(pendingCounts[0]); i++) {
+        benchmark(pendingCounts[i]);
+    }
+    return 0;
+}
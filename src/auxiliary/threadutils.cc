@@ -32,6 +32,9 @@
 
 #include "threadutils.h"
 #include <cstdlib>
+#ifdef PAL_MULTI_NODE
+#include "NodeContext.h"
+#endif
 
 #ifdef _WIN32
 #include <windows.h>
@@ -57,6 +60,10 @@ typedef struct {
 	pthread_t hthread;
 	thread_function_t function;
 	void* parameter;
+#ifdef PAL_MULTI_NODE
+	// node the thread acts for, e.g. by adding tasks to its scheduler
+	cometos::NodeContext* node;
+#endif
 }_thread_handler_t;
 
 typedef struct {
@@ -75,6 +82,14 @@ static DWORD WINAPI ThreadFunction(LPVOID lpParam) {
 #else
 static void* ThreadFunction(void* lpParam) {
 	_thread_handler_t *handler = (_thread_handler_t*) lpParam;
+#ifdef PAL_MULTI_NODE
+	if (handler->node != NULL) {
+		// palExec_atomicBegin() and getScheduler() refer to the node
+		cometos::NodeContext::Scope scope(*handler->node);
+		handler->function((thread_handler_t) handler, handler->parameter);
+		return 0;
+	}
+#endif
 	handler->function((thread_handler_t) handler, handler->parameter);
 	return 0;
 }
@@ -97,6 +112,9 @@ thread_handler_t thread_run(thread_function_t function, void* parameter) {
 			0,// use default creation flags
 			NULL);// returns the thread identifier
 #else
+#ifdef PAL_MULTI_NODE
+	handler->node = cometos::NodeContext::current();
+#endif
 	pthread_create(&handler->hthread, NULL, ThreadFunction, (void*) handler);
 #endif
 
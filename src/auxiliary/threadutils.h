@@ -50,7 +50,10 @@ typedef void* thread_mutex_t;
 typedef void* thread_handler_t;
 typedef void (*thread_function_t)(thread_handler_t, void*);
 
-/**Runs passed function in thread.
+/**Runs passed function in thread. If several nodes are run within one
+ * process (PAL_MULTI_NODE), the thread acts for the node that is current
+ * for the caller, i.e., it takes the lock of that node in
+ * palExec_atomicBegin() and adds tasks to its scheduler.
  */
 thread_handler_t thread_run(thread_function_t function, void* parameter);
 
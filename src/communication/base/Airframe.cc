@@ -39,6 +39,26 @@
 
 namespace cometos {
 
+void AirframeData::makeHeadroom(pktSize_t len) {
+    // keep the default headroom in front of the new header if possible
+    uint16_t start = len + AIRFRAME_HEADROOM;
+    if (start > 2 * AIRFRAME_HEADROOM) {
+        start = 2 * AIRFRAME_HEADROOM;
+    }
+    if (start < len) {
+        start = len;
+    }
+    uint8_t size = getSize();
+    memmove(buffer + start, getBuffer(), size);
+    relocate(buffer + start, size);
+}
+
+void AirframeData::stripFront(pktSize_t len) {
+    uint8_t size = getSize() - len;
+    memmove(buffer + AIRFRAME_HEADROOM, getBuffer() + len, size);
+    relocate(buffer + AIRFRAME_HEADROOM, size);
+}
+
 Airframe* Airframe::getCopy() const {
     Airframe* msg = new Airframe();
 	msg->data = this->data; // copy
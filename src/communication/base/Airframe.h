@@ -46,6 +46,7 @@
 #include "OutputStream.h"
 #include "logging.h"
 #include "Memory.h"
+#include <string.h>
 /*TYPES----------------------------------------------------------------------*/
 
 
@@ -61,6 +62,16 @@
 #define AIRFRAME_MAX_SIZE 120
 #endif
 
+/**Free space kept in front of and behind the data of an empty Airframe.
+ * Prepending or stripping headers at the front is a pointer adjustment as
+ * long as it stays within this space, otherwise the data is moved once.
+ * Each Airframe grows by 2 * AIRFRAME_HEADROOM bytes, thus it is disabled
+ * by default and enabled by the platform (airframe_headroom).
+ */
+#ifndef AIRFRAME_HEADROOM
+#define AIRFRAME_HEADROOM 0
+#endif
+
 namespace cometos {
 
 /*TYPES----------------------------------------------------------------------*/
@@ -70,7 +81,58 @@ typedef uint8_t pktSize_t;
 class AirframeData: public ByteVector {
 public:
 	AirframeData()
-	: ByteVector(buffer, AIRFRAME_MAX_SIZE) {
+	: ByteVector(buffer + AIRFRAME_HEADROOM, AIRFRAME_MAX_SIZE) {
+	}
+
+	AirframeData(const AirframeData& other)
+	: ByteVector(buffer + AIRFRAME_HEADROOM, AIRFRAME_MAX_SIZE) {
+		operator=(other);
+	}
+
+	AirframeData& operator=(const AirframeData& other) {
+		if (this != &other) {
+			relocate(buffer + AIRFRAME_HEADROOM, other.getSize());
+			memcpy(getBuffer(), other.getConstBuffer(), other.getSize());
+		}
+		return *this;
+	}
+
+	void clear() {
+		relocate(buffer + AIRFRAME_HEADROOM, 0);
+	}
+
+	/**Prepends len bytes, O(1) as long as there is enough headroom left*/
+	void pushFront(const uint8_t* src, pktSize_t len) {
+		ASSERT((uint16_t)getSize() + len <= getMaxSize());
+		if (getBuffer() - buffer < len) {
+			makeHeadroom(len);
+		}
+		relocate(getBuffer() - len, getSize() + len);
+		memcpy(getBuffer(), src, len);
+	}
+
+	/**Strips len bytes from the front and copies them to dst if not NULL,
+	 * O(1) as long as the tailroom is not exceeded*/
+	void popFront(uint8_t* dst, pktSize_t len) {
+		ASSERT(len <= getSize());
+		if (dst != NULL) {
+			memcpy(dst, getBuffer(), len);
+		}
+		if (getBuffer() + len > buffer + 2 * AIRFRAME_HEADROOM) {
+			stripFront(len);
+		} else {
+			relocate(getBuffer() + len, getSize() - len);
+		}
+	}
+
+	void pushFront(uint8_t element) {
+		pushFront(&element, 1);
+	}
+
+	uint8_t popFront() {
+		uint8_t element;
+		popFront(&element, 1);
+		return element;
 	}
 
 	void printFrame(OutputStream* outputStream = NULL, bool prefix = false) const {
@@ -96,7 +158,7 @@ public:
                 (*outputStream) << cometos::hex << " ";
             }
             (*outputStream) << "0x";
-            uint8_t d = buffer[i];
+            uint8_t d = getConstBuffer()[i];
             if(d <= 0xF) {
                 (*outputStream) << "0";
             }
@@ -117,7 +179,16 @@ public:
         }
 
 private:
-	uint8_t buffer[AIRFRAME_MAX_SIZE];
+	/**Moves the data such that at least len bytes fit in front of it*/
+	void makeHeadroom(pktSize_t len);
+
+	/**Removes len bytes from the front by moving the remaining data back
+	 * to the default position*/
+	void stripFront(pktSize_t len);
+
+	/**The data window of at most AIRFRAME_MAX_SIZE bytes always starts
+	 * within the first 2 * AIRFRAME_HEADROOM bytes.*/
+	uint8_t buffer[AIRFRAME_MAX_SIZE + 2 * AIRFRAME_HEADROOM];
 };
 
 
@@ -130,7 +201,7 @@ private:
  * be given instead of invoking encapsulate and decapsulate in order to
  * provide interoperability.
  */
-class Airframe: public ObjectContainer {
+class Airframe: public ObjectContainer, public CheckedObject {
 	friend class MacAbstractionLayer;
 public:
 
@@ -199,11 +270,31 @@ public:
         data.pushFront(element);
 	}
 
+	/**Prepends len bytes of a header in wire order, O(1) within the
+	 * AIRFRAME_HEADROOM*/
+	void pushFront(const uint8_t* src, pktSize_t len) {
+	    data.pushFront(src, len);
+	}
+
+	/**Strips len bytes from the front, copying them to dst if given*/
+	void popFront(uint8_t* dst, pktSize_t len) {
+	    data.popFront(dst, len);
+	}
+
+	void popFront(pktSize_t len) {
+	    data.popFront(NULL, len);
+	}
+
 private:
 	AirframeData data;
 };
 
-typedef checked_ptr<Airframe> AirframePtr;
+typedef intrusive_checked_ptr<Airframe> AirframePtr;
+
+template <>
+struct checked_ptr_type<Airframe> {
+    typedef AirframePtr type;
+};
 
 } /* namespace cometos */
 
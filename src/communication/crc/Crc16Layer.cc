@@ -43,12 +43,7 @@
 using namespace cometos;
 
 static uint16_t getCrc(uint8_t* array, pktSize_t length, uint16_t initial_crc) {
-	uint16_t crc = initial_crc;
-
-	for (pktSize_t i = 0; i < length; i++) {
-		crc = crc16_update(crc, array[i]);
-	}
-	return crc;
+	return crc16_updateBlock(initial_crc, array, length);
 }
 
 void Crc16Layer::handleRequest(DataRequest* msg) {
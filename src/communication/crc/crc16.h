@@ -35,7 +35,59 @@
 
 #include <stdint.h>
 
+/**
+ * CRC engines for the two 16 bit CRCs used within CometOS:
+ *
+ * - crc16: reflected polynomial 0xA001 (0x8005), used by Crc16Layer and
+ *   the serial, TWI and RS485 communication modules
+ * - crc16xmodem: polynomial 0x1021, used by the Verifier and firmware
+ *
+ * The implementation is selected with CRC_MODE according to the flash and
+ * RAM budget of the platform:
+ *
+ * - CRC_MODE_BITWISE: no tables, eight iterations per byte
+ * - CRC_MODE_TABLE:   one constant 256 entry table per polynomial (512 bytes,
+ *                     in flash on AVR)
+ * - CRC_MODE_SLICE8:  additionally eight tables per polynomial (4 KiB of
+ *                     RAM each), generated at the first call, which process
+ *                     eight bytes per step in the block functions
+ *
+ * Independent of the mode, the block functions use carry-less
+ * multiplication on x86 CPUs with PCLMULQDQ for larger blocks.
+ */
+
+#define CRC_MODE_BITWISE	0
+#define CRC_MODE_TABLE		1
+#define CRC_MODE_SLICE8		2
+
+#ifndef CRC_MODE
+#if defined __AVR__
+#define CRC_MODE CRC_MODE_BITWISE
+#elif defined __SIZEOF_POINTER__ && __SIZEOF_POINTER__ == 8
+#define CRC_MODE CRC_MODE_SLICE8
+#else
+#define CRC_MODE CRC_MODE_TABLE
+#endif
+#endif
+
+#if CRC_MODE != CRC_MODE_BITWISE
+#if defined __AVR__
+#include <avr/pgmspace.h>
+
+// keep the tables in flash instead of copying them to RAM at startup
+#define CRC_TABLE_ATTR PROGMEM
+#define CRC_TABLE_READ(table, index) pgm_read_word(&(table)[index])
+#else
+#define CRC_TABLE_ATTR
+#define CRC_TABLE_READ(table, index) ((table)[index])
+#endif
+
+extern const uint16_t crc16_table[256] CRC_TABLE_ATTR;
+extern const uint16_t crc16xmodem_table[256] CRC_TABLE_ATTR;
+#endif
+
 inline uint16_t crc16_update(uint16_t crc, uint8_t a) {
+#if CRC_MODE == CRC_MODE_BITWISE
 	crc ^= a;
 	for (uint8_t i = 0; i < 8; ++i) {
 		if (crc & 1)
@@ -45,7 +97,39 @@ inline uint16_t crc16_update(uint16_t crc, uint8_t a) {
 	}
 
 	return crc;
+#else
+	return (crc >> 8) ^ CRC_TABLE_READ(crc16_table, (uint8_t) (crc ^ a));
+#endif
 }
 
+inline uint16_t crc16xmodem_update(uint16_t crc, uint8_t a) {
+#if CRC_MODE == CRC_MODE_BITWISE
+	crc ^= (uint16_t) a << 8;
+	for (uint8_t i = 0; i < 8; ++i) {
+		if (crc & 0x8000)
+			crc = (crc << 1) ^ 0x1021;
+		else
+			crc <<= 1;
+	}
+
+	return crc;
+#else
+	return (crc << 8)
+			^ CRC_TABLE_READ(crc16xmodem_table, (uint8_t) ((crc >> 8) ^ a));
 #endif
+}
+
+/**
+ * Continues crc over length bytes of data, equivalent to calling
+ * crc16_update() for each byte.
+ */
+uint16_t crc16_updateBlock(uint16_t crc, const uint8_t* data, uint16_t length);
 
+/**
+ * Continues crc over length bytes of data, equivalent to calling
+ * crc16xmodem_update() for each byte.
+ */
+uint16_t crc16xmodem_updateBlock(uint16_t crc, const uint8_t* data,
+		uint16_t length);
+
+#endif
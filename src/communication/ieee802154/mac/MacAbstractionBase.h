@@ -265,4 +265,9 @@ public:
 };
 
 }
+
+// attached to every frame
+OBJECT_CONTAINER_SLOT(cometos::MacRxInfo, 1)
+OBJECT_CONTAINER_SLOT(cometos::MacTxInfo, 2)
+
 #endif /* MACABSTRACTIONINTERFACE_H_ */
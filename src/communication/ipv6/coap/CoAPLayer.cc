@@ -37,6 +37,7 @@
 #include "CoAPLayer.h"
 #include "palId.h"
 #include "CoAPResource.h"
+#include "palLocalTime.h"
 
 
 namespace cometos_v6 {
@@ -54,7 +55,11 @@ CoAPLayer::CoAPLayer(const char * service_name) :
             sentMessages(),
             currMessageID(intrand(0xFFFF) % 0xFFFF),
             counter(0),
-            maxTokenLen(2) {
+            maxTokenLen(2),
+            numSentPackets(0),
+            numSentBytes(0),
+            numRcvdPackets(0),
+            numRcvdBytes(0) {
 }
 
 void CoAPLayer::initialize() {
@@ -67,6 +72,11 @@ void CoAPLayer::initialize() {
 void CoAPLayer::finish(){
     deleteAllMessages();
     cancel(&timer);
+
+    RECORD_SCALAR(numSentPackets);
+    RECORD_SCALAR(numSentBytes);
+    RECORD_SCALAR(numRcvdPackets);
+    RECORD_SCALAR(numRcvdBytes);
 }
 
 bool CoAPLayer::unbindPort(uint16_t port)
@@ -98,6 +108,277 @@ CoAPCallback_t* CoAPLayer::getCorrespondingListener(
     return NULL;
 }
 
+bool CoAPLayer::cancelObservation(const IPv6Address& addr,
+        uint16_t localPort, Token token)
+{
+    for (uint8_t i = 0; i < COAP_MAX_OBSERVATIONS; i++) {
+        if (observations[i].localPort == localPort &&
+                observations[i].addr == addr &&
+                observations[i].token == token)
+        {
+            observations[i].localPort = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+CoAPObservation_t* CoAPLayer::findObservation(const IPv6Address& addr,
+        uint16_t localPort, uint16_t remotePort, Token token)
+{
+    for (uint8_t i = 0; i < COAP_MAX_OBSERVATIONS; i++) {
+        if (observations[i].localPort == localPort &&
+                observations[i].remotePort == remotePort &&
+                observations[i].addr == addr &&
+                observations[i].token == token)
+        {
+            return &(observations[i]);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Called for a response to one of our requests carrying an Observe option,
+ * i.e. the server added us to the observers of the requested resource.
+ */
+void CoAPLayer::registerObservation(CoAPMessage* response, uint8_t tag)
+{
+    uint32_t seq = 0;
+    response->getUintOption(CoAPMessageOption::OPT_OBSERVE, seq);
+
+    CoAPObservation_t* observation = findObservation(response->getAddr(),
+            response->getMessageDstPort(),
+            response->getMessageSrcPort(),
+            response->getMessageToken());
+
+    for (uint8_t i = 0; i < COAP_MAX_OBSERVATIONS && observation == NULL; i++) {
+        if (observations[i].localPort == 0) {
+            observation = &(observations[i]);
+        }
+    }
+
+    if (observation == NULL) {
+        // notifications will be rejected, which ends the observation
+        LOG_WARN("No free observation");
+        return;
+    }
+
+    observation->addr = response->getAddr();
+    observation->localPort = response->getMessageDstPort();
+    observation->remotePort = response->getMessageSrcPort();
+    observation->token = response->getMessageToken();
+    observation->seq = seq;
+    observation->tag = tag;
+}
+
+void CoAPLayer::handleNotification(CoAPMessage* message,
+        CoAPObservation_t* observation)
+{
+    uint32_t seq;
+    if (!message->getUintOption(CoAPMessageOption::OPT_OBSERVE, seq)) {
+        // a response without Observe, e.g. an error, ends the observation
+        observation->localPort = 0;
+    } else if (isNewerNotification(observation->seq, seq)) {
+        observation->seq = seq;
+    } else {
+        LOG_INFO("Outdated notification " << seq);
+        return;
+    }
+
+    message->setMessageTag(observation->tag);
+    CoAPCallback_t* listener = getCorrespondingListener(responseListeners,
+            message->getMessageDstPort());
+    if (listener != NULL) {
+        listener->handler->incommingCoAPHandler(message, true);
+    } else {
+        LOG_WARN("No Response Handler Found");
+    }
+}
+
+
+#if COAP_CACHE_ENTRIES > 0
+/*
+ * Looks up the cached response of a GET request. Returns true if the request
+ * is answered from the cache or by the response of a pending request for the
+ * same entry, so it must not be sent. Otherwise entry is set to the pending
+ * entry the request has to be linked to once it is sent, if any, and the
+ * request revalidates a stale response if its ETag was added to options.
+ */
+bool CoAPLayer::lookupCache(const URL& url, uint16_t srcPort,
+        const CoAPMessageOption*& options, uint8_t& optionsLen,
+        uint8_t tag, CoAPMessageOption* revalidateOptions,
+        CoAPCacheEntry_t*& entry)
+{
+    entry = NULL;
+
+    CoAPMessageOption key[COAP_MAX_MESSAGE_OPTIONS];
+    uint8_t keyLen;
+    if (url.ip.isMulticast() ||
+            !ResponseCache<COAP_CACHE_ENTRIES>::getKey(
+                    url, options, optionsLen, key, keyLen))
+    {
+        return false;
+    }
+
+    time_ms_t now = palLocalTime_get();
+    uint16_t port = (url.port == 0) ? COAP_PORT : url.port;
+    CoAPCacheEntry_t* found = cache.find(url.ip, port, key, keyLen);
+    if (found != NULL) {
+        if (found->state == CoAPCacheEntry_t::PENDING || found->isFresh(now)) {
+            if (!found->addWaiter(srcPort, tag)) {
+                // too many waiting, send this one on its own
+                return false;
+            }
+            if (found->state == CoAPCacheEntry_t::VALID &&
+                    !isScheduled(&cacheTimer))
+            {
+                schedule(&cacheTimer, &CoAPLayer::deliverCachedResponses, 0);
+            }
+            LOG_INFO("Request answered by cache");
+            return true;
+        }
+        if (found->numWaiters > 0) {
+            return false;
+        }
+
+        // stale, revalidate it if possible, else fetch it again
+        CoAPOptionIterator it = found->response->getOptions();
+        while (it.next() && it.getOptionNr() <= CoAPMessageOption::OPT_ETAG) {
+            if (it.getOptionNr() == CoAPMessageOption::OPT_ETAG &&
+                    optionsLen < COAP_MAX_MESSAGE_OPTIONS)
+            {
+                for (uint8_t i = 0; i < optionsLen; i++) {
+                    revalidateOptions[i] = options[i];
+                }
+                revalidateOptions[optionsLen++].set(CoAPMessageOption::OPT_ETAG,
+                        it.getOptionData(), it.getOptionLen());
+                options = revalidateOptions;
+                entry = found;
+                entry->state = CoAPCacheEntry_t::PENDING;
+                break;
+            }
+        }
+        if (entry == NULL) {
+            cache.release(found);
+        }
+    }
+
+    if (entry == NULL) {
+        entry = cache.allocate(&buffer, url.ip, port, key, keyLen);
+    }
+    if (entry != NULL) {
+        entry->addWaiter(srcPort, tag);
+        entry->expires = now + (time_ms_t) TRANSMIT_WAIT * 1000;
+    }
+    return false;
+}
+
+/*
+ * Called for the response to the request of a pending cache entry, which is
+ * passed to all requests waiting for the entry. A 2.05 response is stored,
+ * a 2.03 response validates the stored one, which is passed instead. The
+ * Max-Age of the response only decides whether the entry is kept.
+ */
+void CoAPLayer::handleCachedResponse(CoAPCacheEntry_t* entry,
+        CoAPMessage* message, bool state)
+{
+    uint32_t maxAge = COAP_DEFAULT_MAX_AGE;
+    uint32_t value;
+    message->getUintOption(CoAPMessageOption::OPT_MAXAGE, maxAge);
+    if (maxAge > COAP_CACHE_MAX_AGE) {
+        maxAge = COAP_CACHE_MAX_AGE;
+    }
+
+    CoAPMessage* response = message;
+    bool cached = false;
+    if (state && message->getMessageCode() == COAP_VALID &&
+            entry->response != NULL)
+    {
+        response = entry->response;
+        cached = (maxAge > 0);
+    } else if (state && maxAge > 0 &&
+            message->getMessageCode() == COAP_CONTENT &&
+            !message->getUintOption(CoAPMessageOption::OPT_BLOCK2, value) &&
+            !message->getUintOption(CoAPMessageOption::OPT_OBSERVE, value))
+    {
+        if (entry->response != NULL) {
+            delete entry->response;
+        }
+        entry->response = new CoAPMessage(&buffer, message->getAddr(),
+                message->getMessageSrcPort(), message->getMessageDstPort(),
+                message->getMessagePacket(), message->getMessagePacketLen());
+        if (entry->response->getMessagePacket() == NULL) {
+            delete entry->response;
+            entry->response = NULL;
+        } else {
+            entry->response->decodeCoAPMessage();
+            cached = true;
+        }
+    }
+
+    if (cached) {
+        // waiting requests are answered from the cache
+        entry->state = CoAPCacheEntry_t::VALID;
+        entry->expires = palLocalTime_get() + (time_ms_t) maxAge * 1000;
+        if (!isScheduled(&cacheTimer)) {
+            schedule(&cacheTimer, &CoAPLayer::deliverCachedResponses, 0);
+        }
+        return;
+    }
+
+    // the entry is released before the listeners may send new requests,
+    // a validated response is kept until it was delivered
+    CoAPCacheWaiter_t waiters[COAP_CACHE_MAX_WAITERS];
+    uint8_t numWaiters = entry->numWaiters;
+    memcpy(waiters, entry->waiters, sizeof(CoAPCacheWaiter_t) * numWaiters);
+    if (response == entry->response) {
+        entry->response = NULL;
+    }
+    cache.release(entry);
+
+    for (uint8_t i = 0; i < numWaiters; i++) {
+        deliverResponse(response, waiters[i].port, waiters[i].tag, state);
+    }
+    if (response != message) {
+        delete response;
+    }
+}
+
+void CoAPLayer::deliverCachedResponses(cometos::Message* msg)
+{
+    for (uint8_t i = 0; i < COAP_CACHE_ENTRIES; i++) {
+        CoAPCacheEntry_t& entry = cache[i];
+        if (entry.state != CoAPCacheEntry_t::VALID) {
+            // pending entries keep their waiters until the response arrives
+            continue;
+        }
+        // entries with waiters are not evicted by requests of the listeners
+        for (uint8_t w = 0; entry.state == CoAPCacheEntry_t::VALID &&
+                w < entry.numWaiters; w++)
+        {
+            deliverResponse(entry.response, entry.waiters[w].port,
+                    entry.waiters[w].tag, true);
+        }
+        entry.numWaiters = 0;
+    }
+}
+
+void CoAPLayer::deliverResponse(CoAPMessage* response, uint16_t port,
+        uint8_t tag, bool state)
+{
+    response->setMessageTag(tag);
+    response->setMessageDstPort(port);
+
+    CoAPCallback_t* listener = getCorrespondingListener(responseListeners, port);
+    if (listener != NULL) {
+        LOG_DEBUG("Call Response Handler");
+        listener->handler->incommingCoAPHandler(response, state);
+    } else {
+        LOG_WARN("No Response Handler Found");
+    }
+}
+#endif
 
 /*
  *      Client has to call this function.
@@ -107,10 +388,9 @@ uint8_t CoAPLayer::sendMessage(
         uint16_t srcPort,
         uint8_t messageType,
         uint8_t messageCode,
-        CoAPMessageOption** options, uint8_t optionsLen,
+        const CoAPMessageOption* options, uint8_t optionsLen,
         const char* payload, uint16_t payloadLen,
-        bool handleOptions, bool handlePayload,
-        uint8_t tag)
+        bool handlePayload, uint8_t tag)
 {
     uint8_t errcode = 0;
     if (messageType == COAP_ACK ||
@@ -132,12 +412,20 @@ uint8_t CoAPLayer::sendMessage(
         return COAP_MESSAGE_URL_UNREC_ADDRESS;
     }
 
-    CoAPMessageOption* optionList[COAP_MAX_MESSAGE_OPTIONS];
-    memset(optionList, 0, sizeof(CoAPMessageOption*)*COAP_MAX_MESSAGE_OPTIONS);
-
-    for(uint8_t i = 0; i < optionsLen; i++) {
-        optionList[i] = options[i];
+#if COAP_CACHE_ENTRIES > 0
+    CoAPMessageOption revalidateOptions[COAP_MAX_MESSAGE_OPTIONS];
+    CoAPCacheEntry_t* entry = NULL;
+    if (messageCode == COAP_GET &&
+            lookupCache(url, srcPort, options, optionsLen, tag,
+                    revalidateOptions, entry))
+    {
+        delete message;
+        if (handlePayload) {
+            delete payload;
+        }
+        return 0;
     }
+#endif
 
     Token token;
     if ((messageType == COAP_CON || messageType == COAP_NON) &&
@@ -155,18 +443,35 @@ uint8_t CoAPLayer::sendMessage(
             message->getMessageSrcPort(),
             message->getMessageDstPort());
 
-    if (message->init(url,
+    int8_t err = message->init(url,
             srcPort,
             messageType,
             messageCode,
             messageID,
             token,
-            optionList, COAP_MAX_MESSAGE_OPTIONS,
+            options, optionsLen,
             payload, payloadLen,
-            handleOptions, handlePayload) != 0)
-    {
+            handlePayload);
+    if (err == COAP_MESSAGE_SILENTIGNORE && releaseIdleCacheEntries()) {
+        // the buffer is exhausted, drop the cached responses first
+        err = message->init(url,
+                srcPort,
+                messageType,
+                messageCode,
+                messageID,
+                token,
+                options, optionsLen,
+                payload, payloadLen,
+                handlePayload);
+    }
+    if (err != 0) {
         errcode = message->getMessageError();
         delete message;
+#if COAP_CACHE_ENTRIES > 0
+        if (entry != NULL) {
+            cache.release(entry);
+        }
+#endif
         return errcode;
     }
 
@@ -180,6 +485,18 @@ uint8_t CoAPLayer::sendMessage(
         LOG_INFO("Send to UDP Layer");
     }
 
+#if COAP_CACHE_ENTRIES > 0
+    if (entry != NULL) {
+        if (errcode) {
+            cache.release(entry);
+        } else {
+            // the response is passed to all requests waiting for the entry
+            entry->localPort = srcPort;
+            entry->token = token;
+        }
+    }
+#endif
+
     return errcode;
 }
 
@@ -191,15 +508,14 @@ void CoAPLayer::initMessage(
         uint8_t messageCode,
         uint16_t messageID,
         Token token,
-        CoAPMessageOption** options, uint8_t optionsLen,
+        const CoAPMessageOption* options, uint8_t optionsLen,
         const char* payload, uint16_t payloadLen,
-        bool handleOptions, bool handlePayload)
+        bool handlePayload)
 {
     if(msg == NULL) {
         return;
     }
 
-    //int error =
     msg->init(
             url,
             srcPort,
@@ -209,12 +525,24 @@ void CoAPLayer::initMessage(
             token,
             options, optionsLen,
             payload, payloadLen,
-            handleOptions, handlePayload);
+            false);
+
+    if(msg->getMessagePacket() == NULL && releaseIdleCacheEntries()){
+        // the buffer is exhausted, drop the cached responses first
+        msg->init(url,
+                srcPort,
+                messageType,
+                messageCode,
+                messageID,
+                token,
+                options, optionsLen,
+                payload, payloadLen,
+                false);
+    }
 
     if(msg->getMessagePacket() == NULL){
-        delete msg;
+        // still exhausted, drop all stored messages and retry
         deleteAllMessages();
-        msg = prepareMessage();
         msg->init(url,
                 srcPort,
                 messageType,
@@ -223,24 +551,37 @@ void CoAPLayer::initMessage(
                 token,
                 options, optionsLen,
                 payload, payloadLen,
-                handleOptions, handlePayload);
+                handlePayload);
+    } else if (handlePayload) {
+        delete payload;
     }
 }
 
 bool CoAPLayer::isResourceDiscovery(CoAPMessage* request){
 
-    char* path = NULL;
-    uint16_t pathLen = request->getPathString(path);
+    // compare the Uri-Path options segment by segment with the
+    // discovery path, the first char is a '/' that we'll have to ignore
+    const char* path = RESOURCE_DISCOVERY_PATH + 1;
 
-    if (pathLen >= 17) {
+    CoAPOptionIterator it = request->getOptions();
+    while (it.next() && it.getOptionNr() <= CoAPMessageOption::OPT_URIPATH) {
+        if (it.getOptionNr() != CoAPMessageOption::OPT_URIPATH) {
+            continue;
+        }
 
-        if(strncmp(path, RESOURCE_DISCOVERY_PATH, 17) == 0) {
-            delete[] path;
+        // the segment must not run past the end of the path
+        uint16_t segLen = it.getOptionLen();
+        if (segLen > strlen(path) ||
+                memcmp(path, it.getOptionData(), segLen) != 0 ||
+                (path[segLen] != '/' && path[segLen] != '\0')) {
+            return false;
+        }
+        if (path[segLen] == '\0') {
             return true;
         }
+        path += segLen + 1;
     }
 
-    delete[] path;
     return false;
 }
 
@@ -250,8 +591,16 @@ void CoAPLayer::udpPacketReceived(
 {
     ENTER_METHOD_SILENT();
 
+    numRcvdPackets++;
+    numRcvdBytes += length;
+
     CoAPMessage* message = new CoAPMessage(
             &buffer, src, srcPort, dstPort, data, length);
+    if (message->getMessageError() && releaseIdleCacheEntries()) {
+        // the buffer is exhausted, drop the cached responses first
+        delete message;
+        message = new CoAPMessage(&buffer, src, srcPort, dstPort, data, length);
+    }
     int8_t err = message->getMessageError();
     if (err) {
         LOG_ERROR("Error: " << (int)err);
@@ -259,7 +608,7 @@ void CoAPLayer::udpPacketReceived(
         delete message;
         return;
     }
-    int messageErrCode = message->decodeCoAPMessage(NULL, 0);
+    int messageErrCode = message->decodeCoAPMessage();
 
     LOG_DEBUG(" <-- " << message->getMessageString());
 //    message->printMessage(palId_id(), true);
@@ -302,6 +651,16 @@ void CoAPLayer::udpPacketReceived(
                     //insertReceivedMessage(message);
                     handleResponse(message, addr, srcPort, dstPort, true,
                             false, true, 0, token);
+                } else if (meaning == CoAPMessage::EMPTY) {
+                    //may acknowledge a separate response or a notification sent as CON
+                    CoAPMessage* sMsg = sentMessages.getSendMessage(addr,
+                            dstPort, srcPort, true, false, mID);
+                    if (sMsg != NULL && sMsg->isResponse() &&
+                            sMsg->getMessageRetries() < COAP_MAX_RETRANSMIT)
+                    {   //no need to retransmit it any longer
+                        sentMessages.recalculateMessageTimer(sMsg);
+                    }
+                    resources.handleAckOrReset(addr, srcPort, dstPort, mID, false);
                 } else {
                     LOG_INFO("Response to unknown request");
                 }
@@ -317,6 +676,7 @@ void CoAPLayer::udpPacketReceived(
             }
             else if(meaning == CoAPMessage::RESPONSE){
                 LOG_INFO("CON Resp from [" << src.str().c_str() << "]:" << srcPort);
+                CoAPObservation_t* observation = NULL;
                 if(sentMessages.didSendRequest(
                         addr, dstPort, srcPort, false, true, 0, token))
                 {   //If we sent a matching request
@@ -327,6 +687,12 @@ void CoAPLayer::udpPacketReceived(
                     handleResponse(message, addr, srcPort, dstPort, true,
                             false, true, 0, token);
                 }
+                else if ((observation = findObservation(
+                        addr, dstPort, srcPort, token)) != NULL)
+                {   //or it is a notification of a resource we observe
+                    sendAckMessage(message, dstPort);
+                    handleNotification(message, observation);
+                }
                 else{
                     //If we lack the context for this response send a RST message
                 	LOG_INFO("Lack of context");
@@ -416,6 +782,7 @@ void CoAPLayer::udpPacketReceived(
         case COAP_NON:
             if(meaning == CoAPMessage::RESPONSE){
                 LOG_INFO("NON Resp from [" << src.str().c_str() << "]:" << srcPort);
+                CoAPObservation_t* observation = NULL;
                 //if we have sent the matching request
                 if (sentMessages.didSendRequest(
                         addr, dstPort, srcPort, false, true, 0, token))
@@ -425,8 +792,18 @@ void CoAPLayer::udpPacketReceived(
                     handleResponse(message, addr, srcPort, dstPort, true,
                             false, true, 0, token);
 
+                } else if ((observation = findObservation(
+                        addr, dstPort, srcPort, token)) != NULL)
+                {
+                    handleNotification(message, observation);
                 } else {
                     LOG_INFO("unrec resp");
+                    uint32_t seq;
+                    if (message->getUintOption(
+                            CoAPMessageOption::OPT_OBSERVE, seq))
+                    {   //Let the server know that we are not interested anymore
+                        sendResetMessage(message, dstPort);
+                    }
                 }
                 delete message;
             }
@@ -460,7 +837,7 @@ void CoAPLayer::udpPacketReceived(
                                 message->getMessageToken(),
                                 NULL, 0,
                                 payload, strlen(payload),
-                                false, false);
+                                false);
 
                         delete[] payload;
 
@@ -501,6 +878,9 @@ void CoAPLayer::udpPacketReceived(
         case COAP_RST:
             LOG_INFO("RST from [" << src.str().c_str() << "]:" << srcPort);
             if(meaning == CoAPMessage::EMPTY){
+                //a resource may have sent the message on its own, e.g. a notification
+                resources.handleAckOrReset(addr, srcPort, dstPort, mID, true);
+
                 if (sentMessages.didSendMessage(
                         addr, dstPort, srcPort, true, false, mID))
                 {   //if we indeed sent the message (request or response or empty)
@@ -519,91 +899,70 @@ void CoAPLayer::udpPacketReceived(
 }
 
 /*
- * Runs through all sent messages and looks for CONs that have to be resent or can be deleted.
+ * Handles the sent messages whose timer expired and looks for CONs that have to be resent or can be deleted.
  * Sets the unresponded request inactive after COAP_MAX_RETRANSMIT and deletes them
  * after COAP_EXCHANGE_LIFETIME - alreadyWaitedTime, so that they were alive for at most COAP_EXCHANGE_TIME.
  */
 void CoAPLayer::retransmitTimerFired(cometos::Message* msg){
 
-    for(uint8_t i = 0; i < COAP_MAX_MESSAGE_BUFFER; i++)
-    {
-        CoAPMessage* msg = sentMessages.getEntry(i);
-        if(msg != NULL){
+    sentMessages.tick();
 
-            if(msg->getMessageType() == COAP_CON)
+    CoAPMessage* sMsg;
+    while((sMsg = sentMessages.popExpired()) != NULL)
+    {
+        //If this message can be retransmitted and its timeout triggered
+        if(sMsg->getMessageType() == COAP_CON &&
+                sMsg->getMessageRetries() < COAP_MAX_RETRANSMIT)
+        {
+            ReceivedMessage_t* receivedRstAck =
+                    rcvdMessages.getReceivedACK(sMsg);
+            //If we already have the response or have gotten an RST
+            if(rcvdMessages.didReceiveResponse(sMsg))
             {
-                //If this message can be retransmitted and its timeout triggered
-                if(msg->getMessageTimer() <= COAP_RETRANSMIT_INTVAL &&
-                        msg->getMessageRetries() < COAP_MAX_RETRANSMIT)
-                {
-                    ReceivedMessage_t* receivedRstAck =
-                            rcvdMessages.getReceivedACK(msg);
-                    //If we already have the response or have gotten an RST
-                    if(rcvdMessages.didReceiveResponse(msg))
-                    {
-                        sentMessages.recalculateMessageTimer(msg);
-                    }
-                    else if(receivedRstAck != NULL &&
-                            receivedRstAck->token.isZero() &&
-                            (receivedRstAck->type == COAP_RST ||
-                                    receivedRstAck->type == COAP_ACK))
-                    {
-                        rcvdMessages.deleteReceivedACK(msg);
-
-                        sentMessages.deleteMessage(
-                                msg->getAddr(),
-                                msg->getMessageSrcPort(),
-                                msg->getMessageDstPort(),
-                                false, true,
-                                0,
-                                msg->getMessageToken());
-                    }
-                    //if we didnt receive an response yet, resend it
-                    else if(msg->getMessageRetries() < COAP_MAX_RETRANSMIT - 1)
-                    {
-                        LOG_INFO("Resending "
-                                << (msg->getMessageRetries() + 1)
-                                << " th times");
-                        //send the message
-                        sendMessage(msg, false);
-
-                        //increment the retries
-                        msg->incrementMessageRetries(1);
-                        //set the new timer value
-                        msg->setMessageTimer();
-                    }
-                    else
-                    {
-                        //send it a last time and make sure the counter and timer are ok!
-                        LOG_INFO("Resending "
-                                << (msg->getMessageRetries() + 1)
-                                << " th times");
-                        //send the message
-                        sendMessage(msg, false);
-                        sentMessages.recalculateMessageTimer(msg);
-                    }
-                }
-                //if this message doesnt need to be resend just now, decrement its timer value
-                else if(msg->getMessageRetries() < COAP_MAX_RETRANSMIT)
-                {
-                    msg->incrementMessageTimer(- COAP_RETRANSMIT_INTVAL);
-                }
-                //the message awaits deletion after we can safely assume we won't need it anymore
-                else if(msg->getMessageRetries() == COAP_MAX_RETRANSMIT)
-                {
-                    sentMessages.removeSentOrIncreaseTimer(i);
-                }
+                sentMessages.recalculateMessageTimer(sMsg);
             }
-            else if(msg->getMessageType() == COAP_NON)
+            else if(receivedRstAck != NULL &&
+                    receivedRstAck->token.isZero() &&
+                    (receivedRstAck->type == COAP_RST ||
+                            receivedRstAck->type == COAP_ACK))
             {
-                sentMessages.removeSentOrIncreaseTimer(i);
+                rcvdMessages.deleteReceivedACK(sMsg);
+                sentMessages.remove(sMsg);
+            }
+            //if we didnt receive an response yet, resend it
+            else if(sMsg->getMessageRetries() < COAP_MAX_RETRANSMIT - 1)
+            {
+                LOG_INFO("Resending "
+                        << (sMsg->getMessageRetries() + 1)
+                        << " th times");
+                //send the message
+                sendMessage(sMsg, false);
+
+                //increment the retries
+                sMsg->incrementMessageRetries(1);
+                //set the new timer value
+                sMsg->setMessageTimer();
+                sentMessages.rearm(sMsg);
+            }
+            else
+            {
+                //send it a last time and make sure the counter and timer are ok!
+                LOG_INFO("Resending "
+                        << (sMsg->getMessageRetries() + 1)
+                        << " th times");
+                //send the message
+                sendMessage(sMsg, false);
+                sentMessages.recalculateMessageTimer(sMsg);
             }
         }
-
+        //the message awaits deletion after we can safely assume we won't need it anymore
+        else
+        {
+            sentMessages.expire(sMsg);
+        }
     }
     /*
-     * Runs through the list of received messages and deletes them as soon as
-     * they lived for their lifetime.
+     * Deletes the received messages as soon as they lived for their lifetime.
      */
     rcvdMessages.decreaseTimeAndDelete();
 
@@ -612,7 +971,9 @@ void CoAPLayer::retransmitTimerFired(cometos::Message* msg){
             << " Entries: " << (int)buffer.getNumBuffers());
 #endif
 
-    if (!isScheduled(&timer)) {
+    //sending or receiving a message restarts the timer
+    if (!isScheduled(&timer) &&
+            (!sentMessages.isEmpty() || !rcvdMessages.isEmpty())) {
         schedule(&timer, &CoAPLayer::retransmitTimerFired, RETRANSMIT_INTERVAL);
     }
 
@@ -665,6 +1026,8 @@ uint8_t CoAPLayer::sendMessage(CoAPMessage* message, bool handleData) {
             srcPort, dstPort, data, dataLen, NULL))
     {
         LOG_INFO("CoAP->UDP succ");
+        numSentPackets++;
+        numSentBytes += dataLen;
 
         if(message->getMessageType() != COAP_RST && message->getMessageType() != COAP_ACK){
 
@@ -771,12 +1134,29 @@ void CoAPLayer::handleResponse(CoAPMessage* message, const IPv6Address& addr,
                 byMessageID, byToken,
                 messageID, token);
         message->setMessageTag(sMsg->getMessageTag());
-        CoAPCallback_t* listener = getCorrespondingListener(responseListeners, dstPort);
-        if (listener != NULL) {
-            LOG_DEBUG("Call Response Handler");
-            listener->handler->incommingCoAPHandler(message, state);
-        } else {
-            LOG_WARN("No Response Handler Found");
+
+        uint32_t seq;
+        if (state && message->isResponse() &&
+                message->getUintOption(CoAPMessageOption::OPT_OBSERVE, seq))
+        {
+            registerObservation(message, sMsg->getMessageTag());
+        }
+
+#if COAP_CACHE_ENTRIES > 0
+        CoAPCacheEntry_t* entry = cache.findPending(addr, dstPort, srcPort,
+                sMsg->getMessageToken());
+        if (entry != NULL) {
+            handleCachedResponse(entry, message, state);
+        } else
+#endif
+        {
+            CoAPCallback_t* listener = getCorrespondingListener(responseListeners, dstPort);
+            if (listener != NULL) {
+                LOG_DEBUG("Call Response Handler");
+                listener->handler->incommingCoAPHandler(message, state);
+            } else {
+                LOG_WARN("No Response Handler Found");
+            }
         }
 
         sentMessages.deleteMessage(addr, dstPort, srcPort, byMessageID, byToken, messageID, token);
@@ -790,9 +1170,25 @@ void CoAPLayer::deleteAllMessages(){
     LOG_INFO("Deleting all Msgs");
     rcvdMessages.deleteAll();
     sentMessages.deleteAll();
+#if COAP_CACHE_ENTRIES > 0
+    // the requests of pending entries are gone, so no response will come
+    cache.releaseIdle(true);
+#endif
 //    buffer.clearAll();
 }
 
+/*
+ * Releases the cache entries no request is waiting for, to make room in the
+ * buffer. Returns true if any entry was released.
+ */
+bool CoAPLayer::releaseIdleCacheEntries(){
+#if COAP_CACHE_ENTRIES > 0
+    return cache.releaseIdle(false) > 0;
+#else
+    return false;
+#endif
+}
+
 
 
 }
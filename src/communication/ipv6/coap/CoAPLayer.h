@@ -44,6 +44,7 @@
 #include "ReceivedMessages.h"
 #include "SentMessages.h"
 #include "ResourceList.h"
+#include "ResponseCache.h"
 
 #include "coapconfig.h"
 
@@ -65,8 +66,24 @@ struct CoAPCallback_t {
         CoAPCallback_t(): port(0), handler(NULL) {}
 };
 
+/*
+ * A resource observed by this node as a client (RFC 7641). Notifications
+ * matching addr, remotePort and token are passed to the listener bound to
+ * localPort; the entry is unused if localPort is 0.
+ */
+struct CoAPObservation_t {
+        IPv6Address         addr;
+        uint16_t            localPort;
+        uint16_t            remotePort;
+        Token               token;
+        uint32_t            seq;
+        uint8_t             tag;
+        CoAPObservation_t(): localPort(0), remotePort(0), seq(0), tag(0) {}
+};
+
 class CoAPLayer: public cometos::Module, public UDPListener {
         friend class CoAPMessage;
+        friend class CoAPResource;
 public:
     static const char *const MODULE_NAME;
     static const char* RESOURCE_DISCOVERY_PATH;
@@ -120,27 +137,26 @@ public:
     }
     bool unbindPort(uint16_t port);
 
+    /*
+     * Forgets the observation of the resource at addr with the given token,
+     * as found in the notifications passed to the listener of localPort.
+     * Further notifications are rejected with a RST, which makes the
+     * server remove this client from its observers.
+     */
+    bool cancelObservation(const IPv6Address& addr, uint16_t localPort,
+            Token token);
+
 /*    CoAPMessage* prepareMessage(const URL& url, uint16_t srcPort,
             uint8_t messageType, uint8_t messageCode,
             CoAPMessageOption** options, uint8_t optionsLen, const char* payload,
             uint16_t payloadLen, bool handleOptions, bool handlePayload,
             uint8_t* errCode);
 */
-    CoAPMessageOption* prepareOption(uint16_t optNr, const char* optData,
-            uint16_t optLen, uint8_t optOrder){
-        CoAPMessageOption* ret = new CoAPMessageOption(&buffer, optNr, optData, optLen, optOrder);
-        if (ret->isValid()) {
-            return ret;
-        }
-        delete ret;
-        return NULL;
-    }
-
     uint8_t sendMessage(CoAPMessage* message, bool handleData);
     uint8_t sendMessage(const URL& url, uint16_t srcPort, uint8_t messageType,
-            uint8_t messageCode, CoAPMessageOption** options,
+            uint8_t messageCode, const CoAPMessageOption* options,
             uint8_t optionsLen, const char* payload, uint16_t payloadLen,
-            bool handleOptions, bool handlePayload, uint8_t tag);
+            bool handlePayload, uint8_t tag);
 
     CoAPMessage* prepareMessage() {
 
@@ -150,9 +166,8 @@ public:
 
     void initMessage(CoAPMessage* msg, const URL& url, uint16_t srcPort,
             uint8_t messageType, uint8_t messageCode, uint16_t messageID,
-            Token token, CoAPMessageOption** options, uint8_t optionsLen,
-            const char* payload, uint16_t payloadLen, bool handleOptions,
-            bool handlePayload);
+            Token token, const CoAPMessageOption* options, uint8_t optionsLen,
+            const char* payload, uint16_t payloadLen, bool handlePayload);
 
 
     bool insertResource(CoAPResource* insertMe) {
@@ -184,6 +199,37 @@ private:
 
     CoAPCallback_t* getCorrespondingListener(CoAPCallback_t Listeners[COAP_MAX_LISTENERS], uint16_t port);
 
+    CoAPObservation_t* findObservation(const IPv6Address& addr,
+            uint16_t localPort, uint16_t remotePort, Token token);
+
+    void registerObservation(CoAPMessage* response, uint8_t tag);
+
+    void handleNotification(CoAPMessage* message,
+            CoAPObservation_t* observation);
+
+#if COAP_CACHE_ENTRIES > 0
+    bool lookupCache(const URL& url, uint16_t srcPort,
+            const CoAPMessageOption*& options, uint8_t& optionsLen,
+            uint8_t tag, CoAPMessageOption* revalidateOptions,
+            CoAPCacheEntry_t*& entry);
+
+    void handleCachedResponse(CoAPCacheEntry_t* entry, CoAPMessage* message,
+            bool state);
+
+    void deliverCachedResponses(cometos::Message* msg);
+
+    void deliverResponse(CoAPMessage* response, uint16_t port, uint8_t tag,
+            bool state);
+#endif
+
+    /*
+     * Compares Observe sequence numbers as 24 bit serial numbers.
+     */
+    static bool isNewerNotification(uint32_t lastSeq, uint32_t seq) {
+        return (lastSeq < seq && seq - lastSeq < ((uint32_t) 1 << 23)) ||
+               (lastSeq > seq && lastSeq - seq > ((uint32_t) 1 << 23));
+    }
+
     virtual void udpPacketReceived(const IPv6Address& src,
                uint16_t srcPort,
                uint16_t dstPort,
@@ -198,7 +244,7 @@ private:
                 Token(),
                 NULL, 0,
                 NULL, 0,
-                false, false);
+                false);
     }
     void sendAckMessage(CoAPMessage* recMessage, uint16_t port){
         //Only an ACK, no piggieback answer!
@@ -211,7 +257,7 @@ private:
                 Token(),
                 NULL, 0,
                 NULL, 0,
-                false, false);
+                false);
 
     }
     void sendPiggybackMessage(CoAPMessage* recMessage, uint16_t port,
@@ -227,7 +273,7 @@ private:
                 token,
                 NULL, 0,
                 payload, payloadLen,
-                false, false);
+                false);
 
     }
     int sendConfirmableMessage(CoAPMessage* recMessage, uint16_t port);
@@ -243,6 +289,8 @@ private:
 
     void deleteAllMessages();
 
+    bool releaseIdleCacheEntries();
+
     void handleResponse(CoAPMessage* message, const IPv6Address& addr,
             uint16_t srcPort, uint16_t dstPort, bool state,
             bool byMessageID, bool byToken,
@@ -251,9 +299,9 @@ private:
 
     void sendResponse(CoAPMessage* recMessage, uint16_t port,
             uint8_t messageType, uint8_t messageCode,
-            uint16_t messageID, Token token, CoAPMessageOption** options,
+            uint16_t messageID, Token token, const CoAPMessageOption* options,
             uint8_t optionsLen, const char* payload, uint16_t payloadLen,
-            bool handleOptions, bool handlePayload) {
+            bool handlePayload) {
         URL url(URL::COAP, recMessage->getAddr(), recMessage->getMessageSrcPort());
 
         CoAPMessage* query = prepareMessage();
@@ -266,7 +314,7 @@ private:
                 token,
                 options, optionsLen,
                 payload, payloadLen,
-                handleOptions, handlePayload);  //initiate message
+                handlePayload);  //initiate message
         sendMessage(query, false);    //and try to send it
     }
 
@@ -281,14 +329,29 @@ private:
 
     LowpanBuffer<COAP_SET_BUFFER_SIZE, COAP_SET_BUFFER_ENTRIES> buffer;
 
+#if COAP_CACHE_ENTRIES > 0
+    // keeps its responses in buffer, so it has to be destroyed before
+    ResponseCache<COAP_CACHE_ENTRIES>   cache;
+
+    cometos::Message cacheTimer;
+#endif
+
     //listens for responses. Critical for clients.
     CoAPCallback_t responseListeners[COAP_MAX_LISTENERS];
 
     ResourceList<COAP_MAX_RESOURCES>    resources;
 
+    CoAPObservation_t observations[COAP_MAX_OBSERVATIONS];
+
     int counter;            //let only every 3rd message be processed
 
     uint8_t maxTokenLen;    //Determines how long the tokens are. If more security is needed, set this value upto 8!
+
+    // traffic caused by CoAP, including retransmissions, ACKs and RSTs
+    uint32_t numSentPackets;
+    uint32_t numSentBytes;
+    uint32_t numRcvdPackets;
+    uint32_t numRcvdBytes;
 };
 
 }
@@ -102,7 +102,6 @@ void CoAPTest::sendTimerFired(cometos::LongScheduleMsg * msg){
     }
     if(sender)
     {
-        bool handleOptions = false;
         bool handlePayload = false;
         //TODO delete resPaths / resTypes upon finish
         int8_t error = 0;
@@ -117,7 +116,6 @@ void CoAPTest::sendTimerFired(cometos::LongScheduleMsg * msg){
                     cometos_v6::COAP_GET,
                     NULL, 0,
                     NULL, 0,
-                    handleOptions,
                     handlePayload,
                     0); //Ressource Discovery
         } else {   //we found resources, GET a representation of all of them
@@ -133,7 +131,6 @@ void CoAPTest::sendTimerFired(cometos::LongScheduleMsg * msg){
                         cometos_v6::COAP_GET,
                         NULL, 0,
                         NULL, 0,
-                        handleOptions,
                         handlePayload,
                         1);
             }
@@ -150,7 +147,6 @@ void CoAPTest::sendTimerFired(cometos::LongScheduleMsg * msg){
                                 cometos_v6::COAP_POST,
                                 NULL, 0,
                                 "off", 3,
-                                handleOptions,
                                 handlePayload,
                                 2);
                     } else {
@@ -162,7 +158,6 @@ void CoAPTest::sendTimerFired(cometos::LongScheduleMsg * msg){
                                 cometos_v6::COAP_POST,
                                 NULL, 0,
                                 "on", 2,
-                                handleOptions,
                                 handlePayload,
                                 2);
                     }
@@ -178,7 +173,6 @@ void CoAPTest::sendTimerFired(cometos::LongScheduleMsg * msg){
                                 cometos_v6::COAP_POST,
                                 NULL, 0,
                                 "150", 3,
-                                handleOptions,
                                 handlePayload,
                                 2);
                     } else {
@@ -190,7 +184,6 @@ void CoAPTest::sendTimerFired(cometos::LongScheduleMsg * msg){
                                 cometos_v6::COAP_POST,
                                 NULL, 0,
                                 "10", 2,
-                                handleOptions,
                                 handlePayload,
                                 2);
                     }
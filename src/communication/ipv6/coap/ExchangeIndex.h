@@ -0,0 +1,132 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef EXCHANGEINDEX_H_
+#define EXCHANGEINDEX_H_
+
+#include "IPv6Address.h"
+#include "Token.h"
+#include <string.h>
+
+namespace cometos_v6 {
+
+/*
+ * Hash values identifying a message exchange by peer, ports and message ID
+ * or token. Only the interface identifier of the peer is hashed, as all
+ * nodes of a 6LoWPAN usually share the same prefix.
+ */
+inline uint16_t coapEndpointHash(const IPv6Address& addr,
+        uint16_t srcPort, uint16_t dstPort)
+{
+    uint16_t hash = srcPort ^ (dstPort << 3) ^ (dstPort >> 13);
+    for (uint8_t i = 4; i < 8; i++) {
+        hash = (hash << 5) + hash + addr.getAddressPart(i);
+    }
+    return hash;
+}
+
+inline uint16_t coapMessageIDHash(const IPv6Address& addr,
+        uint16_t srcPort, uint16_t dstPort, uint16_t messageID)
+{
+    return coapEndpointHash(addr, srcPort, dstPort) ^ (messageID * 0x9E37u);
+}
+
+inline uint16_t coapTokenHash(const IPv6Address& addr,
+        uint16_t srcPort, uint16_t dstPort, Token token)
+{
+    uint16_t hash = coapEndpointHash(addr, srcPort, dstPort);
+    for (uint8_t i = 0; i < Token::MAX_LENGTH; i++) {
+        hash = (hash << 5) + hash + token.getTokenPart(i);
+    }
+    return hash;
+}
+
+/*
+ * Chained hash index over the N slots of a message table. It only stores
+ * slot numbers; the owner has to compare the actual entries while walking
+ * a chain, as different keys can share one.
+ */
+template<uint8_t N>
+class ExchangeIndex {
+public:
+    static const uint8_t NONE = 0xFF;
+
+    ExchangeIndex() {
+        clear();
+    }
+
+    void clear() {
+        memset(heads, NONE, sizeof(heads));
+        memset(chain, NONE, sizeof(chain));
+    }
+
+    void insert(uint8_t slot, uint16_t hash) {
+        uint16_t bucket = hash & (BUCKETS - 1);
+        chain[slot] = heads[bucket];
+        heads[bucket] = slot;
+    }
+
+    void remove(uint8_t slot, uint16_t hash) {
+        uint8_t* link = &heads[hash & (BUCKETS - 1)];
+        while (*link != NONE) {
+            if (*link == slot) {
+                *link = chain[slot];
+                chain[slot] = NONE;
+                return;
+            }
+            link = &chain[*link];
+        }
+    }
+
+    uint8_t first(uint16_t hash) const {
+        return heads[hash & (BUCKETS - 1)];
+    }
+
+    uint8_t next(uint8_t slot) const {
+        return chain[slot];
+    }
+
+private:
+    static constexpr uint16_t bucketsFor(uint16_t n, uint16_t b = 1) {
+        return (b >= n) ? b : bucketsFor(n, b << 1);
+    }
+
+    // a power of two, so the bucket can be masked from the hash
+    static const uint16_t BUCKETS = bucketsFor(N);
+
+    uint8_t heads[BUCKETS];
+    uint8_t chain[N];
+};
+
+}
+
+#endif /* EXCHANGEINDEX_H_ */
@@ -39,6 +39,7 @@
 #define RECEIVEDMESSAGES_H_
 
 #include "CoAPMessage.h"
+#include "ExchangeIndex.h"
 #include "coapconfig.h"
 
 namespace cometos_v6 {
@@ -50,15 +51,15 @@ struct ReceivedMessage_t {
     CoapType_t  type;
     uint16_t    srcPort;
     uint16_t    dstPort;
-    uint8_t     lifeTime;
-    ReceivedMessage_t(const CoAPMessage* msg) :
+    uint16_t    expires;
+    ReceivedMessage_t(const CoAPMessage* msg, uint16_t expires) :
         ip(msg->getAddr()),
         token(msg->getMessageToken()),
         msgId(msg->getMessageID()),
         type(msg->getMessageType()),
         srcPort(msg->getMessageSrcPort()),
         dstPort(msg->getMessageDstPort()),
-        lifeTime(COAP_MESSAGE_LIFETIME)
+        expires(expires)
     {
     }
 
@@ -85,66 +86,79 @@ struct ReceivedMessage_t {
     }
 };
 
+/*
+ * Buffer of the received messages, used to detect duplicates. Messages are
+ * indexed by (peer, ports, message ID) and (peer, ports, token). As all of
+ * them live for COAP_MESSAGE_LIFETIME ticks, they expire in the order they
+ * were received, which is kept in a doubly linked list.
+ */
 template<uint8_t N>
 class ReceivedMessages {
 public:
-    ReceivedMessages() {
+    ReceivedMessages() :
+        numFree(N),
+        oldest(NONE),
+        newest(NONE),
+        now(0)
+    {
         for (uint8_t i = 0; i < N; i++) {
             rcvdMessages[i] = NULL;
+            freeSlots[i] = N - 1 - i;
         }
     }
     bool didReceiveMessage(const CoAPMessage* Message) {
-        for (uint8_t i = 0; i < N; i++) {
-            if (rcvdMessages[i] != NULL && *(rcvdMessages[i]) == Message) {
+        uint16_t hash = coapMessageIDHash(Message->getAddr(),
+                Message->getMessageSrcPort(), Message->getMessageDstPort(),
+                Message->getMessageID());
+        for (uint8_t i = midIndex.first(hash); i != NONE; i = midIndex.next(i)) {
+            if (*(rcvdMessages[i]) == Message) {
                 return true;
             }
         }
         return false;
     }
     bool didReceiveResponse(const CoAPMessage* Query) {
-        for (uint8_t i = 0; i < N; i++) {
-            if (rcvdMessages[i] != NULL && rcvdMessages[i]->isAnswerTo(Query)) {
-                return true;
-            }
-        }
-        return false;
+        return findResponse(Query) != NONE;
     }
     ReceivedMessage_t* getReceivedACK(const CoAPMessage* Msg) {
-        for (uint8_t i = 0; i < N; i++) {
-            if (rcvdMessages[i] != NULL && rcvdMessages[i]->isAckTo(Msg)) {
-                return rcvdMessages[i];
-            }
-        }
-        return NULL;
+        uint8_t i = findACK(Msg);
+        return (i != NONE) ? rcvdMessages[i] : NULL;
     }
     void insertReceivedMessage(CoAPMessage* received){
-        for (uint8_t i = 0; i < N; i++) {
-            if (rcvdMessages[i] == NULL) {
-                rcvdMessages[i] = new ReceivedMessage_t(received);
-                return;
-            }
+        if (numFree == 0) {
+            return;
+        }
+        uint8_t i = freeSlots[--numFree];
+        rcvdMessages[i] = new ReceivedMessage_t(received,
+                now + COAP_MESSAGE_LIFETIME + 1);
+        midIndex.insert(i, hashMessageID(rcvdMessages[i]));
+        tokenIndex.insert(i, hashToken(rcvdMessages[i]));
+
+        prev[i] = newest;
+        next[i] = NONE;
+        if (newest != NONE) {
+            next[newest] = i;
+        } else {
+            oldest = i;
         }
+        newest = i;
     }
     void deleteReceivedResponse(const CoAPMessage* Query) {
-        for (uint8_t i = 0; i < N; i++) {
-            if (rcvdMessages[i] != NULL && rcvdMessages[i]->isAnswerTo(Query)) {
-                delete rcvdMessages[i];
-                rcvdMessages[i] = NULL;
-            }
+        uint8_t i;
+        while ((i = findResponse(Query)) != NONE) {
+            remove(i);
         }
     }
     void deleteReceivedACK(const CoAPMessage* Msg) {
-        for (uint8_t i = 0; i < N; i++) {
-            if (rcvdMessages[i] != NULL && rcvdMessages[i]->isAckTo(Msg)) {
-                delete rcvdMessages[i];
-                rcvdMessages[i] = NULL;
-            }
+        uint8_t i;
+        while ((i = findACK(Msg)) != NONE) {
+            remove(i);
         }
     }
     bool MsgIdReceived(const IPv6Address& addr, uint16_t srcPort, uint16_t dstPort, uint16_t MessageID) {
-        for (uint8_t i = 0; i < N; i++) {
-            if (rcvdMessages[i] != NULL &&
-                    rcvdMessages[i]->ip == addr &&
+        uint16_t hash = coapMessageIDHash(addr, srcPort, dstPort, MessageID);
+        for (uint8_t i = midIndex.first(hash); i != NONE; i = midIndex.next(i)) {
+            if (rcvdMessages[i]->ip == addr &&
                     rcvdMessages[i]->srcPort == srcPort &&
                     rcvdMessages[i]->dstPort == dstPort &&
                     rcvdMessages[i]->msgId == MessageID) {
@@ -155,9 +169,9 @@ public:
     }
 
     bool TokenReceived(const IPv6Address& addr, uint16_t srcPort, uint16_t dstPort, const Token& token) {
-        for (uint8_t i = 0; i < N; i++) {
-            if (rcvdMessages[i] != NULL &&
-                    rcvdMessages[i]->ip == addr &&
+        uint16_t hash = coapTokenHash(addr, srcPort, dstPort, token);
+        for (uint8_t i = tokenIndex.first(hash); i != NONE; i = tokenIndex.next(i)) {
+            if (rcvdMessages[i]->ip == addr &&
                     rcvdMessages[i]->srcPort == srcPort &&
                     rcvdMessages[i]->dstPort == dstPort &&
                     rcvdMessages[i]->token == token) {
@@ -167,32 +181,99 @@ public:
         return false;
     }
 
+    /*
+     * Advances the time by one tick and deletes the messages that lived
+     * for their lifetime, which are the oldest ones.
+     */
     void decreaseTimeAndDelete() {
-        for(uint8_t i = 0; i < N; i++)
+        now++;
+        while (oldest != NONE &&
+                (int16_t)(now - rcvdMessages[oldest]->expires) >= 0)
         {
-            if (rcvdMessages[i] != NULL){
-                if (rcvdMessages[i]->lifeTime > 0) {
-                    rcvdMessages[i]->lifeTime--;
-                } else {
-                    delete rcvdMessages[i];
-                    rcvdMessages[i] = NULL;
-                }
-            }
+            remove(oldest);
         }
     }
 
     void deleteAll() {
-        for(uint8_t i = 0; i < N; i++)
-        {
-            if(rcvdMessages[i] != NULL){
-                delete rcvdMessages[i];
-                rcvdMessages[i] = NULL;
-            }
+        while (oldest != NONE) {
+            remove(oldest);
         }
     }
 
+    bool isEmpty() {
+        return numFree == N;
+    }
+
 private:
+    static const uint8_t NONE = ExchangeIndex<N>::NONE;
+
+    static uint16_t hashMessageID(const ReceivedMessage_t* rcvd) {
+        return coapMessageIDHash(rcvd->ip, rcvd->srcPort, rcvd->dstPort, rcvd->msgId);
+    }
+
+    static uint16_t hashToken(const ReceivedMessage_t* rcvd) {
+        return coapTokenHash(rcvd->ip, rcvd->srcPort, rcvd->dstPort, rcvd->token);
+    }
+
+    uint8_t findResponse(const CoAPMessage* Query) {
+        uint16_t hash = coapTokenHash(Query->getAddr(),
+                Query->getMessageDstPort(), Query->getMessageSrcPort(),
+                Query->getMessageToken());
+        for (uint8_t i = tokenIndex.first(hash); i != NONE; i = tokenIndex.next(i)) {
+            if (rcvdMessages[i]->isAnswerTo(Query)) {
+                return i;
+            }
+        }
+        return NONE;
+    }
+
+    uint8_t findACK(const CoAPMessage* Msg) {
+        uint16_t hash = coapMessageIDHash(Msg->getAddr(),
+                Msg->getMessageDstPort(), Msg->getMessageSrcPort(),
+                Msg->getMessageID());
+        for (uint8_t i = midIndex.first(hash); i != NONE; i = midIndex.next(i)) {
+            if (rcvdMessages[i]->isAckTo(Msg)) {
+                return i;
+            }
+        }
+        return NONE;
+    }
+
+    void remove(uint8_t i) {
+        midIndex.remove(i, hashMessageID(rcvdMessages[i]));
+        tokenIndex.remove(i, hashToken(rcvdMessages[i]));
+
+        if (prev[i] != NONE) {
+            next[prev[i]] = next[i];
+        } else {
+            oldest = next[i];
+        }
+        if (next[i] != NONE) {
+            prev[next[i]] = prev[i];
+        } else {
+            newest = prev[i];
+        }
+
+        delete rcvdMessages[i];
+        rcvdMessages[i] = NULL;
+        freeSlots[numFree++] = i;
+    }
+
     ReceivedMessage_t* rcvdMessages[N];
+
+    ExchangeIndex<N> midIndex;
+    ExchangeIndex<N> tokenIndex;
+
+    uint8_t freeSlots[N];
+    uint8_t numFree;
+
+    // slots in the order they were received
+    uint8_t prev[N];
+    uint8_t next[N];
+    uint8_t oldest;
+    uint8_t newest;
+
+    uint16_t now;
 };
 
 
@@ -41,13 +41,21 @@
 
 namespace cometos_v6 {
 
-template<uint8_t N>
+/*
+ * Resources are dispatched by a trie of their path segments. A request is
+ * handled by the resource with the longest path that is a prefix of the
+ * request's path, e.g. a resource "/sensors" handles "/sensors/light0" if
+ * there is no resource "/sensors/light0". Segments point into the path of
+ * the resources, so the trie is rebuilt whenever a resource is removed.
+ */
+template<uint8_t N, uint8_t S = COAP_MAX_RESOURCE_SEGMENTS>
 class ResourceList {
 public:
     ResourceList() {
         for (uint8_t i = 0; i < N; i++) {
             resources[i] = NULL;
         }
+        rebuildTrie();
     }
 
     ~ResourceList() {
@@ -68,6 +76,7 @@ public:
             if(resources[i] == deleteMe){
                 delete deleteMe;
                 resources[i] = NULL;
+                rebuildTrie();
                 return true;
             }
         }
@@ -75,22 +84,31 @@ public:
     }
 
     CoAPResource* findMatchingResource(CoAPMessage* request){
-        char* path = NULL;
-        uint16_t pathLen = request->getPathString(path);
+        uint8_t node = ROOT;
+        uint8_t match = nodes[ROOT].resource;
+        bool hasPath = false;
 
-        if (pathLen == 0) return NULL;
-
-        LOG_DEBUG(path);
+        CoAPOptionIterator it = request->getOptions();
+        while (it.next() && it.getOptionNr() <= CoAPMessageOption::OPT_URIPATH) {
+            if (it.getOptionNr() != CoAPMessageOption::OPT_URIPATH) {
+                continue;
+            }
+            hasPath = true;
+            if (node == NONE) {
+                continue;
+            }
 
-        for(uint8_t i = 0; i < N; i++) {
-            if ((resources[i] != NULL) && (resources[i]->hasPath(path))) {
-                delete[] path;
-                return resources[i];
+            node = findChild(node, (const char*)it.getOptionData(),
+                    it.getOptionLen());
+            if (node != NONE && nodes[node].resource != NONE) {
+                match = nodes[node].resource;
             }
         }
 
-        delete[] path;
-        return NULL;
+        if (!hasPath || it.isMalformed()) {
+            return NULL;
+        }
+        return (match != NONE) ? resources[match] : NULL;
     }
 
     bool insertResource(CoAPResource* insertMe, CoAPLayer* owner, CoAPBuffer_t* buffer){
@@ -104,12 +122,35 @@ public:
                 insertMe->setBuffer(buffer);
                 insertMe->init(owner);
                 resources[i] = insertMe;
+                if (!insertPath(i)) {
+                    // not enough trie nodes left for the path
+                    resources[i] = NULL;
+                    rebuildTrie();
+                    return false;
+                }
                 return true;
             }
         }
         return false;
     }
 
+    /*
+     * Passes an empty ACK or RST received from addr:srcPort to all resources
+     * bound to dstPort, as the layer does not know which one sent the message.
+     */
+    void handleAckOrReset(const IPv6Address& addr, uint16_t srcPort,
+            uint16_t dstPort, uint16_t messageID, bool reset) {
+        for(uint8_t i = 0; i < N; i++) {
+            if(resources[i] != NULL && resources[i]->getLocalPort() == dstPort) {
+                if(reset) {
+                    resources[i]->handleReset(addr, srcPort, messageID);
+                } else {
+                    resources[i]->handleAck(addr, srcPort, messageID);
+                }
+            }
+        }
+    }
+
     uint16_t getResourceDiscoveryList(char*& payload) {
         uint16_t pathLength = 0;                                //and send their paths as a response
 
@@ -162,7 +203,73 @@ public:
     }
 
 protected:
+    static const uint8_t NONE = 0xFF;
+    static const uint8_t ROOT = 0;
+
+    struct PathNode_t {
+        const char* segment;
+        uint8_t     segLen;
+        uint8_t     child;
+        uint8_t     sibling;
+        uint8_t     resource;
+    };
+
+    uint8_t findChild(uint8_t node, const char* segment, uint16_t segLen) {
+        for (uint8_t c = nodes[node].child; c != NONE; c = nodes[c].sibling) {
+            if (nodes[c].segLen == segLen &&
+                    memcmp(nodes[c].segment, segment, segLen) == 0) {
+                return c;
+            }
+        }
+        return NONE;
+    }
+
+    bool insertPath(uint8_t res) {
+        uint8_t node = ROOT;
+        for (uint8_t i = 0; i < resources[res]->getPathSize(); i++) {
+            const char* segment = resources[res]->getPathSegment(i);
+            uint16_t segLen = strlen(segment);
+            uint8_t child = findChild(node, segment, segLen);
+            if (child == NONE) {
+                if (numNodes >= S + 1 || segLen > 0xFF) {
+                    return false;
+                }
+                child = numNodes++;
+                nodes[child].segment = segment;
+                nodes[child].segLen = segLen;
+                nodes[child].child = NONE;
+                nodes[child].resource = NONE;
+                nodes[child].sibling = nodes[node].child;
+                nodes[node].child = child;
+            }
+            node = child;
+        }
+        // the first resource inserted for a path keeps handling it
+        if (nodes[node].resource == NONE) {
+            nodes[node].resource = res;
+        }
+        return true;
+    }
+
+    void rebuildTrie() {
+        numNodes = 1;
+        nodes[ROOT].segment = NULL;
+        nodes[ROOT].segLen = 0;
+        nodes[ROOT].child = NONE;
+        nodes[ROOT].sibling = NONE;
+        nodes[ROOT].resource = NONE;
+        for (uint8_t i = 0; i < N; i++) {
+            if (resources[i] != NULL) {
+                insertPath(i);
+            }
+        }
+    }
+
     CoAPResource* resources[N];
+
+    // node 0 is the root, every other node a segment of a resource's path
+    PathNode_t nodes[S + 1];
+    uint8_t numNodes;
 };
 
 }
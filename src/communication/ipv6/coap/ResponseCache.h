@@ -0,0 +1,335 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef RESPONSECACHE_H_
+#define RESPONSECACHE_H_
+
+#include "CoAPMessage.h"
+#include "URL.h"
+#include "coapconfig.h"
+#include "palLocalTime.h"
+
+namespace cometos_v6 {
+
+/*
+ * A local request waiting for the response of a cache entry.
+ */
+struct CoAPCacheWaiter_t {
+        uint16_t            port;
+        uint8_t             tag;
+};
+
+/*
+ * A response to a GET request, cached by the endpoint of the request and
+ * its Uri-Path, Uri-Query and Accept options, which are serialized to key
+ * as (option number, length, value) triples.
+ *
+ * While state is PENDING, a request for the entry is on its way to the
+ * endpoint, sent from localPort with the given token, and response may
+ * still hold a stale representation that is being revalidated.
+ * expires is the local time at which the response becomes stale, or at
+ * which a pending request is given up.
+ */
+struct CoAPCacheEntry_t {
+        enum state_t : uint8_t {
+            UNUSED, PENDING, VALID
+        };
+
+        IPv6Address         addr;
+        uint16_t            port;
+        BufferInformation*  key;
+        CoAPMessage*        response;
+        uint16_t            localPort;
+        Token               token;
+        time_ms_t           expires;
+        state_t             state;
+        uint8_t             numWaiters;
+        CoAPCacheWaiter_t   waiters[COAP_CACHE_MAX_WAITERS];
+
+        CoAPCacheEntry_t():
+            port(0),
+            key(NULL),
+            response(NULL),
+            localPort(0),
+            expires(0),
+            state(UNUSED),
+            numWaiters(0) {}
+
+        bool isFresh(time_ms_t now) const {
+            return state == VALID && (int32_t)(expires - now) > 0;
+        }
+
+        bool addWaiter(uint16_t port, uint8_t tag) {
+            if (numWaiters >= COAP_CACHE_MAX_WAITERS) {
+                return false;
+            }
+            waiters[numWaiters].port = port;
+            waiters[numWaiters].tag = tag;
+            numWaiters++;
+            return true;
+        }
+};
+
+/*
+ * Cache of responses to GET requests sent by this node as a client, e.g.
+ * by a border router on behalf of backend clients. Repeated requests are
+ * answered from the cache as long as the response is fresh (Max-Age),
+ * stale responses with an ETag are revalidated, and requests for an entry
+ * whose request is pending wait for its response instead of being sent.
+ */
+template<uint8_t N>
+class ResponseCache {
+public:
+    ResponseCache() {}
+
+    ~ResponseCache() {
+        clear();
+    }
+
+    /*
+     * Builds the key options of a request in key. Returns false if the
+     * request has other options than Accept, which are not cached.
+     */
+    static bool getKey(const URL& url, const CoAPMessageOption* options,
+            uint8_t optionsLen, CoAPMessageOption* key, uint8_t& keyLen)
+    {
+        keyLen = 0;
+        for (uint8_t i = 0; i < url.numParts; i++) {
+            uint16_t optNr;
+            if (url.uriParts[i].getType() == URIPart::URIPATH) {
+                optNr = CoAPMessageOption::OPT_URIPATH;
+            } else if (url.uriParts[i].getType() == URIPart::URIQUERY) {
+                optNr = CoAPMessageOption::OPT_URIQUERY;
+            } else {
+                return false;
+            }
+            if (keyLen >= COAP_MAX_MESSAGE_OPTIONS) {
+                return false;
+            }
+            key[keyLen++].set(optNr, url.uriParts[i].getPart(),
+                    url.uriParts[i].getLength());
+        }
+
+        for (uint8_t i = 0; i < optionsLen; i++) {
+            if (options[i].getOptionNr() != CoAPMessageOption::OPT_ACCEPT ||
+                    keyLen >= COAP_MAX_MESSAGE_OPTIONS)
+            {
+                return false;
+            }
+            key[keyLen++] = options[i];
+        }
+        return true;
+    }
+
+    /*
+     * Returns the entry of the endpoint addr:port with the given key, or
+     * NULL. Pending requests which were not answered in time are dropped.
+     */
+    CoAPCacheEntry_t* find(const IPv6Address& addr, uint16_t port,
+            const CoAPMessageOption* key, uint8_t keyLen)
+    {
+        time_ms_t now = palLocalTime_get();
+        for (uint8_t i = 0; i < N; i++) {
+            CoAPCacheEntry_t& entry = entries[i];
+            if (entry.state == CoAPCacheEntry_t::UNUSED ||
+                    entry.port != port ||
+                    !(entry.addr == addr) ||
+                    !matchesKey(entry, key, keyLen))
+            {
+                continue;
+            }
+            if (entry.state == CoAPCacheEntry_t::PENDING &&
+                    (int32_t)(entry.expires - now) <= 0)
+            {
+                release(&entry);
+                return NULL;
+            }
+            return &entry;
+        }
+        return NULL;
+    }
+
+    /*
+     * Returns the pending entry whose request was sent from localPort to
+     * addr:port with the given token, or NULL.
+     */
+    CoAPCacheEntry_t* findPending(const IPv6Address& addr, uint16_t localPort,
+            uint16_t port, Token token)
+    {
+        for (uint8_t i = 0; i < N; i++) {
+            CoAPCacheEntry_t& entry = entries[i];
+            if (entry.state == CoAPCacheEntry_t::PENDING &&
+                    entry.localPort == localPort &&
+                    entry.port == port &&
+                    entry.addr == addr &&
+                    entry.token == token)
+            {
+                return &entry;
+            }
+        }
+        return NULL;
+    }
+
+    /*
+     * Takes an entry for addr:port and key in the state PENDING. Unused
+     * entries are taken first, then the entry that is stale or expires
+     * first. Entries with waiters are only taken if their request is
+     * given up. Returns NULL if there is no such entry, or if the buffer
+     * has no space left for the key.
+     */
+    CoAPCacheEntry_t* allocate(CoAPBuffer_t* buffer, const IPv6Address& addr,
+            uint16_t port, const CoAPMessageOption* key, uint8_t keyLen)
+    {
+        time_ms_t now = palLocalTime_get();
+        CoAPCacheEntry_t* victim = NULL;
+        for (uint8_t i = 0; i < N; i++) {
+            CoAPCacheEntry_t& entry = entries[i];
+            if (entry.state == CoAPCacheEntry_t::UNUSED) {
+                victim = &entry;
+                break;
+            }
+            if (entry.numWaiters > 0 &&
+                    (entry.state != CoAPCacheEntry_t::PENDING ||
+                     (int32_t)(entry.expires - now) > 0))
+            {
+                continue;
+            }
+            if (victim == NULL ||
+                    (int32_t)(entry.expires - victim->expires) < 0)
+            {
+                victim = &entry;
+            }
+        }
+        if (victim == NULL) {
+            return NULL;
+        }
+        release(victim);
+
+        uint16_t keySize = 0;
+        for (uint8_t i = 0; i < keyLen; i++) {
+            keySize += 2 + key[i].getOptionLen();
+        }
+        if (keySize > 0) {
+            victim->key = buffer->getBuffer(keySize);
+            if (victim->key == NULL) {
+                return NULL;
+            }
+            uint16_t pos = 0;
+            for (uint8_t i = 0; i < keyLen; i++) {
+                (*victim->key)[pos++] = key[i].getOptionNr();
+                (*victim->key)[pos++] = key[i].getOptionLen();
+                victim->key->copyToBuffer(key[i].getOptionData(),
+                        key[i].getOptionLen(), pos);
+                pos += key[i].getOptionLen();
+            }
+        }
+
+        victim->addr = addr;
+        victim->port = port;
+        victim->state = CoAPCacheEntry_t::PENDING;
+        return victim;
+    }
+
+    /*
+     * Frees the key and response of an entry and makes it unused.
+     */
+    void release(CoAPCacheEntry_t* entry) {
+        if (entry->key != NULL) {
+            entry->key->free();
+            entry->key = NULL;
+        }
+        if (entry->response != NULL) {
+            delete entry->response;
+            entry->response = NULL;
+        }
+        entry->state = CoAPCacheEntry_t::UNUSED;
+        entry->numWaiters = 0;
+    }
+
+    /*
+     * Releases the entries no request is waiting for, and the pending ones
+     * too if withPending is set. Returns the number of released entries.
+     */
+    uint8_t releaseIdle(bool withPending) {
+        uint8_t released = 0;
+        for (uint8_t i = 0; i < N; i++) {
+            CoAPCacheEntry_t& entry = entries[i];
+            if (entry.state != CoAPCacheEntry_t::UNUSED &&
+                    (entry.numWaiters == 0 ||
+                     (withPending && entry.state == CoAPCacheEntry_t::PENDING)))
+            {
+                release(&entry);
+                released++;
+            }
+        }
+        return released;
+    }
+
+    void clear() {
+        for (uint8_t i = 0; i < N; i++) {
+            release(&entries[i]);
+        }
+    }
+
+    CoAPCacheEntry_t& operator[](uint8_t i) {
+        return entries[i];
+    }
+
+private:
+    bool matchesKey(const CoAPCacheEntry_t& entry,
+            const CoAPMessageOption* key, uint8_t keyLen)
+    {
+        uint16_t keySize = (entry.key != NULL) ? entry.key->getSize() : 0;
+        const uint8_t* stored = (entry.key != NULL) ?
+                entry.key->getContent() : NULL;
+
+        uint16_t pos = 0;
+        for (uint8_t i = 0; i < keyLen; i++) {
+            uint16_t len = key[i].getOptionLen();
+            if (pos + 2 + len > keySize ||
+                    stored[pos] != key[i].getOptionNr() ||
+                    stored[pos + 1] != len ||
+                    memcmp(&stored[pos + 2], key[i].getOptionData(), len) != 0)
+            {
+                return false;
+            }
+            pos += 2 + len;
+        }
+        return pos == keySize;
+    }
+
+    CoAPCacheEntry_t entries[N];
+};
+
+}
+
+#endif /* RESPONSECACHE_H_ */
@@ -38,37 +38,35 @@
 #define SENTMESSAGES_H_
 
 #include "CoAPMessage.h"
+#include "ExchangeIndex.h"
 #include "coapconfig.h"
 
 namespace cometos_v6 {
 
+/*
+ * Buffer of the sent messages that may still be retransmitted or answered.
+ * Messages are indexed by (peer, ports, message ID) and (peer, ports, token)
+ * and kept in a heap ordered by the tick at which their timer expires, so
+ * neither matching an incoming message nor a tick of the retransmission
+ * timer has to look at every buffered message.
+ *
+ * Messages sent to a multicast address may be answered by any peer. They
+ * are hashed with the unspecified address and looked up in addition, as
+ * long as there is one.
+ */
 template<uint8_t N>
 class SentMessages {
 public:
-    SentMessages(): sentMessages{NULL} {
-//        for (uint8_t i = 0; i < N; i++) {
-//            sentMessages[i] = NULL;
-//        }
-    }
-
-    void removeSentOrIncreaseTimer(uint8_t i) {
-        //message can safely be removed
-        if(sentMessages[i]->getMessageTimer() <= COAP_RETRANSMIT_INTVAL)
-        {
-            deleteMessage(
-                    sentMessages[i]->getAddr(),
-                    sentMessages[i]->getMessageSrcPort(),
-                    sentMessages[i]->getMessageDstPort(),
-                    false, true,
-                    0,
-                    sentMessages[i]->getMessageToken(), false);
-
-            remove(sentMessages[i]);
-        }
-        //still have to wait
-        else
-        {
-            sentMessages[i]->incrementMessageTimer( -1 );
+    SentMessages():
+        sentMessages{NULL},
+        numFree(N),
+        heapSize(0),
+        numMulticast(0),
+        now(0)
+    {
+        for (uint8_t i = 0; i < N; i++) {
+            freeSlots[i] = N - 1 - i;
+            heapPos[i] = NONE;
         }
     }
 
@@ -119,38 +117,50 @@ public:
             return true;
         }
 
-        for(uint8_t i = 0; i < N; i++){
-            if(sentMessages[i] == NULL){
-                if (add->getMessageType() == COAP_NON) {
-                    add->setMessageTimer(COAP_NON_LIFETIME);
-                }
-                sentMessages[i] = add;
-                return true;
-            }
+        if (numFree == 0) {
+            return false;
         }
-        return false;
+
+        if (add->getMessageType() == COAP_NON) {
+            add->setMessageTimer(COAP_NON_LIFETIME);
+        }
+        uint8_t slot = freeSlots[--numFree];
+        sentMessages[slot] = add;
+        if (add->getAddr().isMulticast()) {
+            numMulticast++;
+        }
+        midIndex.insert(slot, hashMessageID(add));
+        tokenIndex.insert(slot, hashToken(add));
+        arm(slot);
+        return true;
     }
 
     bool remove(CoAPMessage* msg) {
+        uint8_t slot = slotOf(msg);
+        if (slot == NONE) {
+            return false;
+        }
 
-        for(uint8_t i = 0; i < N; i++){
-            if(sentMessages[i] == msg){
-                sentMessages[i] = NULL;
-                delete msg;
-                return true;
-            }
+        midIndex.remove(slot, hashMessageID(msg));
+        tokenIndex.remove(slot, hashToken(msg));
+        if (heapPos[slot] != NONE) {
+            heapRemove(heapPos[slot]);
         }
-        return false;
+        if (msg->getAddr().isMulticast()) {
+            numMulticast--;
+        }
+        sentMessages[slot] = NULL;
+        freeSlots[numFree++] = slot;
+        delete msg;
+        return true;
     }
 
     bool isFull() {
+        return numFree == 0;
+    }
 
-        for(uint8_t i = 0; i < N; i++) {
-            if(sentMessages[i] == NULL) {
-                return false;
-            }
-        }
-        return true;
+    bool isEmpty() {
+        return numFree == N;
     }
 
     bool deleteMessage(const IPv6Address& addr, uint16_t srcPort,
@@ -175,22 +185,22 @@ public:
             bool tryMID,
             bool tryToken) {
 
-        for (uint8_t i = 0; i < N; i++) {
-            if(sentMessages[i] != NULL) {
-                if((sentMessages[i]->getAddr() == addr || sentMessages[i]->getAddr().isMulticast()) &&
-                        sentMessages[i]->getMessageDstPort() == dstPort &&
-                        sentMessages[i]->getMessageSrcPort() == srcPort)
-                {
-                    if (((sentMessages[i]->getMessageID() == messageID) || !tryMID) &&
-                       ((sentMessages[i]->getMessageToken() == token) || !tryToken))
-                    {
-                        return sentMessages[i];
-                    }
+        if (!tryMID && !tryToken) {
+            for (uint8_t i = 0; i < N; i++) {
+                if (matches(i, addr, srcPort, dstPort, messageID, token, false, false)) {
+                    return sentMessages[i];
                 }
             }
+            return NULL;
         }
 
-        return NULL;
+        uint8_t slot = lookup(addr, srcPort, dstPort, messageID, token,
+                tryMID, tryToken, addr);
+        if (slot == NONE && numMulticast > 0) {
+            slot = lookup(addr, srcPort, dstPort, messageID, token,
+                    tryMID, tryToken, IPv6Address());
+        }
+        return (slot != NONE) ? sentMessages[slot] : NULL;
     }
 
     void deleteAll() {
@@ -200,6 +210,15 @@ public:
                 sentMessages[i] = NULL;
             }
         }
+        midIndex.clear();
+        tokenIndex.clear();
+        for (uint8_t i = 0; i < N; i++) {
+            freeSlots[i] = N - 1 - i;
+            heapPos[i] = NONE;
+        }
+        numFree = N;
+        heapSize = 0;
+        numMulticast = 0;
     }
 
     void recalculateMessageTimer(CoAPMessage* msg) {
@@ -213,14 +232,216 @@ public:
         //reset timer and increment to automatically handle negative timer value, as setMessageTimer only accepts uint8_t
         msg->setMessageTimer(0);
         msg->incrementMessageTimer(COAP_EXCHANGE_LIFETIME - waitedTime);
+        rearm(msg);
     }
 
-    CoAPMessage* getEntry(uint8_t i) {
-        if (i < N) return sentMessages[i];
-        return NULL;
+    /*
+     * Advances the time by one tick of the retransmission timer. Afterwards,
+     * popExpired() returns the messages whose timer expired one by one.
+     */
+    void tick() {
+        now++;
     }
+
+    /*
+     * Returns the message with the earliest expired timer, or NULL if there
+     * is none, and takes it out of the timer order. The caller has to either
+     * rearm() the message after updating its timer, or remove it.
+     */
+    CoAPMessage* popExpired() {
+        if (heapSize == 0 || (int16_t)(now - deadlines[heap[0]]) < 0) {
+            return NULL;
+        }
+        uint8_t slot = heap[0];
+        heapRemove(0);
+        return sentMessages[slot];
+    }
+
+    /*
+     * (Re)starts the timer of the message, according to its type, retries
+     * and timer value.
+     */
+    void rearm(CoAPMessage* msg) {
+        uint8_t slot = slotOf(msg);
+        if (slot != NONE) {
+            arm(slot);
+        }
+    }
+
+    /*
+     * Removes a message that won't be needed anymore, together with the
+     * first other message of the exchange with the same token.
+     */
+    void expire(CoAPMessage* msg) {
+        CoAPMessage* other = find(
+                msg->getAddr(),
+                msg->getMessageSrcPort(),
+                msg->getMessageDstPort(),
+                0, msg->getMessageToken(),
+                false, true);
+        if (other != NULL && other != msg) {
+            remove(other);
+        }
+        remove(msg);
+    }
+
 protected:
+    static const uint8_t NONE = ExchangeIndex<N>::NONE;
+
+    /*
+     * Number of ticks until the timer of the message expires. The timer of
+     * a CON that may still be retransmitted runs COAP_RETRANSMIT_INTVAL per
+     * tick, the lifetime of all other messages one per tick.
+     */
+    static uint16_t ticksUntilDue(const CoAPMessage* msg) {
+        uint8_t timer = msg->getMessageTimer();
+        if (msg->getMessageType() == COAP_CON &&
+                msg->getMessageRetries() < COAP_MAX_RETRANSMIT)
+        {
+            uint16_t ticks = (timer + COAP_RETRANSMIT_INTVAL - 1) / COAP_RETRANSMIT_INTVAL;
+            return (ticks > 0) ? ticks : 1;
+        }
+        return (timer <= COAP_RETRANSMIT_INTVAL) ? 1 : timer - COAP_RETRANSMIT_INTVAL + 1;
+    }
+
+    static IPv6Address keyAddr(const CoAPMessage* msg) {
+        return msg->getAddr().isMulticast() ? IPv6Address() : msg->getAddr();
+    }
+
+    static uint16_t hashMessageID(const CoAPMessage* msg) {
+        return coapMessageIDHash(keyAddr(msg), msg->getMessageSrcPort(),
+                msg->getMessageDstPort(), msg->getMessageID());
+    }
+
+    static uint16_t hashToken(const CoAPMessage* msg) {
+        return coapTokenHash(keyAddr(msg), msg->getMessageSrcPort(),
+                msg->getMessageDstPort(), msg->getMessageToken());
+    }
+
+    bool matches(uint8_t i, const IPv6Address& addr, uint16_t srcPort,
+            uint16_t dstPort, uint16_t messageID, const Token& token,
+            bool tryMID, bool tryToken)
+    {
+        return sentMessages[i] != NULL &&
+                (sentMessages[i]->getAddr() == addr || sentMessages[i]->getAddr().isMulticast()) &&
+                sentMessages[i]->getMessageDstPort() == dstPort &&
+                sentMessages[i]->getMessageSrcPort() == srcPort &&
+                ((sentMessages[i]->getMessageID() == messageID) || !tryMID) &&
+                ((sentMessages[i]->getMessageToken() == token) || !tryToken);
+    }
+
+    uint8_t lookup(const IPv6Address& addr, uint16_t srcPort,
+            uint16_t dstPort, uint16_t messageID, const Token& token,
+            bool tryMID, bool tryToken, const IPv6Address& key)
+    {
+        if (tryMID) {
+            uint16_t hash = coapMessageIDHash(key, srcPort, dstPort, messageID);
+            for (uint8_t i = midIndex.first(hash); i != NONE; i = midIndex.next(i)) {
+                if (matches(i, addr, srcPort, dstPort, messageID, token, tryMID, tryToken)) {
+                    return i;
+                }
+            }
+        } else {
+            uint16_t hash = coapTokenHash(key, srcPort, dstPort, token);
+            for (uint8_t i = tokenIndex.first(hash); i != NONE; i = tokenIndex.next(i)) {
+                if (matches(i, addr, srcPort, dstPort, messageID, token, tryMID, tryToken)) {
+                    return i;
+                }
+            }
+        }
+        return NONE;
+    }
+
+    uint8_t slotOf(const CoAPMessage* msg) {
+        if (msg == NULL) {
+            return NONE;
+        }
+        for (uint8_t i = midIndex.first(hashMessageID(msg)); i != NONE; i = midIndex.next(i)) {
+            if (sentMessages[i] == msg) {
+                return i;
+            }
+        }
+        return NONE;
+    }
+
+    void arm(uint8_t slot) {
+        deadlines[slot] = now + ticksUntilDue(sentMessages[slot]);
+        if (heapPos[slot] != NONE) {
+            heapRemove(heapPos[slot]);
+        }
+        heap[heapSize] = slot;
+        heapPos[slot] = heapSize;
+        heapSize++;
+        siftUp(heapSize - 1);
+    }
+
+    bool earlier(uint8_t a, uint8_t b) {
+        return (int16_t)(deadlines[heap[a]] - deadlines[heap[b]]) < 0;
+    }
+
+    void swap(uint8_t a, uint8_t b) {
+        uint8_t slot = heap[a];
+        heap[a] = heap[b];
+        heap[b] = slot;
+        heapPos[heap[a]] = a;
+        heapPos[heap[b]] = b;
+    }
+
+    void siftUp(uint8_t pos) {
+        while (pos > 0 && earlier(pos, (pos - 1) / 2)) {
+            swap(pos, (pos - 1) / 2);
+            pos = (pos - 1) / 2;
+        }
+    }
+
+    void siftDown(uint8_t pos) {
+        while (true) {
+            uint16_t smallest = pos;
+            uint16_t left = 2 * pos + 1;
+            uint16_t right = left + 1;
+            if (left < heapSize && earlier(left, smallest)) {
+                smallest = left;
+            }
+            if (right < heapSize && earlier(right, smallest)) {
+                smallest = right;
+            }
+            if (smallest == pos) {
+                return;
+            }
+            swap(pos, smallest);
+            pos = smallest;
+        }
+    }
+
+    void heapRemove(uint8_t pos) {
+        uint8_t slot = heap[pos];
+        heapSize--;
+        if (pos != heapSize) {
+            uint8_t moved = heap[heapSize];
+            heap[pos] = moved;
+            heapPos[moved] = pos;
+            siftUp(pos);
+            siftDown(heapPos[moved]);
+        }
+        heapPos[slot] = NONE;
+    }
+
     CoAPMessage* sentMessages[N];
+
+    ExchangeIndex<N> midIndex;
+    ExchangeIndex<N> tokenIndex;
+
+    uint8_t freeSlots[N];
+    uint8_t numFree;
+
+    // binary min-heap of slots, ordered by the tick their timer expires
+    uint8_t heap[N];
+    uint8_t heapPos[N];
+    uint16_t deadlines[N];
+    uint8_t heapSize;
+
+    uint8_t numMulticast;
+    uint16_t now;
 };
 
 }
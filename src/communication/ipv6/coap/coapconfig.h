@@ -45,12 +45,34 @@ namespace cometos_v6 {
 const uint8_t COAP_MESSAGE_METADATA_SIZE =  14;
 const uint8_t COAP_MAX_MESSAGE_OPTIONS =    15;
 
-const uint8_t COAP_MAX_MESSAGE_BUFFER = 25;
-const uint8_t COAP_MAX_RESOURCES = 5;
+/*
+ * Sent and received messages are looked up by hash indices and resources
+ * by a trie of their path segments, so these limits can be raised, e.g. on
+ * a border router, without slowing down the processing of each message.
+ * COAP_MAX_RESOURCE_SEGMENTS is the number of distinct path segments of
+ * all resources. All of them have to be below 255.
+ */
+#ifndef COAP_MAX_MESSAGE_BUFFER
+#define COAP_MAX_MESSAGE_BUFFER     25
+#endif
+
+#ifndef COAP_MAX_RESOURCES
+#define COAP_MAX_RESOURCES          5
+#endif
+
+#ifndef COAP_MAX_RESOURCE_SEGMENTS
+#define COAP_MAX_RESOURCE_SEGMENTS  (COAP_MAX_RESOURCES * 2)
+#endif
+
 const uint8_t COAP_MAX_LISTENERS = 5;
 
-const uint16_t COAP_SET_BUFFER_SIZE = 2500;
-const uint8_t COAP_SET_BUFFER_ENTRIES = (COAP_MAX_MESSAGE_BUFFER * 3) + COAP_MAX_MESSAGE_OPTIONS;
+#ifndef COAP_SET_BUFFER_SIZE
+#define COAP_SET_BUFFER_SIZE        2500
+#endif
+
+const uint8_t COAP_SET_BUFFER_ENTRIES =
+        ((COAP_MAX_MESSAGE_BUFFER * 3) + COAP_MAX_MESSAGE_OPTIONS > 255) ?
+        255 : (COAP_MAX_MESSAGE_BUFFER * 3) + COAP_MAX_MESSAGE_OPTIONS;
 //typedef LowpanBuffer<COAP_SET_BUFFER_SIZE, COAP_SET_BUFFER_ENTRIES> CoAPBuffer_t;
 typedef ManagedBuffer CoAPBuffer_t;
 
@@ -58,6 +80,68 @@ const uint8_t COAP_RETRANSMIT_INTVAL = 2;
 
 static const uint8_t COAP_MESSAGE_LIFETIME = 30;
 
+/*
+ * Block-wise transfers (RFC 7959): largest block size exponent we offer
+ * (block size = 2^(szx + 4)) and the bytes of a frame assumed to be used
+ * by compressed IPv6/UDP headers and the CoAP header/options, so that a
+ * block fits into a single MAC frame without 6LoWPAN fragmentation.
+ */
+#ifndef COAP_BLOCK_MAX_SZX
+#define COAP_BLOCK_MAX_SZX          2
+#endif
+
+#ifndef COAP_BLOCK_FRAME_OVERHEAD
+#define COAP_BLOCK_FRAME_OVERHEAD   40
+#endif
+
+/*
+ * Seconds a client is asked to wait (Max-Age of a 5.03 response) if a file
+ * resource is busy with reading or writing a block of another request.
+ */
+#ifndef COAP_FILE_BUSY_MAX_AGE
+#define COAP_FILE_BUSY_MAX_AGE      1
+#endif
+
+/*
+ * Observe (RFC 7641): clients a single resource can be observed by, every
+ * how many notifications a CON is sent to check that the client is still
+ * interested, and after how many unacknowledged CONs it is dropped.
+ * COAP_MAX_OBSERVATIONS limits the resources observed as a client.
+ */
+#ifndef COAP_OBSERVE_MAX_OBSERVERS
+#define COAP_OBSERVE_MAX_OBSERVERS  4
+#endif
+
+#ifndef COAP_OBSERVE_CON_INTERVAL
+#define COAP_OBSERVE_CON_INTERVAL   8
+#endif
+
+#ifndef COAP_OBSERVE_MAX_UNACKED
+#define COAP_OBSERVE_MAX_UNACKED    2
+#endif
+
+#ifndef COAP_MAX_OBSERVATIONS
+#define COAP_MAX_OBSERVATIONS       4
+#endif
+
+/*
+ * Cache of responses to GET requests sent as a client, e.g. by a border
+ * router on behalf of backend clients; disabled with 0 entries. Up to
+ * COAP_CACHE_MAX_WAITERS requests of an entry are answered by a single
+ * response. Responses are cached for at most COAP_CACHE_MAX_AGE seconds.
+ */
+#ifndef COAP_CACHE_ENTRIES
+#define COAP_CACHE_ENTRIES          0
+#endif
+
+#ifndef COAP_CACHE_MAX_WAITERS
+#define COAP_CACHE_MAX_WAITERS      4
+#endif
+
+#ifndef COAP_CACHE_MAX_AGE
+#define COAP_CACHE_MAX_AGE          86400
+#endif
+
 }
 
 #endif
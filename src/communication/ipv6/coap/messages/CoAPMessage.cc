@@ -197,36 +197,42 @@ cometos::SString<100> CoAPMessage::getErrorCodeDescriptions(uint8_t error){
 
 int8_t CoAPMessage::init(
         const URL& url, uint16_t srcPort, uint8_t messageType, uint8_t messageCode,
-        uint16_t messageID, Token token, CoAPMessageOption** options,
+        uint16_t messageID, Token token, const CoAPMessageOption* options,
         uint8_t optionsLen, const char* payload, uint16_t payloadLen,
-        bool handleOptions, bool handlePayload)
+        bool handlePayload)
 {
 
+    setMessageError(0);
     setMessageSrcPort(srcPort);
     setMessagePayloadLen(payloadLen);
 
-    int8_t err = setURL(url, options, optionsLen);
+    if (optionsLen > COAP_MAX_MESSAGE_OPTIONS) {
+        setMessageError(OPT_UNKNOWN_ERROR);
+        return OPT_UNKNOWN_ERROR;
+    }
+
+    // the options of the caller and of the url are only referenced here
+    // and encoded into the packet right away
+    CoAPMessageOption opts[COAP_MAX_MESSAGE_OPTIONS];
+    for (uint8_t i = 0; i < optionsLen; i++) {
+        opts[i] = options[i];
+    }
+
+    int8_t err = setURL(url, opts, optionsLen, COAP_MAX_MESSAGE_OPTIONS);
     if (err < 0) {
-        if(handleOptions) {
-            deleteCoAPPacketOptions(options, optionsLen);
-        }
         setMessageError(err);
         return err;
     }
 
     encodeCoAPMessage(
-            messageType, messageCode, messageID, options, optionsLen, token,
+            messageType, messageCode, messageID, opts, optionsLen, token,
             payload, payloadLen, handlePayload);
 
-    if(handleOptions) {
-        deleteCoAPPacketOptions(options, optionsLen);
-    }
-
     return getMessageError();
 }
 
-int8_t CoAPMessage::setURL(const URL& url, CoAPMessageOption** options,
-        uint8_t optionsMaxLen) {
+int8_t CoAPMessage::setURL(const URL& url, CoAPMessageOption* options,
+        uint8_t& optionsLen, uint8_t optionsMaxLen) {
     if (url.protocol != URL::COAP) {
         return OPT_UNKNOWN_PROTOCOL;
     }
@@ -238,42 +244,21 @@ int8_t CoAPMessage::setURL(const URL& url, CoAPMessageOption** options,
         setMessageDstPort(url.port);
     }
 
-    uint16_t optionOrder = 0;
-
     for (uint8_t i = 0; i < url.numParts; i++) {
+        uint16_t optNr;
         if (url.uriParts[i].getType() == URIPart::URIPATH) {
-            if(i > 0 && url.uriParts[i-1].getType() == URIPart::URIPATH) {
-                optionOrder++;
-            }
-
-            CoAPMessageOption* opt = new CoAPMessageOption(
-                    this->buffer,
-                    CoAPMessageOption::OPT_URIPATH,
-                    url.uriParts[i].getPart(), url.uriParts[i].getLength(),
-                    optionOrder);
-            if (!opt->isValid() || !insertNextOption(options, optionsMaxLen, opt)) {
-                delete opt;
-                return OPT_UNKNOWN_ERROR;
-            }
+            optNr = CoAPMessageOption::OPT_URIPATH;
         } else if (url.uriParts[i].getType() == URIPart::URIQUERY) {
-            if(i > 0 && url.uriParts[i-1].getType() == URIPart::URIPATH) {
-                optionOrder = 0;
-            } else if(i > 0 && url.uriParts[i-1].getType() == URIPart::URIQUERY) {
-                optionOrder++;
-            }
-
-            CoAPMessageOption* opt = new CoAPMessageOption(
-                    this->buffer,
-                    CoAPMessageOption::OPT_URIQUERY,
-                    url.uriParts[i].getPart(), url.uriParts[i].getLength(),
-                    optionOrder);
-            if(!opt->isValid() || !insertNextOption(options, optionsMaxLen, opt)) {
-                delete opt;
-                return OPT_UNKNOWN_ERROR;
-            }
+            optNr = CoAPMessageOption::OPT_URIQUERY;
         } else {
             return OPT_UNREC_OPTION;
         }
+
+        if (optionsLen >= optionsMaxLen) {
+            return OPT_UNKNOWN_ERROR;
+        }
+        options[optionsLen++].set(optNr,
+                url.uriParts[i].getPart(), url.uriParts[i].getLength());
     }
 
     return 0;
@@ -321,19 +306,6 @@ int CoAPMessage::init(
 }
 */
 
-bool CoAPMessage::insertNextOption(
-        CoAPMessageOption** opts, uint8_t optsMaxLen,
-        CoAPMessageOption* insertMe)
-{
-    for(uint8_t i = 0; i < optsMaxLen; i++) {
-        if(opts[i] == NULL){
-            opts[i] = insertMe;
-            return true;
-        }
-    }
-    return false;
-}
-
 int CoAPMessage::getMessageCodeMeaning(codeMeaning_t& meaning){
 
 
@@ -375,11 +347,9 @@ int CoAPMessage::getMessageCodeMeaning(codeMeaning_t& meaning){
  *
  */
 
-int CoAPMessage::decodeCoAPMessage(
-        CoAPMessageOption** opts, uint8_t optsMaxLen)
+int CoAPMessage::decodeCoAPMessage()
 {
 
-    uint16_t skip = 0;
     codeMeaning_t meaning;
     uint8_t messageType = getMessageType();
 
@@ -414,133 +384,55 @@ int CoAPMessage::decodeCoAPMessage(
             error++;
         }
     }
-    if(error){
+    if(error || 4 + tokenLen > getMessagePacketLen()){
         addMessageError(COAP_MESSAGE_FORMATERROR);
         return COAP_MESSAGE_FORMATERROR;
     }
-    skip = 4 + tokenLen;
-
-    //Initiating variables needed for decoding the options
-    uint16_t initialOptionDelta=0;
-
-    if(skip >= getMessagePacketLen()){
-        if(opts != NULL) {
-            memset(opts, 0, sizeof(CoAPMessageOption*)*optsMaxLen);
-        }
-
-        setMessagePayloadLen(0);
-        return COAP_MESSAGE_OK;
-    }
 
-    ErrorCodes_t optionsErrCode = decodeCoAPMessageOptions(
-            skip, initialOptionDelta, opts, optsMaxLen);     //Parse the Message Options
-    if(optionsErrCode != OPT_SUCC){
-        if(opts != NULL) {
-            memset(opts, 0, sizeof(CoAPMessageOption*)*optsMaxLen);
-        }
+    //Walk over the options to find where the payload starts
+    CoAPOptionIterator it = getOptions();
+    while (it.next()) {
     }
-    if(optionsErrCode==OPT_UNREC_OPTION){
-        addMessageError(COAP_MESSAGE_UNREC_OPTION);
-        return COAP_MESSAGE_UNREC_OPTION;
-    }
-    else if(optionsErrCode == OPT_MESSAGE_FORMAT_ERROR){
+    if (it.isMalformed()) {
         addMessageError(COAP_MESSAGE_FORMATERROR);
         return COAP_MESSAGE_FORMATERROR;
     }
 
-    if(skip == getMessagePacketLen()){
-        setMessagePayloadLen(0);
-        return COAP_MESSAGE_OK;
+    uint16_t skip = 4 + tokenLen + it.getPosition();
+    if (it.foundPayloadMarker()) {
+        setMessageOptionsLen(it.getPosition() - 1);
+    } else {
+        setMessageOptionsLen(it.getPosition());
     }
-
     setMessagePayloadLen(getMessagePacketLen() - skip);
 
-
     return getMessageError();
 }
 
-void bubbleSort(CoAPMessageOption** array, uint8_t length)
-{
-    CoAPMessageOption* temp;
-    uint8_t test; /*use this only if unsure whether the list is already sorted or not*/
-    for(uint8_t i = length - 1; i > 0; i--)
-    {
-        test=0;
-        for(uint8_t j = 0; j < i; j++)
-        {
-            if(array[j + 1] != NULL) {   //Check, if the last element is reached.
-                if((array[j]->getOptionNr() > array[j+1]->getOptionNr()) ||
-                        (array[j]->getOptionNr() == array[j+1]->getOptionNr() &&
-                                array[j]->getOptionOrder() > array[j+1]->getOptionOrder()))
-                    /* compare neighboring elements */
-                {
-                    temp = array[j]; /* swap array[j] and array[j+1] */
-                    array[j] = array[j+1];
-                    array[j+1] = temp;
-                    test=1;
-                }
-            } else {
-                break;
-            }
-        } /*end for j*/
-        if(test==0) break; /*will exit if the list is sorted!*/
-    } /*end for i*/
-
-}
-
-uint16_t CoAPMessage::getEncodedCoAPMessageOptionsLen(
-        CoAPMessageOption** opts, uint8_t optsMaxLen)
-{
-
-    uint16_t lastOptionNr = 0;
-    uint16_t currOptionDelta = 0;
-    uint16_t currOptionLen = 0;
-
-    uint16_t skip = 0;
-    uint16_t addedOptionLen = 0;
-    bubbleSort(opts, optsMaxLen);
-
-    for (uint8_t i = 0; i < optsMaxLen && opts[i] != NULL; ++i) //Iterate through list and calculate needed buffer size
-    {
-        currOptionDelta = opts[i]->getOptionNr() - lastOptionNr;
-        currOptionLen = opts[i]->getOptionLen();
-        lastOptionNr += currOptionDelta;
-
-        if(currOptionDelta > 12) {
-            if(currOptionDelta < 269) {
-                skip += 1;
-            } else {
-                skip += 2;
-            }
-        }
-
-        if(currOptionLen > 12) {
-            if(currOptionLen < 269) {
-                skip += 1;
-            } else {
-                skip += 2;
-            }
-        }
-
-        addedOptionLen += currOptionLen;
-        addedOptionLen += 1;            //Each Option has at least 1B, the option delta and the option len.
-    };
-    return addedOptionLen +  skip;
-}
-
 void CoAPMessage::encodeCoAPMessage(
         uint8_t messageType, uint8_t messageCode, uint16_t messageID,
-        CoAPMessageOption** options, uint8_t optionsLen, Token token,
+        CoAPMessageOption* options, uint8_t optionsLen, Token token,
         const char* payload, uint16_t payloadLen, bool handlePayload)
 {
-    uint16_t shift=0;
+    // sort the options by their number, repeated options keep their order
+    for (uint8_t i = 1; i < optionsLen; i++) {
+        CoAPMessageOption opt = options[i];
+        uint8_t j = i;
+        for (; j > 0 && options[j - 1].getOptionNr() > opt.getOptionNr(); j--) {
+            options[j] = options[j - 1];
+        }
+        options[j] = opt;
+    }
 
-    if(options != NULL && optionsLen != 0) {
-        setMessageOptionsLen(getEncodedCoAPMessageOptionsLen(options,
-                optionsLen));
-    } else {
-        setMessageOptionsLen(0);
+    uint16_t lastOptionNr = 0;
+    uint16_t encodedOptionsLen = 0;
+    for (uint8_t i = 0; i < optionsLen; i++) {
+        encodedOptionsLen += CoAPMessageOption::getEncodedLen(
+                options[i].getOptionNr() - lastOptionNr,
+                options[i].getOptionLen());
+        lastOptionNr = options[i].getOptionNr();
     }
+    setMessageOptionsLen(encodedOptionsLen);
 
     uint8_t tokenLen = token.getTokenLength();
     uint16_t messageLen = 4 + getMessageOptionsLen() + tokenLen +
@@ -556,31 +448,22 @@ void CoAPMessage::encodeCoAPMessage(
         return;
     }
 
-    uint8_t header[4];
-    header[shift] = ( (COAP_VERSION<<6) | ((messageType<<4)&0x30) ) | (tokenLen&0x0F);
-    header[++shift] = messageCode;
-    header[++shift] = (messageID>>8)&0xFF;
-    header[++shift] = messageID&0xFF;
-
-    biPacket->copyToBuffer(header, 4, 0);
+    uint16_t shift = 0;
+    (*biPacket)[shift++] = ( (COAP_VERSION<<6) | ((messageType<<4)&0x30) ) | (tokenLen&0x0F);
+    (*biPacket)[shift++] = messageCode;
+    (*biPacket)[shift++] = (messageID>>8)&0xFF;
+    (*biPacket)[shift++] = messageID&0xFF;
 
     for(uint8_t i = 0; i < tokenLen; i++){
-        uint8_t tokenTemp = token.getTokenPart(i + (Token::MAX_LENGTH - tokenLen));
-        biPacket->copyToBuffer(&tokenTemp, 1, ++shift);
+        (*biPacket)[shift++] = token.getTokenPart(i + (Token::MAX_LENGTH - tokenLen));
     }
 
-    if(getMessageOptionsLen()){
-        encodeCoAPMessageOptions(options, optionsLen, ++shift);
-        shift += getMessageOptionsLen() - 1;
-    }
+    shift = encodeCoAPMessageOptions(options, optionsLen, shift);
 
     if(payloadLen && payload!=NULL){
 
-        uint8_t temp = 0xFF;
-        shift++;
-        biPacket->copyToBuffer(&temp, 1, shift);            //Insert payload indicator
-        shift++;
-        biPacket->copyToBuffer((uint8_t*)payload, payloadLen, shift); //Insert payload indicator
+        (*biPacket)[shift++] = 0xFF;                            //Insert payload indicator
+        biPacket->copyToBuffer((uint8_t*)payload, payloadLen, shift); //Insert payload
         shift+=payloadLen;
 
         if(handlePayload) {
@@ -590,203 +473,60 @@ void CoAPMessage::encodeCoAPMessage(
 
 }
 
-int CoAPMessage::findInCoAPMessageOptions(
-        uint16_t optionNr, CoAPMessageOption** opts, uint8_t optsSize)
+bool CoAPMessage::getUintOption(uint16_t optionNr, uint32_t& value) const
 {
-
-    CoAPMessageOption* tempOptions[COAP_MAX_MESSAGE_OPTIONS];
-    memset(tempOptions, 0, sizeof(tempOptions));
-    uint8_t error = decodeCoAPMessageOptions(tempOptions, COAP_MAX_MESSAGE_OPTIONS);
-
-    if(error != 0) {
-        return 0;
-    }
-    uint8_t i, j;
-    for(i = 0, j = 0; i < COAP_MAX_MESSAGE_OPTIONS && j < optsSize; i++)
-    {
-        if(tempOptions[i] != NULL && tempOptions[i]->getOptionNr() == optionNr)
-        {
-            opts[j] = tempOptions[i];
-            j++;
-        }
-        else if(tempOptions[i] != NULL) {
-            delete tempOptions[i];
-        }
-    }
-
-    return j;
-}
-
-
-int CoAPMessage::decodeCoAPMessageOptions(
-        CoAPMessageOption** opts, uint8_t optsSize)
-{
-    uint16_t optionDelta = 0;
-    uint16_t prevOptionDeltas = 0;
-    setMessageOptionsLen(0);
-
-    uint16_t skip = 4 + getMessageTokenLen();
-
-    for(uint8_t i = 0; i < optsSize && skip < this->getMessagePacketLen(); i++)
-    {
-        uint16_t optionLen = 0;
-
-        switch (decodeMessageOptionsMetadata(optionDelta, optionLen, skip)) {
-            case OPT_SUCC:
-                return 0;
-            case OPT_MESSAGE_FORMAT_ERROR:
-                for (uint8_t j = 0; j < i; j++) {
-                    delete opts[j];
-                }
-                return COAP_MESSAGE_FORMATERROR;
-            default:
-                ;
-        }
-
-        if(opts != NULL){
-            opts[i] = decodeMessageOption(optionDelta + prevOptionDeltas,
-                    skip, optionLen);
-            if (opts[i] == NULL) {
-                for (uint8_t j = 0; j < i; j++) {
-                    delete opts[j];
-                }
-                return 4; // TODO: ???? Warum 4? Darum
-            }
-            if(opts[i]->getData() == NULL) {
-                for (uint8_t j = 0; j < i; j++) {
-                    delete opts[j];
-                }
-                return 5;
-            }
+    CoAPOptionIterator it = getOptions();
+    while (it.next() && it.getOptionNr() <= optionNr) {
+        if (it.getOptionNr() == optionNr) {
+            value = it.getUint();
+            return true;
         }
-
-        prevOptionDeltas += optionDelta;
-
-        skip += optionLen;
     }
-    return 0;
-}
-
-CoAPMessage::ErrorCodes_t CoAPMessage::decodeCoAPMessageOptions(
-        uint16_t& skip, uint16_t prevOptionDelta, CoAPMessageOption** opts,
-        uint8_t optsMaxLen)
-{
-    uint16_t optionDelta = 0;
-    uint16_t optionLen = 0;
-    setMessageOptionsLen(0);
-
-    while(skip < getMessagePacketLen())
-    {
-        switch (decodeMessageOptionsMetadata(optionDelta, optionLen, skip)) {
-            case OPT_SUCC:
-                return OPT_SUCC;
-            case OPT_MESSAGE_FORMAT_ERROR:
-                return OPT_MESSAGE_FORMAT_ERROR;
-            default:
-                ;
-        }
-
-        if(opts != NULL){
-            CoAPMessageOption* tempOption = decodeMessageOption(
-                    optionDelta, skip, optionLen);
-            if(!insertNextOption(opts, optsMaxLen, tempOption)){
-                for(uint8_t i = 0; i < optsMaxLen; i++) {
-                    if(opts[i] != NULL){
-                        delete opts[i];
-                        opts[i] = NULL;
-                    }
-                }
-                return OPT_UNREC_OPTION;
-            }
-        }
-
-        skip += optionLen;
-    };
-    return OPT_SUCC;
+    return false;
 }
 
-void CoAPMessage::encodeCoAPMessageOptions(
-        CoAPMessageOption** opts, uint8_t optsMaxLen, uint16_t shift)
+/*
+ * Writes the sorted options into the packet, starting at pos.
+ * Returns the position after the last option.
+ */
+uint16_t CoAPMessage::encodeCoAPMessageOptions(
+        const CoAPMessageOption* opts, uint8_t optsLen, uint16_t pos)
 {
-    uint8_t optionData[getMessageOptionsLen()];
-
     uint16_t lastOptionNr = 0;
-    uint16_t currOptionDelta = 0;
-    uint16_t currOptionLen = 0;
-
-    uint16_t skip = 0;
 
-    bubbleSort(opts, optsMaxLen);
-
-    lastOptionNr = 0;
-    for (uint8_t i = 0; i < optsMaxLen && opts[i] != NULL; ++i) //encode the options into the allocated buffer.
+    for (uint8_t i = 0; i < optsLen; i++)
     {
-        uint16_t currOptionBegin=skip;
-
-        currOptionDelta = opts[i]->getOptionNr() - lastOptionNr;
-        currOptionLen = opts[i]->getOptionLen();
-        lastOptionNr += currOptionDelta;
+        uint16_t optionBegin = pos++;
+        uint16_t optionLen = opts[i].getOptionLen();
 
-        if(currOptionDelta < 13) {                               //encode optionNr
-            optionData[currOptionBegin] = (currOptionDelta & 0xF) << 4;
-        } else if(currOptionDelta<269) {
-            optionData[currOptionBegin] = 13 << 4;
-            optionData[++skip] = ((currOptionDelta - 13) & 0xFF);
-        }
-        else
-        {
-            optionData[currOptionBegin] = 14 << 4;
-            optionData[++skip] = ((currOptionDelta - 269) >> 8) & 0xFF;
-            optionData[++skip] = (currOptionDelta - 269) & 0xFF;
-        }
+        uint8_t header = encodeExtended(opts[i].getOptionNr() - lastOptionNr, pos) << 4;
+        header |= encodeExtended(optionLen, pos);
+        (*biPacket)[optionBegin] = header;
+        lastOptionNr = opts[i].getOptionNr();
 
-        if(currOptionLen < 13) {                      //encode optionLen
-            optionData[currOptionBegin] |= currOptionLen & 0xF;
-        } else if(currOptionLen < 269) {
-            optionData[currOptionBegin] |= 13;
-            optionData[++skip] = ((currOptionLen - 13) & 0xFF);
-        }
-        else
-        {
-            optionData[currOptionBegin] |= 14;
-            optionData[++skip] = ((currOptionLen - 269) >> 8) & 0xFF;
-            optionData[++skip] = ((currOptionLen - 269) & 0xFF);
-        }
-
-        memcpy(&optionData[++skip],
-                opts[i]->getOptionData(),
-                opts[i]->getOptionLen());       //Finally copy the data.
-        skip+=opts[i]->getOptionLen();
-        delete opts[i];
-        opts[i] = NULL;
+        biPacket->copyToBuffer(opts[i].getOptionData(), optionLen, pos);
+        pos += optionLen;
     }
 
-    biPacket->copyToBuffer(optionData, getMessageOptionsLen(), shift);
-
-    if(skip!=0) {
-        if(getMessageOptionsLen() != skip) {
-            return;
-        }
-    }
-    return;
+    return pos;
 }
 
-bool CoAPMessage::deleteCoAPPacketOptions(
-        CoAPMessageOption** opts, uint8_t optsMaxLen)
+/*
+ * Writes the extended bytes of an option delta or length at pos, if
+ * needed, and returns the 4 bit value for the option header.
+ */
+uint8_t CoAPMessage::encodeExtended(uint16_t value, uint16_t& pos)
 {
-
-    if(opts != NULL) {
-
-		for(uint8_t i = 0; i < optsMaxLen; i++)
-		{
-			if(opts[i] != NULL){
-				delete opts[i];
-				opts[i] = NULL;
-			}
-		}
+    if (value < 13) {
+        return value;
+    } else if (value < 269) {
+        (*biPacket)[pos++] = value - 13;
+        return 13;
+    } else {
+        (*biPacket)[pos++] = ((value - 269) >> 8) & 0xFF;
+        (*biPacket)[pos++] = (value - 269) & 0xFF;
+        return 14;
     }
-
-    return true;
 }
 
 }
@@ -88,6 +88,7 @@ enum {
     COAP_VALID =                    0x43,
     COAP_CHANGED =                  0x44,
     COAP_CONTENT =                  0x45,
+    COAP_CONTINUE =                 0x5F,
 
     COAP_BAD_REQUEST =              0x80,
     COAP_UNAUTHORIZED =             0x81,
@@ -96,6 +97,7 @@ enum {
     COAP_NOTFOUND =                 0x84,
     COAP_METHODNOTALLOWED =         0x85,
     COAP_NOTACCEPTABLE =            0x86,
+    COAP_REQUESTENTITYINCOMPLETE =  0x88,
     COAP_PRECONDITIONFAILED =       0x8C,
     COAP_REQUESTENTITYTOOLARGE =    0x8D,
     COAP_UNSUPPORTEDCONTENTFORMAT = 0x8F,
@@ -144,6 +146,9 @@ const uint16_t COAP_MAX_RTT =           2 * COAP_MAX_LATENCY + COAP_PROCESSING_D
 const uint16_t COAP_EXCHANGE_LIFETIME = COAP_MAX_TRANSMIT_SPAN + (2 * COAP_MAX_LATENCY) + COAP_PROCESSING_DELAY;
 const uint16_t COAP_NON_LIFETIME =      COAP_MAX_TRANSMIT_SPAN + COAP_MAX_LATENCY;
 
+//See RFC 7252 5.10.5, freshness of a response without Max-Age option
+const uint32_t COAP_DEFAULT_MAX_AGE =   60;      //60s
+
 enum {
     COAP_MESSAGE_OK =                   0x00,
     COAP_MESSAGE_FORMATERROR =          0x01,
@@ -177,11 +182,16 @@ public:
             bool handleOptions, bool handlePayload);*/
     int8_t init(const URL& url, uint16_t srcPort, uint8_t messageType,
             uint8_t messageCode, uint16_t messageID, Token token,
-            CoAPMessageOption** options, uint8_t optionsLen, const char* payload,
-            uint16_t payloadLen, bool handleOptions, bool handlePayload);
+            const CoAPMessageOption* options, uint8_t optionsLen,
+            const char* payload, uint16_t payloadLen, bool handlePayload);
 
-    int8_t setURL(const URL& url, CoAPMessageOption** options,
-            uint8_t optionsMaxLen);
+    /*
+     * Sets the endpoint of the message and appends the URI path and query
+     * of the url to options, which hold optionsLen of optionsMaxLen options.
+     * The options refer to the parts of url.
+     */
+    int8_t setURL(const URL& url, CoAPMessageOption* options,
+            uint8_t& optionsLen, uint8_t optionsMaxLen);
 
     cometos::SString<255> getMessageString();
 
@@ -275,30 +285,36 @@ public:
         getMessageCodeMeaning(res);
         return (res == RESPONSE);
     }
-    uint16_t getPathString(char*& path) {
-        uint16_t pathLen = 0;
-        CoAPMessageOption* pathOpts[COAP_MAX_MESSAGE_OPTIONS];
-        uint8_t numOptions = findInCoAPMessageOptions(
-                CoAPMessageOption::OPT_URIPATH, pathOpts, COAP_MAX_MESSAGE_OPTIONS);
-
-        for(uint8_t i = 0; i < numOptions; i++) {
-            pathLen += pathOpts[i]->getOptionLen() + 1;     //+1 for the '/' 's
+    /*
+     * Returns an iterator over the options of a received message, which
+     * are parsed in place.
+     */
+    CoAPOptionIterator getOptions() const {
+        uint16_t start = 4 + getMessageTokenLen();
+        if (biPacket == NULL || start >= getMessagePacketLen()) {
+            return CoAPOptionIterator(NULL, 0);
         }
+        return CoAPOptionIterator(&biPacket->getContent()[start],
+                getMessagePacketLen() - start);
+    }
 
-        path = new char[pathLen + 1];                             //+1 for the '\0'
-        path[pathLen] = 0;
-        uint16_t skip = 0;
-        for(uint8_t i = 0; i < numOptions; i++){
-            path[skip] = '/';
-            skip++;
-            memcpy(&path[skip],
-                    pathOpts[i]->getOptionData(),
-                    pathOpts[i]->getOptionLen());
-            skip += pathOpts[i]->getOptionLen();
-
-            delete pathOpts[i];
+    /*
+     * Looks up the first option with the given number and decodes its
+     * value as uint. Returns false if the message has no such option.
+     */
+    bool getUintOption(uint16_t optionNr, uint32_t& value) const;
+
+    /*
+     * Decodes a Block1 or Block2 option. Returns false if the message
+     * has no such option, block is left untouched in this case.
+     */
+    bool getBlockOption(uint16_t optionNr, CoAPBlock& block) const {
+        uint32_t value;
+        if (!getUintOption(optionNr, value)) {
+            return false;
         }
-        return pathLen;
+        block.setValue(value);
+        return true;
     }
 
     void onlyKeepMetaData() {
@@ -340,9 +356,6 @@ private:
         getMessageCodeMeaning(empty);
         return (empty == EMPTY);
     }
-    int findInCoAPMessageOptions(uint16_t optionNr, CoAPMessageOption** opts,
-            uint8_t optsSize);
-    int decodeCoAPMessageOptions(CoAPMessageOption** opts, uint8_t optsSize);
 
     uint8_t calculateTimer(uint8_t retries){
         // generate a random number between ACK_TIMEOUT and
@@ -426,75 +439,14 @@ private:
         metaData.error = metaData.error | error;
     }
 
-    bool insertNextOption(
-            CoAPMessageOption** opts,
-            uint8_t optsMaxLen,
-            CoAPMessageOption* insertMe);
-
-    int decodeCoAPMessage(CoAPMessageOption** opts, uint8_t optsMaxLen);
+    int decodeCoAPMessage();
     void encodeCoAPMessage(uint8_t messageType, uint8_t messageCode,
-            uint16_t messageID,CoAPMessageOption** options, uint8_t optionsLen,
+            uint16_t messageID, CoAPMessageOption* options, uint8_t optionsLen,
             Token token, const char* payload, uint16_t payloadLen,
             bool handlePayload);
-    ErrorCodes_t decodeCoAPMessageOptions(uint16_t& skip, uint16_t prevOptionDelta,
-            CoAPMessageOption** opts, uint8_t optsMaxLen);
-    void encodeCoAPMessageOptions(CoAPMessageOption** opts, uint8_t optsMaxLen,
-            uint16_t shift);
-
-    uint16_t getEncodedCoAPMessageOptionsLen(CoAPMessageOption** opts,
-            uint8_t optsMaxLen);
-    bool deleteCoAPPacketOptions(CoAPMessageOption** opts, uint8_t optsMaxLen);
-
-    CoAPMessageOption* decodeMessageOption(uint16_t delta, uint16_t pos, uint16_t size) {
-        char optionValue[size];
-
-        memcpy(optionValue, &biPacket->getContent()[pos], size);
-
-        CoAPMessageOption* ret = new CoAPMessageOption(
-                this->buffer, delta, optionValue, size, 0);
-        if (ret->isValid()) {
-            return ret;
-        }
-        delete ret;
-        return NULL;
-
-    }
-
-    ErrorCodes_t decodeMessageOptionsMetadata(uint16_t& optionDelta, uint16_t& optionLen, uint16_t& skip) {
-        optionDelta = ( biPacket->getContent()[skip] >> 4) & 0xF;
-        optionLen =     biPacket->getContent()[skip++]     & 0xF;
-
-        if(optionDelta == 13) {
-            optionDelta += biPacket->getContent()[skip++];
-        } else if(optionDelta == 14) {
-            optionDelta += (((uint16_t)(biPacket->getContent()[skip + 1])<<8) |
-                    biPacket->getContent()[skip]) + 269;
-            skip += 2;
-        } else if(optionDelta == 15) {
-            if(optionLen == 15) {   //Payload Marker found
-                return OPT_SUCC;
-            } else {                //No payload marker found -> Message Format Error
-                return OPT_MESSAGE_FORMAT_ERROR;
-            }
-        }
-
-        if(optionLen == 13)
-        {
-            optionLen += biPacket->getContent()[skip++];
-        }
-        else if(optionLen == 14)
-        {
-            optionLen += ((biPacket->getContent()[skip+1]<<8) |
-                    biPacket->getContent()[skip]) + 269;
-            skip += 2;
-        }
-        else if(optionLen == 15)
-            return OPT_MESSAGE_FORMAT_ERROR;
-
-        setMessageOptionsLen(getMessageOptionsLen() + optionLen + 1);
-
-        return OPT_GO_ON;
-    }
+    uint16_t encodeCoAPMessageOptions(const CoAPMessageOption* opts,
+            uint8_t optsLen, uint16_t pos);
+    uint8_t encodeExtended(uint16_t value, uint16_t& pos);
 
     CoAPBuffer_t*       buffer;
     BufferInformation*  biPacket;
@@ -52,6 +52,7 @@ public:
         OPT_URIHOST =        3,
         OPT_ETAG =           4,
         OPT_IFNONMATCH =     5,
+        OPT_OBSERVE =        6,
         OPT_URIPORT =        7,
         OPT_LOCATIONPATH =   8,
         OPT_URIPATH =        11,
@@ -60,44 +61,246 @@ public:
         OPT_URIQUERY =       15,
         OPT_ACCEPT =         17,
         OPT_LOCATIONQUERY =  20,
+        OPT_BLOCK2 =         23,
+        OPT_BLOCK1 =         27,
+        OPT_SIZE2 =          28,
         OPT_PROXYURI =       35,
         OPT_PROXYSCHEME =    39,
         OPT_SIZE1 =          60
     };
 
-    CoAPMessageOption(CoAPBuffer_t* buffer, uint16_t optNr,
-            const char* optData, uint16_t optLen, uint8_t optOrder);
+    CoAPMessageOption(uint16_t optNr = 0, const void* optData = NULL,
+            uint16_t optLen = 0) :
+        nr(optNr),
+        len(optLen),
+        data((const uint8_t*) optData)
+    {}
 
-    virtual ~CoAPMessageOption();
-
-    bool optionsContain(uint16_t opNr);
+    /*
+     * Options do not copy their value, optData has to stay valid until the
+     * message is encoded. Only uint values are stored in the option itself,
+     * so an array of options can be set up on the stack.
+     */
+    void set(uint16_t optNr, const void* optData, uint16_t optLen) {
+        nr = optNr;
+        len = optLen;
+        data = (const uint8_t*) optData;
+    }
+    void setUint(uint16_t optNr, uint32_t optValue) {
+        nr = optNr;
+        len = encodeUint(optValue, value);
+        data = NULL;
+    }
 
     uint16_t getOptionNr() const{
-        return (bufferInfo->getContent()[1]<<8) | bufferInfo->getContent()[0];
-    }
-    uint8_t getOptionOrder() const{
-        return bufferInfo->getContent()[2];
+        return nr;
     }
     uint16_t getOptionLen() const{
-            return bufferInfo->getSize() - 3;
+        return len;
     }
     const uint8_t* getOptionData() const{
-        return &bufferInfo->getContent()[3];
+        return (data != NULL) ? data : value;
+    }
+
+    /*
+     * Bytes needed to encode an option with the given delta to the
+     * previous option number and value length.
+     */
+    static uint16_t getEncodedLen(uint16_t delta, uint16_t len) {
+        return 1 + getExtendedLen(delta) + getExtendedLen(len) + len;
+    }
+    static uint8_t getExtendedLen(uint16_t value) {
+        return (value < 13) ? 0 : ((value < 269) ? 1 : 2);
+    }
+
+    /*
+     * Encodes an uint option value with the minimal number of bytes
+     * (network byte order, 0 is encoded with zero length).
+     * Returns the number of bytes written to data, which has to hold 4 bytes.
+     */
+    static uint8_t encodeUint(uint32_t value, uint8_t* data) {
+        uint8_t len = 0;
+        for (uint32_t v = value; v != 0; v >>= 8) {
+            len++;
+        }
+        for (uint8_t i = 0; i < len; i++) {
+            data[i] = (value >> (8 * (len - i - 1))) & 0xFF;
+        }
+        return len;
+    }
+
+    static uint32_t decodeUint(const uint8_t* data, uint16_t len) {
+        uint32_t value = 0;
+        for (uint16_t i = 0; i < len && i < 4; i++) {
+            value = (value << 8) | data[i];
+        }
+        return value;
+    }
+
+private:
+    uint16_t        nr;
+    uint16_t        len;
+    const uint8_t*  data;
+    uint8_t         value[4];
+};
+
+/*
+ * Parses the options of a received message in place, e.g.
+ *
+ *   CoAPOptionIterator it = message->getOptions();
+ *   while (it.next()) {
+ *       if (it.getOptionNr() == CoAPMessageOption::OPT_URIPATH) ...
+ *   }
+ *
+ * Options are visited in the order of their numbers.
+ */
+class CoAPOptionIterator {
+public:
+    CoAPOptionIterator(const uint8_t* options, uint16_t length) :
+        options(options),
+        length(length),
+        pos(0),
+        nr(0),
+        len(0),
+        state(OPTIONS)
+    {}
+
+    /*
+     * Advances to the next option. Returns false at the payload marker,
+     * at the end of the message, or if the options are malformed.
+     */
+    bool next() {
+        if (state != OPTIONS) {
+            return false;
+        }
+        if (pos >= length) {
+            state = END;
+            return false;
+        }
+
+        uint8_t first = options[pos++];
+        if (first == 0xFF) {
+            state = PAYLOAD;
+            return false;
+        }
+
+        uint32_t delta = first >> 4;
+        uint32_t optLen = first & 0xF;
+        if (!readExtended(delta) || !readExtended(optLen) ||
+                optLen > (uint32_t)(length - pos) ||
+                nr + delta > 0xFFFF)
+        {
+            state = MALFORMED;
+            return false;
+        }
+
+        nr += delta;
+        len = optLen;
+        pos += optLen;
+        return true;
+    }
+
+    uint16_t getOptionNr() const {
+        return nr;
+    }
+    uint16_t getOptionLen() const {
+        return len;
+    }
+    const uint8_t* getOptionData() const {
+        return &options[pos - len];
+    }
+    uint32_t getUint() const {
+        return CoAPMessageOption::decodeUint(getOptionData(), len);
     }
 
-    const uint8_t* getData() const{
-        return bufferInfo->getContent();
+    bool isMalformed() const {
+        return state == MALFORMED;
     }
-    uint16_t getDataLen() const{
-        return bufferInfo->getSize();
+    bool foundPayloadMarker() const {
+        return state == PAYLOAD;
     }
 
-    bool isValid() const {
-        return (bufferInfo != NULL);
+    /*
+     * Number of bytes parsed so far, including the payload marker once
+     * next() returned false because of it.
+     */
+    uint16_t getPosition() const {
+        return pos;
     }
 
 private:
-    BufferInformation* bufferInfo;
+    bool readExtended(uint32_t& value) {
+        if (value == 13) {
+            if (pos + 1 > length) {
+                return false;
+            }
+            value = 13 + options[pos];
+            pos += 1;
+        } else if (value == 14) {
+            if (pos + 2 > length) {
+                return false;
+            }
+            value = 269 + (((uint16_t) options[pos] << 8) | options[pos + 1]);
+            pos += 2;
+        } else if (value == 15) {
+            return false;
+        }
+        return true;
+    }
+
+    const uint8_t*  options;
+    uint16_t        length;
+    uint16_t        pos;
+    uint16_t        nr;
+    uint16_t        len;
+    enum : uint8_t {
+        OPTIONS, PAYLOAD, END, MALFORMED
+    }               state;
+};
+
+/*
+ * Value of a Block1 or Block2 option (RFC 7959):
+ * block number, more flag and size exponent (block size = 2^(szx + 4)).
+ */
+struct CoAPBlock {
+    static const uint8_t SZX_MAX = 6;   // 1024 bytes, 7 is reserved
+
+    uint32_t    num;
+    bool        more;
+    uint8_t     szx;
+
+    CoAPBlock(uint32_t num = 0, bool more = false, uint8_t szx = SZX_MAX) :
+        num(num), more(more), szx(szx) {}
+
+    uint16_t getSize() const {
+        return 1 << (szx + 4);
+    }
+
+    uint32_t getOffset() const {
+        return num << (szx + 4);
+    }
+
+    uint32_t getValue() const {
+        return (num << 4) | (more ? 0x08 : 0) | (szx & 0x07);
+    }
+
+    void setValue(uint32_t value) {
+        num = value >> 4;
+        more = (value & 0x08) != 0;
+        szx = value & 0x07;
+    }
+
+    /*
+     * Returns the largest size exponent whose blocks fit into
+     * maxPayload bytes; blocks are at least 16 bytes.
+     */
+    static uint8_t szxForPayload(uint16_t maxPayload) {
+        uint8_t szx = 0;
+        while (szx < SZX_MAX && (1 << (szx + 5)) <= maxPayload) {
+            szx++;
+        }
+        return szx;
+    }
 };
 
 }
@@ -0,0 +1,424 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "CoAPFileResource.h"
+#include "CoAPLayer.h"
+#include "palLocalTime.h"
+
+using namespace cometos;
+
+namespace cometos_v6 {
+
+CoAPFileResource::CoAPFileResource() :
+        file(NULL),
+        szx(COAP_BLOCK_MAX_SZX),
+        peerPort(0),
+        messageID(0),
+        type(COAP_CON),
+        blockwise(false),
+        lastCode(COAP_EMPTY),
+        busy(false),
+        cachedSegment(-1),
+        received(0),
+        uploading(false),
+        uploadPort(0),
+        uploadTime(0)
+{
+    // largest block that still fits into a single frame
+    uint16_t maxPayload = mac_getMaximumPayload();
+    if (maxPayload > COAP_BLOCK_FRAME_OVERHEAD) {
+        uint8_t frameSzx = CoAPBlock::szxForPayload(
+                maxPayload - COAP_BLOCK_FRAME_OVERHEAD);
+        if (frameSzx < szx) {
+            szx = frameSzx;
+        }
+    } else {
+        szx = 0;
+    }
+    options = COAP_RES_R | COAP_RES_W;
+}
+
+void CoAPFileResource::setFile(SegmentedFile* file) {
+    ASSERT(!busy);
+    this->file = file;
+    if (file != NULL) {
+        file->setMaxSegmentSize(1 << (szx + 4));
+    }
+    cachedSegment = -1;
+    received = 0;
+    uploading = false;
+}
+
+void CoAPFileResource::handleRequest(CoAPMessage* request) {
+    if (request == NULL) {
+        return;
+    }
+
+    if (busy) {
+        // the response to the pending request follows its file operation,
+        // other requests have to wait
+        if (!isCurrentRequest(request)) {
+            sendBusy(request);
+        }
+        return;
+    }
+
+    storeRequest(request);
+
+    if (file == NULL || !file->isOpen()) {
+        sendResponse(COAP_SERVICEUNAVAILABE);
+        return;
+    }
+
+    uint8_t code = request->getMessageCode();
+    if (code == COAP_GET && isReadable()) {
+        handleGet(request);
+    } else if ((code == COAP_PUT || code == COAP_POST) && isWritable()) {
+        handlePut(request);
+    } else {
+        sendResponse(COAP_METHODNOTALLOWED);
+    }
+}
+
+void CoAPFileResource::handleDuplicateRequest(CoAPMessage* request,
+        uint8_t type) {
+    if (request == NULL) {
+        return;
+    }
+
+    if (busy || request->getMessageCode() == COAP_GET) {
+        // answered with 5.03 while busy; reading is idempotent, otherwise
+        // just serve the block again
+        handleRequest(request);
+    } else if (isCurrentRequest(request)) {
+        // the block was already written, only repeat the response
+        storeRequest(request);
+        sendResponse(lastCode, blockwise ? (uint16_t)CoAPMessageOption::OPT_BLOCK1 : 0);
+    } else {
+        // only answered with 5.03 so far, e.g. if that answer got lost
+        handleRequest(request);
+    }
+}
+
+void CoAPFileResource::handleGet(CoAPMessage* request) {
+    if (isUploadPending()) {
+        // the segment holds upload data which must not be overwritten
+        sendResponse(COAP_SERVICEUNAVAILABE);
+        return;
+    }
+
+    block = CoAPBlock(0, false, szx);
+    blockwise = request->getBlockOption(CoAPMessageOption::OPT_BLOCK2, block);
+    if (block.szx > CoAPBlock::SZX_MAX) {
+        sendResponse(COAP_BADOPTION);
+        return;
+    }
+    if (block.szx > szx) {
+        // larger blocks than offered, answer with ours (RFC 7959 2.4)
+        block.num <<= (block.szx - szx);
+        block.szx = szx;
+    }
+
+    file_size_t size = file->getFileSize();
+    if (block.num > 0 && block.getOffset() >= (uint32_t) size) {
+        sendResponse(COAP_BADOPTION);
+        return;
+    }
+
+    if (block.num == 0) {
+        // new transfer, the file might have been changed meanwhile
+        cachedSegment = -1;
+    }
+
+    num_segments_t seg = block.getOffset() >> (szx + 4);
+    if (size == 0 || seg == cachedSegment) {
+        sendBlock();
+        return;
+    }
+
+    if (file->getArbiter()->requestImmediately() != COMETOS_SUCCESS) {
+        sendResponse(COAP_SERVICEUNAVAILABE);
+        return;
+    }
+    busy = true;
+    cachedSegment = seg;
+    file->read(segment, file->getSegmentSize(seg), seg,
+            CALLBACK_MET(&CoAPFileResource::readDone, *this));
+}
+
+void CoAPFileResource::readDone(cometos_error_t result) {
+    file->getArbiter()->release();
+    busy = false;
+
+    if (result != COMETOS_SUCCESS) {
+        cachedSegment = -1;
+        sendResponse(COAP_INTERNALSERVERERROR);
+        return;
+    }
+    sendBlock();
+}
+
+void CoAPFileResource::sendBlock() {
+    uint32_t size = file->getFileSize();
+    uint32_t offset = block.getOffset();
+    uint16_t len = 0;
+    if (offset < size) {
+        len = (size - offset < block.getSize()) ? size - offset : block.getSize();
+    }
+    block.more = (offset + len < size);
+
+    // the segment holds one of our blocks, which contains the requested one
+    uint16_t pos = offset & ((1 << (szx + 4)) - 1);
+    sendResponse(COAP_CONTENT,
+            CoAPMessageOption::OPT_BLOCK2,
+            block.num == 0 ? (uint16_t)CoAPMessageOption::OPT_SIZE2 : 0, size,
+            segment + pos, len);
+}
+
+void CoAPFileResource::handlePut(CoAPMessage* request) {
+    file_size_t size = file->getFileSize();
+    const uint8_t* data = request->getMessagePayload();
+    uint16_t len = request->getMessagePayloadLen();
+
+    block = CoAPBlock(0, false, szx);
+    blockwise = request->getBlockOption(CoAPMessageOption::OPT_BLOCK1, block);
+    if (!blockwise) {
+        if (len > block.getSize()) {
+            // hint the client to use block-wise transfer (RFC 7959 2.9.3)
+            sendResponse(COAP_REQUESTENTITYTOOLARGE,
+                    CoAPMessageOption::OPT_BLOCK1,
+                    CoAPMessageOption::OPT_SIZE1, size);
+            return;
+        }
+    } else if (block.szx > CoAPBlock::SZX_MAX) {
+        sendResponse(COAP_BADOPTION);
+        return;
+    } else if (block.szx > szx) {
+        if (block.num != 0) {
+            sendResponse(COAP_BAD_REQUEST);
+            return;
+        }
+        // only accept the first bytes and let the client continue with
+        // our block size (RFC 7959 2.3)
+        block.szx = szx;
+        if (len > block.getSize()) {
+            len = block.getSize();
+            block.more = true;
+        }
+    } else if (len > block.getSize() || (block.more && len < block.getSize())) {
+        sendResponse(COAP_BAD_REQUEST);
+        return;
+    }
+
+    if (isUploadPending() && !isUploadOwner(request)) {
+        sendResponse(COAP_SERVICEUNAVAILABE);
+        return;
+    }
+
+    uint32_t offset = block.getOffset();
+    if (offset == 0) {
+        received = 0;
+    } else if (!uploading || offset != (uint32_t) received) {
+        sendResponse(COAP_REQUESTENTITYINCOMPLETE, CoAPMessageOption::OPT_BLOCK1);
+        return;
+    }
+
+    uint32_t total = 0;
+    if (offset + len > (uint32_t) size ||
+            (block.num == 0 &&
+             request->getUintOption(CoAPMessageOption::OPT_SIZE1, total) &&
+             total > (uint32_t) size))
+    {
+        sendResponse(COAP_REQUESTENTITYTOOLARGE,
+                blockwise ? (uint16_t)CoAPMessageOption::OPT_BLOCK1 : 0,
+                CoAPMessageOption::OPT_SIZE1, size);
+        return;
+    }
+
+    uint16_t segSize = 1 << (szx + 4);
+    num_segments_t seg = offset >> (szx + 4);
+    uint16_t pos = offset & (segSize - 1);
+    if (pos == 0) {
+        memset(segment, 0, segSize);
+    }
+    // buffer holds upload data from now on
+    cachedSegment = -1;
+    if (offset == 0) {
+        uploading = true;
+        uploadPeer = request->getAddr();
+        uploadPort = request->getMessageSrcPort();
+        uploadToken = request->getMessageToken();
+    }
+    uploadTime = palLocalTime_get();
+    memcpy(segment + pos, data, len);
+    received = offset + len;
+
+    if (block.more && pos + len < file->getSegmentSize(seg)) {
+        // segment not complete yet, wait for the next block
+        sendResponse(COAP_CONTINUE, CoAPMessageOption::OPT_BLOCK1);
+        return;
+    }
+
+    if (file->getArbiter()->requestImmediately() != COMETOS_SUCCESS) {
+        received = offset;
+        sendResponse(COAP_SERVICEUNAVAILABE);
+        return;
+    }
+    busy = true;
+    file->write(segment, file->getSegmentSize(seg), seg,
+            CALLBACK_MET(&CoAPFileResource::writeDone, *this));
+}
+
+void CoAPFileResource::writeDone(cometos_error_t result) {
+    if (result != COMETOS_SUCCESS) {
+        file->getArbiter()->release();
+        busy = false;
+        received = block.getOffset();
+        sendResponse(COAP_INTERNALSERVERERROR);
+        return;
+    }
+
+    if (block.more) {
+        file->getArbiter()->release();
+        busy = false;
+        sendResponse(COAP_CONTINUE, CoAPMessageOption::OPT_BLOCK1);
+    } else {
+        file->flush(CALLBACK_MET(&CoAPFileResource::flushDone, *this));
+    }
+}
+
+void CoAPFileResource::flushDone(cometos_error_t result) {
+    file->getArbiter()->release();
+    busy = false;
+    uploading = false;
+
+    if (result != COMETOS_SUCCESS) {
+        sendResponse(COAP_INTERNALSERVERERROR);
+        return;
+    }
+    sendResponse(COAP_CHANGED,
+            blockwise ? (uint16_t)CoAPMessageOption::OPT_BLOCK1 : 0);
+    uploadFinished(received);
+}
+
+void CoAPFileResource::storeRequest(CoAPMessage* request) {
+    peer = request->getAddr();
+    peerPort = request->getMessageSrcPort();
+    messageID = request->getMessageID();
+    token = request->getMessageToken();
+    type = request->getMessageType();
+}
+
+bool CoAPFileResource::isCurrentRequest(CoAPMessage* request) const {
+    return request->getMessageID() == messageID &&
+            request->getAddr() == peer &&
+            request->getMessageSrcPort() == peerPort;
+}
+
+bool CoAPFileResource::isUploadOwner(CoAPMessage* request) const {
+    return request->getAddr() == uploadPeer &&
+            request->getMessageSrcPort() == uploadPort &&
+            request->getMessageToken() == uploadToken;
+}
+
+bool CoAPFileResource::isUploadPending() {
+    if (uploading && palLocalTime_get() - uploadTime >=
+            (time_ms_t) COAP_EXCHANGE_LIFETIME * 1000)
+    {
+        // abandoned by the client, the segment may be overwritten
+        uploading = false;
+    }
+    return uploading;
+}
+
+void CoAPFileResource::sendBusy(CoAPMessage* request) {
+    // answer directly, the stored exchange belongs to the pending request
+    CoAPMessageOption opt;
+    opt.setUint(CoAPMessageOption::OPT_MAXAGE, COAP_FILE_BUSY_MAX_AGE);
+    bool piggyback = (request->getMessageType() == COAP_CON);
+    URL url(URL::COAP, request->getAddr(), request->getMessageSrcPort());
+    CoAPMessage* answer = makeMessage();
+    if (answer->init(url,
+            localPort,
+            piggyback ? COAP_ACK : COAP_NON,
+            COAP_SERVICEUNAVAILABE,
+            piggyback ? request->getMessageID() :
+                    getNextMessageID(request->getAddr(),
+                            request->getMessageSrcPort()),
+            request->getMessageToken(),
+            &opt, 1,
+            NULL, 0,
+            false) != 0 ||
+        answer->getMessagePacket() == NULL)
+    {
+        delete answer;
+        return;
+    }
+    sendMessage(answer);
+}
+
+void CoAPFileResource::sendResponse(uint8_t code, uint16_t blockOptNr,
+        uint16_t sizeOptNr, uint32_t size,
+        const uint8_t* payload, uint16_t payloadLen) {
+    CoAPMessageOption opts[2];
+    uint8_t numOpts = 0;
+    if (blockOptNr != 0) {
+        opts[numOpts++].setUint(blockOptNr, block.getValue());
+    }
+    if (sizeOptNr != 0) {
+        opts[numOpts++].setUint(sizeOptNr, size);
+    }
+
+    lastCode = code;
+
+    // piggyback on the ACK if possible, even after reading the file
+    bool piggyback = (type == COAP_CON);
+    URL url(URL::COAP, peer, peerPort);
+    CoAPMessage* answer = makeMessage();
+    if (answer->init(url,
+            localPort,
+            piggyback ? COAP_ACK : COAP_NON,
+            code,
+            piggyback ? messageID : getNextMessageID(peer, peerPort),
+            token,
+            opts, numOpts,
+            (const char*) payload, payloadLen,
+            false) != 0 ||
+        answer->getMessagePacket() == NULL)
+    {
+        delete answer;
+        return;
+    }
+    sendMessage(answer);
+}
+
+}
@@ -0,0 +1,145 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef COAPFILERESOURCE_H_
+#define COAPFILERESOURCE_H_
+
+#include "CoAPResource.h"
+#include "SegmentedFile.h"
+
+namespace cometos_v6 {
+
+/*
+ * Resource streaming a SegmentedFile with block-wise transfers (RFC 7959).
+ *
+ * GET reads the file block by block (Block2), PUT and POST write it
+ * (Block1). Every block maps to a part of exactly one file segment, so
+ * only a single segment is kept in memory regardless of the file size.
+ * The block size is chosen to fit a single MAC frame and is offered to
+ * the client, which may ask for smaller blocks, but never for larger ones.
+ *
+ * The file has to be opened by the application; its size limits uploads.
+ * While an upload is incomplete, the segment holds data not written yet,
+ * so requests of other clients are answered with 5.03 until the upload
+ * is finished or was not continued for COAP_EXCHANGE_LIFETIME.
+ */
+class CoAPFileResource : public CoAPResource {
+public:
+    static const uint16_t MAX_BLOCK_SIZE = 1 << (COAP_BLOCK_MAX_SZX + 4);
+
+    CoAPFileResource();
+    virtual ~CoAPFileResource() {}
+
+    /*
+     * Sets the file to stream from and to. Its segment size is set to the
+     * block size, so it must not be used by other modules meanwhile.
+     */
+    void setFile(cometos::SegmentedFile* file);
+
+    /*
+     * Size exponent of the blocks offered by this resource.
+     */
+    uint8_t getBlockSzx() const { return szx; }
+
+    /*
+     * Number of bytes received by the last upload so far.
+     */
+    cometos::file_size_t getReceivedSize() const { return received; }
+
+    virtual void handleRequest(CoAPMessage* request);
+    virtual void handleDuplicateRequest(CoAPMessage* request, uint8_t type);
+
+    virtual char* getRepresentation() { return NULL; }
+    virtual void setRepresentation(const char* repr, uint16_t len) {}
+
+protected:
+    /*
+     * Called after the last block of an upload was written to the file.
+     */
+    virtual void uploadFinished(cometos::file_size_t size) {}
+
+private:
+    void handleGet(CoAPMessage* request);
+    void handlePut(CoAPMessage* request);
+
+    void readDone(cometos_error_t result);
+    void writeDone(cometos_error_t result);
+    void flushDone(cometos_error_t result);
+
+    void sendBlock();
+
+    void sendResponse(uint8_t code, uint16_t blockOptNr = 0,
+            uint16_t sizeOptNr = 0, uint32_t size = 0,
+            const uint8_t* payload = NULL, uint16_t payloadLen = 0);
+
+    /*
+     * Answers with 5.03 and Max-Age COAP_FILE_BUSY_MAX_AGE while a file
+     * operation of another request is pending.
+     */
+    void sendBusy(CoAPMessage* request);
+
+    void storeRequest(CoAPMessage* request);
+
+    bool isCurrentRequest(CoAPMessage* request) const;
+    bool isUploadOwner(CoAPMessage* request) const;
+    bool isUploadPending();
+
+    cometos::SegmentedFile* file;
+    uint8_t szx;
+
+    /* exchange currently served; the request itself is gone by the
+     * time an asynchronous file operation finishes */
+    IPv6Address peer;
+    uint16_t    peerPort;
+    uint16_t    messageID;
+    Token       token;
+    CoapType_t  type;
+    CoAPBlock   block;
+    bool        blockwise;
+    uint8_t     lastCode;
+
+    bool busy;
+    cometos::num_segments_t cachedSegment;
+    cometos::file_size_t received;
+    uint8_t segment[MAX_BLOCK_SIZE];
+
+    /* client of the incomplete upload and the time of its last block */
+    bool        uploading;
+    IPv6Address uploadPeer;
+    uint16_t    uploadPort;
+    Token       uploadToken;
+    time_ms_t   uploadTime;
+};
+
+}
+
+#endif /* COAPFILERESOURCE_H_ */
@@ -0,0 +1,274 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "CoAPObservableResource.h"
+#include "CoAPLayer.h"
+
+namespace cometos_v6 {
+
+CoAPObservableResource::CoAPObservableResource() :
+        seq(0),
+        minInterval(0),
+        pending(false),
+        numNotifications(0),
+        numCoalesced(0),
+        holdOffTask(*this)
+{
+}
+
+CoAPObservableResource::~CoAPObservableResource() {
+    cometos::getScheduler().remove(holdOffTask);
+}
+
+void CoAPObservableResource::changed() {
+    if (holdOffTask.isScheduled()) {
+        // a notification was sent recently, send the latest state afterwards
+        if (pending) {
+            numCoalesced++;
+        }
+        pending = true;
+        return;
+    }
+    notifyObservers();
+}
+
+uint8_t CoAPObservableResource::getNumObservers() const {
+    uint8_t num = 0;
+    for (uint8_t i = 0; i < COAP_OBSERVE_MAX_OBSERVERS; i++) {
+        if (observers[i].port != 0) {
+            num++;
+        }
+    }
+    return num;
+}
+
+void CoAPObservableResource::handleRequest(CoAPMessage* request) {
+    if (request == NULL) {
+        return;
+    }
+
+    if (request->getMessageCode() != COAP_GET) {
+        handleUpdate(request);
+        return;
+    }
+
+    uint32_t observe;
+    bool hasObserve = request->getUintOption(
+            CoAPMessageOption::OPT_OBSERVE, observe);
+    CoAPObserver_t* observer = findObserver(request->getAddr(),
+            request->getMessageSrcPort(), request->getMessageToken());
+
+    if (hasObserve && observe == 0) {
+        // (re-)registration
+        for (uint8_t i = 0; i < COAP_OBSERVE_MAX_OBSERVERS && observer == NULL; i++) {
+            if (observers[i].port == 0) {
+                observer = &observers[i];
+            }
+        }
+        if (observer != NULL) {
+            *observer = CoAPObserver_t();
+            observer->addr = request->getAddr();
+            observer->port = request->getMessageSrcPort();
+            observer->token = request->getMessageToken();
+        } else {
+            LOG_WARN("No free observer");
+        }
+    } else if (observer != NULL) {
+        // deregistration
+        observer->port = 0;
+        observer = NULL;
+    }
+
+    sendResponse(request, COAP_CONTENT, observer != NULL);
+}
+
+void CoAPObservableResource::handleDuplicateRequest(CoAPMessage* request,
+        uint8_t type) {
+    if (request != NULL && request->getMessageCode() == COAP_GET) {
+        // (de-)registration is idempotent, just respond again
+        handleRequest(request);
+    }
+}
+
+void CoAPObservableResource::handleAck(const IPv6Address& addr,
+        uint16_t port, uint16_t messageID) {
+    for (uint8_t i = 0; i < COAP_OBSERVE_MAX_OBSERVERS; i++) {
+        if (observers[i].port == port && observers[i].addr == addr &&
+                observers[i].conMessageID == messageID) {
+            observers[i].numUnacked = 0;
+        }
+    }
+}
+
+void CoAPObservableResource::handleReset(const IPv6Address& addr,
+        uint16_t port, uint16_t messageID) {
+    for (uint8_t i = 0; i < COAP_OBSERVE_MAX_OBSERVERS; i++) {
+        if (observers[i].port == port && observers[i].addr == addr &&
+                (observers[i].messageID == messageID ||
+                 observers[i].conMessageID == messageID)) {
+            LOG_INFO("Observer " << addr.str() << " reset");
+            if (observers[i].numUnacked > 0) {
+                cancelMessage(addr, port, observers[i].conMessageID);
+            }
+            observers[i].port = 0;
+        }
+    }
+}
+
+void CoAPObservableResource::handleUpdate(CoAPMessage* request) {
+    sendResponse(request, COAP_METHODNOTALLOWED);
+}
+
+void CoAPObservableResource::sendResponse(CoAPMessage* request, uint8_t code,
+        bool observing) {
+    CoAPMessageOption opt;
+    if (observing) {
+        opt.setUint(CoAPMessageOption::OPT_OBSERVE, seq);
+    }
+
+    const char* repr = NULL;
+    uint16_t reprLen = 0;
+    if (code == COAP_CONTENT) {
+        repr = getRepresentation();
+        reprLen = (repr != NULL) ? strlen(repr) : 0;
+    }
+
+    // piggyback on the ACK of a CON request
+    bool piggyback = (request->getMessageType() == COAP_CON);
+    URL url(URL::COAP, request->getAddr(), request->getMessageSrcPort());
+    CoAPMessage* answer = makeMessage();
+    if (answer->init(url,
+            localPort,
+            piggyback ? COAP_ACK : COAP_NON,
+            code,
+            piggyback ? request->getMessageID() :
+                    getNextMessageID(request->getAddr(), request->getMessageSrcPort()),
+            request->getMessageToken(),
+            &opt, observing ? 1 : 0,
+            repr, reprLen,
+            false) != 0 ||
+        answer->getMessagePacket() == NULL)
+    {
+        delete answer;
+        return;
+    }
+    sendMessage(answer);
+}
+
+CoAPObserver_t* CoAPObservableResource::findObserver(const IPv6Address& addr,
+        uint16_t port, Token token) {
+    for (uint8_t i = 0; i < COAP_OBSERVE_MAX_OBSERVERS; i++) {
+        if (observers[i].port == port && observers[i].addr == addr &&
+                observers[i].token == token) {
+            return &observers[i];
+        }
+    }
+    return NULL;
+}
+
+void CoAPObservableResource::notifyObservers() {
+    pending = false;
+    if (getNumObservers() == 0) {
+        return;
+    }
+
+    seq = (seq + 1) & MAX_SEQ;
+    for (uint8_t i = 0; i < COAP_OBSERVE_MAX_OBSERVERS; i++) {
+        if (observers[i].port != 0) {
+            notify(observers[i]);
+        }
+    }
+
+    if (minInterval > 0) {
+        cometos::getScheduler().replace(holdOffTask, minInterval);
+    }
+}
+
+void CoAPObservableResource::notify(CoAPObserver_t& observer) {
+    bool con = (observer.numNon + 1 >= COAP_OBSERVE_CON_INTERVAL);
+    if (con && observer.numUnacked > 0) {
+        if (observer.numUnacked >= COAP_OBSERVE_MAX_UNACKED) {
+            LOG_INFO("Observer " << observer.addr.str() << " unreachable");
+            cancelMessage(observer.addr, observer.port, observer.conMessageID);
+            observer.port = 0;
+            return;
+        }
+        // the new state supersedes the unacknowledged one
+        cancelMessage(observer.addr, observer.port, observer.conMessageID);
+    }
+
+    CoAPMessageOption opt;
+    opt.setUint(CoAPMessageOption::OPT_OBSERVE, seq);
+
+    const char* repr = getRepresentation();
+    uint16_t messageID = getNextMessageID(observer.addr, observer.port);
+    URL url(URL::COAP, observer.addr, observer.port);
+    CoAPMessage* msg = makeMessage();
+    if (msg->init(url,
+            localPort,
+            con ? COAP_CON : COAP_NON,
+            COAP_CONTENT,
+            messageID,
+            observer.token,
+            &opt, 1,
+            repr, (repr != NULL) ? strlen(repr) : 0,
+            false) != 0 ||
+        msg->getMessagePacket() == NULL)
+    {
+        delete msg;
+        return;
+    }
+
+    // only CONs have to be kept for retransmissions, NONs are matched
+    // against RSTs by the stored message ID
+    if ((con ? sendTrackedMessage(msg) : sendMessage(msg)) != 0) {
+        return;
+    }
+
+    observer.messageID = messageID;
+    if (con) {
+        observer.conMessageID = messageID;
+        observer.numNon = 0;
+        observer.numUnacked++;
+    } else {
+        observer.numNon++;
+    }
+    numNotifications++;
+}
+
+void CoAPObservableResource::holdOffExpired() {
+    if (pending) {
+        notifyObservers();
+    }
+}
+
+}
@@ -0,0 +1,136 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef COAPOBSERVABLERESOURCE_H_
+#define COAPOBSERVABLERESOURCE_H_
+
+#include "CoAPResource.h"
+#include "Task.h"
+
+namespace cometos_v6 {
+
+/*
+ * A client observing a resource (RFC 7641), identified by endpoint and token.
+ * The entry is unused if port is 0.
+ */
+struct CoAPObserver_t {
+    IPv6Address addr;
+    uint16_t    port;
+    Token       token;
+    uint16_t    messageID;      // last notification, matched by RSTs
+    uint16_t    conMessageID;   // last CON notification, matched by ACKs
+    uint8_t     numNon;         // NON notifications since the last CON
+    uint8_t     numUnacked;     // CON notifications not acknowledged
+    CoAPObserver_t(): port(0), messageID(0), conMessageID(0), numNon(0), numUnacked(0) {}
+};
+
+/*
+ * Resource which can be observed (RFC 7641) instead of being polled.
+ *
+ * A GET with Observe 0 registers the client, Observe 1 or a GET without
+ * Observe from the same endpoint and token deregisters it. The application
+ * calls changed() whenever the representation changes. Notifications are
+ * sent as NON; every COAP_OBSERVE_CON_INTERVAL-th one is sent as CON to
+ * check that the client is still there. Clients answering with a RST or
+ * not acknowledging COAP_OBSERVE_MAX_UNACKED CONs in a row are removed.
+ *
+ * With a minimum notification interval set, changes within this interval
+ * after a notification are coalesced into a single one carrying the
+ * latest representation, which is sent when the interval is over.
+ *
+ * Requests other than GET are passed to handleUpdate().
+ */
+class CoAPObservableResource : public CoAPResource {
+public:
+    static const uint32_t MAX_SEQ = 0xFFFFFF;
+
+    CoAPObservableResource();
+    virtual ~CoAPObservableResource();
+
+    /*
+     * Limits the rate of notifications to one per minInterval milliseconds.
+     */
+    void setMinNotificationInterval(time_ms_t minInterval) {
+        this->minInterval = minInterval;
+    }
+
+    /*
+     * Signals a change of the representation to the observers.
+     */
+    void changed();
+
+    uint8_t getNumObservers() const;
+
+    uint32_t getNumNotifications() const { return numNotifications; }
+    uint32_t getNumCoalesced() const { return numCoalesced; }
+
+    virtual void handleRequest(CoAPMessage* request);
+    virtual void handleDuplicateRequest(CoAPMessage* request, uint8_t type);
+
+    virtual void handleAck(const IPv6Address& addr, uint16_t port, uint16_t messageID);
+    virtual void handleReset(const IPv6Address& addr, uint16_t port, uint16_t messageID);
+
+protected:
+    /*
+     * Handles requests other than GET; the default rejects them.
+     */
+    virtual void handleUpdate(CoAPMessage* request);
+
+    /*
+     * Responds to a request, with the current representation for 2.05.
+     * If observing, the Observe option tells the client it is registered.
+     */
+    void sendResponse(CoAPMessage* request, uint8_t code, bool observing = false);
+
+private:
+    CoAPObserver_t* findObserver(const IPv6Address& addr, uint16_t port, Token token);
+
+    void notifyObservers();
+    void notify(CoAPObserver_t& observer);
+
+    void holdOffExpired();
+
+    CoAPObserver_t observers[COAP_OBSERVE_MAX_OBSERVERS];
+
+    uint32_t seq;
+    time_ms_t minInterval;
+    bool pending;
+
+    uint32_t numNotifications;
+    uint32_t numCoalesced;
+
+    cometos::BoundedTask<CoAPObservableResource, &CoAPObservableResource::holdOffExpired> holdOffTask;
+};
+
+}
+
+#endif /* COAPOBSERVABLERESOURCE_H_ */
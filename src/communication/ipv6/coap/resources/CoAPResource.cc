@@ -44,6 +44,14 @@ uint8_t CoAPResource::sendMessage(CoAPMessage* message){
     return coap->sendMessage(message, true);
 }
 
+uint8_t CoAPResource::sendTrackedMessage(CoAPMessage* message){
+    uint8_t err = coap->sendMessage(message, false);
+    if (err) {
+        delete message;
+    }
+    return err;
+}
+
 CoAPMessage* CoAPResource::makeMessage(){
     return coap->prepareMessage();
 }
@@ -55,18 +63,25 @@ void CoAPResource::initMessage(       cometos_v6::CoAPMessage* msg,
                                       uint8_t messageCode,
                                       uint16_t messageID,
                                       cometos_v6::Token token,
-                                      cometos_v6::CoAPMessageOption** options,
+                                const cometos_v6::CoAPMessageOption* options,
                                       uint8_t optionsLen,
                                 const char* payload,
                                       uint16_t payloadLen,
-                                      bool handleOptions,
                                       bool handlePayload)
 {
     coap->initMessage(msg, url, srcPort,
                       messageType, messageCode,
                       messageID, token, options,
                       optionsLen, payload, payloadLen,
-                      handleOptions, handlePayload);
+                      handlePayload);
+}
+
+uint16_t CoAPResource::getNextMessageID(const IPv6Address& addr, uint16_t dstPort){
+    return coap->getNextMessageID(addr, localPort, dstPort);
+}
+
+void CoAPResource::cancelMessage(const IPv6Address& addr, uint16_t dstPort, uint16_t messageID){
+    coap->sentMessages.deleteMessage(addr, localPort, dstPort, true, false, messageID);
 }
 
 uint16_t CoAPResource::printPath(char* path, uint16_t maxLen){
@@ -62,7 +62,7 @@ enum {
 #define RESOURCE_HANDLER_PARAMETERS     cometos_v6::CoAPMessage* message
 #define RESOURCE_HANDLER_CALLING        message
 
-#define RESOURCE_COAP_HANDLER_SIGNATURE      cometos_v6::CoAPMessage*, const cometos_v6::URL&, uint16_t, uint8_t, uint8_t, uint16_t, cometos_v6::Token, cometos_v6::CoAPMessageOption**, uint8_t, const char*, uint16_t, bool, bool
+#define RESOURCE_COAP_HANDLER_SIGNATURE      cometos_v6::CoAPMessage*, const cometos_v6::URL&, uint16_t, uint8_t, uint8_t, uint16_t, cometos_v6::Token, const cometos_v6::CoAPMessageOption*, uint8_t, const char*, uint16_t, bool
 #define RESOURCE_COAP_HANDLER_PARAMETERS
 #define RESOURCE_COAP_HANDLER_CALLING
 
@@ -96,6 +96,13 @@ public:
 
     uint8_t sendMessage(CoAPMessage* message);
 
+    /*
+     * Sends a message which is kept by the CoAPLayer like a request of a client,
+     * i.e. a CON is retransmitted until it is acknowledged.
+     * The message is deleted if sending fails.
+     */
+    uint8_t sendTrackedMessage(CoAPMessage* message);
+
     CoAPMessage* makeMessage();
 
     void initMessage(      cometos_v6::CoAPMessage* msg,
@@ -105,13 +112,18 @@ public:
                            uint8_t messageCode,
                            uint16_t messageID,
                            cometos_v6::Token token,
-                           cometos_v6::CoAPMessageOption** options,
+                     const cometos_v6::CoAPMessageOption* options,
                            uint8_t optionsLen,
                      const char* payload,
                            uint16_t payloadLen,
-                           bool handleOptions,
                            bool handlePayload);
 
+    /*
+     * Returns an unused message ID for a response sent to addr:dstPort
+     * which can not be piggybacked on an ACK.
+     */
+    uint16_t getNextMessageID(const IPv6Address& addr, uint16_t dstPort);
+
     /*
      * This method sets the internal fields of the ressource.
      */
@@ -163,6 +175,17 @@ public:
         return true;
     }
 
+    /*
+     * Returns the number of segments of the path and the segment at
+     * position i, i.e. "is" for i = 1 and the path "/this/is/a/path".
+     */
+    uint8_t getPathSize() const {
+        return pathSize;
+    }
+    const char* getPathSegment(uint8_t i) const {
+        return path[i];
+    }
+
     /*
      * Returns the length of the path.
      */
@@ -225,8 +248,23 @@ public:
      */
     virtual void handleDuplicateRequest(CoAPMessage* request, uint8_t type) = 0;
 
+    /*
+     *  These functions get called by CoAPLayer if an empty ACK or RST from addr:port
+     *  matches the message ID of a CON or NON message sent from the local port of
+     *  this resource. Resources sending messages on their own, e.g. notifications
+     *  of observers, can use them to learn about the fate of these messages.
+     */
+    virtual void handleAck(const IPv6Address& addr, uint16_t port, uint16_t messageID) {}
+    virtual void handleReset(const IPv6Address& addr, uint16_t port, uint16_t messageID) {}
+
 protected:
 
+    /*
+     * Stops retransmissions of a CON message sent to addr:dstPort, e.g. if
+     * it is superseded by a newer one.
+     */
+    void cancelMessage(const IPv6Address& addr, uint16_t dstPort, uint16_t messageID);
+
     void deletePath() {
         if(this->path != NULL){
             for(uint8_t i = 0; i < this->pathSize; i++){
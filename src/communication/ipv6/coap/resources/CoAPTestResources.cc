@@ -80,7 +80,7 @@ void CoAPLightSensor::handleRequest(cometos_v6::CoAPMessage* request)
             request->getMessageToken(),
             NULL, 0,
             lightIntensity, strlen(lightIntensity),
-            false, false);
+            false);
 
 
     sendMessage(answer);
@@ -172,7 +172,7 @@ void CoAPLightSwitch::setRepresentation(const char* repr, uint16_t len){
              request->getMessageToken(),
              NULL, 0,
              switchState, strlen(switchState),
-             false, false);
+             false);
      sendMessage(answer);
  }
 
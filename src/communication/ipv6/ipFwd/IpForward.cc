@@ -103,7 +103,15 @@ IpForward::IpForward(const char * service_name, RoutingTable* rt,
         it(it),
         icmp(icmp),
         poolToLower(nullptr),
-        poolToUpper(nullptr)
+        poolToUpper(nullptr),
+        burstHead(0),
+        burstLength(0),
+        burstSize(IPFWD_BURST_SIZE),
+        draining(false),
+        lastRouteValid(false),
+        lastResult(RR_NO_ROUTE),
+        numBursts(0),
+        numRouteHits(0)
 {}
 
 IpForward::~IpForward() {
@@ -149,13 +157,18 @@ void IpForward::initialize() {
 
     CONFIG_NED_OBJ(cfg, numRequestsToLower);
     CONFIG_NED_OBJ(cfg, numIndicationsToUpper);
+    CONFIG_NED(burstSize);
+    setBurstSize(burstSize);
 
     createMessagePools(cfg);
 
 }
 
 void IpForward::finish() {
+    cancel(&burstMsg);
 #ifdef OMNETPP
+    RECORD_SCALAR(numBursts);
+    RECORD_SCALAR(numRouteHits);
     poolToLower->finish();
     poolToUpper->finish();
 #endif
@@ -307,7 +320,103 @@ IpConfig& IpForward::getActive() {
 
 
 
+void IpForward::setBurstSize(uint8_t size) {
+    if (size > IPFWD_MAX_BURST) {
+        size = IPFWD_MAX_BURST;
+    }
+    burstSize = size;
+}
+
 void IpForward::handleRequestFromLowpan(IPv6Request *reqFromLower) {
+    if (!enqueueBurst(reqFromLower, NULL)) {
+        processRequestFromLowpan(reqFromLower);
+    }
+}
+
+void IpForward::handleRequestFromUpper(ContentRequest *cRequest) {
+    ASSERT(cRequest != NULL);
+    if (!enqueueBurst(NULL, cRequest)) {
+        processRequestFromUpper(cRequest);
+    }
+}
+
+bool IpForward::enqueueBurst(IPv6Request *ipRequest, ContentRequest *cRequest) {
+    if (burstSize <= 1 && burstLength == 0) {
+        return false;
+    }
+    if (burstLength == IPFWD_MAX_BURST) {
+        if (draining) {
+            // requests issued while a burst is handled must not start
+            // another drain, this one is handled right away instead
+            return false;
+        }
+        // keep the order of arrival by handling the oldest requests first
+        drainBurst();
+    }
+    BurstEntry & entry = burstQueue[(burstHead + burstLength) % IPFWD_MAX_BURST];
+    entry.ipRequest = ipRequest;
+    entry.cRequest = cRequest;
+    burstLength++;
+    if (!isScheduled(&burstMsg)) {
+        schedule(&burstMsg, &IpForward::handleBurst);
+    }
+    return true;
+}
+
+void IpForward::handleBurst(cometos::Message *msg) {
+    drainBurst();
+    if (burstLength > 0) {
+        schedule(&burstMsg, &IpForward::handleBurst);
+    }
+}
+
+void IpForward::drainBurst() {
+    uint8_t n = burstLength;
+    if (n > burstSize) {
+        n = burstSize > 0 ? burstSize : 1;
+    }
+    if (n == 0) {
+        return;
+    }
+
+    BurstEntry burst[IPFWD_MAX_BURST];
+    for (uint8_t i = 0; i < n; i++) {
+        burst[i] = burstQueue[burstHead];
+        burstHead = (burstHead + 1) % IPFWD_MAX_BURST;
+    }
+    burstLength -= n;
+
+    // group by destination, keeping the order within each destination
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t next = i + 1;
+        for (uint8_t j = next; j < n; j++) {
+            if (burst[j].destination() == burst[i].destination()) {
+                BurstEntry entry = burst[j];
+                for (uint8_t k = j; k > next; k--) {
+                    burst[k] = burst[k - 1];
+                }
+                burst[next++] = entry;
+            }
+        }
+        i = next - 1;
+    }
+
+    LOG_DEBUG("Drain " << (int) n << " reqs");
+    numBursts++;
+    draining = true;
+    lastRouteValid = false;
+    for (uint8_t i = 0; i < n; i++) {
+        if (burst[i].ipRequest != NULL) {
+            processRequestFromLowpan(burst[i].ipRequest);
+        } else {
+            processRequestFromUpper(burst[i].cRequest);
+        }
+    }
+    draining = false;
+    lastRouteValid = false;
+}
+
+void IpForward::processRequestFromLowpan(IPv6Request *reqFromLower) {
     LOG_DEBUG("Rcvd IPRq frm Lowpan" <<"ip dst: " << reqFromLower->data.datagram->dst.str() << " ip src: " <<reqFromLower->data.datagram->src.str());
     LOG_DEBUG("Datagram Datalength: " << reqFromLower->data.datagram->getUpperLayerPayloadLength());
 
@@ -315,7 +424,11 @@ void IpForward::handleRequestFromLowpan(IPv6Request *reqFromLower) {
         rb->rxResult(reqFromLower->data.datagram->src, *reqFromLower->get<LlRxInfo>());
     }
 
-    if (isForMe(reqFromLower->data.datagram->dst)) {
+    if (isForMe(reqFromLower->data.datagram->dst)
+#ifdef COMETOS_V6_RPL_SR
+            && !hasPendingSegments(reqFromLower->data.datagram)
+#endif
+            ) {
 
         // TODO: Multicast support
 
@@ -379,8 +492,7 @@ void IpForward::handleRequestFromLowpan(IPv6Request *reqFromLower) {
     }
 }
 
-void IpForward::handleRequestFromUpper(ContentRequest *cRequest) {
-    ASSERT(cRequest != NULL);
+void IpForward::processRequestFromUpper(ContentRequest *cRequest) {
     LOG_DEBUG("up->IP CReq");
     if (isForMe(cRequest->dst)) {
         LOG_DEBUG("Pckt for me! " << cRequest->dst.str());
@@ -581,7 +693,7 @@ void IpForward::handleResponseFromLowpan(IPv6Response* ipResponse) {
         IPv6RoutingHeader * SRHeader = (IPv6RoutingHeader *)fh;
         if (SRHeader->dataAdded==1) {
             const uint8_t* addressData = SRHeader->getHData();
-            delete addressData;
+            delete[] addressData;
             SRHeader->dataAdded=0;
         }
     }
@@ -669,28 +781,15 @@ routeResult_t IpForward::routeOver(IPv6Request *iprequest) {
 
 #ifdef COMETOS_V6_RPL_SR
     RPLRouting* Routing_Info = (RPLRouting*)rb;
-    if (Routing_Info->nonstoring) {
+    IPv6RoutingHeader* srh = getSourceRoutingHeader(iprequest->data.datagram);
+    if (srh != NULL && srh->getSegmentsLeft() > 0 && isForMe(iprequest->data.datagram->dst)) {
+        // we are a hop of a source route, the header tells the next one
+        rr = findSourceRoute(iprequest->data.datagram, iprequest->data.srcMacAddress, iprequest->data.dstMacAddress);
+    } else if (Routing_Info->isNonStoringRoot() && srh == NULL
+            && addSourceRoutingHeader(iprequest->data.datagram)) {
         LOG_DEBUG("Using Non Storing Mode");
-        //In Non-Storing mode, the root builds a strict source routing header,
-        //hop-by-hop, by recursively looking up one-hop information that ties a
-        //Target (address or prefix) and a transit address together.
-        bool SRHAdded = false;
-        if (Routing_Info->isRoot) {
-            SRHAdded = addSourceRoutingHeader(iprequest->data.datagram);
-            if (SRHAdded) {
-                LOG_DEBUG ("Source Routing Header added successfully");
-            }
-            else {
-                LOG_DEBUG ("Source Routing Header could not be added");
-                rr = RR_SRHEADER_ERROR;
-            }
-        }
-        if (rr!= RR_SRHEADER_ERROR  && SRHAdded) {
-            rr = findSourceRoute(iprequest->data.datagram, iprequest->data.srcMacAddress, iprequest->data.dstMacAddress);
-        }
-        else {
-            rr = findRoute(iprequest->data.datagram->dst, iprequest->data.srcMacAddress, iprequest->data.dstMacAddress);
-        }
+        // the datagram is addressed to the first hop now
+        rr = resolveNextHop(iprequest->data.datagram->dst, iprequest->data.srcMacAddress, iprequest->data.dstMacAddress);
     } else {
         rr = findRoute(iprequest->data.datagram->dst, iprequest->data.srcMacAddress, iprequest->data.dstMacAddress);
     }
@@ -734,49 +833,43 @@ routeResult_t IpForward::routeOver(IPv6Request *iprequest) {
 }
 
 #ifdef COMETOS_V6_RPL_SR
+IPv6RoutingHeader* IpForward::getSourceRoutingHeader(IPv6Datagram *datagram) {
+    FollowingHeader* fh = datagram->getNextHeader();
+    while (fh != NULL) {
+        if (fh->getHeaderType() == IPv6RoutingHeader::HeaderNumber
+                && ((IPv6RoutingHeader*)fh)->getRoutingType() == IPv6RoutingHeader::SOURCE_ROUTING_TYPE) {
+            return (IPv6RoutingHeader*)fh;
+        }
+        fh = fh->getNextHeader();
+    }
+    return NULL;
+}
+
 bool IpForward::addSourceRoutingHeader(IPv6Datagram *sourceDatagram) {
     LOG_DEBUG("Try to add SrcRouting Header");
 
-    IPv6RoutingHeader* sourceRoutingHeader = new IPv6RoutingHeader;
-    //sourceDatagram->createNextHeader(43); ?
-    //Source Routing Headers have Routing Type 3
-    sourceRoutingHeader->setRoutingType(3);
-
-    IPv6Address dest = sourceDatagram->dst;
-    const IPv6Route * sourceRoute = srt->doLongestPrefixMatch(dest);
-    if (!sourceRoute){
+    // the path is maintained by the source routing table, we only copy
+    // the prepared header, which may change before the datagram is sent
+    const SourceRoute* sourceRoute = srt->getSourceRoute(sourceDatagram->dst);
+    if (sourceRoute == NULL) {
         LOG_DEBUG("No source route to the destination");
-        return 0;
+        return false;
     }
 
-    IPv6Address nextHop = sourceRoute->getNextHop();
-
-    // For now we store the hops addresses here
-    IPv6Address hops[IP_MAXCONTENTS];
-    int i = 0;
-
-    while (nextHop != dest) {
-        if (i==IP_MAXCONTENTS) {
-            //Too many hops, cannot add the Header
-            return 0;
-        }
-        hops[i] = nextHop;
-        nextHop = sourceRoute->getNextHop();
-
-        i++;
+    sourceDatagram->dst = sourceRoute->firstHop;
+    if (sourceRoute->segments == 0) {
+        // destination is our neighbor
+        return true;
     }
-    int numberHops = i;
 
-    //Now we store the hops in the Header
-    uint8_t* addressData = new uint8_t[numberHops * IP6_BYTES];
-    int j=0;
-    for (int index=0;index<numberHops;index++) {
-        hops[index].writeAddress(&(addressData[j]));
-        j += IP6_BYTES;
-    }
-    sourceRoutingHeader->setData(addressData,j);
-    sourceRoutingHeader->dataAdded=1;
-    sourceRoutingHeader->setSegmentsLeft(numberHops-1);
+    uint8_t* addressData = new uint8_t[sourceRoute->headerLength];
+    memcpy(addressData, sourceRoute->header, sourceRoute->headerLength);
+
+    IPv6RoutingHeader* sourceRoutingHeader = new IPv6RoutingHeader;
+    sourceRoutingHeader->setRoutingType(IPv6RoutingHeader::SOURCE_ROUTING_TYPE);
+    sourceRoutingHeader->setData(addressData, sourceRoute->headerLength);
+    sourceRoutingHeader->dataAdded = true;
+    sourceRoutingHeader->setSegmentsLeft(sourceRoute->segments);
 
     //We add the Header to the datagram
     //We look for the right position to add the Header
@@ -805,7 +898,24 @@ bool IpForward::addSourceRoutingHeader(IPv6Datagram *sourceDatagram) {
         }
     }
     sourceDatagram->addHeader(sourceRoutingHeader,pos);
-    return 1;
+    return true;
+}
+
+routeResult_t IpForward::resolveNextHop(
+        const IPv6Address & nextHop,
+        Ieee802154MacAddress & src,
+        Ieee802154MacAddress & dst) {
+    const Ieee802154MacAddress* dstMACAddr = nd->resolveNeighbor(nextHop);
+    if (dstMACAddr != NULL) {
+        src = it->getInterface(INTERFACE_ID).getMacAddress();
+        dst = *dstMACAddr;
+
+        LOG_DEBUG("Sending Pckt over " << dst.a4());
+        return RR_SUCCESS;
+    } else {
+        LOG_DEBUG("Cld not rslv Nghbr");
+        return RR_NO_NEIGHBOR;
+    }
 }
 #endif
 
@@ -814,6 +924,31 @@ routeResult_t IpForward::findRoute(
         Ieee802154MacAddress & src,
         Ieee802154MacAddress & dst) {
 
+    // datagrams of a burst are grouped by destination, so remembering
+    // the last lookup is enough to resolve each destination only once
+    if (lastRouteValid && lastDestination == destination) {
+        numRouteHits++;
+        src = lastSrc;
+        dst = lastDst;
+        return lastResult;
+    }
+
+    routeResult_t result = lookupRoute(destination, src, dst);
+    if (draining) {
+        lastRouteValid = true;
+        lastDestination = destination;
+        lastResult = result;
+        lastSrc = src;
+        lastDst = dst;
+    }
+    return result;
+}
+
+routeResult_t IpForward::lookupRoute(
+        const IPv6Address & destination,
+        Ieee802154MacAddress & src,
+        Ieee802154MacAddress & dst) {
+
     LOG_DEBUG("Srch for Rt Dst " << destination.str());
     const IPv6Route * route = rt->doLongestPrefixMatch(destination);
     LOG_DEBUG("Check Rt");
@@ -847,87 +982,19 @@ routeResult_t IpForward::findRoute(
 
 #ifdef COMETOS_V6_RPL_SR
 routeResult_t IpForward::findSourceRoute(
-        const IPv6Datagram * datagram,
+        IPv6Datagram * datagram,
         Ieee802154MacAddress & src,
         Ieee802154MacAddress & dst) {
 
-    IPv6Address destination = datagram->dst;
-    const IPv6Route * sourceRoute = srt->doLongestPrefixMatch(destination);
-
-    if (sourceRoute == NULL) {
-            LOG_DEBUG("No Rt to Dst!");
-            return RR_NO_ROUTE;
+    // the next hop follows directly from segments left (RFC 6554, 4.2)
+    IPv6RoutingHeader * SRHeader = getSourceRoutingHeader(datagram);
+    ASSERT(SRHeader != NULL);
+    if (!SRHeader->nextSegment(datagram->dst) || isForMe(datagram->dst)) {
+        LOG_WARN("Invalid SrcRouting Header");
+        return RR_SRHEADER_ERROR;
     }
-    else {
-        // We take the data from the source Routing Header
-        FollowingHeader* fh = datagram->getNextHeader();
-        while (fh != NULL && fh->getHeaderType() != IPv6RoutingHeader::HeaderNumber) {
-            fh = fh->getNextHeader();
-        }
-        ASSERT(fh!=NULL);
-        IPv6RoutingHeader * SRHeader = (IPv6RoutingHeader *)fh;
-        int numberHops = SRHeader->getSegmentsLeft()+1;
-        const uint8_t* addressData = SRHeader->getHData();
-        IPv6Address hops[IP_MAXCONTENTS];
-        int j=0;
-        for (int index=0;index<numberHops;index++) {
-            hops[index] = IPv6Address(&addressData[j]);
-            j += IP6_BYTES;
-        }
-
-        // If there is still segments left in the header,
-        // the datagram must go to the next hop
-        if (SRHeader->getSegmentsLeft() > 1){
-            //Intermediate Hops before reaching the destination
-            LOG_DEBUG("Get MAC Addr");
-
-            // We check which one is the next hop
-            IPv6Address nh;
-            IPv6Address sourceAddress = it->getInterface(sourceRoute->getInterfaceId()).getAddress(0);
-            for (int i=0;i<numberHops;i++) {
-                if (hops[i]==sourceAddress) {
-                    nh = hops[i+1];
-                }
-            }
-
-            const Ieee802154MacAddress* dstMACAddr = nd->resolveNeighbor(nh);
 
-            if (dstMACAddr != NULL) {
-                src = it->getInterface(sourceRoute->getInterfaceId()).getMacAddress();
-                dst = *dstMACAddr;
-
-                LOG_DEBUG("Sending Pckt w/ Dst "
-                            << destination.getAddressPart(7)
-                            << " over " << dst.a4());
-                return RR_SUCCESS;
-            } else {
-                LOG_DEBUG("Cld not rslv Nghbr");
-                return RR_NO_NEIGHBOR;
-            }
-            SRHeader->decrSegmentsLeft();
-        }
-        else if (SRHeader->getSegmentsLeft() == 1) {
-            // The last segment is the direct route to the destination
-
-            LOG_DEBUG("Get MAC Addr");
-            const Ieee802154MacAddress* dstMACAddr = nd->resolveNeighbor(destination);
-
-            if (dstMACAddr != NULL) {
-                src = it->getInterface(sourceRoute->getInterfaceId()).getMacAddress();
-                dst = *dstMACAddr;
-
-                LOG_DEBUG("Sending Pckt to Dst "
-                              << destination.getAddressPart(7));
-                return RR_SUCCESS;
-            } else {
-                LOG_DEBUG("Cld not rslv Nghbr");
-                return RR_NO_NEIGHBOR;
-            }
-        }
-        else {
-            return RR_NO_ROUTE;
-        }
-    }
+    return resolveNextHop(datagram->dst, src, dst);
 }
 #endif
 
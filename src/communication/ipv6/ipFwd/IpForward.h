@@ -49,6 +49,7 @@
 #include "RoutingTable.h"
 #ifdef COMETOS_V6_RPL_SR
 #include "RPLSourceRoutingTable.h"
+#include "IPv6RoutingHeader.h"
 #endif
 #include "IPv6InterfaceTable.h"
 #include "PersistableConfig.h"
@@ -69,6 +70,16 @@ const uint8_t IPFWD_MAX_REQUESTS = LOWPAN_SET_DF_PACKETS;
 #endif
 const uint8_t IP_MAXCONTENTS = 8;
 
+/** Maximum number of requests handled by one task in burst mode */
+#ifndef IPFWD_MAX_BURST
+#define IPFWD_MAX_BURST 8
+#endif
+
+/** Default burst size; 1 handles every request on arrival */
+#ifndef IPFWD_BURST_SIZE
+#define IPFWD_BURST_SIZE 1
+#endif
+
 #if defined SWIG || defined BOARD_python
 enum routeResult_t
 #else
@@ -184,6 +195,32 @@ public:
      */
     routeResult_t crossLayerRouting(IPv6Request* & ipReq, const IPv6Address & destination);
 
+    /**
+     * Sets the number of requests handled per scheduler task. With a size
+     * larger than one, requests from lowpan and the upper layers are
+     * queued and drained in bursts. Within a burst, datagrams to the same
+     * destination are handled one after another and share a single route
+     * and neighbor resolution.
+     *
+     * @param size burst size, limited to IPFWD_MAX_BURST
+     */
+    void setBurstSize(uint8_t size);
+
+    uint8_t getBurstSize() {
+        return burstSize;
+    }
+
+    /** number of drained bursts */
+    uint32_t getNumBursts() {
+        return numBursts;
+    }
+
+    /** number of route lookups answered by the result of a previous
+     * datagram of the same burst */
+    uint32_t getNumRouteHits() {
+        return numRouteHits;
+    }
+
     virtual bool isBusy();
     virtual void applyConfig(IpConfig& cfg);
     virtual IpConfig& getActive();
@@ -215,6 +252,34 @@ public:
 #endif
 
 private:
+    /**
+     * Request waiting for the next burst, either from lowpan or from
+     * one of the upper layers.
+     */
+    struct BurstEntry {
+        IPv6Request*    ipRequest;
+        ContentRequest* cRequest;
+
+        const IPv6Address & destination() const {
+            return ipRequest != NULL ? ipRequest->data.datagram->dst : cRequest->dst;
+        }
+    };
+
+    void processRequestFromLowpan(IPv6Request *ipRequest);
+    void processRequestFromUpper(ContentRequest *cRequest);
+
+    /**
+     * Queues a request for the next burst.
+     *
+     * @return false if burst mode is disabled and the request has to be
+     *         handled right away
+     */
+    bool enqueueBurst(IPv6Request *ipRequest, ContentRequest *cRequest);
+
+    void handleBurst(cometos::Message *msg);
+
+    void drainBurst();
+
     routeResult_t routeOver(IPv6Request *ipRequest);
 
     void deleteMessagePools();
@@ -239,12 +304,35 @@ private:
             Ieee802154MacAddress & src,
             Ieee802154MacAddress & dst);
 
+    routeResult_t lookupRoute(
+            const IPv6Address & destination,
+            Ieee802154MacAddress & src,
+            Ieee802154MacAddress & dst);
+
 #ifdef COMETOS_V6_RPL_SR
+    IPv6RoutingHeader* getSourceRoutingHeader(IPv6Datagram *datagram);
+
+    bool hasPendingSegments(IPv6Datagram *datagram) {
+        IPv6RoutingHeader* srh = getSourceRoutingHeader(datagram);
+        return srh != NULL && srh->getSegmentsLeft() > 0;
+    }
+
+    /**
+     * Adds the source routing header for the destination of a datagram
+     * sent by the root and readdresses it to the first hop.
+     */
     bool addSourceRoutingHeader(IPv6Datagram *datagram);
 
-    //Tries to find a source Route for a given destination
+    /**
+     * Forwards a datagram to the next hop of its source routing header.
+     */
     routeResult_t findSourceRoute(
-            const IPv6Datagram * datagram,
+            IPv6Datagram * datagram,
+            Ieee802154MacAddress & src,
+            Ieee802154MacAddress & dst);
+
+    routeResult_t resolveNextHop(
+            const IPv6Address & nextHop,
             Ieee802154MacAddress & src,
             Ieee802154MacAddress & dst);
 #endif
@@ -265,6 +353,23 @@ private:
 
     cometos::MappedPoolBase<IpData>* poolToLower;
     cometos::MappedPoolBase<IpIndicationData>* poolToUpper;
+
+    BurstEntry             burstQueue[IPFWD_MAX_BURST];
+    uint8_t                burstHead;
+    uint8_t                burstLength;
+    uint8_t                burstSize;
+    cometos::Message       burstMsg;
+
+    /** result of the last route lookup, only valid while draining */
+    bool                   draining;
+    bool                   lastRouteValid;
+    IPv6Address            lastDestination;
+    routeResult_t          lastResult;
+    Ieee802154MacAddress   lastSrc;
+    Ieee802154MacAddress   lastDst;
+
+    uint32_t               numBursts;
+    uint32_t               numRouteHits;
 };
 
 }
@@ -35,6 +35,7 @@
  */
 
 #include "FollowingHeader.h"
+#include "InternetChecksum.h"
 
 namespace cometos_v6 {
 
@@ -53,19 +54,14 @@ FollowingHeader::~FollowingHeader() {
 };
 
 uint16_t doingChecksum(uint32_t chksum, const uint8_t* data, uint16_t length, const IPv6Address &src, const IPv6Address &dst, uint16_t allLength, uint8_t headerNumber) {
-    for (uint16_t i = 0; i < length; i++) {
-        chksum += ((uint16_t) data[i++]) << 8;
-        if (i < length) {
-            chksum += data[i];
-        }
-    }
-    for (uint8_t i = 0; i < 8; i++) {
-        chksum += src.getAddressPart(i) + dst.getAddressPart(i);
-    }
+    return doingChecksum(chksum + checksumPseudoHeader(src, dst), data, length,
+            allLength, headerNumber);
+}
+
+uint16_t doingChecksum(uint32_t chksum, const uint8_t* data, uint16_t length, uint16_t allLength, uint8_t headerNumber) {
+    chksum = checksumAdd(chksum, data, length);
     chksum += allLength + headerNumber;
-    while (chksum > 0xFFFF) {
-        chksum = (chksum & 0xFFFF) + (chksum >> 16);
-    }
+    chksum = checksumFold(chksum);
     if (chksum != 0xFFFF) {
         return ~chksum;
     } else {
@@ -261,6 +261,14 @@ uint16_t doingChecksum(uint32_t chksum,
         const IPv6Address &src, const IPv6Address &dst,
         uint16_t allLength, uint8_t headerNumber);
 
+/**
+ * Variant of doingChecksum for a partial sum that already contains the
+ * addresses of the pseudo header, see checksumPseudoHeader().
+ */
+uint16_t doingChecksum(uint32_t chksum,
+        const uint8_t* data, uint16_t length,
+        uint16_t allLength, uint8_t headerNumber);
+
 
 }
 
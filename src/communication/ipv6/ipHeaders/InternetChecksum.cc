@@ -0,0 +1,154 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "InternetChecksum.h"
+#include <string.h>
+
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+#define CHECKSUM_X86_SIMD
+#include <immintrin.h>
+#endif
+
+#if defined __SIZEOF_POINTER__ && __SIZEOF_POINTER__ == 8 \
+        && defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define CHECKSUM_WIDE_WORDS
+#endif
+
+namespace cometos_v6 {
+
+#ifdef CHECKSUM_WIDE_WORDS
+/*
+ * The ones' complement sum is independent of the byte order (RFC 1071,
+ * 2.(B)), thus the data is summed up in host order and the folded result
+ * is swapped once at the end.
+ */
+static uint64_t addWords(uint64_t sum, const uint8_t* data, uint16_t length) {
+    while (length >= 8) {
+        uint64_t w;
+        memcpy(&w, data, 8);
+        sum += (w & 0xFFFFFFFF) + (w >> 32);
+        data += 8;
+        length -= 8;
+    }
+    if (length > 0) {
+        uint64_t w = 0;
+        memcpy(&w, data, length);
+        sum += (w & 0xFFFFFFFF) + (w >> 32);
+    }
+    return sum;
+}
+
+#ifdef CHECKSUM_X86_SIMD
+__attribute__((target("sse2")))
+static uint64_t addWordsSse2(uint64_t sum, const uint8_t* data, uint16_t length) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    // each 32 bit lane receives at most 2 * 65535 / 16 words, no overflow
+    while (length >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*) data);
+        acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, zero));
+        acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, zero));
+        data += 16;
+        length -= 16;
+    }
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i*) lanes, acc);
+    sum += (uint64_t) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return addWords(sum, data, length);
+}
+
+__attribute__((target("avx2")))
+static uint64_t addWordsAvx2(uint64_t sum, const uint8_t* data, uint16_t length) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = _mm256_setzero_si256();
+    while (length >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*) data);
+        acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(v, zero));
+        acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(v, zero));
+        data += 32;
+        length -= 32;
+    }
+    uint32_t lanes[8];
+    _mm256_storeu_si256((__m256i*) lanes, acc);
+    for (uint8_t i = 0; i < 8; i++) {
+        sum += lanes[i];
+    }
+    return addWords(sum, data, length);
+}
+
+typedef uint64_t (*addWords_t)(uint64_t, const uint8_t*, uint16_t);
+
+static addWords_t selectAddWords() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return addWordsAvx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return addWordsSse2;
+    }
+    return addWords;
+}
+
+static uint64_t addWordsBest(uint64_t sum, const uint8_t* data, uint16_t length) {
+    // selected once at the first call, the initialization is thread-safe
+    static const addWords_t selected = selectAddWords();
+    return selected(sum, data, length);
+}
+#else
+#define addWordsBest addWords
+#endif
+
+uint32_t checksumAdd(uint32_t sum, const uint8_t* data, uint16_t length) {
+    uint64_t s = addWordsBest(0, data, length);
+    s = (s & 0xFFFFFFFF) + (s >> 32);
+    s = (s & 0xFFFFFFFF) + (s >> 32);
+    uint16_t folded = checksumFold((uint32_t) s);
+    folded = (folded << 8) | (folded >> 8);
+    return checksumFold(sum + folded);
+}
+
+#else
+uint32_t checksumAdd(uint32_t sum, const uint8_t* data, uint16_t length) {
+    sum = checksumFold(sum);
+    while (length > 1) {
+        sum += ((uint16_t) data[0] << 8) | data[1];
+        data += 2;
+        length -= 2;
+    }
+    if (length > 0) {
+        sum += (uint16_t) data[0] << 8;
+    }
+    return checksumFold(sum);
+}
+#endif
+
+}
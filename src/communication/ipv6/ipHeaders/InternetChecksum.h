@@ -0,0 +1,107 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef INTERNETCHECKSUM_H_
+#define INTERNETCHECKSUM_H_
+
+#include <stdint.h>
+#include "IPv6Address.h"
+
+namespace cometos_v6 {
+
+/**
+ * Adds data, interpreted as big-endian 16 bit words, to a ones' complement
+ * sum (RFC 1071). A trailing odd byte is padded with zero. If a sum is
+ * accumulated over several calls, all but the last block have to be of even
+ * length.
+ *
+ * On 64 bit hosts, the data is summed up in words of 64 bit. On x86, SSE2
+ * or AVX2 is used instead if the CPU supports it.
+ *
+ * @param sum    partial sum to continue, at most 0xFFFFFFFF - 0xFFFF
+ * @return       partial sum, folded to at most 0xFFFF
+ */
+uint32_t checksumAdd(uint32_t sum, const uint8_t* data, uint16_t length);
+
+/**
+ * Folds a partial sum into 16 bit without complementing it.
+ */
+inline uint16_t checksumFold(uint32_t sum) {
+    while (sum > 0xFFFF) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return sum;
+}
+
+/**
+ * Partial sum of the source and destination address of the pseudo header.
+ * It can be kept by callers that compute several checksums for the same
+ * pair of addresses.
+ */
+inline uint32_t checksumPseudoHeader(const IPv6Address &src,
+        const IPv6Address &dst) {
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        sum += src.getAddressPart(i);
+        sum += dst.getAddressPart(i);
+    }
+    return sum;
+}
+
+/**
+ * Updates a checksum after a 16 bit word of the covered data was changed
+ * from oldWord to newWord, according to RFC 1624 (equation 3).
+ */
+inline uint16_t checksumAdjust(uint16_t checksum, uint16_t oldWord,
+        uint16_t newWord) {
+    uint32_t sum = (uint16_t) ~checksum;
+    sum += (uint16_t) ~oldWord;
+    sum += newWord;
+    return ~checksumFold(sum);
+}
+
+/**
+ * Updates a checksum after an address of the pseudo header was changed.
+ */
+inline uint16_t checksumAdjust(uint16_t checksum, const IPv6Address &oldAddr,
+        const IPv6Address &newAddr) {
+    uint32_t sum = (uint16_t) ~checksum;
+    for (uint8_t i = 0; i < 8; i++) {
+        sum += (uint16_t) ~oldAddr.getAddressPart(i);
+        sum += newAddr.getAddressPart(i);
+    }
+    return ~checksumFold(sum);
+}
+
+}
+
+#endif /* INTERNETCHECKSUM_H_ */
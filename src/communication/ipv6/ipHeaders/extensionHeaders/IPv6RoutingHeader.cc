@@ -35,6 +35,7 @@
  */
 
 #include "IPv6RoutingHeader.h"
+#include <string.h>
 
 namespace cometos_v6 {
 
@@ -42,6 +43,7 @@ const headerType_t IPv6RoutingHeader::HeaderNumber;
 
 IPv6RoutingHeader::IPv6RoutingHeader() :
     FollowingHeader(IPv6RoutingHeader::HeaderNumber),
+    dataAdded(false),
     length(0),
     routingType(0),
     segmentsLeft(0),
@@ -51,6 +53,7 @@ IPv6RoutingHeader::IPv6RoutingHeader() :
 IPv6RoutingHeader::IPv6RoutingHeader(uint8_t routingType, uint8_t segmentsLeft,
         uint8_t* data, uint8_t length) :
     FollowingHeader(IPv6RoutingHeader::HeaderNumber),
+    dataAdded(false),
     length(length),
     routingType(routingType),
     segmentsLeft(segmentsLeft),
@@ -83,7 +86,9 @@ uint16_t IPv6RoutingHeader::writeHeaderToBuffer(uint8_t* buffer) const {
 uint16_t IPv6RoutingHeader::parse (const uint8_t* buffer, uint16_t length) {
     uint16_t p = 0;
     p++; //uint8_t type = buffer[p++];
-    this->length = buffer[p++] << 3;
+    // the header length does not include the first 8 bytes, of which
+    // 4 belong to the data
+    this->length = (buffer[p++] << 3) + 4;
     routingType = buffer[p++];
     segmentsLeft = buffer[p++];
     this->data = &(buffer[p]);
@@ -91,4 +96,58 @@ uint16_t IPv6RoutingHeader::parse (const uint8_t* buffer, uint16_t length) {
     return p + (this->length);
 }
 
+uint8_t IPv6RoutingHeader::getNumAddresses(const uint8_t* data, uint8_t length) {
+    uint8_t cmprI = data[0] >> 4;
+    uint8_t cmprE = data[0] & 0xF;
+    uint8_t pad = data[1] >> 4;
+    if (length < 4 + pad + (16 - cmprE)) {
+        return 0;
+    }
+    return (length - 4 - pad - (16 - cmprE)) / (16 - cmprI) + 1;
+}
+
+IPv6Address IPv6RoutingHeader::getAddress(const uint8_t* data, uint8_t length,
+        uint8_t i, const IPv6Address& dst) {
+    uint8_t cmprI = data[0] >> 4;
+    uint8_t elided = (i == getNumAddresses(data, length) - 1) ? (data[0] & 0xF) : cmprI;
+    uint8_t address[16];
+    dst.writeAddress(address);
+    memcpy(address + elided, data + 4 + i * (16 - cmprI), 16 - elided);
+    return IPv6Address(address);
+}
+
+bool IPv6RoutingHeader::nextSegment(IPv6Address& dst) {
+    if (routingType != SOURCE_ROUTING_TYPE || segmentsLeft == 0 || length < 4) {
+        return false;
+    }
+    uint8_t n = getNumAddresses(data, length);
+    if (segmentsLeft > n) {
+        return false;
+    }
+
+    if (!dataAdded) {
+        uint8_t* copy = new uint8_t[length];
+        memcpy(copy, data, length);
+        data = copy;
+        dataAdded = true;
+    }
+
+    segmentsLeft--;
+    uint8_t i = n - segmentsLeft - 1;
+    IPv6Address next = getAddress(data, length, i, dst);
+    if (next.isMulticast()) {
+        return false;
+    }
+
+    // store the current destination in place of the next hop
+    uint8_t cmprI = data[0] >> 4;
+    uint8_t elided = (i == n - 1) ? (data[0] & 0xF) : cmprI;
+    uint8_t address[16];
+    dst.writeAddress(address);
+    memcpy(const_cast<uint8_t*>(data) + 4 + i * (16 - cmprI), address + elided, 16 - elided);
+
+    dst = next;
+    return true;
+}
+
 }
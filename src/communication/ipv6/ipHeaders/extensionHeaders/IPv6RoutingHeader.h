@@ -41,6 +41,7 @@
 
 #include <cometos.h>
 #include "FollowingHeader.h"
+#include "IPv6Address.h"
 
 /*TYPES----------------------------------------------------------------------*/
 
@@ -54,6 +55,8 @@ class IPv6RoutingHeader : public FollowingHeader {
 public:
     static const headerType_t HeaderNumber = 43;
     static const uint8_t FIXED_SIZE = 4;
+    /** RPL source routing header (RFC 6554) */
+    static const uint8_t SOURCE_ROUTING_TYPE = 3;
 
     IPv6RoutingHeader ();
     IPv6RoutingHeader (uint8_t routingType, uint8_t segmentsLeft,
@@ -99,6 +102,31 @@ public:
     }
     bool dataAdded;
     uint16_t parse (const uint8_t* buffer, uint16_t length);
+
+    /**
+     * Processes the next segment of a source routing header, i.e.,
+     * decrements segments left and swaps the destination address with
+     * the next address of the header. The data is copied before if it is
+     * not owned by the header (dataAdded).
+     *
+     * @param dst destination address of the datagram, replaced by the
+     *            address of the next hop
+     * @return false if the header is malformed
+     */
+    bool nextSegment(IPv6Address& dst);
+
+    /**
+     * @return number of addresses in the data of a source routing header
+     */
+    static uint8_t getNumAddresses(const uint8_t* data, uint8_t length);
+
+    /**
+     * @return address i of a source routing header, with the elided
+     *         prefix taken from dst
+     */
+    static IPv6Address getAddress(const uint8_t* data, uint8_t length,
+            uint8_t i, const IPv6Address& dst);
+
 protected:
     uint8_t length;
     uint8_t routingType;
@@ -0,0 +1,93 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "FragmentIndex.h"
+#include "cometos.h"
+
+namespace cometos_v6 {
+
+FragmentIndex::FragmentIndex(uint8_t* slots, uint16_t numSlots) :
+        slots(slots),
+        mask(numSlots - 1),
+        occupied(0)
+{
+    ASSERT((numSlots & (numSlots - 1)) == 0);
+    clear();
+}
+
+uint16_t FragmentIndex::numSlots(uint8_t entries) {
+    uint16_t n = 2;
+    while (n < 2 * (uint16_t) entries) {
+        n <<= 1;
+    }
+    return n;
+}
+
+uint16_t FragmentIndex::hash(const Ieee802154MacAddress& srcMAC,
+                             uint16_t tag,
+                             uint16_t size) {
+    // tags are assigned sequentially by each sender, thus they are the
+    // main source of entropy and go to the lower bits
+    uint16_t h = tag;
+    h = (h * 31) ^ srcMAC.a4();
+    h = (h * 31) ^ srcMAC.a3();
+    h = (h * 31) ^ srcMAC.a2();
+    h = (h * 31) ^ srcMAC.a1();
+    h = (h * 31) ^ size;
+    return h ^ (h >> 7);
+}
+
+bool FragmentIndex::insert(uint16_t hash, uint8_t handler) {
+    if ((occupied + 1) * 4 > (uint16_t) (mask + 1) * 3) {
+        return false;
+    }
+    uint16_t slot = first(hash);
+    while (slots[slot] != EMPTY) {
+        if (slots[slot] == handler) {
+            // stale slot of the same handler is reused
+            return true;
+        }
+        slot = next(slot);
+    }
+    slots[slot] = handler;
+    occupied++;
+    return true;
+}
+
+void FragmentIndex::clear() {
+    for (uint16_t i = 0; i <= mask; i++) {
+        slots[i] = EMPTY;
+    }
+    occupied = 0;
+}
+
+} // namespace cometos_v6
@@ -0,0 +1,128 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef FRAGMENTINDEX_H_
+#define FRAGMENTINDEX_H_
+
+#include <stdint.h>
+#include "Ieee802154MacAddress.h"
+
+namespace cometos_v6 {
+
+/**
+ * Number of slots of a FragmentIndex for the given number of handlers,
+ * i.e., the smallest power of two which is at least twice the number of
+ * handlers.
+ */
+template<uint8_t Entries, uint16_t Slots = 2, bool Done = (Slots >= 2 * Entries)>
+struct FragmentIndexSize {
+    static const uint16_t value = FragmentIndexSize<Entries, 2 * Slots>::value;
+};
+
+template<uint8_t Entries, uint16_t Slots>
+struct FragmentIndexSize<Entries, Slots, true> {
+    static const uint16_t value = Slots;
+};
+
+/**
+ * Open-addressed hash index over an array of fragment handlers, keyed by
+ * source MAC address, datagram tag and datagram size. Slots contain the
+ * position of a handler within its array.
+ *
+ * Handlers are freed without notifying the index, thus a slot may refer to
+ * a handler that is free or was reused for another datagram. Users have to
+ * check if the handler of a slot matches the key, which makes stale slots
+ * harmless. They only increase the probe length until the index is
+ * rebuilt, which is signaled by insert() if three quarters of the slots
+ * are occupied.
+ */
+class FragmentIndex {
+public:
+    static const uint8_t EMPTY = 0xFF;
+
+    /**
+     * @param slots       storage for the index
+     * @param numSlots    size of slots, has to be a power of two
+     */
+    FragmentIndex(uint8_t* slots, uint16_t numSlots);
+
+    /**
+     * @return number of slots to use for the given number of handlers
+     */
+    static uint16_t numSlots(uint8_t entries);
+
+    static uint16_t hash(const Ieee802154MacAddress& srcMAC,
+                         uint16_t tag,
+                         uint16_t size);
+
+    /**
+     * @return first slot to probe for the given hash value
+     */
+    uint16_t first(uint16_t hash) const {
+        return hash & mask;
+    }
+
+    uint16_t next(uint16_t slot) const {
+        return (slot + 1) & mask;
+    }
+
+    /**
+     * @return handler referenced by slot or EMPTY, which ends the probing
+     */
+    uint8_t get(uint16_t slot) const {
+        return slots[slot];
+    }
+
+    /**
+     * Adds a handler to the index.
+     *
+     * @return false if the index is too full, nothing is added in this case
+     *         and the index has to be cleared and refilled with all
+     *         handlers in use
+     */
+    bool insert(uint16_t hash, uint8_t handler);
+
+    void clear();
+
+    uint8_t* getSlots() {
+        return slots;
+    }
+
+private:
+    uint8_t* slots;
+    uint16_t mask;
+    uint16_t occupied;
+};
+
+} // namespace cometos_v6
+
+#endif /* FRAGMENTINDEX_H_ */
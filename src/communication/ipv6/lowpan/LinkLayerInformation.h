@@ -163,5 +163,8 @@ private:
 
 }
 
+// attached to every datagram
+OBJECT_CONTAINER_SLOT(cometos_v6::LlRxInfo, 3)
+OBJECT_CONTAINER_SLOT(cometos_v6::LlTxInfo, 4)
 
 #endif /* LINKLAYERINFORMATION_H_ */
@@ -222,8 +222,8 @@ void LowpanAdaptionLayer::createSpecificationImplementation(const LowpanConfig&
                                                BufferSizeVector,
                                                BufferNumElemVector,
 #endif
-                                               srcContexts,
-                                               dstContexts,
+                                               contexts.getPrefixes(),
+                                               contexts.getPrefixes(),
                                                _ipRetransmissionList,
                                                this);
 
@@ -238,8 +238,8 @@ void LowpanAdaptionLayer::createSpecificationImplementation(const LowpanConfig&
                                                   BufferSizeVector,
                                                   BufferNumElemVector,
 #endif
-                                                  srcContexts,
-                                                  dstContexts,
+                                                  contexts.getPrefixes(),
+                                                  contexts.getPrefixes(),
                                                   _ipRetransmissionList,
                                                   this);
     }
@@ -260,7 +260,8 @@ void LowpanAdaptionLayer::createHandlerObjects(const LowpanConfig& cfg) {
              << "|numDatagramHandlers=" << (int) cfg.numDirectDatagramHandlers
              << "|numBufferHandlers=" << (int) cfg.numBufferHandlers
              << "|queueType=" << (int) cfg.queueType
-             << "|enableDirectFwd=" << cfg.enableDirectFwd);
+             << "|enableDirectFwd=" << cfg.enableDirectFwd
+             << "|enableCutThrough=" << cfg.enableCutThrough);
 
     createQueueAndLca(cfg);
     if (cfg.congestionControlType == LowpanConfigConstants::CCT_DG_ORDERED) {
@@ -279,6 +280,7 @@ void LowpanAdaptionLayer::createHandlerObjects(const LowpanConfig& cfg) {
         IpForward * ip = (IpForward *) getModule(IPFWD_MODULE_NAME);
         ASSERT(ip!=NULL);
         db->initialize(ip);
+        db->setCutThrough(cfg.enableCutThrough);
         fragmentHandler = db;
     } else {
         fragmentHandler = fragmentBuffer;
@@ -323,6 +325,7 @@ void LowpanAdaptionLayer::initialize() {
     LAL_VECTOR_INI(BufferNumElemVector);
     LAL_VECTOR_INI(FreeIPRequestsVector);
     LAL_VECTOR_INI(MacFrameDurationVector);
+    LAL_VECTOR_INI(ForwardingDelayVector);
 
     nd = (NeighborDiscovery*) getModule(NEIGHBOR_DISCOVERY_MODULE_NAME);
     ASSERT(nd != NULL);
@@ -357,11 +360,13 @@ void LowpanAdaptionLayer::initialize() {
     CONFIG_NED_OBJ(cfg, pushBackStaleObjects);
     CONFIG_NED_OBJ(cfg, queueSize);
     CONFIG_NED_OBJ(cfg, useRateTimerForQueueSwitch);
+    CONFIG_NED_OBJ(cfg, enableCutThrough);
 
     createHandlerObjects(cfg);
 
     schedule(&timeOutSchedule, &LowpanAdaptionLayer::fragmentTimeout,
             cfg.timeoutMs);
+    schedule(&contextTimer, &LowpanAdaptionLayer::contextTimeout, 60000);
 }
 
 void LowpanAdaptionLayer::finish() {
@@ -370,6 +375,7 @@ void LowpanAdaptionLayer::finish() {
     cancel(&timeOutSchedule);
     cancel(&rateTimer);
     cancel(&_RTOTimer);
+    cancel(&contextTimer);
     deleteHandlerObjects();
 
     LAL_SCALAR_REC("drpdPkt_I", dropped_Invalid);
@@ -395,6 +401,9 @@ void LowpanAdaptionLayer::finish() {
     LAL_SCALAR_REC("objectsPushedBack", objectsPushedBack);
     LAL_SCALAR_REC("timesQueueRecovered", timesQueueRecovered);
     LAL_SCALAR_REC("timesQueueNotRecovered", timesQueueNotRecovered);
+    LAL_SCALAR_REC("fwdFrm", forwardedFrames);
+    LAL_SCALAR_REC("fwdDelay", forwardingDelay);
+    LAL_SCALAR_REC("cutThroughFrm", cutThroughFrames);
 }
 
 void LowpanAdaptionLayer::applyConfig(LowpanConfig & newCfg) {
@@ -434,6 +443,7 @@ LowpanAdaptionLayerStats LowpanAdaptionLayer::getStats() {
 
 void LowpanAdaptionLayer::resetStats() {
     stats.reset();
+    contexts.resetCounters();
 }
 
 void LowpanAdaptionLayer::fragmentTimeout(cometos::Message *msg) {
@@ -486,11 +496,12 @@ uint8_t LowpanAdaptionLayer::checkMesh(cometos::Airframe & frame,
 void LowpanAdaptionLayer::handleMACIndication(LowpanIndication *ind) {
     Ieee802154MacAddress    src = Ieee802154MacAddress(ind->src);
     Ieee802154MacAddress    dst = Ieee802154MacAddress(ind->dst);
-    cometos::AirframePtr      frame = ind->decapsulateAirframe();
+    receivedFrame = ind->decapsulateAirframe();
+    cometos::Airframe&      frame = *receivedFrame;
     cometos::MacRxInfo info;
     uint8_t lowpanDispatch = ind->head;
 
-    uint8_t* data = frame->getData();
+    uint8_t* data = frame.getData();
     if (data[12] == 0xa1 && data[13] == 0x81) {
        LOG_ERROR("RECV tok81A1");
     }
@@ -504,10 +515,11 @@ void LowpanAdaptionLayer::handleMACIndication(LowpanIndication *ind) {
 
     if (isMeshHeader(lowpanDispatch)) {
         Ieee802154MacAddress ourAddress = dst;
-        lowpanDispatch = checkMesh(*frame, lowpanDispatch, src, dst);
+        lowpanDispatch = checkMesh(frame, lowpanDispatch, src, dst);
         bool isPacketAddressedToUs = (ourAddress == dst);
         if (!isPacketAddressedToUs) {
             delete(ind);
+            receivedFrame.delete_object();
             return;  // A sublayer should work with the mesh routing.
         }
     }
@@ -517,7 +529,7 @@ void LowpanAdaptionLayer::handleMACIndication(LowpanIndication *ind) {
         ASSERT(false);
     }
 
-    lowpanVariant->parseframe(*frame, lowpanDispatch, src, dst, &dgInfo);
+    lowpanVariant->parseframe(frame, lowpanDispatch, src, dst, &dgInfo);
 
     if(dgInfo.isValid()){
         saveIPContextandSendtoIpLayer(dgInfo, src, dst);
@@ -527,7 +539,18 @@ void LowpanAdaptionLayer::handleMACIndication(LowpanIndication *ind) {
     }
 
     delete ind;
-    frame.delete_object();
+    // frame might have been taken over by a cut-through QueueFrame
+    if (receivedFrame) {
+        receivedFrame.delete_object();
+    }
+}
+
+bool LowpanAdaptionLayer::takeReceivedFrame(cometos::Airframe& frame, cometos::AirframePtr& owner) {
+    if (!receivedFrame || receivedFrame.get() != &frame) {
+        return false;
+    }
+    owner = std::move(receivedFrame);
+    return true;
 }
 
 
@@ -803,6 +826,21 @@ void LowpanAdaptionLayer::receiveMACResponse(cometos::DataResponse *resp) {
         }
     }
 
+    // per-hop forwarding delay, from reception to successful transmission
+    if (resp->isSuccess() && queue->getQueueSize() > 0) {
+        const QueueObject* lastsent = queue->getObjectToRespondTo();
+        time_ms_t tsRcvd;
+        if (!isnull(lastsent) && lastsent->getRxTimestamp(tsRcvd)) {
+            time_ms_t delay = palLocalTime_get() - tsRcvd;
+            LAL_SCALAR_INC(forwardedFrames);
+            LAL_SCALAR_ADD(forwardingDelay, delay);
+            if (lastsent->isCutThrough()) {
+                LAL_SCALAR_INC(cutThroughFrames);
+            }
+            LAL_VECTOR_REC(ForwardingDelayVector, delay);
+        }
+    }
+
     switch (queue->response(resp)) {
     case LOWPANQUEUE_PACKET_FINISHED:
         LAL_SCALAR_INC(sentPackets);
@@ -953,6 +991,11 @@ void LowpanAdaptionLayer::RTOTimeout(cometos::Message *msg) {
     schedule(&_RTOTimer, &LowpanAdaptionLayer::RTOTimeout, RTO_GRANULARITY);
 }
 
+void LowpanAdaptionLayer::contextTimeout(cometos::Message *msg) {
+    contexts.tick();
+    schedule(&contextTimer, &LowpanAdaptionLayer::contextTimeout, 60000);
+}
+
 void LowpanAdaptionLayer::saveIPContextandSendtoIpLayer(
         IPv6DatagramInformation & dgInfo,
         Ieee802154MacAddress& src, Ieee802154MacAddress& dst) {
@@ -1029,8 +1072,14 @@ void serialize(ByteVector & buf, const cometos_v6::LowpanAdaptionLayerStats & va
     serialize(buf, val.objectsPushedBack);
     serialize(buf, val.timesQueueRecovered);
     serialize(buf, val.timesQueueNotRecovered);
+    serialize(buf, val.forwardedFrames);
+    serialize(buf, val.forwardingDelay);
+    serialize(buf, val.cutThroughFrames);
 }
 void unserialize(ByteVector & buf, cometos_v6::LowpanAdaptionLayerStats & val) {
+    unserialize(buf, val.cutThroughFrames);
+    unserialize(buf, val.forwardingDelay);
+    unserialize(buf, val.forwardedFrames);
     unserialize(buf, val.timesQueueNotRecovered);
     unserialize(buf, val.timesQueueRecovered);
     unserialize(buf, val.objectsPushedBack);
@@ -56,6 +56,7 @@
 #include "ParameterStore.h"
 #include "RemotelyConfigurableModule.h"
 #include "LocalCongestionAvoider.h"
+#include "LowpanContextTable.h"
 
 
 /*TYPES----------------------------------------------------------------------*/
@@ -178,6 +179,30 @@ public:
 
     void RTOTimeout(cometos::Message *msg);
 
+    /**
+     * Ages the header compression contexts once a minute.
+     */
+    void contextTimeout(cometos::Message *msg);
+
+    /**
+     * Contexts for stateful header compression, which are distributed by
+     * the routing protocol.
+     */
+    LowpanContextTable& getContextTable() {
+        return contexts;
+    }
+
+    /**
+     * Hands over ownership of the frame currently being processed by
+     * handleMACIndication, so it can be forwarded without copying.
+     *
+     * @param frame     frame passed down to the fragment handler
+     * @param owner     takes the frame on success; has to be empty
+     * @return          false if frame is not the received one or was
+     *                  already taken
+     */
+    bool takeReceivedFrame(cometos::Airframe& frame, cometos::AirframePtr& owner);
+
     void sendIfAllowed();
 
     bool isSuccessorOfActiveDg(const QueueObject& obj);
@@ -246,6 +271,7 @@ private:
     cometos::Message timeOutSchedule;
     cometos::Message rateTimer;
     cometos::Message _RTOTimer;
+    cometos::Message contextTimer;
 
 
     uint16_t    fragmentTagOwn;
@@ -262,8 +288,7 @@ private:
     /** Buffer to reassemble datagrams destined to us or in Assembly Mode*/
     AssemblyBufferBase* fragmentBuffer;
 
-    IPv6Context srcContexts[16];
-    IPv6Context dstContexts[16];
+    LowpanContextTable contexts;
 
     LocalCongestionAvoider* lca;
 
@@ -288,10 +313,12 @@ private:
     LAL_VECTOR(BufferNumElemVector);
     LAL_VECTOR(FreeIPRequestsVector);
     LAL_VECTOR(MacFrameDurationVector);
+    LAL_VECTOR(ForwardingDelayVector);
 
     LowpanConfig cfg;
     LowpanAdaptionLayerStats stats;
     time_ms_t tsSend;
+    cometos::AirframePtr receivedFrame;
     LowpanVariant* lowpanVariant;
 
     NeighborDiscovery* nd;
@@ -67,7 +67,8 @@ bool LowpanConfig::operator==(const LowpanConfig & rhs) {
         && this->queueSwitchAfter == rhs.queueSwitchAfter
         && this->pushBackStaleObjects == rhs.pushBackStaleObjects
         && this->queueSize == rhs.queueSize
-        && this->useRateTimerForQueueSwitch == rhs.useRateTimerForQueueSwitch;
+        && this->useRateTimerForQueueSwitch == rhs.useRateTimerForQueueSwitch
+        && this->enableCutThrough == rhs.enableCutThrough;
 }
 
 bool LowpanConfig::isValid() {
@@ -104,9 +105,11 @@ void LowpanConfig::doSerialize(cometos::ByteVector& buf) const {
     serialize(buf, this->pushBackStaleObjects);
     serialize(buf, this->queueSize);
     serialize(buf, this->useRateTimerForQueueSwitch);
+    serialize(buf, this->enableCutThrough);
 }
 
 void LowpanConfig::doUnserialize(cometos::ByteVector& buf) {
+    unserialize(buf, this->enableCutThrough);
     unserialize(buf, this->useRateTimerForQueueSwitch);
     unserialize(buf, this->queueSize);
     unserialize(buf, this->pushBackStaleObjects);
@@ -131,7 +131,8 @@ struct LowpanConfig : public cometos::PersistableConfig {
                  uint16_t timeoutMs = DEFAULT_LOWPAN_TIMEOUT,
                  uint8_t queueSwitchAfter = LowpanConfigConstants::DEFAULT_QUEUE_SWITCH_AFTER,
                  bool pushBackStaleObjects = false,
-                 bool useRateTimerForQueueSwitch = false) :
+                 bool useRateTimerForQueueSwitch = false,
+                 bool enableCutThrough = false) :
         macRetryControlMode(mcm),
         delayMode(dm),
         queueType(queueType),
@@ -149,7 +150,8 @@ struct LowpanConfig : public cometos::PersistableConfig {
         queueSwitchAfter(queueSwitchAfter),
         pushBackStaleObjects(pushBackStaleObjects),
         queueSize(queueSize),
-        useRateTimerForQueueSwitch(useRateTimerForQueueSwitch)
+        useRateTimerForQueueSwitch(useRateTimerForQueueSwitch),
+        enableCutThrough(enableCutThrough)
     {}
 
     virtual void doSerialize(cometos::ByteVector& buf) const;
@@ -176,6 +178,7 @@ struct LowpanConfig : public cometos::PersistableConfig {
     bool pushBackStaleObjects;
     uint8_t queueSize;
     bool useRateTimerForQueueSwitch;
+    bool enableCutThrough;
 
     bool operator==(const LowpanConfig & rhs);
 };
@@ -211,7 +214,10 @@ struct LowpanAdaptionLayerStats {
         LAL_SCALAR_INI(timesQueueEmpty, 0),
         LAL_SCALAR_INI(objectsPushedBack, 0),
         LAL_SCALAR_INI(timesQueueRecovered, 0),
-        LAL_SCALAR_INI(timesQueueNotRecovered, 0)
+        LAL_SCALAR_INI(timesQueueNotRecovered, 0),
+        LAL_SCALAR_INI(forwardedFrames, 0),
+        LAL_SCALAR_INI(forwardingDelay, 0),
+        LAL_SCALAR_INI(cutThroughFrames, 0)
     {}
 
     void reset() {
@@ -238,6 +244,9 @@ struct LowpanAdaptionLayerStats {
         objectsPushedBack = 0;
         timesQueueRecovered = 0;
         timesQueueNotRecovered = 0;
+        forwardedFrames = 0;
+        forwardingDelay = 0;
+        cutThroughFrames = 0;
     }
 
     LAL_SCALAR(dropped_Invalid);
@@ -263,6 +272,9 @@ struct LowpanAdaptionLayerStats {
     LAL_SCALAR(objectsPushedBack);
     LAL_SCALAR(timesQueueRecovered);
     LAL_SCALAR(timesQueueNotRecovered);
+    LAL_SCALAR(forwardedFrames);
+    LAL_SCALAR(forwardingDelay); ///< sum of per-hop delays in ms
+    LAL_SCALAR(cutThroughFrames);
 };
 
 uint32_t avgDurationMs(const LowpanAdaptionLayerStats& lals);
@@ -39,11 +39,22 @@
 
 namespace cometos_v6 {
 
+void BufferInformation::free() {
+    ASSERT(used);
+    if (owner != NULL) {
+        owner->release(*this);
+        owner->recycle(*this);
+    }
+    used = false;
+}
+
 uint16_t BufferInformation::freeEnd(uint16_t EndSpace) {
     ASSERT(used);
     if (size <= EndSpace) {
+        if (owner != NULL) owner->release(*this);
         size = 0;
     } else {
+        if (owner != NULL) owner->shrinkEnd(*this, EndSpace);
         size -= EndSpace;
     }
     return size;
@@ -52,8 +63,10 @@ uint16_t BufferInformation::freeEnd(uint16_t EndSpace) {
 uint16_t BufferInformation::freeBegin(uint16_t BeginSpace) {
     ASSERT(used);
     if (size <= BeginSpace) {
+        if (owner != NULL) owner->release(*this);
         size = 0;
     } else {
+        if (owner != NULL) owner->shrinkBegin(*this, BeginSpace);
         startPos += BeginSpace;
         size -= BeginSpace;
     }
@@ -72,6 +85,13 @@ void BufferInformation::copyToBuffer(const uint8_t* data, uint16_t bSize, uint16
 uint8_t BufferInformation::streamOut() {
     ASSERT(used && (size > 0));
     uint8_t ret = (*startPos);
+    if (owner != NULL) {
+        if (size == 1) {
+            owner->release(*this);
+        } else {
+            owner->shrinkBegin(*this, 1);
+        }
+    }
     startPos++;
     size--;
     return ret;
@@ -107,51 +127,78 @@ void BufferInformation::populateFrame(cometos::Airframe& frame,
 }
 
 //// ManagedBuffer ////////////////////////////////////////////////////////////
-ManagedBuffer::ManagedBuffer()
+/*
+ * All buffers with a size greater than zero are nodes of a treap that is
+ * ordered by address. Every node stores the free space up to the next
+ * buffer (gap) and the largest gap of its subtree (maxGap), which allows to
+ * find the lowest address with enough free space, the buffer containing a
+ * pointer and the neighbours of a buffer in O(log n). Unused handlers are
+ * kept in a singly linked list.
+ */
+ManagedBuffer::ManagedBuffer() :
+        root(NONE),
+        freeHandlers(NONE),
+        seed(0)
 {}
 
 
 BufferInformation* ManagedBuffer::getBuffer(uint16_t size, MbRequestStatus& result) {
     uint8_t* buffer = getBufArray();
-    uint8_t* start = buffer;
-    uint8_t mEntries = getNumHandlers();
-    uint16_t bSize = getBufferSize();
     BufferInformation* handlers = getHandlers();
     result = SUCCESS;
-    uint16_t freeSize = bSize;
-    for (int16_t j = 0; (j < mEntries) && (freeSize >= size); j++) {
-        if ((handlers[j].used) && (handlers[j].size > 0) && (handlers[j].startPos >= start)) {
-            uint16_t tmpFreeSize = handlers[j].startPos - start;
-            if (freeSize > tmpFreeSize) {
-                freeSize = tmpFreeSize;
-                if (freeSize < size) {
-                    start = handlers[j].startPos + handlers[j].size;
-                    ASSERT(start > buffer);
-                    freeSize = bSize - (start - buffer);
-                    j = -1;
-                }
-            }
+
+    // use the space in front of the first buffer if possible, otherwise the
+    // gap behind the buffer with the lowest address that is large enough
+    uint8_t* start = buffer;
+    uint16_t freeSize = headSpace(handlers);
+    uint8_t prev = NONE;
+    if (freeSize < size) {
+        prev = firstFit(handlers, size);
+        if (prev == NONE) {
+            result = FAIL_MEMORY;
+#ifdef LOWPANBUFFER_ENABLESTATS
+            failMemory++;
+#endif
+            return NULL;
         }
+        start = handlers[prev].startPos + handlers[prev].size;
+        freeSize = handlers[prev].gap;
     }
 
-    if (freeSize >= size) {
-        for (uint8_t i = 0; i < mEntries; i++) {
-            if (!handlers[i].used) {
-                handlers[i].used = true;
-                handlers[i].size = size;
-                handlers[i].startPos  = start;
-                ASSERT(start >= buffer);
-                ASSERT(size <= bSize);
-                ASSERT(freeSize >= size);
-                ASSERT((uint16_t)(start - buffer + size) <= bSize);
-                return &(handlers[i]);
-            }
-        }
+    if (freeHandlers == NONE) {
         result = FAIL_HANDLERS;
-    } else {
-        result = FAIL_MEMORY;
+#ifdef LOWPANBUFFER_ENABLESTATS
+        failHandlers++;
+#endif
+        return NULL;
     }
-    return NULL;
+    uint8_t i = freeHandlers;
+    freeHandlers = handlers[i].right;
+
+    handlers[i].used = true;
+    handlers[i].size = size;
+    handlers[i].startPos  = start;
+    ASSERT(start >= buffer);
+    ASSERT(size <= getBufferSize());
+    ASSERT(freeSize >= size);
+    ASSERT((uint16_t)(start - buffer + size) <= getBufferSize());
+
+    if (size > 0) {
+        if (prev != NONE) {
+            setGap(handlers, root, prev, 0);
+        }
+        handlers[i].gap = freeSize - size;
+        link(handlers, i);
+    }
+
+#ifdef LOWPANBUFFER_ENABLESTATS
+    usedSize += size;
+    if (usedSize > peakUsedSize) {
+        peakUsedSize = usedSize;
+    }
+    numBuffers++;
+#endif
+    return &(handlers[i]);
 }
 
 BufferInformation* ManagedBuffer::getBuffer(uint16_t size) {
@@ -163,13 +210,9 @@ BufferInformation* ManagedBuffer::getBuffer(uint16_t size) {
 
 BufferInformation* ManagedBuffer::getCorrespondingBuffer(const uint8_t* pointer) {
     BufferInformation* handlers = getHandlers();
-    uint8_t mEntries = getNumHandlers();
-    for (uint8_t i = 0; i < mEntries; i++) {
-        if (handlers[i].used &&
-                (handlers[i].startPos <= pointer) &&
-                (&(handlers[i].startPos[handlers[i].size]) > pointer)) {
-            return &(handlers[i]);
-        }
+    uint8_t i = predecessor(handlers, pointer + 1);
+    if (i != NONE && &(handlers[i].startPos[handlers[i].size]) > pointer) {
+        return &(handlers[i]);
     }
     return NULL;
 }
@@ -180,36 +223,222 @@ void ManagedBuffer::clearAll() {
     uint8_t mEntries = getNumHandlers();
     for (uint8_t i = 0; i < mEntries; i++) {
         handlers[i].used = false;
+        handlers[i].linked = false;
+        handlers[i].owner = this;
+        handlers[i].right = (i + 1 < mEntries) ? i + 1 : NONE;
     }
+    root = NONE;
+    freeHandlers = (mEntries > 0) ? 0 : NONE;
+#ifdef LOWPANBUFFER_ENABLESTATS
+    usedSize = 0;
+    peakUsedSize = 0;
+    numBuffers = 0;
+    failMemory = 0;
+    failHandlers = 0;
+#endif
 }
 
-#ifdef LOWPAN_ENABLE_BUFFERSTATS
-/**
- * getUsedBufferSize()
- * returns the size of allocated buffer space. (for statistics)
- */
-uint16_t ManagedBuffer::getUsedBufferSize() const {
+void ManagedBuffer::release(BufferInformation& buf) {
+    if (buf.linked) {
+        unlink(getHandlers(), &buf - getHandlers());
+    }
+#ifdef LOWPANBUFFER_ENABLESTATS
+    usedSize -= buf.size;
+#endif
+}
+
+void ManagedBuffer::recycle(BufferInformation& buf) {
     BufferInformation* handlers = getHandlers();
-    uint16_t ret = 0;
-    for (uint8_t i = 0; i < mEntries; i++) {
-        if (handlers[i].used) {
-            ret += handlers[i].size;
+    buf.right = freeHandlers;
+    freeHandlers = &buf - handlers;
+#ifdef LOWPANBUFFER_ENABLESTATS
+    numBuffers--;
+#endif
+}
+
+void ManagedBuffer::shrinkBegin(BufferInformation& buf, bufSize_t space) {
+    BufferInformation* handlers = getHandlers();
+    if (buf.linked) {
+        uint8_t prev = predecessor(handlers, buf.startPos);
+        if (prev != NONE) {
+            setGap(handlers, root, prev, handlers[prev].gap + space);
         }
     }
-    return ret;
+#ifdef LOWPANBUFFER_ENABLESTATS
+    usedSize -= space;
+#endif
 }
 
-
-uint8_t ManagedBuffer::getNumBuffers() const {
+void ManagedBuffer::shrinkEnd(BufferInformation& buf, bufSize_t space) {
     BufferInformation* handlers = getHandlers();
-    uint16_t ret = 0;
-    for (uint8_t i = 0; i < mEntries; i++) {
-        if (handlers[i].used) {
-            ret++;
+    if (buf.linked) {
+        setGap(handlers, root, &buf - handlers, buf.gap + space);
+    }
+#ifdef LOWPANBUFFER_ENABLESTATS
+    usedSize -= space;
+#endif
+}
+
+void ManagedBuffer::link(BufferInformation* h, uint8_t i) {
+    // linear congruential generator with full period
+    seed = seed * 109 + 89;
+    h[i].prio = seed;
+    h[i].left = NONE;
+    h[i].right = NONE;
+    h[i].linked = true;
+    pull(h, i);
+
+    uint8_t l;
+    uint8_t r;
+    split(h, root, h[i].startPos, l, r);
+    root = merge(h, merge(h, l, i), r);
+}
+
+void ManagedBuffer::unlink(BufferInformation* h, uint8_t i) {
+    // the space is added to the gap of the previous buffer
+    uint8_t prev = predecessor(h, h[i].startPos);
+    uint16_t space = h[i].size + h[i].gap;
+
+    uint8_t l;
+    uint8_t m;
+    uint8_t r;
+    split(h, root, h[i].startPos, l, r);
+    split(h, r, h[i].startPos + 1, m, r);
+    ASSERT(m == i);
+    root = merge(h, l, r);
+    h[i].linked = false;
+
+    if (prev != NONE) {
+        setGap(h, root, prev, h[prev].gap + space);
+    }
+}
+
+void ManagedBuffer::setGap(BufferInformation* h, uint8_t t, uint8_t i, bufSize_t gap) {
+    ASSERT(t != NONE);
+    if (h[i].startPos < h[t].startPos) {
+        setGap(h, h[t].left, i, gap);
+    } else if (h[t].startPos < h[i].startPos) {
+        setGap(h, h[t].right, i, gap);
+    } else {
+        h[t].gap = gap;
+    }
+    pull(h, t);
+}
+
+void ManagedBuffer::split(BufferInformation* h, uint8_t t, const uint8_t* key,
+        uint8_t& l, uint8_t& r) {
+    if (t == NONE) {
+        l = NONE;
+        r = NONE;
+        return;
+    }
+    if (h[t].startPos < key) {
+        split(h, h[t].right, key, h[t].right, r);
+        l = t;
+    } else {
+        split(h, h[t].left, key, l, h[t].left);
+        r = t;
+    }
+    pull(h, t);
+}
+
+uint8_t ManagedBuffer::merge(BufferInformation* h, uint8_t a, uint8_t b) {
+    if (a == NONE) {
+        return b;
+    }
+    if (b == NONE) {
+        return a;
+    }
+    if (h[a].prio > h[b].prio) {
+        h[a].right = merge(h, h[a].right, b);
+        pull(h, a);
+        return a;
+    } else {
+        h[b].left = merge(h, a, h[b].left);
+        pull(h, b);
+        return b;
+    }
+}
+
+uint8_t ManagedBuffer::predecessor(BufferInformation* h, const uint8_t* key) const {
+    uint8_t best = NONE;
+    uint8_t t = root;
+    while (t != NONE) {
+        if (h[t].startPos < key) {
+            best = t;
+            t = h[t].right;
+        } else {
+            t = h[t].left;
+        }
+    }
+    return best;
+}
+
+uint8_t ManagedBuffer::firstFit(BufferInformation* h, bufSize_t size) const {
+    uint8_t t = root;
+    while (t != NONE) {
+        if (h[t].left != NONE && h[h[t].left].maxGap >= size) {
+            t = h[t].left;
+        } else if (h[t].gap >= size) {
+            return t;
+        } else {
+            t = h[t].right;
         }
     }
+    return NONE;
+}
+
+ManagedBuffer::bufSize_t ManagedBuffer::headSpace(BufferInformation* h) {
+    uint8_t t = root;
+    if (t == NONE) {
+        return getBufferSize();
+    }
+    while (h[t].left != NONE) {
+        t = h[t].left;
+    }
+    return h[t].startPos - getBufArray();
+}
+
+void ManagedBuffer::pull(BufferInformation* h, uint8_t i) {
+    uint16_t m = h[i].gap;
+    if (h[i].left != NONE && h[h[i].left].maxGap > m) {
+        m = h[h[i].left].maxGap;
+    }
+    if (h[i].right != NONE && h[h[i].right].maxGap > m) {
+        m = h[h[i].right].maxGap;
+    }
+    h[i].maxGap = m;
+}
+
+#ifdef LOWPANBUFFER_ENABLESTATS
+uint16_t ManagedBuffer::getUsedBufferSize() const {
+    return usedSize;
+}
+
+uint8_t ManagedBuffer::getNumBuffers() const {
+    return numBuffers;
+}
+
+uint16_t ManagedBuffer::getPeakUsedBufferSize() const {
+    return peakUsedSize;
+}
+
+uint16_t ManagedBuffer::getLargestFreeExtent() {
+    uint16_t ret = headSpace(getHandlers());
+    if (root != NONE && getHandlers()[root].maxGap > ret) {
+        ret = getHandlers()[root].maxGap;
+    }
     return ret;
 }
+
+uint16_t ManagedBuffer::getNumFailures(MbRequestStatus reason) const {
+    if (reason == FAIL_MEMORY) {
+        return failMemory;
+    } else if (reason == FAIL_HANDLERS) {
+        return failHandlers;
+    }
+    return 0;
+}
 #endif
 
 
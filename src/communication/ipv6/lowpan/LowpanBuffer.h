@@ -49,9 +49,14 @@
 #endif
 #endif
 
+#if defined LOWPAN_ENABLE_BUFFERSTATS && !defined LOWPANBUFFER_ENABLESTATS
+#define LOWPANBUFFER_ENABLESTATS
+#endif
+
 namespace cometos_v6 {
 
 class BufferInformation;
+class ManagedBuffer;
 
 class bufferPart {
 public:
@@ -68,7 +73,14 @@ public:
     BufferInformation():
         startPos(0),
         size(0),
-        used(false) {}
+        used(false),
+        owner(NULL),
+        left(0xFF),
+        right(0xFF),
+        prio(0),
+        linked(false),
+        gap(0),
+        maxGap(0) {}
 
     virtual ~BufferInformation() {}
 
@@ -76,10 +88,7 @@ public:
         return used;
     }
 
-    virtual void free() {
-        ASSERT(used);
-        used = false;
-    }
+    virtual void free();
 
     virtual uint16_t freeEnd(uint16_t EndSpace);
     virtual uint16_t freeBegin(uint16_t BeginSpace);
@@ -156,6 +165,16 @@ private:
     uint8_t*    startPos;   ///< Pointer to the beginning of the Buffer
     uint16_t    size;       ///< Size of the Buffer
     bool        used;       ///< Used flag
+
+    // Node of the address-ordered index (a treap) of the owning
+    // ManagedBuffer. Only buffers with a size greater than zero are linked.
+    ManagedBuffer* owner;
+    uint8_t     left;       ///< lower addresses
+    uint8_t     right;      ///< higher addresses, next free handler if unused
+    uint8_t     prio;       ///< heap priority of the treap
+    bool        linked;     ///< part of the index
+    uint16_t    gap;        ///< free space between this and the next buffer
+    uint16_t    maxGap;     ///< largest gap within the subtree
 };
 
 class ManagedBuffer {
@@ -175,6 +194,11 @@ public:
     ManagedBuffer();
     virtual ~ManagedBuffer() {}
 
+    /**
+     * getBuffer
+     * Allocates size bytes at the lowest address with enough free space.
+     * Takes O(log n) for n allocated buffers.
+     */
     BufferInformation* getBuffer(bufSize_t size, MbRequestStatus& result);
     BufferInformation* getBuffer(bufSize_t size);
 
@@ -182,7 +206,7 @@ public:
     /**
      * getCorrespondingBuffer
      * Checks if the pointer points to a space in the buffer and returns the
-     * corresponding BufferInformation object.
+     * corresponding BufferInformation object. Takes O(log n).
      * @param pointer   Pointer to check
      */
     BufferInformation* getCorrespondingBuffer(const uint8_t* pointer);
@@ -205,13 +229,69 @@ public:
      * returns the number of allocated buffers. (for statistics)
      */
     uint8_t getNumBuffers() const;
+
+    /**
+     * getPeakUsedBufferSize()
+     * returns the maximum of allocated buffer space since the last call of
+     * clearAll(). (for statistics)
+     */
+    bufSize_t getPeakUsedBufferSize() const;
+
+    /**
+     * getLargestFreeExtent()
+     * returns the largest request that currently succeeds. Compared to the
+     * free buffer space, this indicates the fragmentation. (for statistics)
+     */
+    bufSize_t getLargestFreeExtent();
+
+    /**
+     * getNumFailures()
+     * returns the number of requests that failed with the given reason.
+     * (for statistics)
+     */
+    uint16_t getNumFailures(MbRequestStatus reason) const;
 #endif
 
 private:
+    friend class BufferInformation;
+
+    static const uint8_t NONE = 0xFF;
+
     virtual uint8_t* getBufArray() = 0;
     virtual BufferInformation* getHandlers() = 0;
     virtual bufSize_t getBufferSize() const = 0;
     virtual uint8_t getNumHandlers() const = 0;
+
+    // called by BufferInformation before its space shrinks
+    void release(BufferInformation& buf);
+    void recycle(BufferInformation& buf);
+    void shrinkBegin(BufferInformation& buf, bufSize_t space);
+    void shrinkEnd(BufferInformation& buf, bufSize_t space);
+
+    // treap over the allocated space, ordered by address
+    void link(BufferInformation* h, uint8_t i);
+    void unlink(BufferInformation* h, uint8_t i);
+    void setGap(BufferInformation* h, uint8_t t, uint8_t i, bufSize_t gap);
+    void split(BufferInformation* h, uint8_t t, const uint8_t* key,
+            uint8_t& l, uint8_t& r);
+    uint8_t merge(BufferInformation* h, uint8_t a, uint8_t b);
+    uint8_t predecessor(BufferInformation* h, const uint8_t* key) const;
+    uint8_t firstFit(BufferInformation* h, bufSize_t size) const;
+    bufSize_t headSpace(BufferInformation* h);
+
+    static void pull(BufferInformation* h, uint8_t i);
+
+    uint8_t root;           ///< root of the treap
+    uint8_t freeHandlers;   ///< list of unused handlers
+    uint8_t seed;           ///< generates treap priorities
+
+#ifdef LOWPANBUFFER_ENABLESTATS
+    bufSize_t usedSize;
+    bufSize_t peakUsedSize;
+    uint8_t numBuffers;
+    uint16_t failMemory;
+    uint16_t failHandlers;
+#endif
 };
 
 
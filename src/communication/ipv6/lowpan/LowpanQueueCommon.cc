@@ -48,7 +48,7 @@ cometos::DataRequest* LowpanQueueCommon::getLowpanQueueFrame(
         LowpanFragMetadata& fragMeta,
         const IPv6Datagram* & dg)
 {
-    cometos::AirframePtr frame = cometos::make_checked<cometos::Airframe>();
+    cometos::AirframePtr frame = qo->getFrame();
 
     qo->createFrame(*frame, maxSize, fragMeta, dg);
     if(frame->getLength() == 0) return NULL; // for LFFRPacket
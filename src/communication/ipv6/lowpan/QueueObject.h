@@ -158,6 +158,31 @@ public:
         return true;
     }
 
+    /**
+     * Returns the frame to be filled by createFrame. Objects forwarding a
+     * received frame in place hand it over here, all others get a new one.
+     */
+    virtual cometos::AirframePtr getFrame() {
+        return cometos::make_checked<cometos::Airframe>();
+    }
+
+    /**
+     * Retrieves the local time at which the forwarded fragment of this
+     * object was received.
+     *
+     * @return false if the object does not forward a received fragment
+     */
+    virtual bool getRxTimestamp(time_ms_t & timestamp) const {
+        return false;
+    }
+
+    /**
+     * @return true if the received frame is forwarded without copying
+     */
+    virtual bool isCutThrough() const {
+        return false;
+    }
+
 protected:
     static void addFragmentHeader(cometos::Airframe& frame, uint16_nbo& tag, uint16_t size, uint8_t offset, bool congestionStatus) {
         // TODO byte order
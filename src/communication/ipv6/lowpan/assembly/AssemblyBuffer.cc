@@ -42,10 +42,13 @@ namespace cometos_v6 {
 
 AssemblyBufferBase::AssemblyBufferBase(DatagramReassembly* handlers,
                        uint8_t numHandlers,
-                       ManagedBuffer* lowpanBuf) :
+                       ManagedBuffer* lowpanBuf,
+                       uint8_t* indexSlots,
+                       uint16_t numIndexSlots) :
                            handlers(handlers),
                            mEntries(numHandlers),
-                           lBuffer(lowpanBuf)
+                           lBuffer(lowpanBuf),
+                           index(indexSlots, numIndexSlots)
 {}
 
 AssemblyBufferBase::~AssemblyBufferBase() {
@@ -197,8 +200,11 @@ DatagramReassembly* AssemblyBufferBase::findCorrespondingId(
         const Ieee802154MacAddress& srcMAC,
         uint16_t tag,
         uint16_t size) {
-    for (uint8_t id = 0; id < mEntries; id++) {
-        if ((handlers[id].getStatus() != ASSEMBLYBUFFER_STATUS_FREE) &&
+    uint16_t slot = index.first(FragmentIndex::hash(srcMAC, tag, size));
+    for (; index.get(slot) != FragmentIndex::EMPTY; slot = index.next(slot)) {
+        uint8_t id = index.get(slot);
+        if ((id < mEntries) &&
+                (handlers[id].getStatus() != ASSEMBLYBUFFER_STATUS_FREE) &&
                 handlers[id].belongsToDatagram(srcMAC, tag, size))
         {
             return &(handlers[id]);
@@ -207,6 +213,24 @@ DatagramReassembly* AssemblyBufferBase::findCorrespondingId(
     return NULL;
 }
 
+void AssemblyBufferBase::addToIndex(uint8_t id) {
+    if (index.insert(FragmentIndex::hash(handlers[id].getMACAddr(),
+                                         handlers[id].getTag(),
+                                         handlers[id].getSize()), id)) {
+        return;
+    }
+
+    // too many stale slots, rebuild from the handlers in use
+    index.clear();
+    for (uint8_t i = 0; i < mEntries; i++) {
+        if (handlers[i].getStatus() != ASSEMBLYBUFFER_STATUS_FREE) {
+            index.insert(FragmentIndex::hash(handlers[i].getMACAddr(),
+                                             handlers[i].getTag(),
+                                             handlers[i].getSize()), i);
+        }
+    }
+}
+
 DatagramReassembly* AssemblyBufferBase::getBuffer(
         const Ieee802154MacAddress& srcMAC,
         uint16_t tag,
@@ -226,6 +250,7 @@ DatagramReassembly* AssemblyBufferBase::getBuffer(
         LOG_DEBUG("Acquired buffer of size " << reqBufSize);
         if (NULL != buffer) {
             handlers[id].initialize(srcMAC, buffer, tag, dgSize);
+            addToIndex(id);
             return &(handlers[id]);
         }
 
@@ -242,7 +267,9 @@ DatagramReassembly* AssemblyBufferBase::getBuffer(
 
 
 DynAssemblyBuffer::DynAssemblyBuffer(ManagedBuffer* buffer, uint8_t MEntries) :
-        AssemblyBufferBase(new DatagramReassembly[MEntries], MEntries, buffer)
+        AssemblyBufferBase(new DatagramReassembly[MEntries], MEntries, buffer,
+                new uint8_t[FragmentIndex::numSlots(MEntries)],
+                FragmentIndex::numSlots(MEntries))
 {
 }
 
@@ -250,6 +277,7 @@ DynAssemblyBuffer::~DynAssemblyBuffer() {
     DatagramReassembly*& pHandlers = this->getHandlers();
     delete[] pHandlers;
     pHandlers = NULL;
+    delete[] this->getIndex().getSlots();
 }
 
 
@@ -45,14 +45,21 @@
 #include "IPHCDecompressor.h"
 #include "FragmentHandler.h"
 #include "RoutingBase.h"
+#include "FragmentIndex.h"
 
 namespace cometos_v6 {
 
 class AssemblyBufferBase : public FragmentHandler{
 public:
+    /**
+     * @param indexSlots    storage for the FragmentIndex of the handlers,
+     *                      see FragmentIndex::numSlots()
+     */
     AssemblyBufferBase(DatagramReassembly* handlers,
                        uint8_t numHandlers,
-                       ManagedBuffer* lowpanBuf);
+                       ManagedBuffer* lowpanBuf,
+                       uint8_t* indexSlots,
+                       uint16_t numIndexSlots);
 
     virtual ~AssemblyBufferBase();
 
@@ -113,6 +120,10 @@ protected:
         return handlers;
     }
 
+    FragmentIndex& getIndex() {
+        return index;
+    }
+
 private:
 
     DatagramReassembly* findCorrespondingId(
@@ -125,10 +136,14 @@ private:
             uint16_t tag,
             uint16_t size,
             bufStatus_t & status);
+
+    /** adds an initialized handler to the index */
+    void addToIndex(uint8_t id);
 private:
     DatagramReassembly* handlers;
     uint8_t mEntries;
     ManagedBuffer* lBuffer;
+    FragmentIndex index;
 };
 
 
@@ -149,7 +164,9 @@ public:
     AssemblyBuffer(ManagedBuffer* buffer) :
         AssemblyBufferBase(handlerArray,
         MEntries,
-        buffer)
+        buffer,
+        indexArray,
+        FragmentIndexSize<MEntries>::value)
     {}
 
     ~AssemblyBuffer() {
@@ -159,6 +176,7 @@ public:
     }
 
     DatagramReassembly handlerArray[MEntries];
+    uint8_t indexArray[FragmentIndexSize<MEntries>::value];
 };
 
 //typedef AssemblyBuffer<LOWPAN_SET_ASSEMBLY_ENTRIES> AssemblyBuffer_t;
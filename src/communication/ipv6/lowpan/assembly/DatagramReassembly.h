@@ -183,6 +183,10 @@ public:
         return tag;
     }
 
+    uint16_t getSize() const {
+        return size;
+    }
+
     uint8_t getStatus() {
         return ticksLeft;
     }
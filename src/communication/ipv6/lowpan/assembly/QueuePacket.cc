@@ -41,9 +41,10 @@
 namespace cometos_v6 {
 
 QueuePacket::QueuePacket(IPv6Request* req, uint16_t tag,
-        BufferInformation* buf, uint16_t posInBuffer):
+        BufferInformation* buf, uint16_t posInBuffer,
+        LowpanContextTable* contexts):
         ipRequest(req),
-        comprDatagramm(req),
+        comprDatagramm(req, FollowingHeader::NoNextHeaderNumber, contexts),
         offset(0),
         size(req->data.datagram->getCompleteHeaderLength()
                 + req->data.datagram->getUpperLayerPayloadLength()),
@@ -48,7 +48,8 @@ class LowpanAdaptionLayer;
 
 class QueuePacket: public QueueObject {
 public:
-    QueuePacket(IPv6Request* req, uint16_t tag, BufferInformation* buf, uint16_t posInBuffer = 0);
+    QueuePacket(IPv6Request* req, uint16_t tag, BufferInformation* buf, uint16_t posInBuffer = 0,
+                LowpanContextTable* contexts = NULL);
     ~QueuePacket();
 
     virtual QueueObject::response_t response(bool success, const cometos::MacTxInfo & info);
@@ -45,14 +45,18 @@ DirectBuffer::DirectBuffer(
             LowpanAdaptionLayer* lowpan,
             AssemblyBufferBase* assemblyBuf,
             ManagedBuffer* buffer,
-            uint16_t* tag) :
+            uint16_t* tag,
+            uint8_t* indexSlots,
+            uint16_t numIndexSlots) :
         numEntries(size),
         assembly(assemblyBuf),
         lowpan(lowpan),
         buffer(buffer),
         nexttag(tag),
         ip(NULL),
-        datagramHandlers(datagramHandlers)
+        datagramHandlers(datagramHandlers),
+        index(indexSlots, numIndexSlots),
+        cutThrough(false)
 {}
 
 
@@ -78,7 +82,23 @@ DatagramReassembly* DirectBuffer::addFragment(
 
    // packet information object found, try to add the received new fragment
    fragmentResult_t res = pi->addFragment(offset, frame.getLength());
-   if (res == PI_IN_ORDER) {
+   cometos::AirframePtr rxFrame;
+   if (res == PI_IN_ORDER && cutThrough && lowpan->takeReceivedFrame(frame, rxFrame)) {
+       ASSERT(pi->isFree() == false);
+       bool last = false;
+       if (pi->getSize() == pi->getTransmitted()) {
+           last = true;
+           status = BS_SUCCESS_PACKET;
+       }
+       QueueFrame* qfp = new QueueFrame(pi, rxFrame, offset, last);
+
+       if (!lowpan->enqueueQueueObject(qfp)) {
+           delete qfp; ///< also deletes the frame
+           status = BS_QUEUE_FULL;
+       } else {
+           return NULL;
+       }
+   } else if (res == PI_IN_ORDER) {
        ManagedBuffer::MbRequestStatus mbStatus;
        BufferInformation* buf = buffer->getBuffer(frame.getLength(), mbStatus);
        if (buf != NULL) {
@@ -90,7 +110,9 @@ DatagramReassembly* DirectBuffer::addFragment(
                last = true;
                status = BS_SUCCESS_PACKET;
            }
-           QueueFrame* qfp = new QueueFrame(pi, buf, 0, offset, last);
+           QueueFrame* qfp = new QueueFrame(pi, buf, 0, offset, last,
+                                            FollowingHeader::NoNextHeaderNumber,
+                                            &lowpan->getContextTable());
 
            // try to queue fragment
            if (!lowpan->enqueueQueueObject(qfp)) {
@@ -205,6 +227,7 @@ DatagramReassembly* DirectBuffer::addFirstFragment(
                             (*nexttag)++,
                             size,
                             ffbi.uncompressedSize);
+               addToIndex(handler);
                ipReq = NULL;
                handler->getDatagram()->decrHopLimit();
                ASSERT(handler->isFree() == false);
@@ -214,7 +237,8 @@ DatagramReassembly* DirectBuffer::addFirstFragment(
                                                uncompressedPosInBuf,
                                                0,
                                                false,
-                                               decompressor->getNextUncompressedHeaderType());
+                                               decompressor->getNextUncompressedHeaderType(),
+                                               &lowpan->getContextTable());
 
                if (!lowpan->enqueueQueueObject(qo)) {
                    delete qo;
@@ -320,7 +344,9 @@ DatagramReassembly* DirectBuffer::addFirstLFFRFragment(const Ieee802154MacAddres
             buf->addFrame(frame);
             ASSERT(handler->isFree() == false);
             handler->resetStatus(); // refresh this already existing entry ... its in use
-            LFFRFrame* qfp = new LFFRFrame(handler, buf, offsetForFirstFragment, sequenceNumber, enableImplicitAck);
+            LFFRFrame* qfp = new LFFRFrame(handler, buf, offsetForFirstFragment, sequenceNumber, enableImplicitAck,
+                                           FollowingHeader::NoNextHeaderNumber,
+                                           &lowpan->getContextTable());
             // try to queue fragment
             if (!lowpan->enqueueQueueObject(qfp)) {
                 delete qfp; ///< also include buf->free();
@@ -379,6 +405,7 @@ DatagramReassembly* DirectBuffer::addFirstLFFRFragment(const Ieee802154MacAddres
                        (*nexttag)++,
                        size,
                        SBP.uncompressedSize);
+               addToIndex(handler);
                ipReq = NULL;
                handler->getDatagram()->decrHopLimit();
                ASSERT(handler->isFree() == false);
@@ -391,7 +418,8 @@ DatagramReassembly* DirectBuffer::addFirstLFFRFragment(const Ieee802154MacAddres
                                              offsetForFirstFragment,
                                              sequenceNumber,
                                              enableImplicitAck,
-                                             dcDatagram->getNextUncompressedHeaderType());
+                                             dcDatagram->getNextUncompressedHeaderType(),
+                                             &lowpan->getContextTable());
                if (!lowpan->enqueueQueueObject(qo)) {
                    delete qo;
                    status = BS_QUEUE_FULL;
@@ -474,7 +502,9 @@ DatagramReassembly* DirectBuffer::addSubsequentLFFRFragment(
                           0,
                           offset,
                           sequenceNumber,
-                          enableImplicitAck);
+                          enableImplicitAck,
+                          FollowingHeader::NoNextHeaderNumber,
+                          &lowpan->getContextTable());
         // try to queue fragment
         if (!lowpan->enqueueQueueObject(qfp)) {
             delete qfp;  ///< also include buf->free();
@@ -560,19 +590,38 @@ PacketInformation* DirectBuffer::getFreeHandler() {
 }
 
 
+void DirectBuffer::addToIndex(PacketInformation* handler) {
+    uint8_t id = handler - datagramHandlers;
+    if (index.insert(FragmentIndex::hash(handler->getSrcMAC(),
+                                         handler->getTag(),
+                                         handler->getSize()), id)) {
+        return;
+    }
+
+    // too many stale slots, rebuild from the handlers in use
+    index.clear();
+    for (uint8_t i = 0; i < numEntries; i++) {
+        if (!datagramHandlers[i].isFree()) {
+            index.insert(FragmentIndex::hash(datagramHandlers[i].getSrcMAC(),
+                                             datagramHandlers[i].getTag(),
+                                             datagramHandlers[i].getSize()), i);
+        }
+    }
+}
+
 PacketInformation* DirectBuffer::findCorrespondingPI(
             const Ieee802154MacAddress& srcMAC,
             uint16_t tag,
             uint16_t size) {
-    uint8_t id = 0;
-    for (; (id < numEntries) && (
-            datagramHandlers[id].isFree() ||
-            datagramHandlers[id].getTag() != tag ||
-            datagramHandlers[id].getSize() != size ||
-            datagramHandlers[id].getSrcMAC() != srcMAC);
-        id++);
-    if (id < numEntries) {
-        return &(datagramHandlers[id]);
+    uint16_t slot = index.first(FragmentIndex::hash(srcMAC, tag, size));
+    for (; index.get(slot) != FragmentIndex::EMPTY; slot = index.next(slot)) {
+        PacketInformation& pi = datagramHandlers[index.get(slot)];
+        if (!pi.isFree() &&
+                pi.getTag() == tag &&
+                pi.getSize() == size &&
+                pi.getSrcMAC() == srcMAC) {
+            return &pi;
+        }
     }
     return NULL;
 }
@@ -644,7 +693,9 @@ DynDirectBuffer::DynDirectBuffer(
                      lowpan,
                      assemblyBuf,
                      buffer,
-                     tag)
+                     tag,
+                     new uint8_t[FragmentIndex::numSlots(numDatagramHandlers)],
+                     FragmentIndex::numSlots(numDatagramHandlers))
 {
 }
 
@@ -653,6 +704,7 @@ DynDirectBuffer::~DynDirectBuffer() {
     PacketInformation*& pi = this->getDatagramHandlers();
     delete[] pi;
     pi = NULL;
+    delete[] this->getIndex().getSlots();
 
 }
 
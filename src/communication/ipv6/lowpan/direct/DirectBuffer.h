@@ -48,6 +48,7 @@
 
 #include "ICMPv6.h"
 #include "PacketInformation.h"
+#include "FragmentIndex.h"
 
 namespace cometos_v6 {
 const uint32_t NULL_ACK_BITMAP = 0x00000000;
@@ -55,18 +56,32 @@ class LowpanAdaptionLayer;
 
 class DirectBuffer : public FragmentHandler {
 public:
+    /**
+     * @param indexSlots    storage for the FragmentIndex of the handlers,
+     *                      see FragmentIndex::numSlots()
+     */
     DirectBuffer(
             PacketInformation* datagramHandlers,
             uint8_t size,
             LowpanAdaptionLayer* lowpan,
             AssemblyBufferBase* assemblyBuf,
             ManagedBuffer* buffer,
-            uint16_t* tag);
+            uint16_t* tag,
+            uint8_t* indexSlots,
+            uint16_t numIndexSlots);
 
     ~DirectBuffer() {}
 
     void initialize(IpForward * ip);
 
+    /**
+     * Enables forwarding subsequent fragments in place, instead of
+     * copying their payload into the buffer.
+     */
+    void setCutThrough(bool enable) {
+        cutThrough = enable;
+    }
+
     /**
      * @param[in] srcMAC
      * @param[in] tag
@@ -133,6 +148,8 @@ private:
     void sendLFFRNullBitmap(const Ieee802154MacAddress& srcMAC, uint16_t& tag,
                             bufStatus_t& status);
     PacketInformation* getFreeHandler();
+    /** adds a handler to the index after it was set */
+    void addToIndex(PacketInformation* handler);
     bool areAllLFFRFragmentsAcked(PacketInformation* directBufInfoOnDatagram,
                                   const uint32_t& ackBitmap);
     uint32_t generateFullyAckdBitmap(uint8_t sequenceNumber);
@@ -142,6 +159,10 @@ protected:
         return datagramHandlers;
     }
 
+    FragmentIndex& getIndex() {
+        return index;
+    }
+
 private:
 
     const uint8_t               numEntries;
@@ -153,6 +174,8 @@ private:
 
     IpForward*                  ip;
     PacketInformation*          datagramHandlers;
+    FragmentIndex               index;
+    bool                        cutThrough;
 };
 
 class DynDirectBuffer : public DirectBuffer {
@@ -179,13 +202,16 @@ public:
                           lowpan,
                           assemblyBuf,
                           buffer,
-                          tag)
+                          tag,
+                          indexArray,
+                          FragmentIndexSize<DEntries>::value)
     {}
 
     ~DirectBufferImpl() {}
 
 private:
     PacketInformation pktArray[DEntries];
+    uint8_t indexArray[FragmentIndexSize<DEntries>::value];
 };
 
 
@@ -35,6 +35,7 @@
  */
 
 #include "QueueFrame.h"
+#include "palLocalTime.h"
 
 namespace cometos_v6 {
 
@@ -43,21 +44,63 @@ QueueFrame::QueueFrame(PacketInformation* directPacket,
         uint8_t uncompressedPos,
         uint8_t offset,
         bool last,
-        uint8_t typeOfUncontainedNextHeader):
+        uint8_t typeOfUncontainedNextHeader,
+        LowpanContextTable* contexts):
             directPacket(directPacket),
             offset(offset),
             buffer(buffer),
             state(false, last),
             typeOfUncontainedNextHeader(typeOfUncontainedNextHeader),
-            uncompressedPos(uncompressedPos)
+            uncompressedPos(uncompressedPos),
+            contexts(contexts),
+            rxTimestamp(palLocalTime_get()),
+            cutThrough(false)
 {
     ASSERT(directPacket->isFree() == false);
 }
 
+QueueFrame::QueueFrame(PacketInformation* directPacket,
+        cometos::AirframePtr & frame,
+        uint8_t offset,
+        bool last):
+            directPacket(directPacket),
+            offset(offset),
+            buffer(NULL),
+            state(false, last),
+            typeOfUncontainedNextHeader(FollowingHeader::NoNextHeaderNumber),
+            uncompressedPos(0),
+            contexts(NULL),
+            rxTimestamp(palLocalTime_get()),
+            cutThrough(true)
+{
+    ASSERT(directPacket->isFree() == false);
+    ASSERT(offset > 0);
+    rxFrame = std::move(frame);
+    // drop the reception meta data, the frame is sent as a new request
+    rxFrame->removeAll();
+}
+
 QueueFrame::~QueueFrame() {
     if (buffer != NULL) {
         buffer->free();
     }
+    if (rxFrame) {
+        rxFrame.delete_object();
+    }
+}
+
+cometos::AirframePtr QueueFrame::getFrame() {
+    if (!rxFrame) {
+        return QueueObject::getFrame();
+    }
+    cometos::AirframePtr frame;
+    frame = std::move(rxFrame);
+    return frame;
+}
+
+bool QueueFrame::getRxTimestamp(time_ms_t & timestamp) const {
+    timestamp = rxTimestamp;
+    return true;
 }
 
 QueueObject::response_t QueueFrame::response(bool success, const cometos::MacTxInfo & info) {
@@ -88,7 +131,11 @@ void QueueFrame::createFrame(cometos::Airframe& frame,
     ASSERT(directPacket->isFree() == false);
 
     uint8_t fragSize;
-    if (offset > 0) {
+    if (cutThrough) {
+        // the payload already is in the frame, obtained by getFrame()
+        ASSERT(buffer == NULL && !rxFrame);
+        fragSize = frame.getLength();
+    } else if (offset > 0) {
         // expect content to live at the beginning of passed buffer
         // in this case, all content will be uncompressed
         LOG_DEBUG("Getting frame from buffer of " << (int) buffer->getSize() << "bytes") ;
@@ -102,7 +149,8 @@ void QueueFrame::createFrame(cometos::Airframe& frame,
         IPHCCompressor comprDatagramm(directPacket->getDatagram(),
                         tmpMAC,
                         directPacket->getDstMAC(),
-                        typeOfUncontainedNextHeader);
+                        typeOfUncontainedNextHeader,
+                        contexts);
         fragSize = comprDatagramm.streamDatagramToFrame(frame, maxSize, buffer, uncompressedPos); //, true);
     }
 
@@ -77,7 +77,29 @@ public:
             uint8_t uncompressedPosition,
             uint8_t offset,
             bool last = false,
-            uint8_t typeOfUncontainedNextHeader = FollowingHeader::NoNextHeaderNumber);
+            uint8_t typeOfUncontainedNextHeader = FollowingHeader::NoNextHeaderNumber,
+            LowpanContextTable* contexts = NULL);
+
+    /**
+     * Create a QueueFrame forwarding a received subsequent fragment in
+     * place. Only the fragment header is rewritten, the payload stays
+     * in the received frame.
+     *
+     * @param directPacket
+     *      meta data about the datagram transmission
+     * @param frame
+     *      received frame holding only the payload of the fragment;
+     *      the QueueFrame takes over its ownership
+     * @param offset
+     *      6LoWPAN fragment offset in units of 8 octets, larger than 0
+     * @param last
+     *      flag indicating if this is the last fragment of a datagram
+     */
+    QueueFrame(PacketInformation* directPacket,
+            cometos::AirframePtr & frame,
+            uint8_t offset,
+            bool last = false);
+
     ~QueueFrame();
 
     virtual QueueObject::response_t response(bool success, const cometos::MacTxInfo & info);
@@ -107,6 +129,14 @@ public:
 
     virtual uint16_t getCurrDgSize() const;
 
+    virtual cometos::AirframePtr getFrame();
+
+    virtual bool getRxTimestamp(time_ms_t & timestamp) const;
+
+    virtual bool isCutThrough() const {
+        return cutThrough;
+    }
+
     virtual inline PacketInformation* getDirectPacket() {
         return directPacket;
     }
@@ -125,6 +155,12 @@ private:
     } state;
     uint8_t             typeOfUncontainedNextHeader;
     uint16_t            uncompressedPos;
+    LowpanContextTable* contexts;
+
+    /** received frame, until it is handed to the queue */
+    cometos::AirframePtr rxFrame;
+    time_ms_t           rxTimestamp;
+    bool                cutThrough;
 };
 
 } /* namespace cometos_v6 */
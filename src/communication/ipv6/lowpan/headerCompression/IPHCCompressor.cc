@@ -46,27 +46,35 @@ IPHCCompressor::~IPHCCompressor() {}
 IPHCCompressor::IPHCCompressor(IPv6Datagram* datagram,
                             const Ieee802154MacAddress& srcMAC,
                             const Ieee802154MacAddress& dstMAC,
-                            uint8_t typeOfUncontainedNextHeader)
+                            uint8_t typeOfUncontainedNextHeader,
+                            LowpanContextTable* contexts)
         : datagram(datagram),
           srcMAC(srcMAC),
           dstMAC(dstMAC),
           nHeader(NULL),
           uncomprSize(0),
           posInCurrUncompressedHeader(0),
-          typeOfUncontainedNextHeader(typeOfUncontainedNextHeader)
+          typeOfUncontainedNextHeader(typeOfUncontainedNextHeader),
+          contexts(contexts),
+          srcContext(LowpanContextTable::NO_CONTEXT),
+          dstContext(LowpanContextTable::NO_CONTEXT)
 {
     ASSERT(datagram != NULL);
 }
 
 
-IPHCCompressor::IPHCCompressor(IPv6Request* req, uint8_t typeOfUncontainedNextHeader)
+IPHCCompressor::IPHCCompressor(IPv6Request* req, uint8_t typeOfUncontainedNextHeader,
+                               LowpanContextTable* contexts)
         : datagram(req->data.datagram),
           srcMAC(req->data.srcMacAddress),
           dstMAC(req->data.dstMacAddress),
           nHeader(NULL),
           uncomprSize(0),
           posInCurrUncompressedHeader(0),
-          typeOfUncontainedNextHeader(typeOfUncontainedNextHeader)
+          typeOfUncontainedNextHeader(typeOfUncontainedNextHeader),
+          contexts(contexts),
+          srcContext(LowpanContextTable::NO_CONTEXT),
+          dstContext(LowpanContextTable::NO_CONTEXT)
 {}
 
 uint16_t IPHCCompressor::streamDatagramToFrame(cometos::Airframe& frame,
@@ -192,7 +200,7 @@ uint8_t IPHCCompressor::putCompressibleHeadersInBuffer(
     uncomprSize = IPv6Datagram::IPV6_HEADER_SIZE;
 
     // set Context
-    // TODO: We don't implement this, yet.
+    bool cidInline = comprContexts(buffer, compressedSize);
 
     // encode Flow Label and Traffic Class
     comprTCFL(buffer, compressedSize);
@@ -227,11 +235,29 @@ uint8_t IPHCCompressor::putCompressibleHeadersInBuffer(
     comprHopLimit(buffer, compressedSize);
 
     // encode Source Address
+    uint8_t srcStart = compressedSize;
     comprSrcAddr(buffer, compressedSize);
 
     // encode Destination Address
+    uint8_t dstStart = compressedSize;
     comprDstAddr(buffer, compressedSize);
 
+    if (contexts != NULL) {
+        // compared to inlining the whole address, which would be necessary
+        // for any global address without context
+        uint8_t saved = 0;
+        if (srcContext != LowpanContextTable::NO_CONTEXT) {
+            saved += 16 - (dstStart - srcStart);
+        }
+        if (dstContext != LowpanContextTable::NO_CONTEXT) {
+            saved += 16 - (compressedSize - dstStart);
+        }
+        if (saved > 0 && cidInline) {
+            saved--;
+        }
+        contexts->countCompression(saved);
+    }
+
     // now compress all next headers, as long as their uncompressed size
     // would also fit the given buffer
     while (    (nHeader != NULL)
@@ -300,8 +326,7 @@ void IPHCCompressor::comprHopLimit(uint8_t* buf, uint8_t& pos) {
 }
 
 void IPHCCompressor::comprSrcAddr(uint8_t* buf, uint8_t& pos) {
-    // For now we just implement the stateless compression
-    // TODO We also don't use the 16 bit Mac Address
+    // TODO We don't use the 16 bit Mac Address for link local addresses
 
     if (datagram->src.isLinkLocal()) {
         IPv6Address own(0, 0, 0, 0, srcMAC.a1(), srcMAC.a2(), srcMAC.a3(),
@@ -316,16 +341,18 @@ void IPHCCompressor::comprSrcAddr(uint8_t* buf, uint8_t& pos) {
         }
     } else if (datagram->src.isUnspecified()) {
         setContextBasedSAC(buf);
+    } else if (srcContext != LowpanContextTable::NO_CONTEXT) {
+        setContextBasedSAC(buf);
+        buf[1] |= comprContextIID(datagram->src, srcMAC, buf, pos) << SAM_SHIFT;
     } else {
-        // As we use no stateful compression we can't compress addresses that
-        // are not linklocal
+        // without a context we can't compress addresses that are not
+        // linklocal
         storeIPAddress(datagram->src, 0, buf, pos);
     }
 }
 
 void IPHCCompressor::comprDstAddr(uint8_t* buf, uint8_t& pos) {
-    // For starters we just implement the stateless compression
-    // We also don't use the 16 bit Mac Address
+    // We don't use the 16 bit Mac Address for link local addresses
 
     if (datagram->dst.isLinkLocal()) {
         if (datagram->dst.getAddressPart(4) == dstMAC.a1() &&
@@ -370,13 +397,67 @@ void IPHCCompressor::comprDstAddr(uint8_t* buf, uint8_t& pos) {
             // Everything needs to be stored...
             storeIPAddress(datagram->dst, 0, buf, pos);
         }
+    } else if (dstContext != LowpanContextTable::NO_CONTEXT) {
+        setContextBasedDAC(buf);
+        buf[1] |= comprContextIID(datagram->dst, dstMAC, buf, pos) << DAM_SHIFT;
     } else {
-        // As we use no stateful compression we can't compress addresses that
-        // are not linklocal
+        // without a context we can't compress addresses that are not
+        // linklocal
         storeIPAddress(datagram->dst, 0, buf, pos);
     }
 }
 
+bool IPHCCompressor::comprContexts(uint8_t* buf, uint8_t& pos) {
+    srcContext = findContext(datagram->src);
+    dstContext = findContext(datagram->dst);
+
+    // context 0 is used if no CID is inlined
+    uint8_t src = (srcContext == LowpanContextTable::NO_CONTEXT) ? 0 : srcContext;
+    uint8_t dst = (dstContext == LowpanContextTable::NO_CONTEXT) ? 0 : dstContext;
+    if (src == 0 && dst == 0) {
+        return false;
+    }
+    setCIDInline(buf);
+    buf[pos++] = (src << 4) | dst;
+    return true;
+}
+
+uint8_t IPHCCompressor::findContext(const IPv6Address& address) {
+    if (contexts == NULL || !address.isUnicast() || address.isLinkLocal()
+            || address.isLoopback()) {
+        return LowpanContextTable::NO_CONTEXT;
+    }
+    uint8_t cid = contexts->find(address);
+    if (cid == LowpanContextTable::NO_CONTEXT) {
+        contexts->observe(address);
+    } else {
+        contexts->use(cid);
+    }
+    return cid;
+}
+
+uint8_t IPHCCompressor::comprContextIID(const IPv6Address& address,
+                                        const Ieee802154MacAddress& mac,
+                                        uint8_t* buf, uint8_t& pos) {
+    // forwarded frames are compressed without the source MAC address,
+    // which is left at its default then and must not be used for eliding
+    if (mac != Ieee802154MacAddress() &&
+            address.getAddressPart(4) == mac.a1() &&
+            address.getAddressPart(5) == mac.a2() &&
+            address.getAddressPart(6) == mac.a3() &&
+            address.getAddressPart(7) == mac.a4()) {
+        return AM_SF_ELIDED;
+    }
+    if (address.getAddressPart(4) == 0 &&
+            address.getAddressPart(5) == 0x00FF &&
+            address.getAddressPart(6) == 0xFE00) {
+        storeIPAddress(address, 7, buf, pos);
+        return AM_SF_2BYTE;
+    }
+    storeIPAddress(address, 4, buf, pos);
+    return AM_SF_8BYTE;
+}
+
 void IPHCCompressor::storeIPAddress(const IPv6Address& address,
                                              uint8_t start, uint8_t* buf,
                                              uint8_t& pos) {
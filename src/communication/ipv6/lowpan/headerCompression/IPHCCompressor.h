@@ -44,6 +44,7 @@
 #include "UDPPacket.h"
 #include "LowpanBuffer.h"
 #include "IPv6Request.h"
+#include "LowpanContextTable.h"
 
 #define SIZE_OF_LOWPAN_SUBSEQUENT_HEADERS 5
 #define LOWPAN_FIRSTFRAGMENT_HEADER_SIZE 4
@@ -54,11 +55,13 @@ public:
     IPHCCompressor(IPv6Datagram* datagram,
                    const Ieee802154MacAddress& srcMAC,
                    const Ieee802154MacAddress& dstMAC,
-                   uint8_t typeOfUncontainedNextHeader);
+                   uint8_t typeOfUncontainedNextHeader,
+                   LowpanContextTable* contexts = NULL);
 
 
     IPHCCompressor(IPv6Request* req,
-                   uint8_t typeOfUncontainedNextHeader = FollowingHeader::NoNextHeaderNumber);
+                   uint8_t typeOfUncontainedNextHeader = FollowingHeader::NoNextHeaderNumber,
+                   LowpanContextTable* contexts = NULL);
 
     ~IPHCCompressor();
 
@@ -150,6 +153,34 @@ private:
      */
     void comprHopLimit(uint8_t* buf, uint8_t& pos);
 
+    /**
+     * Selects the contexts for source and destination address and inlines
+     * their CIDs if any is not the default context 0.
+     *
+     * @param[in,out] buf ptr to first byte of LOWPAN_IPHC encoding
+     * @param[in,out] pos offset to current writing position in LOWPAN_IPHC-
+     *                    encoded datagram; will be incremented for every
+     *                    inlined byte written to buf
+     * @return true if the CID byte was inlined
+     */
+    bool comprContexts(uint8_t* buf, uint8_t& pos);
+
+    /**
+     * @return CID of the context to compress address with or
+     *         LowpanContextTable::NO_CONTEXT
+     */
+    uint8_t findContext(const IPv6Address& address);
+
+    /**
+     * Compresses the interface identifier of an address which matches a
+     * context, i.e., elides it if derived from mac or stores 16 or 64 bit.
+     *
+     * @return address mode, i.e., SAM or DAM value
+     */
+    uint8_t comprContextIID(const IPv6Address& address,
+                            const Ieee802154MacAddress& mac,
+                            uint8_t* buf, uint8_t& pos);
+
     /**
      * Compresses source address and sets LOWPAN_IPHC header fields accordingly.
      *
@@ -226,8 +257,9 @@ private:
     uint16_t uncomprSize;
     uint16_t posInCurrUncompressedHeader;
     uint8_t typeOfUncontainedNextHeader;
-
-
+    LowpanContextTable* contexts;
+    uint8_t srcContext;
+    uint8_t dstContext;
 };
 
 } /* namespace cometos_v6 */
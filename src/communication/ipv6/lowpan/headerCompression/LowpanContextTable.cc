@@ -0,0 +1,265 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "LowpanContextTable.h"
+#include "cometosAssert.h"
+
+namespace cometos_v6 {
+
+LowpanContextTable::LowpanContextTable():
+    originator(false)
+{
+    resetCounters();
+    clear();
+}
+
+void LowpanContextTable::clear() {
+    for (uint8_t cid = 0; cid < LOWPAN_CONTEXTS; cid++) {
+        prefixes[cid] = IPv6Context();
+        lengths[cid] = 0;
+        compress[cid] = false;
+        lifetimes[cid] = 0;
+        advertisements[cid] = 0;
+        uses[cid] = 0;
+        learned[cid] = false;
+        evicted[cid] = false;
+    }
+    for (uint8_t i = 0; i < LOWPAN_CONTEXT_CANDIDATES; i++) {
+        candidateCounts[i] = 0;
+    }
+}
+
+void LowpanContextTable::set(uint8_t cid, const IPv6Address& prefix,
+                             uint8_t length, bool compress,
+                             uint16_t lifetime) {
+    ASSERT(cid < LOWPAN_CONTEXTS);
+    ASSERT(length <= 64);
+    if (lifetime == 0) {
+        prefixes[cid] = IPv6Context();
+        lengths[cid] = 0;
+        this->compress[cid] = false;
+        lifetimes[cid] = 0;
+        return;
+    }
+    IPv6Address p = prefix.getPrefix(length);
+    prefixes[cid] = IPv6Context(p.getAddressPart(0), p.getAddressPart(1),
+                                p.getAddressPart(2), p.getAddressPart(3));
+    lengths[cid] = length;
+    this->compress[cid] = compress;
+    lifetimes[cid] = lifetime;
+    advertisements[cid] = 0;
+    uses[cid] = 0;
+    learned[cid] = false;
+    evicted[cid] = false;
+}
+
+bool LowpanContextTable::matches(const IPv6Context& prefix,
+                                 const IPv6Address& address) {
+    // the decompressor takes the upper 64 bits from the context, thus
+    // bits beyond a shorter prefix have to be zero in the address, too
+    for (uint8_t i = 0; i < 4; i++) {
+        if (prefix.getAddressPart(i) != address.getAddressPart(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint8_t LowpanContextTable::find(const IPv6Address& address) const {
+    for (uint8_t cid = 0; cid < LOWPAN_CONTEXTS; cid++) {
+        if (compress[cid] && matches(prefixes[cid], address)) {
+            return cid;
+        }
+    }
+    return NO_CONTEXT;
+}
+
+void LowpanContextTable::observe(const IPv6Address& address) {
+    if (!originator) {
+        return;
+    }
+    IPv6Context prefix(address.getAddressPart(0), address.getAddressPart(1),
+                       address.getAddressPart(2), address.getAddressPart(3));
+    for (uint8_t cid = 0; cid < LOWPAN_CONTEXTS; cid++) {
+        if (isValid(cid) && matches(prefixes[cid], address)) {
+            // learned already, but not yet advertised often enough
+            return;
+        }
+    }
+    learn(prefix);
+}
+
+void LowpanContextTable::learn(const IPv6Context& prefix) {
+    IPv6Address address;
+    address.setContext(prefix, 0, 0, 0, 0);
+
+    uint8_t least = 0;
+    for (uint8_t i = 0; i < LOWPAN_CONTEXT_CANDIDATES; i++) {
+        if (candidateCounts[i] > 0 && matches(candidates[i], address)) {
+            if (candidateCounts[i] < 0xFF) {
+                candidateCounts[i]++;
+            }
+            if (candidateCounts[i] < LOWPAN_CONTEXT_LEARN_THRESHOLD) {
+                return;
+            }
+            for (uint8_t cid = 0; cid < LOWPAN_CONTEXTS; cid++) {
+                if (!isValid(cid)) {
+                    set(cid, address, 64, false);
+                    learned[cid] = true;
+                    candidateCounts[i] = 0;
+                    return;
+                }
+            }
+            // all contexts in use, keep counting until one is free
+            evict(candidateCounts[i]);
+            return;
+        }
+        if (candidateCounts[i] < candidateCounts[least]) {
+            least = i;
+        }
+    }
+
+    // Space-Saving: the new prefix takes over the least frequent candidate
+    // and inherits its count, which bounds the error of the estimation
+    candidates[least] = prefix;
+    if (candidateCounts[least] < 0xFF) {
+        candidateCounts[least]++;
+    }
+}
+
+bool LowpanContextTable::evict(uint8_t count) {
+    uint8_t victim = NO_CONTEXT;
+    for (uint8_t cid = 0; cid < LOWPAN_CONTEXTS; cid++) {
+        if (!isValid(cid) || !learned[cid]) {
+            continue;
+        }
+        if (evicted[cid]) {
+            // only a single context lapses at a time
+            return false;
+        }
+        if (!compress[cid]) {
+            // still advertised before its first use
+            continue;
+        }
+        if (victim == NO_CONTEXT || uses[cid] < uses[victim]) {
+            victim = cid;
+        }
+    }
+    if (victim == NO_CONTEXT || uses[victim] >= count) {
+        return false;
+    }
+    // neighbors stop using the context once they receive the cleared C
+    // flag, the CID is not reused before its lifetime has expired
+    compress[victim] = false;
+    evicted[victim] = true;
+    return true;
+}
+
+uint16_t LowpanContextTable::writeOptions(uint8_t* buf, uint16_t size) {
+    uint16_t pos = 0;
+    for (uint8_t cid = 0; cid < LOWPAN_CONTEXTS; cid++) {
+        if (!isValid(cid)) {
+            continue;
+        }
+        if (size - pos < OPTION_LENGTH) {
+            break;
+        }
+        buf[pos++] = OPTION_TYPE;
+        buf[pos++] = OPTION_LENGTH / 8;
+        buf[pos++] = lengths[cid];
+        buf[pos++] = (compress[cid] ? 0x10 : 0) | cid;
+        buf[pos++] = 0;
+        buf[pos++] = 0;
+        buf[pos++] = lifetimes[cid] >> 8;
+        buf[pos++] = lifetimes[cid] & 0xFF;
+        for (uint8_t i = 0; i < 4; i++) {
+            uint16_t part = prefixes[cid].getAddressPart(i);
+            buf[pos++] = part >> 8;
+            buf[pos++] = part & 0xFF;
+        }
+
+        if (originator && !compress[cid] && !evicted[cid]
+                && ++advertisements[cid] >= LOWPAN_CONTEXT_ADVERTISEMENTS) {
+            compress[cid] = true;
+        }
+    }
+    return pos;
+}
+
+bool LowpanContextTable::readOption(const uint8_t* option, uint8_t length) {
+    if (length < OPTION_LENGTH || option[0] != OPTION_TYPE
+            || option[1] * 8 > length || option[1] < 2) {
+        return false;
+    }
+    if (originator) {
+        return true;
+    }
+
+    uint8_t contextLength = option[2];
+    uint8_t cid = option[3] & 0x0F;
+    uint16_t lifetime = ((uint16_t) option[6] << 8) | option[7];
+    if (contextLength > 64) {
+        // not supported, the context would cover the interface identifier
+        set(cid, IPv6Address(), 0, false, 0);
+        return true;
+    }
+
+    IPv6Address prefix;
+    for (uint8_t i = 0; i < 4; i++) {
+        prefix.setAddressPart(option[8 + 2 * i], option[9 + 2 * i], i);
+    }
+    set(cid, prefix, contextLength, (option[3] & 0x10) != 0, lifetime);
+    return true;
+}
+
+void LowpanContextTable::tick() {
+    for (uint8_t cid = 0; cid < LOWPAN_CONTEXTS; cid++) {
+        if (originator) {
+            if (!learned[cid]) {
+                // configured contexts do not expire
+                continue;
+            }
+            bool used = uses[cid] > 0;
+            uses[cid] /= 2;
+            if (used && !evicted[cid]) {
+                lifetimes[cid] = LOWPAN_CONTEXT_LIFETIME;
+                continue;
+            }
+        }
+        if (lifetimes[cid] > 0 && --lifetimes[cid] == 0) {
+            // keep the prefix for decompressing datagrams still in flight
+            compress[cid] = false;
+        }
+    }
+}
+
+}
@@ -0,0 +1,229 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef LOWPAN_CONTEXT_TABLE_H_
+#define LOWPAN_CONTEXT_TABLE_H_
+
+#include <stdint.h>
+#include "IPv6Address.h"
+
+namespace cometos_v6 {
+
+/** number of contexts addressable by the 4 bit CIDs of LOWPAN_IPHC */
+#define LOWPAN_CONTEXTS 16
+
+/** number of prefixes observed as candidates for a new context */
+#ifndef LOWPAN_CONTEXT_CANDIDATES
+#define LOWPAN_CONTEXT_CANDIDATES 4
+#endif
+
+/** number of datagrams using a prefix before a context is assigned to it */
+#ifndef LOWPAN_CONTEXT_LEARN_THRESHOLD
+#define LOWPAN_CONTEXT_LEARN_THRESHOLD 8
+#endif
+
+/**
+ * number of advertisements of a learned context before it is used for
+ * compression, which gives neighbors the chance to know it beforehand
+ */
+#ifndef LOWPAN_CONTEXT_ADVERTISEMENTS
+#define LOWPAN_CONTEXT_ADVERTISEMENTS 3
+#endif
+
+/** valid lifetime of advertised contexts in minutes */
+#ifndef LOWPAN_CONTEXT_LIFETIME
+#define LOWPAN_CONTEXT_LIFETIME 60
+#endif
+
+/**
+ * Contexts for the stateful address compression of LOWPAN_IPHC (RFC 6282)
+ * with a prefix of up to 64 bits, which are shared by source and
+ * destination addresses.
+ *
+ * The originator of the contexts, i.e., the border router, learns them
+ * from the traffic it compresses. Every global unicast address without
+ * context is observed and a context is assigned to a prefix, which was
+ * used by LOWPAN_CONTEXT_LEARN_THRESHOLD datagrams. The candidate prefixes
+ * are counted with the Space-Saving algorithm, thus a few frequent
+ * prefixes are found in constant memory.
+ *
+ * Contexts are distributed with the 6LoWPAN Context Option (6CO, RFC 6775)
+ * and only used for compression if its C flag is set. The originator sets
+ * it after having advertised a new context LOWPAN_CONTEXT_ADVERTISEMENTS
+ * times. Other nodes take over contexts, including their C flag, from the
+ * options they receive and drop them after their lifetime has expired.
+ *
+ * The originator renews the lifetime of a learned context as long as it is
+ * used for compression, thus unused contexts lapse like on the other nodes.
+ * If all contexts are in use, a candidate that was counted more often than
+ * the least used learned context evicts it: its C flag is cleared and its
+ * lifetime runs out, then the CID is free for the candidate.
+ */
+class LowpanContextTable {
+public:
+    static const uint8_t NO_CONTEXT = 0xFF;
+    static const uint8_t OPTION_TYPE = 34;
+    static const uint8_t OPTION_LENGTH = 16;
+
+    LowpanContextTable();
+
+    void clear();
+
+    /**
+     * Enables learning of contexts, which should only be done by a single
+     * node of the network.
+     */
+    void setOriginator(bool originator) {
+        this->originator = originator;
+    }
+
+    bool isOriginator() const {
+        return originator;
+    }
+
+    /**
+     * Sets a context, e.g., a statically configured one.
+     *
+     * @param lifetime  valid lifetime in minutes, 0 removes the context
+     */
+    void set(uint8_t cid, const IPv6Address& prefix, uint8_t length,
+             bool compress, uint16_t lifetime = LOWPAN_CONTEXT_LIFETIME);
+
+    /**
+     * @return CID of a context for compressing address or NO_CONTEXT
+     */
+    uint8_t find(const IPv6Address& address) const;
+
+    /**
+     * Counts a global unicast address for which no context was found. If
+     * it is the originator, this may create a new context for its prefix.
+     */
+    void observe(const IPv6Address& address);
+
+    /**
+     * Counts an address compressed with a context.
+     */
+    void use(uint8_t cid) {
+        if (uses[cid] < 0xFF) {
+            uses[cid]++;
+        }
+    }
+
+    /**
+     * Counts a compressed IPv6 header.
+     *
+     * @param saved     number of bytes saved by stateful compression
+     */
+    void countCompression(uint8_t saved) {
+        if (saved > 0) {
+            statefulHeaders++;
+            bytesSaved += saved;
+        }
+    }
+
+    /**
+     * Writes a 6CO for every valid context.
+     *
+     * @return number of bytes written
+     */
+    uint16_t writeOptions(uint8_t* buf, uint16_t size);
+
+    /**
+     * Takes over the context of a 6CO, which is ignored by the originator.
+     *
+     * @param option    option starting with its type
+     * @return false if the option is malformed
+     */
+    bool readOption(const uint8_t* option, uint8_t length);
+
+    /**
+     * Ages the contexts, to be called once a minute. The originator only
+     * ages the learned contexts that were not used since the last tick.
+     */
+    void tick();
+
+    bool isValid(uint8_t cid) const {
+        return lifetimes[cid] > 0;
+    }
+
+    /**
+     * Prefixes of the contexts, padded with zeros, as used by the
+     * IPHCDecompressor.
+     */
+    IPv6Context (&getPrefixes())[LOWPAN_CONTEXTS] {
+        return prefixes;
+    }
+
+    /** number of IPv6 headers with at least one address compressed by context */
+    uint32_t getStatefulHeaders() const {
+        return statefulHeaders;
+    }
+
+    /** total number of bytes saved by stateful compression */
+    uint32_t getBytesSaved() const {
+        return bytesSaved;
+    }
+
+    void resetCounters() {
+        statefulHeaders = 0;
+        bytesSaved = 0;
+    }
+
+private:
+    static bool matches(const IPv6Context& prefix, const IPv6Address& address);
+
+    void learn(const IPv6Context& prefix);
+    bool evict(uint8_t count);
+
+    IPv6Context prefixes[LOWPAN_CONTEXTS];
+    uint8_t lengths[LOWPAN_CONTEXTS];
+    bool compress[LOWPAN_CONTEXTS];
+    uint16_t lifetimes[LOWPAN_CONTEXTS];
+    uint8_t advertisements[LOWPAN_CONTEXTS];
+    /** number of compressed addresses, halved every tick */
+    uint8_t uses[LOWPAN_CONTEXTS];
+    /** learned by the originator, thus aged by usage */
+    bool learned[LOWPAN_CONTEXTS];
+    bool evicted[LOWPAN_CONTEXTS];
+
+    IPv6Context candidates[LOWPAN_CONTEXT_CANDIDATES];
+    uint8_t candidateCounts[LOWPAN_CONTEXT_CANDIDATES];
+
+    bool originator;
+
+    uint32_t statefulHeaders;
+    uint32_t bytesSaved;
+};
+
+}
+
+#endif /* LOWPAN_CONTEXT_TABLE_H_ */
@@ -40,13 +40,15 @@ LFFRFrame::LFFRFrame(PacketInformation* directPacket,
                      uint8_t dataGrmOffset,
                      uint8_t sequenceNumber,
                      bool enableImplicitAck,
-                     uint8_t typeOfUncontainedNextHeader)
+                     uint8_t typeOfUncontainedNextHeader,
+                     LowpanContextTable* contexts)
     : directPacket(directPacket),
       buffer(buffer),
       _dataGrmOffset(dataGrmOffset),
       _sequenceNumber(sequenceNumber),
       _enableImplicitAck(enableImplicitAck),
-      _typeOfUncontainedNextHeader(typeOfUncontainedNextHeader)
+      _typeOfUncontainedNextHeader(typeOfUncontainedNextHeader),
+      _contexts(contexts)
 //      ,_uncompressedPos(uncompressedPos)
 {
     ASSERT(directPacket->isFree() == false);
@@ -105,7 +107,8 @@ void LFFRFrame::createFrame(cometos::Airframe& frame,
         IPHCCompressor compressor(directPacket->getDatagram(),
                                                  directPacket->getSrcMAC(),
                                                  directPacket->getDstMAC(),
-                                                 _typeOfUncontainedNextHeader);
+                                                 _typeOfUncontainedNextHeader,
+                                                 _contexts);
         uint16_t posInBuffer = 0;
         fragSize = compressor.streamDatagramToFrame(frame, maxSize, buffer, posInBuffer);
     } else {
@@ -49,6 +49,7 @@ class LFFRFrame : public LFFRObject, public QueueFragment {
     uint8_t _sequenceNumber;
     bool _enableImplicitAck;
     uint8_t _typeOfUncontainedNextHeader;
+    LowpanContextTable* _contexts;
 //    uint8_t _uncompressedPos;
 
    public:
@@ -58,7 +59,8 @@ class LFFRFrame : public LFFRObject, public QueueFragment {
               uint8_t dataGrmOffset,
               uint8_t sequenceNumber,
               bool enableImplicitAck,
-              uint8_t typeOfUncontainedNextHeader = FollowingHeader::NoNextHeaderNumber);
+              uint8_t typeOfUncontainedNextHeader = FollowingHeader::NoNextHeaderNumber,
+              LowpanContextTable* contexts = NULL);
     virtual ~LFFRFrame();
 
     QueueObject::response_t response(bool success,
@@ -230,7 +230,8 @@ uint8_t LFFRPacket::fetchDataForFirstFrame(cometos::Airframe& frame,
     IPHCCompressor compressedDatagram(
         _datagramInformation->getDatagram(), _datagramInformation->getsrcMac(),
         _datagramInformation->getdstMac(),
-        FollowingHeader::NoNextHeaderNumber);
+        FollowingHeader::NoNextHeaderNumber,
+        _datagramInformation->getContextTable());
 
     uint8_t bufferForCompressedHeader[maxSize];
     uint8_t blockSize = maxSize;
@@ -205,6 +205,10 @@ bool DatagramInformation::areAllFragmentsAcked(uint32_t& ackBitmap) {
     return true;
 }
 
+LowpanContextTable* DatagramInformation::getContextTable() {
+    return _lowpan != NULL ? &_lowpan->getContextTable() : NULL;
+}
+
 uint32_t DatagramInformation::getRetransmissionList(
     uint32_t& receivedAckBitmap) {
     uint32_t mask = ~(0x7FFFFFFF >> _lastFragmentForThisDatagram);
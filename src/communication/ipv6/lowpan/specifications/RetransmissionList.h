@@ -39,6 +39,7 @@
 
 namespace cometos_v6 {
 class LowpanAdaptionLayer;
+class LowpanContextTable;
 const uint32_t RTO_INITIAL_VALUE = 1028;
 const uint8_t RTO_ALPHA_DIV_FACTOR = 3;
 const uint8_t RTO_BETA_DIV_FACTOR = 2;
@@ -57,6 +58,8 @@ public:
     ~DatagramInformation();
     inline IPv6Request* getipRequest() { return ipRequestInformation; }
     inline uint16_t getTag() { return datagramTag; }
+    LowpanContextTable* getContextTable();
+
     inline Ieee802154MacAddress& getsrcMac() {
         return (ipRequestInformation->data.srcMacAddress);
     }
@@ -31,6 +31,7 @@
  */
 
 #include "Rfc4944Specification.h"
+#include "LowpanAdaptionLayer.h"
 
 namespace cometos_v6 {
 
@@ -288,7 +289,8 @@ QueueObject* Rfc4944Implementation::processBufferSpaceAndReturnQueueObject(
         uint16_t posInBuffer)
 {
     LOG_INFO("Creating new QueuePacket; posInBuffer=" << posInBuffer);
-    QueueObject* tmp = new QueuePacket(req, tag, buf, posInBuffer);
+    QueueObject* tmp = new QueuePacket(req, tag, buf, posInBuffer,
+                                       &_lowpan->getContextTable());
     return tmp;
 }
 
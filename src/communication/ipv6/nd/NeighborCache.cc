@@ -0,0 +1,247 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "NeighborCache.h"
+
+namespace cometos_v6 {
+
+NeighborCache::NeighborCache() {
+    resetCounters();
+    clear();
+}
+
+void NeighborCache::clear() {
+    for (uint16_t i = 0; i < NUM_SLOTS; i++) {
+        ipSlots[i] = EMPTY;
+        macSlots[i] = EMPTY;
+    }
+    for (nd_key_t k = 0; k < ND_MAX_ENTRIES; k++) {
+        lruNext[k] = k + 1;
+    }
+    lruNext[ND_MAX_ENTRIES - 1] = EMPTY;
+    freeHead = 0;
+    lruHead = EMPTY;
+    lruTail = EMPTY;
+    used = 0;
+}
+
+uint16_t NeighborCache::hash(const IPv6Address& ip) {
+    // the interface identifier differs most between neighbors, so it is
+    // mixed in last
+    uint32_t h = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        h = (h ^ ip.getAddressPart(i)) * 0x9E3779B1UL;
+    }
+    return h ^ (h >> 16);
+}
+
+uint16_t NeighborCache::hash(const Ieee802154MacAddress& mac) {
+    uint32_t h = mac.a1();
+    h = (h * 0x9E3779B1UL) ^ mac.a2();
+    h = (h * 0x9E3779B1UL) ^ mac.a3();
+    h = (h * 0x9E3779B1UL) ^ mac.a4();
+    h *= 0x9E3779B1UL;
+    return h ^ (h >> 16);
+}
+
+uint16_t NeighborCache::findSlot(const IPv6Address& ip) const {
+    uint16_t s = first(hash(ip));
+    while (ipSlots[s] != EMPTY && !(entries[ipSlots[s]] == ip)) {
+        s = next(s);
+    }
+    return s;
+}
+
+uint16_t NeighborCache::findSlot(const Ieee802154MacAddress& mac) const {
+    uint16_t s = first(hash(mac));
+    while (macSlots[s] != EMPTY && !(entries[macSlots[s]] == mac)) {
+        s = next(s);
+    }
+    return s;
+}
+
+NeighborEntry* NeighborCache::find(const IPv6Address& ip) {
+    nd_key_t key = ipSlots[findSlot(ip)];
+    if (key == EMPTY) {
+        misses++;
+        return NULL;
+    }
+    hits++;
+    touch(key);
+    return &entries[key];
+}
+
+NeighborEntry* NeighborCache::find(const Ieee802154MacAddress& mac) {
+    nd_key_t key = macSlots[findSlot(mac)];
+    if (key == EMPTY) {
+        misses++;
+        return NULL;
+    }
+    hits++;
+    touch(key);
+    return &entries[key];
+}
+
+NeighborEntry* NeighborCache::insert(const NeighborEntry& entry, bool isStatic) {
+    if (freeHead == EMPTY) {
+        if (lruTail == EMPTY) {
+            return NULL;
+        }
+        removeKey(lruTail);
+        evictions++;
+    }
+
+    nd_key_t key = freeHead;
+    freeHead = lruNext[key];
+    used++;
+
+    entries[key] = entry;
+    this->isStatic[key] = isStatic;
+    if (!isStatic) {
+        pushLru(key);
+    }
+    ipSlots[findSlot(entry.ip)] = key;
+    linkMac(key);
+    return &entries[key];
+}
+
+void NeighborCache::update(NeighborEntry* entry, const Ieee802154MacAddress& mac) {
+    nd_key_t key = keyOf(entry);
+    if (!isStatic[key]) {
+        unlinkLru(key);
+        isStatic[key] = true;
+    }
+    if (entry->mac != mac) {
+        unlinkMac(key);
+        entry->mac = mac;
+        linkMac(key);
+    }
+}
+
+void NeighborCache::remove(const Ieee802154MacAddress& mac) {
+    nd_key_t key = macSlots[findSlot(mac)];
+    while (key != EMPTY) {
+        nd_key_t older = sameMac[key];
+        removeKey(key);
+        key = older;
+    }
+}
+
+void NeighborCache::remove(NeighborEntry* entry) {
+    removeKey(keyOf(entry));
+}
+
+void NeighborCache::removeKey(nd_key_t key) {
+    shiftBack<false>(ipSlots, findSlot(entries[key].ip));
+    unlinkMac(key);
+    if (!isStatic[key]) {
+        unlinkLru(key);
+    }
+    lruNext[key] = freeHead;
+    freeHead = key;
+    used--;
+}
+
+void NeighborCache::linkMac(nd_key_t key) {
+    uint16_t s = findSlot(entries[key].mac);
+    sameMac[key] = macSlots[s];
+    macSlots[s] = key;
+}
+
+void NeighborCache::unlinkMac(nd_key_t key) {
+    uint16_t s = findSlot(entries[key].mac);
+    if (macSlots[s] == key) {
+        if (sameMac[key] != EMPTY) {
+            macSlots[s] = sameMac[key];
+        } else {
+            shiftBack<true>(macSlots, s);
+        }
+        return;
+    }
+    nd_key_t k = macSlots[s];
+    while (sameMac[k] != key) {
+        k = sameMac[k];
+    }
+    sameMac[k] = sameMac[key];
+}
+
+template<bool ByMac>
+void NeighborCache::shiftBack(nd_key_t* slots, uint16_t s) {
+    uint16_t j = s;
+    slots[s] = EMPTY;
+    while (true) {
+        j = next(j);
+        if (slots[j] == EMPTY) {
+            return;
+        }
+        const NeighborEntry& e = entries[slots[j]];
+        uint16_t home = first(ByMac ? hash(e.mac) : hash(e.ip));
+        if (((j - home) & (NUM_SLOTS - 1)) >= ((j - s) & (NUM_SLOTS - 1))) {
+            slots[s] = slots[j];
+            slots[j] = EMPTY;
+            s = j;
+        }
+    }
+}
+
+void NeighborCache::touch(nd_key_t key) {
+    if (!isStatic[key] && key != lruHead) {
+        unlinkLru(key);
+        pushLru(key);
+    }
+}
+
+void NeighborCache::pushLru(nd_key_t key) {
+    lruPrev[key] = EMPTY;
+    lruNext[key] = lruHead;
+    if (lruHead != EMPTY) {
+        lruPrev[lruHead] = key;
+    } else {
+        lruTail = key;
+    }
+    lruHead = key;
+}
+
+void NeighborCache::unlinkLru(nd_key_t key) {
+    if (lruPrev[key] != EMPTY) {
+        lruNext[lruPrev[key]] = lruNext[key];
+    } else {
+        lruHead = lruNext[key];
+    }
+    if (lruNext[key] != EMPTY) {
+        lruPrev[lruNext[key]] = lruPrev[key];
+    } else {
+        lruTail = lruPrev[key];
+    }
+}
+
+}
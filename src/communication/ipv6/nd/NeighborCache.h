@@ -0,0 +1,242 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __COMETOS_V6_NEIGHBOR_CACHE_H_
+#define __COMETOS_V6_NEIGHBOR_CACHE_H_
+
+#include <stdint.h>
+#include "IPv6Address.h"
+#include "Ieee802154MacAddress.h"
+
+namespace cometos_v6 {
+
+/** number of neighbors which can be resolved at the same time */
+#ifndef ND_MAX_ENTRIES
+#define ND_MAX_ENTRIES 18
+#endif
+
+#if ND_MAX_ENTRIES < 255
+typedef uint8_t nd_key_t;
+#else
+typedef uint16_t nd_key_t;
+#endif
+
+struct NeighborEntry {
+    Ieee802154MacAddress mac;
+    IPv6Address ip;
+    NeighborEntry()
+    {}
+
+    NeighborEntry(const IPv6Address& ip):
+        mac(ip.getAddressPart(7)),
+        ip(ip)
+    {}
+
+    NeighborEntry(const Ieee802154MacAddress& mac, const IPv6Address& ip):
+        mac(mac),
+        ip(ip)
+    {}
+
+    bool operator==(const IPv6Address& ip) const {
+        return (ip == this->ip);
+    }
+
+    bool operator==(const Ieee802154MacAddress& mac) const {
+        return (mac == this->mac);
+    }
+
+    void operator=(const NeighborEntry& other) {
+        ip = other.ip;
+        mac = other.mac;
+    }
+};
+
+/**
+ * Neighbor cache with constant time lookup in both directions, IPv6 to MAC
+ * address and vice versa.
+ *
+ * Entries are kept in an array and indexed by two open-addressed hash
+ * tables with linear probing, one keyed by IPv6 address, one by MAC
+ * address. Several IPv6 addresses, e.g., the link-local and a global one,
+ * may belong to the same MAC address. The MAC index refers to the newest
+ * of them, which is the head of a chain of entries with the same MAC.
+ *
+ * Entries are either dynamic, i.e., derived from an address and thus
+ * recoverable at any time, or static, i.e., added explicitly. Dynamic
+ * entries are kept in least recently used order and the least recently
+ * used one is evicted if a new entry does not fit into the cache. Static
+ * entries are never evicted.
+ *
+ * Pointers to entries stay valid until the entry is removed or evicted.
+ */
+class NeighborCache {
+    template<uint16_t Slots, bool Done = (Slots >= 2 * ND_MAX_ENTRIES)>
+    struct SlotCount {
+        static const uint16_t value = SlotCount<2 * Slots>::value;
+    };
+
+    template<uint16_t Slots>
+    struct SlotCount<Slots, true> {
+        static const uint16_t value = Slots;
+    };
+
+public:
+    static const nd_key_t EMPTY = (nd_key_t) ~0;
+    static const uint16_t NUM_SLOTS = SlotCount<2>::value;
+
+    NeighborCache();
+
+    void clear();
+
+    /**
+     * Looks up the entry for an IPv6 address and marks it as recently
+     * used.
+     *
+     * @return entry or NULL if there is none
+     */
+    NeighborEntry* find(const IPv6Address& ip);
+
+    /**
+     * Looks up the newest entry for a MAC address and marks it as recently
+     * used.
+     *
+     * @return entry or NULL if there is none
+     */
+    NeighborEntry* find(const Ieee802154MacAddress& mac);
+
+    /**
+     * Adds an entry, which must not be in the cache yet. If the cache is
+     * full, the least recently used dynamic entry is evicted.
+     *
+     * @return new entry or NULL if the cache is full of static entries
+     */
+    NeighborEntry* insert(const NeighborEntry& entry, bool isStatic);
+
+    /**
+     * Changes the MAC address of an entry and makes it static.
+     */
+    void update(NeighborEntry* entry, const Ieee802154MacAddress& mac);
+
+    /**
+     * Removes all entries for a MAC address.
+     */
+    void remove(const Ieee802154MacAddress& mac);
+
+    void remove(NeighborEntry* entry);
+
+    nd_key_t size() const {
+        return used;
+    }
+
+    bool full() const {
+        return used == ND_MAX_ENTRIES;
+    }
+
+    /** number of lookups which found an entry */
+    uint32_t getHits() const {
+        return hits;
+    }
+
+    /** number of lookups which did not find an entry */
+    uint32_t getMisses() const {
+        return misses;
+    }
+
+    /** number of dynamic entries evicted for new ones */
+    uint32_t getEvictions() const {
+        return evictions;
+    }
+
+    void resetCounters() {
+        hits = 0;
+        misses = 0;
+        evictions = 0;
+    }
+
+    static uint16_t hash(const IPv6Address& ip);
+
+    static uint16_t hash(const Ieee802154MacAddress& mac);
+
+private:
+    uint16_t first(uint16_t hash) const {
+        return hash & (NUM_SLOTS - 1);
+    }
+
+    uint16_t next(uint16_t slot) const {
+        return (slot + 1) & (NUM_SLOTS - 1);
+    }
+
+    nd_key_t keyOf(const NeighborEntry* entry) const {
+        return entry - entries;
+    }
+
+    uint16_t findSlot(const IPv6Address& ip) const;
+    uint16_t findSlot(const Ieee802154MacAddress& mac) const;
+
+    void removeKey(nd_key_t key);
+    void unlinkMac(nd_key_t key);
+    void linkMac(nd_key_t key);
+
+    /** empties a slot of ipSlots or macSlots and moves its successors */
+    template<bool ByMac>
+    void shiftBack(nd_key_t* slots, uint16_t s);
+
+    /** moves a dynamic entry to the front of the LRU list */
+    void touch(nd_key_t key);
+    void pushLru(nd_key_t key);
+    void unlinkLru(nd_key_t key);
+
+    NeighborEntry entries[ND_MAX_ENTRIES];
+    nd_key_t ipSlots[NUM_SLOTS];
+    nd_key_t macSlots[NUM_SLOTS];
+
+    // next older entry with the same MAC address
+    nd_key_t sameMac[ND_MAX_ENTRIES];
+
+    // LRU list of dynamic entries, most recently used first; free entries
+    // are chained by lruNext
+    bool isStatic[ND_MAX_ENTRIES];
+    nd_key_t lruPrev[ND_MAX_ENTRIES];
+    nd_key_t lruNext[ND_MAX_ENTRIES];
+    nd_key_t lruHead;
+    nd_key_t lruTail;
+    nd_key_t freeHead;
+    nd_key_t used;
+
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+};
+
+}
+
+#endif
@@ -63,18 +63,16 @@ const Ieee802154MacAddress* NeighborDiscovery::resolveNeighbor(const IPv6Address
 
     // for now, use last 16-bit part of IPAddress as MAC address
     LOG_DEBUG("Get MAC Addr for IP Addr");
-    for (uint8_t i=neighbors.begin(); i != neighbors.end(); i = neighbors.next(i))
-    {
-        if (neighbors[i] == address) {
-            return &(neighbors[i].mac);
-        }
+    NeighborEntry* n = neighbors.find(address);
+    if (n != NULL) {
+        return &(n->mac);
     }
 
-    if (!neighbors.full() && autoInsert) {
-        uint8_t k = neighbors.push_front(NeighborEntry(address));
-        if (k != neighbors.end()) {
+    if (autoInsert) {
+        n = neighbors.insert(NeighborEntry(address), false);
+        if (n != NULL) {
             LOG_INFO("Added " << cometos::hex << address.getAddressPart(7) << cometos::dec << " to nb");
-            return &(neighbors[k].mac);
+            return &(n->mac);
         }
     }
     LOG_WARN("No neighbor found");
@@ -83,17 +81,23 @@ const Ieee802154MacAddress* NeighborDiscovery::resolveNeighbor(const IPv6Address
 
 
 const IPv6Address* NeighborDiscovery::reverseLookup(const Ieee802154MacAddress& macAddr) {
-    for (uint8_t i = neighbors.begin(); i != neighbors.end(); i = neighbors.next(i)) {
-        if (neighbors[i] == macAddr) {
-            return &(neighbors[i].ip);
-        }
+    NeighborEntry* n = neighbors.find(macAddr);
+    if (n != NULL) {
+        return &(n->ip);
     }
 
-    if (!neighbors.full() && autoInsert) {
-        uint8_t k = neighbors.push_front(NeighborEntry(IPv6Address(IP_NWK_PREFIX, macAddr.a4())));
-        ASSERT(k != neighbors.end());
-        LOG_INFO("Added " << neighbors[k].ip.str() << " to neighbor discovery");
-        return &(neighbors[k].ip);
+    if (autoInsert) {
+        IPv6Address ip(IP_NWK_PREFIX, macAddr.a4());
+        n = neighbors.find(ip);
+        if (n != NULL) {
+            // known under another MAC address, which is kept
+            return &(n->ip);
+        }
+        n = neighbors.insert(NeighborEntry(macAddr, ip), false);
+        if (n != NULL) {
+            LOG_INFO("Added " << n->ip.str() << " to neighbor discovery");
+            return &(n->ip);
+        }
     }
     LOG_WARN("Reverse lookup failed");
     return NULL;
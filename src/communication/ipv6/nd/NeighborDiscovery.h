@@ -40,7 +40,7 @@
 
 #include "cometos.h"
 #include "IPv6Address.h"
-#include "SList.h"
+#include "NeighborCache.h"
 #include "MacAbstractionBase.h"
 #include "Ieee802154MacAddress.h"
 
@@ -50,38 +50,6 @@ namespace cometos_v6 {
 
 #define IP_NWK_PREFIX 0x64,0x29,0x30,0x31,0x0,0x0,0x0
 
-const uint8_t ND_MAX_ENTRIES = 18;
-
-struct NeighborEntry {
-    Ieee802154MacAddress mac;
-    IPv6Address ip;
-    NeighborEntry()
-    {}
-
-    NeighborEntry(const IPv6Address& ip):
-        mac(ip.getAddressPart(7)),
-        ip(ip)
-    {}
-
-    NeighborEntry(const Ieee802154MacAddress& mac, const IPv6Address& ip):
-        mac(mac),
-        ip(ip)
-    {}
-
-    bool operator==(const IPv6Address& ip) const {
-        return (ip == this->ip);
-    }
-
-    bool operator==(const Ieee802154MacAddress& mac) const {
-        return (mac == this->mac);
-    }
-
-    void operator=(const NeighborEntry& other) {
-        ip = other.ip;
-        mac = other.mac;
-    }
-};
-
 class NeighborDiscovery : public cometos::Module
 {
   public:
@@ -94,8 +62,6 @@ class NeighborDiscovery : public cometos::Module
     ~NeighborDiscovery() {
     }
 
-    typedef cometos::StaticSList<NeighborEntry, ND_MAX_ENTRIES> NeighborList;
-
     const Ieee802154MacAddress* findNeighbor(const IPv6Address & nextHop);
 
     const Ieee802154MacAddress* resolveNeighbor(const IPv6Address & nextHop) ;
@@ -103,32 +69,26 @@ class NeighborDiscovery : public cometos::Module
     const IPv6Address* reverseLookup(const Ieee802154MacAddress& macAddr);
 
     bool addNeighbor(const IPv6Address& ip, const Ieee802154MacAddress& mac) {
-        for (uint8_t i=neighbors.begin(); i != neighbors.end(); i = neighbors.next(i))
-        {
-            if (neighbors[i] == ip) {
-                neighbors[i].mac = mac;
-                return true;
-            }
+        NeighborEntry* n = neighbors.find(ip);
+        if (n != NULL) {
+            neighbors.update(n, mac);
+            return true;
         }
-        return (neighbors.push_front(NeighborEntry(mac, ip)) != neighbors.end());
+        return (neighbors.insert(NeighborEntry(mac, ip), true) != NULL);
     }
 
     void removeNeighbor(const Ieee802154MacAddress& mac) {
-        uint8_t i=neighbors.begin();
-        while (i != neighbors.end())
-        {
-            if (neighbors[i].mac == mac) {
-                i = neighbors.erase(i);
-            } else {
-                i = neighbors.next(i);
-            }
-        }
+        neighbors.remove(mac);
+    }
+
+    const NeighborCache& getNeighborCache() const {
+        return neighbors;
     }
 
   protected:
     virtual void initialize();
 
-    NeighborList neighbors;
+    NeighborCache neighbors;
     Ieee802154MacAddress macBroadcast;
 
     bool autoInsert;
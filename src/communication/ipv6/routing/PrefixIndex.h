@@ -0,0 +1,274 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __COMETOS_V6_PREFIXINDEX_H_
+#define __COMETOS_V6_PREFIXINDEX_H_
+
+#include <stdint.h>
+#include "IPv6Route.h"
+#include "cometosAssert.h"
+
+namespace cometos_v6 {
+
+/**
+ * Longest prefix match over a set of routes with one hash table lookup per
+ * distinct prefix length in use, i.e., independent of the number of
+ * routes. At the root of a non-storing RPL network most routes are host
+ * routes (/128), thus a lookup typically costs one or two probes.
+ *
+ * The index does not store routes itself but keys of a route container,
+ * e.g., the positions in a StaticSList of IPv6Route pointers. Every
+ * operation gets the container, which has to return the route for a key
+ * with operator[]. Routes must not be changed while they are indexed.
+ *
+ * Only one route per prefix and length is indexed. If another one is
+ * added, it displaces the former one, which has to be restored by the
+ * caller if the displacing route is removed.
+ *
+ * The hash table uses linear probing with at least twice as many slots as
+ * routes and backward shift deletion, so it never runs full and does not
+ * degrade by removals.
+ */
+template<typename Key, uint16_t Capacity>
+class PrefixIndex {
+    template<uint16_t Slots, bool Done = (Slots >= 2 * Capacity)>
+    struct SlotCount {
+        static const uint16_t value = SlotCount<2 * Slots>::value;
+    };
+
+    template<uint16_t Slots>
+    struct SlotCount<Slots, true> {
+        static const uint16_t value = Slots;
+    };
+
+public:
+    static const Key EMPTY = (Key) ~0;
+    static const uint16_t NUM_SLOTS = SlotCount<2>::value;
+    static const uint8_t MAX_LENGTHS = Capacity < 128 ? Capacity : 128;
+
+    PrefixIndex() {
+        clear();
+    }
+
+    void clear() {
+        for (uint16_t i = 0; i < NUM_SLOTS; i++) {
+            slots[i] = EMPTY;
+        }
+        numLengths = 0;
+    }
+
+    /**
+     * Adds a route to the index.
+     *
+     * @return key of the route with the same prefix and length that is
+     *         displaced by the new one, EMPTY if there was none
+     */
+    template<class Routes>
+    Key add(Key key, Routes& routes) {
+        countLength(routes[key]->getPrefixLength());
+        return place(key, routes);
+    }
+
+    /**
+     * Indexes a route again that was displaced by add() before.
+     */
+    template<class Routes>
+    void restore(Key key, Routes& routes) {
+        place(key, routes);
+    }
+
+    /**
+     * Removes a route, which has to be called before it is removed from
+     * the container.
+     *
+     * @return true if the route was indexed, false if it was displaced
+     */
+    template<class Routes>
+    bool remove(Key key, Routes& routes) {
+        const IPv6Route* route = routes[key];
+        uncountLength(route->getPrefixLength());
+
+        uint16_t s = first(hash(route->getDestPrefix(), route->getPrefixLength()));
+        while (slots[s] != EMPTY) {
+            if (slots[s] == key) {
+                shiftBack(s, routes);
+                return true;
+            }
+            s = next(s);
+        }
+        return false;
+    }
+
+    /**
+     * @return key of the route with the longest prefix matching dest or
+     *         EMPTY if no route matches
+     */
+    template<class Routes>
+    Key find(const IPv6Address& dest, Routes& routes) const {
+        for (uint8_t i = 0; i < numLengths; i++) {
+            Key key = findExact(dest, lengths[i], routes);
+            if (key != EMPTY) {
+                return key;
+            }
+        }
+        return EMPTY;
+    }
+
+    /**
+     * @return key of the indexed route for the given prefix and length or
+     *         EMPTY if there is none
+     */
+    template<class Routes>
+    Key findExact(const IPv6Address& prefix, uint8_t length, Routes& routes) const {
+        uint16_t s = first(hash(prefix, length));
+        while (slots[s] != EMPTY) {
+            const IPv6Route* route = routes[slots[s]];
+            if (route->getPrefixLength() == length
+                    && prefix.matches(route->getDestPrefix(), length)) {
+                return slots[s];
+            }
+            s = next(s);
+        }
+        return EMPTY;
+    }
+
+    static uint16_t hash(const IPv6Address& prefix, uint8_t length) {
+        uint32_t h = length;
+        uint8_t bits = length;
+        for (uint8_t i = 0; bits > 0; i++) {
+            uint16_t part = prefix.getAddressPart(i);
+            if (bits < 16) {
+                part &= 0xFFFF << (16 - bits);
+                bits = 0;
+            } else {
+                bits -= 16;
+            }
+            h = (h ^ part) * 0x9E3779B1UL;
+        }
+        return h ^ (h >> 16);
+    }
+
+private:
+    uint16_t first(uint16_t hash) const {
+        return hash & (NUM_SLOTS - 1);
+    }
+
+    uint16_t next(uint16_t slot) const {
+        return (slot + 1) & (NUM_SLOTS - 1);
+    }
+
+    template<class Routes>
+    Key place(Key key, Routes& routes) {
+        const IPv6Route* route = routes[key];
+        uint8_t length = route->getPrefixLength();
+        uint16_t s = first(hash(route->getDestPrefix(), length));
+        while (slots[s] != EMPTY) {
+            const IPv6Route* other = routes[slots[s]];
+            if (other->getPrefixLength() == length
+                    && other->getDestPrefix().matches(route->getDestPrefix(), length)) {
+                Key displaced = slots[s];
+                slots[s] = key;
+                return displaced;
+            }
+            s = next(s);
+        }
+        slots[s] = key;
+        return EMPTY;
+    }
+
+    /**
+     * Empties slot s and moves following entries of the probe sequence
+     * back, which would otherwise become unreachable.
+     */
+    template<class Routes>
+    void shiftBack(uint16_t s, Routes& routes) {
+        uint16_t j = s;
+        slots[s] = EMPTY;
+        while (true) {
+            j = next(j);
+            if (slots[j] == EMPTY) {
+                return;
+            }
+            const IPv6Route* route = routes[slots[j]];
+            uint16_t home = first(hash(route->getDestPrefix(), route->getPrefixLength()));
+            if (((j - home) & (NUM_SLOTS - 1)) >= ((j - s) & (NUM_SLOTS - 1))) {
+                slots[s] = slots[j];
+                slots[j] = EMPTY;
+                s = j;
+            }
+        }
+    }
+
+    /** Keeps the lengths in use sorted in descending order. */
+    void countLength(uint8_t length) {
+        uint8_t i = 0;
+        while (i < numLengths && lengths[i] > length) {
+            i++;
+        }
+        if (i < numLengths && lengths[i] == length) {
+            lengthCounts[i]++;
+            return;
+        }
+        ASSERT(numLengths < MAX_LENGTHS);
+        for (uint8_t j = numLengths; j > i; j--) {
+            lengths[j] = lengths[j - 1];
+            lengthCounts[j] = lengthCounts[j - 1];
+        }
+        lengths[i] = length;
+        lengthCounts[i] = 1;
+        numLengths++;
+    }
+
+    void uncountLength(uint8_t length) {
+        for (uint8_t i = 0; i < numLengths; i++) {
+            if (lengths[i] == length) {
+                if (--lengthCounts[i] == 0) {
+                    numLengths--;
+                    for (uint8_t j = i; j < numLengths; j++) {
+                        lengths[j] = lengths[j + 1];
+                        lengthCounts[j] = lengthCounts[j + 1];
+                    }
+                }
+                return;
+            }
+        }
+    }
+
+    Key slots[NUM_SLOTS];
+    uint8_t lengths[MAX_LENGTHS];
+    Key lengthCounts[MAX_LENGTHS];
+    uint8_t numLengths;
+};
+
+}
+
+#endif
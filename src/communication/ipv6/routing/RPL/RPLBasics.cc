@@ -568,6 +568,11 @@ void RPLCodec::decodeDIO(DIO_Object &currentDIO_info, const uint8_t *data, uint1
                 i++;
                 continue;
             }
+            if(data[i] == SIXLOWPAN_CONTEXT && i + 1 < length){
+                // handled by RPLRouting::readContextOption
+                i += 2 + data[i + 1];
+                continue;
+            }
             ASSERT(1);
             return;
         }
@@ -87,7 +87,10 @@ enum {
     TRANSIT_INFORMATION =   0x06,
     SOLICITED_INFORMATON =  0x07,
     PREFIX_INFORMATION =    0x08,
-    RPL_TARGET_DESCRIPTOR = 0x09
+    RPL_TARGET_DESCRIPTOR = 0x09,
+    // 6LoWPAN Context Options (RFC 6775), which have no RPL option type
+    // assigned and are carried in the DIO like in a Router Advertisement
+    SIXLOWPAN_CONTEXT =     0x22
 };
 
 enum {
@@ -38,6 +38,7 @@
 /*INCLUDES-------------------------------------------------------------------*/
 #include "IPv6InterfaceTable.h"
 #include "RPLRouting.h"
+#include "LowpanAdaptionLayer.h"
 #include "RPLObjectiveFunction.h"
 #include "RPLObjFunction0.h"
 #include "RPLMRHOF.h"
@@ -65,7 +66,9 @@ RPLRouting::RPLRouting(const char * name) :
         neverConnected(true),
         ICMPv6Layer(NULL),
         routingTable(NULL),
-        pathSequence(0)
+        contexts(NULL),
+        pathSequence(0),
+        interfaceTable(this, INTERFACE_TABLE_MODULE_NAME)
 {
     //DEFAULT MACROS
     //DIO_Info
@@ -196,7 +199,7 @@ void RPLRouting::initialize(){
     DODAGInstance.neighborhood.init();
 
     if (this->DODAGInstance.DIO_info.grounded) {
-        IPv6Address ground = ((IPv6InterfaceTable *) getModule(INTERFACE_TABLE_MODULE_NAME))->getInterface(0).getGlobalAddress();
+        IPv6Address ground = interfaceTable->getInterface(0).getGlobalAddress();
         ground.setAddressPart(0,7);
         LOG_WARN("grndd, deflt Rt: " << ground.str().c_str());
 
@@ -229,6 +232,13 @@ void RPLRouting::initModules(){
     sourceRoutingTable = static_cast<RPLSourceRoutingTable *>(getModule(SOURCE_ROUTING_TABLE_MODULE_NAME));
             ASSERT(sourceRoutingTable!=NULL);
 #endif
+
+    LowpanAdaptionLayer * lowpan = static_cast<LowpanAdaptionLayer *>(getModule(LOWPAN_MODULE_NAME));
+    if (lowpan != NULL) {
+        contexts = &lowpan->getContextTable();
+        // the root learns the contexts for its DODAG
+        contexts->setOriginator(DODAGInstance.root);
+    }
 }
 
 void RPLRouting::secondStageInitialize(cometos::Message* msg) {
@@ -265,8 +275,8 @@ void RPLRouting::rootDODAG(){
     DODAGInstance.neighborhood.removeAllNeighbors();
     //TODO RoutingTable what to do with packages with no goal -> so far ignored !!!!
 
-    ASSERT(getModule(INTERFACE_TABLE_MODULE_NAME)!=NULL);
-    this->DODAGInstance.DIO_info.DODAGID = ((IPv6InterfaceTable *) getModule(INTERFACE_TABLE_MODULE_NAME))->getInterface(0).getGlobalAddress();
+    ASSERT(interfaceTable.get()!=NULL);
+    this->DODAGInstance.DIO_info.DODAGID = interfaceTable->getInterface(0).getGlobalAddress();
 
     //Node connected if it creates a tree
     connected = true;
@@ -612,7 +622,7 @@ void RPLRouting::choosePrefParent(parentChangeCause cause){
 
 
         RPL_target tempRPL_t(128,
-                ((IPv6InterfaceTable *) getModule(INTERFACE_TABLE_MODULE_NAME))->getInterface(0).getGlobalAddress(),
+                interfaceTable->getInterface(0).getGlobalAddress(),
                 0);
         //not sure about the newParent->getIpAdress()
 
@@ -719,7 +729,7 @@ void RPLRouting::icmpMessageReceived(const IPv6Address &src, const IPv6Address &
 
 void RPLRouting::handleDIO(const IPv6Address &src, const uint8_t *data, uint16_t length){
 
-    IPv6Address ownIP = ((IPv6InterfaceTable *) getModule(INTERFACE_TABLE_MODULE_NAME))->getInterface(0).getLocalAddress();
+    IPv6Address ownIP = interfaceTable->getInterface(0).getLocalAddress();
     if(ownIP == src) {
         LOG_DEBUG("DIO from myself, ignoring ");
         return;
@@ -734,6 +744,10 @@ void RPLRouting::handleDIO(const IPv6Address &src, const uint8_t *data, uint16_t
 
     RPLCodec::decodeDIO(currentDIO_info, data, length);
 
+    if (!connected || currentDIO_info.DODAGID == DODAGInstance.DIO_info.DODAGID) {
+        readContextOption(data, length);
+    }
+
     //Unknown neighbor?
     uint8_t neighborIndex = DODAGInstance.neighborhood.findNeighborIndex(src);
 
@@ -989,7 +1003,7 @@ void RPLRouting::handleDAO(const IPv6Address &src, const uint8_t *data, uint16_t
         if(storing){
             currentIndex = DAO_Information.findTarget(currentDAO_info.RPL_Targets[i].target);
             //Loop check
-            if(currentDAO_info.RPL_Targets[i].target == ((IPv6InterfaceTable *) getModule(INTERFACE_TABLE_MODULE_NAME))->getInterface(0).getGlobalAddress()){
+            if(currentDAO_info.RPL_Targets[i].target == interfaceTable->getInterface(0).getGlobalAddress()){
                 //node is in sub tree of node
                 poisonSubDAG = true;
                 //TODO - loop avoidance
@@ -1022,7 +1036,7 @@ void RPLRouting::handleDAO(const IPv6Address &src, const uint8_t *data, uint16_t
         else {
             currentIndex = DAO_Information.findTarget(currentDAO_info.RPL_Targets[i].target);
             //Loop check
-            if(currentDAO_info.RPL_Targets[i].target == ((IPv6InterfaceTable *) getModule(INTERFACE_TABLE_MODULE_NAME))->getInterface(0).getGlobalAddress()){
+            if(currentDAO_info.RPL_Targets[i].target == interfaceTable->getInterface(0).getGlobalAddress()){
                 //node is in sub tree of node
                 poisonSubDAG = true;
                 //TODO - loop avoidance
@@ -1078,7 +1092,7 @@ void RPLRouting::handleDAO(const IPv6Address &src, const uint8_t *data, uint16_t
         else {
             if (sourceRoutingTable->doLongestPrefixMatch(DAO_Information.RPL_Targets[j].target) != NULL) {
                 IPv6Address nextHop = sourceRoutingTable->doLongestPrefixMatch(DAO_Information.RPL_Targets[j].target)->getNextHop();
-                LOG_DEBUG("Next hop: " << << nextHop.str().c_str());
+                LOG_DEBUG("Next hop: " << nextHop.str().c_str());
             } else {
                 LOG_WARN("No Route to target " << target.str().c_str());
             }
@@ -1132,7 +1146,7 @@ void RPLRouting::sendDIS(){
 
 
 void RPLRouting::sendDIO(){
-    IPv6Address source = ((IPv6InterfaceTable *) getModule(INTERFACE_TABLE_MODULE_NAME))->getInterface(0).getLocalAddress(); //.getGlobalAddress()
+    IPv6Address source = interfaceTable->getInterface(0).getLocalAddress(); //.getGlobalAddress()
     LOG_DEBUG("Sending DIO from: " <<source.str().c_str());
     LOG_DEBUG("to: Multicast" << " rank: " << DODAGInstance.DIO_info.rank);
     //TODO create Buffer field direct acces?
@@ -1146,6 +1160,8 @@ void RPLRouting::sendDIO(){
 
     uint16_t length = RPLCodec::encodeDIO(&DIO_Buffer[0], DODAGInstance.DIO_info, pad1, padN, DAG_MetricContainer, routingInfo, DODAG_Config, prefixInfo);
 
+    length += writeContextOption(&DIO_Buffer[length], MAX_LENGTH - length - 1);
+
     ASSERT(length < MAX_LENGTH);
 
     //TEST TEST encode and decode
@@ -1236,6 +1252,48 @@ void RPLRouting::sendDIO(){
     }
 }
 
+uint16_t RPLRouting::writeContextOption(uint8_t *data, uint16_t size){
+    if (contexts == NULL || size < 2 + LowpanContextTable::OPTION_LENGTH) {
+        return 0;
+    }
+    // all contexts in a single option, whose length is limited to 255
+    uint16_t space = size - 2;
+    if (space > 255) {
+        space = 255;
+    }
+    uint16_t length = contexts->writeOptions(&data[2], space);
+    if (length == 0) {
+        return 0;
+    }
+    data[0] = SIXLOWPAN_CONTEXT;
+    data[1] = length;
+    return 2 + length;
+}
+
+void RPLRouting::readContextOption(const uint8_t *data, uint16_t length){
+    if (contexts == NULL) {
+        return;
+    }
+    uint16_t i = DIO_MIN_LENGTH;
+    while (i + 1 < length) {
+        if (data[i] == PAD1) {
+            i++;
+            continue;
+        }
+        uint16_t end = i + 2 + data[i + 1];
+        if (end > length) {
+            return;
+        }
+        if (data[i] == SIXLOWPAN_CONTEXT) {
+            uint16_t j = i + 2;
+            while (j < end && contexts->readOption(&data[j], end - j)) {
+                j += data[j + 1] * 8;
+            }
+        }
+        i = end;
+    }
+}
+
 void RPLRouting::sendDAO(){
     //SECURITY MEASSURE
     if(DODAGInstance.root){ // TODO: There was a "&& storing", why?
@@ -1263,7 +1321,7 @@ void RPLRouting::sendDAO(){
     first4Bytes[0] = DAO_Buffer[0] + (DAO_Buffer[1] << 8);
     first4Bytes[1] = DAO_Buffer[2] + (DAO_Buffer[3] << 8);
 
-    IPv6Address source = ((IPv6InterfaceTable *) getModule(INTERFACE_TABLE_MODULE_NAME))->getInterface(0).getLocalAddress();
+    IPv6Address source = interfaceTable->getInterface(0).getLocalAddress();
     IPv6Address target = DODAGInstance.neighborhood.getPrefParent()->getIpAdress();
 
     //It should be a difference between storing and non-storing!
@@ -50,6 +50,8 @@
 #include "RPLRoutingTable.h"
 #include "RPLSourceRoutingTable.h"
 #include "Module.h"
+#include "IPv6InterfaceTable.h"
+#include "LowpanContextTable.h"
 namespace cometos_v6 {
 
 #define RPL_MODULE_NAME "rm"
@@ -190,6 +192,18 @@ private:
     //receive DIO
     void handleDIO(const IPv6Address &src, const uint8_t *data, uint16_t length);
 
+    /**
+     * Appends the 6LoWPAN header compression contexts to a DIO.
+     *
+     * @return number of bytes appended
+     */
+    uint16_t writeContextOption(uint8_t *data, uint16_t size);
+
+    /**
+     * Takes over the 6LoWPAN header compression contexts of a DIO.
+     */
+    void readContextOption(const uint8_t *data, uint16_t length);
+
     //receive DIS
     void handleDIS(const uint8_t *data, uint16_t length);
 
@@ -247,6 +261,9 @@ private:
     RPLSourceRoutingTable * sourceRoutingTable;
 #endif
 
+    // contexts of the 6LoWPAN layer, NULL if there is none
+    LowpanContextTable * contexts;
+
     //TODO BETTER BUFFER SOLUTION MAGIC NUMBER
     uint8_t DIO_Buffer[MAX_LENGTH];
     uint8_t DAO_Buffer[MAX_LENGTH];
@@ -255,6 +272,8 @@ private:
 
     uint8_t pathSequence;
 
+    cometos::ModuleRef<IPv6InterfaceTable> interfaceTable;
+
     void setMetric(uint8_t value);
 
     void updateMetric(uint8_t value);
@@ -268,7 +287,14 @@ private:
     cometos::Message msg;
 
 public:
-    bool isRoot = DODAGInstance.root;
+    /*
+     * True for the root of a non-storing DODAG, which routes downwards
+     * with source routing headers.
+     */
+    bool isNonStoringRoot() const {
+        return (DODAGInstance.DIO_info.MOP == MOP_NON_STORING) &&
+                DODAGInstance.root;
+    }
 };
 
 /*****************************************************************************************************/
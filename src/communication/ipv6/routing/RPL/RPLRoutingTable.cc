@@ -77,21 +77,10 @@ route_key_t RPLRoutingTable::modifyRoute(const IPv6Address * destPrefix,
                             int metric)
 {
 
-    uint8_t index = routeList.begin();
-
-
-    IPv6Route *route = routeList.get(index);
-
-    while(index != routeList.end()){
-        LOG_DEBUG("route" << route->getDestPrefix().str());
-
-        route = routeList.get(index);
-
-        if(route->getDestPrefix() == *destPrefix){
-            routeList.erase(index);
-            index = routeList.end();
-        } else {
-            index = routeList.next(index);
+    for (uint8_t index = routeList.begin(); index != routeList.end(); index = routeList.next(index)) {
+        if(routeList[index]->getDestPrefix() == *destPrefix){
+            eraseRoute(index);
+            break;
         }
     }
 
@@ -122,6 +111,7 @@ route_key_t RPLRoutingTable::internAddRoute(IPv6Route * route) {
     } else {
         LOG_DEBUG("Ins rt " << route->getNextHop().getAddressPart(7));
     }
+    indexRoute(rk);
     return rk;
 }
 
@@ -177,9 +167,7 @@ bool RPLRoutingTable::deleteRoute(IPv6Address ip, DAO_Object DAO_info){
             LOG_WARN("Del route " << cometos::hex << route->getDestPrefix().getAddressPart(7) << cometos::dec
                     << "/" << (int)(route->getPrefixLength())
                     << " over " << cometos::hex << route->getNextHop().getAddressPart(7) << cometos::dec);
-            uint8_t newIndex = routeList.next(index);
-            routeList.erase(index);
-            index = newIndex;
+            index = eraseRoute(index);
             deleted = true;
             continue;
         }
@@ -57,33 +57,13 @@ void RPLSourceRoutingTable::initialize() {
 }
 
 const IPv6Route* RPLSourceRoutingTable::doLongestPrefixMatch(const IPv6Address & dest) {
-    uint8_t route = 0xFF;
-    uint8_t prefixLength = 0;
     LOG_DEBUG("Srch fr Mtch to " << dest.str());
-    for (uint8_t i=routeList.begin(); i != routeList.end(); i = routeList.next(i))
-    {
-        // TODO: Also do some checking, if the entries are expired
-        ASSERT(i != routeList.next(i));
-
-        bool prefixIsLonger = prefixLength < routeList[i]->getPrefixLength();
-        const IPv6Address & pre = routeList[i]->getDestPrefix();
-        uint8_t len = routeList[i]->getPrefixLength();
-        bool destMatches = dest.matches(pre, len);
-        if ( prefixIsLonger && destMatches)
-        {
-            LOG_DEBUG("Fnd Match dest: " << dest.str() << " found: " << routeList[i]->getDestPrefix().str());
-            prefixLength = routeList[i]->getPrefixLength();
-            LOG_DEBUG("Fnd Match length: " << (int)prefixLength);
-            route = i;
-        }
+    const IPv6Route* route = findRoute(dest);
+    if (route != NULL) {
+        LOG_DEBUG("Fnd Match dest: " << dest.str() << " found: " << route->getDestPrefix().str() << "/" << (int)route->getPrefixLength());
+        return route;
     }
 
-    LOG_DEBUG("Done");
-    if (route < 0xFF) {
-        LOG_DEBUG("found match");
-        return (routeList[route]);
-
-    }
     //FABIAN
     //return NULL;
     //Return possible default Route -> create new Route for prefix
@@ -127,21 +107,10 @@ route_key_t RPLSourceRoutingTable::modifyRoute(const IPv6Address * destPrefix,
                             int metric)
 {
 
-    uint8_t index = routeList.begin();
-
-
-    IPv6Route *route = routeList.get(index);
-
-    while(index != routeList.end()){
-        LOG_DEBUG("route" << route->getDestPrefix().str()<<"\n");
-
-        route = routeList.get(index);
-
-        if(route->getDestPrefix() == *destPrefix){
-            routeList.erase(index);
-            index = routeList.end();
-        } else {
-            index = routeList.next(index);
+    for (uint8_t index = routeList.begin(); index != routeList.end(); index = routeList.next(index)) {
+        if(routeList[index]->getDestPrefix() == *destPrefix){
+            eraseRoute(index);
+            break;
         }
     }
 
@@ -171,9 +140,30 @@ route_key_t RPLSourceRoutingTable::internAddRoute(IPv6Route * route) {
     } else {
         LOG_DEBUG("Ins rt " << route->getNextHop().getAddressPart(7));
     }
+    indexRoute(rk);
+    sourceRoutes.routeAdded(rk, route->getDestPrefix());
     return rk;
 }
 
+uint8_t RPLSourceRoutingTable::eraseRoute(uint8_t index) {
+    sourceRoutes.invalidate(index);
+    return RoutingTable::eraseRoute(index);
+}
+
+void RPLSourceRoutingTable::clearRouteList() {
+    sourceRoutes.clear();
+    RoutingTable::clearRouteList();
+}
+
+const SourceRoute* RPLSourceRoutingTable::getSourceRoute(const IPv6Address & dest) {
+    // only host routes end at dest, the RH3 is built from their targets
+    route_key_t rk = routeIndex.findExact(dest, 128, routeList);
+    if (rk == RouteIndex::EMPTY) {
+        return NULL;
+    }
+    return sourceRoutes.get(rk, *this, routeList, routeIndex);
+}
+
 //FABIAN KROME
 
 void RPLSourceRoutingTable::updateDefaultRoute(const IPv6Address * nextHop,
@@ -211,9 +201,7 @@ bool RPLSourceRoutingTable::deleteRoute(IPv6Address ip, DAO_Object DAO_info){
         {
             //DAO_info.deleteTarget(DAO_info.findTarget(route->getDestPrefix()));
             LOG_DEBUG("route " << route->getDestPrefix().str() << "/" << (int)(route->getPrefixLength()) << " over " << route->getNextHop().str());
-            uint8_t newIndex = routeList.next(index);
-            routeList.erase(index);
-            index = newIndex;
+            index = eraseRoute(index);
             deleted = true;
             continue;
         }
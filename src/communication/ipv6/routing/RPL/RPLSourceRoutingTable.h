@@ -40,6 +40,7 @@
 #include "Module.h"
 #include "RPLBasics.h"
 #include "RoutingTable.h"
+#include "SourceRouteCache.h"
 
 namespace cometos_v6 {
 
@@ -83,10 +84,22 @@ public:
 
     const IPv6Route* getDefaultRoute() const { return defaultRoute;}
 
+    /**
+     * @return source route from the root to dest, NULL if there is no
+     *         host route to dest or the path is invalid
+     */
+    const SourceRoute* getSourceRoute(const IPv6Address & dest);
+
+    virtual void clearRouteList();
+
 protected:
     virtual void initialize();
     route_key_t internAddRoute(IPv6Route * route);
 
+    virtual uint8_t eraseRoute(uint8_t index);
+
+    SourceRouteCache sourceRoutes;
+
 };
 
 }
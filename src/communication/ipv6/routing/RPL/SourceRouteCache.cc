@@ -0,0 +1,221 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "SourceRouteCache.h"
+#include "IPv6RoutingHeader.h"
+#include <string.h>
+
+namespace cometos_v6 {
+
+static uint8_t commonPrefixBytes(const IPv6Address& a, const IPv6Address& b) {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        uint16_t diff = a.getAddressPart(i) ^ b.getAddressPart(i);
+        if (diff != 0) {
+            return (diff & 0xFF00) ? n : n + 1;
+        }
+        n += 2;
+    }
+    return n;
+}
+
+SourceRouteCache::SourceRouteCache() {
+    for (uint8_t i = 0; i < RoutingTable::RT_ROUTING_TABLE_SIZE; i++) {
+        entries[i].header = NULL;
+        valid[i] = false;
+    }
+}
+
+SourceRouteCache::~SourceRouteCache() {
+    clear();
+}
+
+const SourceRoute* SourceRouteCache::get(route_key_t rk,
+                                         const RoutingTable& table,
+                                         RoutingTable::RouteList& routes,
+                                         const RoutingTable::RouteIndex& index) {
+    if (valid[rk]) {
+        return &entries[rk];
+    }
+
+    // follow the DAO parents up to the root or to a cached path
+    route_key_t chain[SOURCE_ROUTE_MAX_HOPS + 1];
+    uint8_t length = 0;
+    route_key_t top = NO_PARENT;
+    const IPv6Address* unresolved = NULL;
+    route_key_t cur = rk;
+    while (true) {
+        if (length == SOURCE_ROUTE_MAX_HOPS + 1) {
+            LOG_WARN("Src rt too long");
+            return NULL;
+        }
+        chain[length++] = cur;
+        const IPv6Address& parent = routes[cur]->getNextHop();
+        if (table.isLocalAddress(parent)) {
+            break;
+        }
+        cur = index.findExact(parent, 128, routes);
+        if (cur == RoutingTable::RouteIndex::EMPTY) {
+            // no DAO of the parent yet, assume it to be our neighbor
+            unresolved = &parent;
+            break;
+        }
+        if (valid[cur]) {
+            top = cur;
+            break;
+        }
+    }
+
+    // build the entries from the root downwards
+    for (uint8_t i = length; i-- > 0;) {
+        route_key_t parent = (i == length - 1) ? top : chain[i + 1];
+        if (!build(chain[i], parent, unresolved, routes)) {
+            return NULL;
+        }
+    }
+    return &entries[rk];
+}
+
+bool SourceRouteCache::build(route_key_t rk, route_key_t parent,
+                             const IPv6Address* unresolved,
+                             RoutingTable::RouteList& routes) {
+    SourceRoute& e = entries[rk];
+    const IPv6Address& target = routes[rk]->getDestPrefix();
+
+    IPv6Address hops[SOURCE_ROUTE_MAX_HOPS];
+    uint8_t numHops = 0;
+    if (parent != NO_PARENT) {
+        const SourceRoute& p = entries[parent];
+        if (p.segments >= SOURCE_ROUTE_MAX_HOPS) {
+            LOG_WARN("Src rt too long");
+            return false;
+        }
+        e.firstHop = p.firstHop;
+        for (uint8_t i = 0; i < p.segments; i++) {
+            hops[numHops++] = IPv6RoutingHeader::getAddress(p.header, p.headerLength, i, p.firstHop);
+        }
+        hops[numHops++] = target;
+    } else if (unresolved != NULL) {
+        e.firstHop = *unresolved;
+        hops[numHops++] = target;
+    } else {
+        e.firstHop = target;
+    }
+
+    delete[] e.header;
+    e.header = NULL;
+    e.headerLength = 0;
+    e.segments = numHops;
+    parents[rk] = parent;
+    valid[rk] = true;
+    if (numHops == 0) {
+        return true;
+    }
+
+    // elide the prefix all hops share with the first hop; since the
+    // destination address is swapped with the hops on the way, the same
+    // number of bytes is elided for all of them (RFC 6554, 4.2)
+    uint8_t elided = 15;
+    for (uint8_t i = 0; i < numHops; i++) {
+        uint8_t common = commonPrefixBytes(hops[i], e.firstHop);
+        if (common < elided) {
+            elided = common;
+        }
+    }
+    uint8_t cmprI = numHops > 1 ? elided : 0;
+    uint8_t cmprE = elided;
+    uint8_t addressBytes = (numHops - 1) * (16 - cmprI) + (16 - cmprE);
+    uint8_t pad = (8 - (addressBytes & 0x7)) & 0x7;
+
+    e.headerLength = 4 + addressBytes + pad;
+    e.header = new uint8_t[e.headerLength];
+    e.header[0] = (cmprI << 4) | cmprE;
+    e.header[1] = pad << 4;
+    e.header[2] = 0;
+    e.header[3] = 0;
+
+    uint8_t pos = 4;
+    for (uint8_t i = 0; i < numHops; i++) {
+        uint8_t address[16];
+        uint8_t elide = (i == numHops - 1) ? cmprE : cmprI;
+        hops[i].writeAddress(address);
+        memcpy(e.header + pos, address + elide, 16 - elide);
+        pos += 16 - elide;
+    }
+    memset(e.header + pos, 0, pad);
+    return true;
+}
+
+void SourceRouteCache::invalidate(route_key_t rk) {
+    if (!valid[rk]) {
+        return;
+    }
+    drop(rk);
+
+    // drop the subtree, entries are dropped if their parent was
+    bool dropped = true;
+    while (dropped) {
+        dropped = false;
+        for (uint8_t i = 0; i < RoutingTable::RT_ROUTING_TABLE_SIZE; i++) {
+            if (valid[i] && parents[i] != NO_PARENT && !valid[parents[i]]) {
+                drop(i);
+                dropped = true;
+            }
+        }
+    }
+}
+
+void SourceRouteCache::routeAdded(route_key_t rk, const IPv6Address& address) {
+    invalidate(rk);
+    // paths that end at the new route, which were assumed to start there
+    for (uint8_t i = 0; i < RoutingTable::RT_ROUTING_TABLE_SIZE; i++) {
+        if (valid[i] && parents[i] == NO_PARENT && entries[i].firstHop == address) {
+            invalidate(i);
+        }
+    }
+}
+
+void SourceRouteCache::clear() {
+    for (uint8_t i = 0; i < RoutingTable::RT_ROUTING_TABLE_SIZE; i++) {
+        if (valid[i]) {
+            drop(i);
+        }
+    }
+}
+
+void SourceRouteCache::drop(route_key_t rk) {
+    delete[] entries[rk].header;
+    entries[rk].header = NULL;
+    valid[rk] = false;
+}
+
+}
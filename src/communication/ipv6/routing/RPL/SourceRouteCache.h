@@ -0,0 +1,119 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __COMETOS_V6_SOURCEROUTECACHE_H_
+#define __COMETOS_V6_SOURCEROUTECACHE_H_
+
+#include "RoutingTable.h"
+
+namespace cometos_v6 {
+
+/** maximum number of addresses in a source routing header */
+#ifndef SOURCE_ROUTE_MAX_HOPS
+#define SOURCE_ROUTE_MAX_HOPS 8
+#endif
+
+/**
+ * Downward path from the root to a target in non-storing mode, ready to be
+ * sent as RPL source routing header (RFC 6554). The datagram is addressed
+ * to firstHop and carries the remaining hops and the target in header.
+ */
+struct SourceRoute {
+    IPv6Address firstHop;
+    // data of the routing header following the fixed part, i.e.,
+    // CmprI/CmprE/Pad, the compressed addresses and the padding;
+    // NULL if the target is a neighbor of the root
+    uint8_t* header;
+    uint8_t headerLength;
+    uint8_t segments;
+};
+
+/**
+ * Source routes of the root for the targets of an RPLSourceRoutingTable,
+ * indexed by their route key. Routes are built when first requested
+ * from the DAO parent relations, which are the next hops of the host
+ * routes, and kept until the route of the target or of one of the hops
+ * changes. Since every entry references its parent, this invalidates the
+ * whole subtree below a changed route.
+ */
+class SourceRouteCache {
+public:
+    static const uint8_t NO_PARENT = 0xFF;
+
+    SourceRouteCache();
+
+    ~SourceRouteCache();
+
+    /**
+     * @param rk     key of the route to the target
+     * @param table  table the routes belong to, used to detect the root
+     * @return source route to the target or NULL if the path is longer
+     *         than SOURCE_ROUTE_MAX_HOPS or contains a loop
+     */
+    const SourceRoute* get(route_key_t rk,
+                           const RoutingTable& table,
+                           RoutingTable::RouteList& routes,
+                           const RoutingTable::RouteIndex& index);
+
+    /**
+     * Drops the source routes via the given route, which has to be called
+     * before a route is changed or removed.
+     */
+    void invalidate(route_key_t rk);
+
+    /**
+     * Drops the source routes that may pass a route that was added for
+     * the given address.
+     */
+    void routeAdded(route_key_t rk, const IPv6Address& address);
+
+    void clear();
+
+private:
+    /**
+     * Builds the entry of a route by appending its target to the path of
+     * its parent, whose entry has to be valid.
+     */
+    bool build(route_key_t rk, route_key_t parent,
+               const IPv6Address* unresolved,
+               RoutingTable::RouteList& routes);
+
+    void drop(route_key_t rk);
+
+    SourceRoute entries[RoutingTable::RT_ROUTING_TABLE_SIZE];
+    route_key_t parents[RoutingTable::RT_ROUTING_TABLE_SIZE];
+    bool valid[RoutingTable::RT_ROUTING_TABLE_SIZE];
+};
+
+}
+
+#endif
@@ -63,6 +63,8 @@ void RoutingTable::clearRouteList() {
         delete routeList.get(i);
     }
     routeList.clear();
+    routeIndex.clear();
+    displacedRoutes = 0;
 }
 
 bool RoutingTable::isRouter() const {
@@ -130,39 +132,51 @@ bool RoutingTable::isLocalAddress(const IPv6Address & address) const {
     return false;
 }
 
-const IPv6Route* RoutingTable::doLongestPrefixMatch(const IPv6Address & dest) {
-    uint8_t route = 0xFF;
-    int16_t prefixLength = -1;
-    LOG_DEBUG("Srch fr Mtch " << dest.str());
-    for (uint8_t i=routeList.begin(); i != routeList.end(); i = routeList.next(i))
-    {
-        // TODO: Also do some checking, if the entries are expired
-        ASSERT(i != routeList.next(i));
-
-        LOG_DEBUG(routeList[i]->getDestPrefix().str() << "/" << (int)routeList[i]->getPrefixLength() << " over " << routeList[i]->getNextHop().str());
-
-        bool prefixIsLonger = prefixLength < routeList[i]->getPrefixLength();
-        const IPv6Address & pre = routeList[i]->getDestPrefix();
-        uint8_t len = routeList[i]->getPrefixLength();
-        bool destMatches = dest.matches(pre, len);
-        if ( prefixIsLonger && destMatches)
-        {
-            prefixLength = routeList[i]->getPrefixLength();
-            LOG_DEBUG("Fnd Prefix Match: " << routeList[i]->getDestPrefix().str() << "/" << (int)prefixLength);
-            if (prefixLength == 128) {
-                LOG_DEBUG("Perfect Match, skip rest");
-                return (routeList[i]);
+const IPv6Route* RoutingTable::findRoute(const IPv6Address & dest) {
+    route_key_t rk = routeIndex.find(dest, routeList);
+    if (rk == RouteIndex::EMPTY) {
+        return NULL;
+    }
+    return routeList[rk];
+}
+
+void RoutingTable::indexRoute(route_key_t rk) {
+    if (routeIndex.add(rk, routeList) != RouteIndex::EMPTY) {
+        displacedRoutes++;
+    }
+}
+
+uint8_t RoutingTable::eraseRoute(uint8_t index) {
+    IPv6Route* route = routeList[index];
+    bool indexed = routeIndex.remove(index, routeList);
+    uint8_t next = routeList.erase(index);
+
+    if (!indexed) {
+        displacedRoutes--;
+    } else if (displacedRoutes > 0) {
+        // the newest of the displaced routes with this prefix takes over
+        for (uint8_t i = routeList.begin(); i != routeList.end(); i = routeList.next(i)) {
+            if (routeList[i]->getPrefixLength() == route->getPrefixLength()
+                    && routeList[i]->getDestPrefix().matches(route->getDestPrefix(), route->getPrefixLength())) {
+                routeIndex.restore(i, routeList);
+                displacedRoutes--;
+                break;
             }
-            route = i;
         }
     }
 
-    LOG_DEBUG("Done");
-    if (route < 0xFF) {
-        LOG_DEBUG("found match");
-        return (routeList[route]);
+    delete route;
+    return next;
+}
 
+const IPv6Route* RoutingTable::doLongestPrefixMatch(const IPv6Address & dest) {
+    LOG_DEBUG("Srch fr Mtch " << dest.str());
+    const IPv6Route* route = findRoute(dest);
+    if (route != NULL) {
+        LOG_DEBUG("Fnd Prefix Match: " << route->getDestPrefix().str() << "/" << (int)route->getPrefixLength());
+        return route;
     }
+
     //FABIAN
     //return NULL;
     //Return possible default Route -> create new Route for prefix
@@ -247,20 +261,10 @@ route_key_t RoutingTable::modifyRoute(const IPv6Address * destPrefix,
                             int metric)
 {
 
-    uint8_t index = routeList.begin();
-
-    IPv6Route *route = routeList.get(index);
-
-    while(index != routeList.end()){
-        LOG_DEBUG("route" << route->getDestPrefix().str()<<"\n");
-
-        route = routeList.get(index);
-
-        if(route->getDestPrefix() == *destPrefix){
-            routeList.erase(index);
-            index = routeList.end();
-        } else {
-            index = routeList.next(index);
+    for (uint8_t index = routeList.begin(); index != routeList.end(); index = routeList.next(index)) {
+        if(routeList[index]->getDestPrefix() == *destPrefix){
+            eraseRoute(index);
+            break;
         }
     }
 
@@ -295,6 +299,7 @@ route_key_t RoutingTable::internAddRoute(IPv6Route * route) {
     } else {
         LOG_DEBUG("Ins rt " << route->getDestPrefix().str() << "/" << (int)(route->getPrefixLength()) << " over " << route->getNextHop().str());
     }
+    indexRoute(rk);
     return rk;
 }
 
@@ -339,29 +344,13 @@ bool RoutingTable::deleteRoute(IPv6Address ip) { //, DAO_Object DAO_info){
         return false;
     }
 
-    IPv6Route *route = routeList.get(index);
-    uint8_t newIndex;
-
-
     while(index != routeList.end()){
+        IPv6Route *route = routeList.get(index);
         LOG_DEBUG("route" << route->getDestPrefix().str()<<"\n");
 
-        route = routeList.get(index);
-
-        if(route->getDestPrefix() == ip){
-            //DAO_info.deleteTarget(DAO_info.findTarget(route->getDestPrefix()));
-            newIndex = routeList.next(index);
-            routeList.erase(index);
-            index = newIndex;
-            deleted = true;
-            continue;
-        }
-
-        if(route->getNextHop() == ip){
+        if(route->getDestPrefix() == ip || route->getNextHop() == ip){
             //DAO_info.deleteTarget(DAO_info.findTarget(route->getDestPrefix()));
-            newIndex = routeList.next(index);
-            routeList.erase(index);
-            index = newIndex;
+            index = eraseRoute(index);
             deleted = true;
             continue;
         }
@@ -41,99 +41,14 @@
 #include "SList.h"
 #include "IPv6Address.h"
 #include "IPv6InterfaceTable.h"
+#include "IPv6Route.h"
+#include "PrefixIndex.h"
 #include "palLocalTime.h"
 
 namespace cometos_v6 {
 
 #define ROUTING_TABLE_MODULE_NAME "rt"
 
-//FABIAN
-const uint8_t NULL_PREFIX_LENGTH = 0;
-
-typedef uint8_t route_key_t;
-
-/**
- * Represents a route in the route table. Routes with src=FROM_RA represent
- * on-link prefixes advertised by routers.
- *
- * TODO this is taken from INET and most likely contains some overkill, to be revisited
- */
-class IPv6Route
-{
-  public:
-    /** Specifies where the route comes from */
-#if defined SWIG || defined BOARD_python
-    enum RouteSrc
-#else
-    enum RouteSrc : uint8_t
-#endif
-    {
-        FROM_RA,        ///< on-link prefix, from Router Advertisement
-        OWN_ADV_PREFIX, ///< on routers: on-link prefix that the router **itself** advertises on the link
-        STATIC,         ///< static route
-        ROUTING_PROT,   ///< route is managed by a routing protocol (OSPF,BGP,etc)
-    };
-
-  protected:
-    IPv6Address _destPrefix;
-    uint8_t _activeFlag:1;
-    uint8_t _prefixLength:7;
-    RouteSrc _src;
-    uint8_t _interfaceID;      //XXX IPv4 IRoutingTable uses interface pointer
-    IPv6Address _nextHop;  // unspecified means "direct"
-    time_ms_t _expiryTime;
-    uint16_t _metric;
-
-  public:
-    /**
-     * Constructor. The destination prefix and the route source is passed
-     * to the constructor and cannot be changed afterwards.
-     *
-     * TODO check which fields are really needed and if some might even have to be added
-     */
-    IPv6Route(const IPv6Address& destPrefix,
-            uint8_t length,
-            RouteSrc src,
-            uint8_t interfaceID = 0,
-            uint16_t metric = 0,
-            bool active = false):
-        _destPrefix(destPrefix),
-        _activeFlag(active),
-        _prefixLength(length-1),
-        _src(src),
-        _interfaceID(interfaceID),
-        _expiryTime(0),
-        _metric(metric)
-    {
-        // prefix length has to be a number in the range [1,128]
-        // we subtract 1 to get it into a 7-bit part of an uint8_t
-        // to get some space for an additional flag
-        ASSERT(length > 0);
-    }
-
-//    virtual std::string info() const;
-//    virtual std::string detailedInfo() const;
-    static const char *routeSrcName(RouteSrc src);
-
-    void setInterfaceId(uint8_t interfaceId)  {_interfaceID = interfaceId;}
-    void setNextHop(const IPv6Address* nextHop)  {_nextHop = *nextHop;}
-    void setExpiryTime(time_ms_t expiryTime)  {_expiryTime = expiryTime;}
-    void setMetric(uint16_t metric)  {_metric = metric;}
-
-    const IPv6Address& getDestPrefix() const {return _destPrefix;}
-    uint8_t getPrefixLength() const  {return _prefixLength+1;}
-    bool isActive() const {return _activeFlag;}
-    void setActive(bool value) {_activeFlag = value;}
-    RouteSrc getSrc() const  {return _src;}
-    uint8_t getInterfaceId() const  {return _interfaceID;}
-    const IPv6Address& getNextHop() const  {return _nextHop;}
-//    simtime_t getExpiryTime() const  {return _expiryTime;}
-    time_ms_t getExpiryTime() const {return _expiryTime;}
-    uint16_t getMetric() const  {return _metric;}
-
-};
-
-
 /**
  * Generic class storing routing information, installed there
  * by some routing protocol, neighbor discovery
@@ -152,9 +67,10 @@ public:
 #endif
 
     typedef cometos::StaticSList<IPv6Route *, RT_ROUTING_TABLE_SIZE> RouteList;
+    typedef PrefixIndex<route_key_t, RT_ROUTING_TABLE_SIZE> RouteIndex;
 
     RoutingTable(const char * service_name = NULL):
-        Module(service_name), it(NULL), defaultRoute(NULL) {}
+        Module(service_name), it(NULL), defaultRoute(NULL), displacedRoutes(0) {}
 
     virtual ~RoutingTable() { clearRouteList(); deleteDefaultRoute(); }
 
@@ -214,12 +130,33 @@ protected:
     virtual void initialize();
     route_key_t internAddRoute(IPv6Route * route);
 
+    /**
+     * @return route with the longest prefix matching dest, NULL if there
+     *         is none (the default route is not considered)
+     */
+    const IPv6Route* findRoute(const IPv6Address & dest);
+
+    /** Adds a route that was just inserted into routeList to the index. */
+    void indexRoute(route_key_t rk);
+
+    /**
+     * Removes and deletes a route.
+     *
+     * @return position of the following route in routeList
+     */
+    virtual uint8_t eraseRoute(uint8_t index);
+
     RouteList routeList;
     IPv6InterfaceTable* it;
 
     //FABIAN
     IPv6Route *defaultRoute;
 
+    RouteIndex routeIndex;
+
+    // routes with the same prefix as a newer one, which are not indexed
+    uint8_t displacedRoutes;
+
 };
 
 }
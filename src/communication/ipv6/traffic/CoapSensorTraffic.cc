@@ -0,0 +1,211 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "CoapSensorTraffic.h"
+
+namespace cometos_v6 {
+
+const char * CoapSensorTraffic::RESOURCE_PATH = "sensor";
+const char * const CoapSensorTraffic::MODULE_NAME = "cst";
+
+static void toHex(uint32_t value, uint8_t digits, char* out) {
+    for (uint8_t i = 0; i < digits; i++) {
+        uint8_t nibble = (value >> (4 * (digits - i - 1))) & 0xF;
+        out[i] = nibble < 10 ? '0' + nibble : 'a' + nibble - 10;
+    }
+}
+
+static bool fromHex(const uint8_t* data, uint8_t digits, uint32_t& value) {
+    value = 0;
+    for (uint8_t i = 0; i < digits; i++) {
+        uint8_t c = data[i];
+        if (c >= '0' && c <= '9') {
+            value = (value << 4) | (c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            value = (value << 4) | (c - 'a' + 10);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+CoapSensorResource::CoapSensorResource() :
+    CoAPObservableResource(),
+    numRequests(0)
+{
+    toHex(0, REPR_LEN, state);
+    state[REPR_LEN] = 0;
+}
+
+CoapSensorResource::~CoapSensorResource() {
+}
+
+void CoapSensorResource::update(uint16_t seq, time_ms_t time) {
+    toHex(seq, 4, state);
+    toHex(time, 8, &state[4]);
+    changed();
+}
+
+void CoapSensorResource::handleRequest(cometos_v6::CoAPMessage* request) {
+    if (request->getMessageCode() == COAP_GET) {
+        numRequests++;
+    }
+    CoAPObservableResource::handleRequest(request);
+}
+
+char* CoapSensorResource::getRepresentation() {
+    return state;
+}
+
+void CoapSensorResource::setRepresentation(const char* repr, uint16_t len) {
+    ASSERT(len == REPR_LEN);
+    memcpy(state, repr, REPR_LEN);
+}
+
+bool CoapSensorResource::decode(const uint8_t* data, uint16_t len,
+        uint16_t& seq, time_ms_t& time) {
+    uint32_t value;
+    if (data == NULL || len != REPR_LEN || !fromHex(data, 4, value)) {
+        return false;
+    }
+    seq = value;
+    if (!fromHex(&data[4], 8, value)) {
+        return false;
+    }
+    time = value;
+    return true;
+}
+
+
+CoapSensorTraffic::CoapSensorTraffic(const char * service_name) :
+    Module(service_name),
+    coap(NULL),
+    isMaster(false),
+    observe(true),
+    localPort(COAP_PORT + 1),
+    changeInterval(10000),
+    pollInterval(1000),
+    minNotificationInterval(0),
+    seq(0),
+    numRequests(0),
+    numResponses(0)
+{
+}
+
+CoapSensorTraffic::~CoapSensorTraffic() {
+}
+
+void CoapSensorTraffic::initialize() {
+    coap = (CoAPLayer *) getModule(CoAPLayer::MODULE_NAME);
+    ASSERT(coap != NULL);
+
+    bool isSensor = false;
+
+    CONFIG_NED(isMaster);
+    CONFIG_NED(isSensor);
+    CONFIG_NED(observe);
+    CONFIG_NED(localPort);
+    CONFIG_NED(changeInterval);
+    CONFIG_NED(pollInterval);
+    CONFIG_NED(minNotificationInterval);
+
+    if (isMaster) {
+        localPort = coap->bindPort(this, localPort);
+        currNode = initializeTargetList();
+        if (currNode != IPv6Address(0,0,0,0,0,0,0,0)) {
+            schedule(&requestMsg, &CoapSensorTraffic::requestNext, pollInterval);
+        }
+    } else if (isSensor) {
+        sensor.setRessourceData(&RESOURCE_PATH, 1, COAP_RES_R, COAP_PORT, NULL);
+        sensor.setMinNotificationInterval(minNotificationInterval);
+        coap->insertResource(&sensor);
+
+        schedule(&changeMsg, &CoapSensorTraffic::sensorChanged,
+                changeInterval / 2 + intrand(changeInterval));
+    }
+}
+
+void CoapSensorTraffic::finish() {
+    cancel(&changeMsg);
+    cancel(&requestMsg);
+
+    RECORD_SCALAR(numRequests);
+    RECORD_SCALAR(numResponses);
+}
+
+void CoapSensorTraffic::incommingCoAPHandler(const CoAPMessage* message, const bool state) {
+    ENTER_METHOD_SILENT();
+    uint16_t valueSeq;
+    time_ms_t changed;
+    if (state && CoapSensorResource::decode(message->getMessagePayload(),
+            message->getMessagePayloadLen(), valueSeq, changed))
+    {
+        LOG_DEBUG("Value " << valueSeq << " from " << message->getAddr().str());
+        numResponses++;
+        valueReceived(message->getAddr(), valueSeq, changed);
+    }
+}
+
+void CoapSensorTraffic::sensorChanged(cometos::Message * msg) {
+    seq++;
+    sensor.update(seq, palLocalTime_get());
+    schedule(&changeMsg, &CoapSensorTraffic::sensorChanged,
+            changeInterval / 2 + intrand(changeInterval));
+}
+
+void CoapSensorTraffic::requestNext(cometos::Message * msg) {
+    cometos_v6::URL url(cometos_v6::URL::COAP, currNode);
+    url.addURIPart(RESOURCE_PATH, strlen(RESOURCE_PATH), URIPart::URIPATH);
+
+    // observers register once, polling continues for all targets
+    CoAPMessageOption opt(CoAPMessageOption::OPT_OBSERVE);
+
+    int8_t error = coap->sendMessage(url,
+                            localPort,
+                            cometos_v6::COAP_CON,
+                            cometos_v6::COAP_GET,
+                            &opt, observe ? 1 : 0,
+                            NULL, 0,
+                            false,
+                            0);
+    (void) error; // remove unused warning
+    LOG_DEBUG("SEND GET to " << currNode.str() << "; error=" << (uint16_t) error);
+    numRequests++;
+
+    bool listFinished = getNextTarget(&currNode);
+    if (!observe || !listFinished) {
+        schedule(&requestMsg, &CoapSensorTraffic::requestNext, pollInterval);
+    }
+}
+
+} /* namespace cometos_v6 */
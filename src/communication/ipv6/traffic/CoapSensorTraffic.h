@@ -0,0 +1,158 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef COAP_SENSOR_TRAFFIC_H_
+#define COAP_SENSOR_TRAFFIC_H_
+
+#include "cometos.h"
+#include "CoAPLayer.h"
+#include "CoAPObservableResource.h"
+#include "palLocalTime.h"
+
+namespace cometos_v6 {
+
+/**
+ * Observable CoAP resource holding the latest value of a sensor, i.e. a
+ * sequence number of the change and the time it happened.
+ */
+class CoapSensorResource : public CoAPObservableResource {
+public:
+    static const uint8_t REPR_LEN = 12;
+
+    CoapSensorResource();
+    virtual ~CoapSensorResource();
+
+    /**
+     * Sets a new value and notifies the observers.
+     */
+    void update(uint16_t seq, time_ms_t time);
+
+    virtual void handleRequest(cometos_v6::CoAPMessage* request);
+
+    virtual char* getRepresentation();
+    virtual void setRepresentation(const char* repr, uint16_t len);
+
+    uint16_t getNumRequests() const { return numRequests; }
+
+    /**
+     * Decodes a representation as sent by this resource.
+     *
+     * @return false, if data does not contain a sensor value
+     */
+    static bool decode(const uint8_t* data, uint16_t len,
+            uint16_t& seq, time_ms_t& time);
+
+private:
+    char state[REPR_LEN + 1];
+    uint16_t numRequests;
+};
+
+
+/**
+ * Compares pushing sensor values via CoAP Observe with polling them.
+ *
+ * Sensor nodes change their value in random intervals, which have a mean of
+ * changeInterval. The master either registers as observer at all targets
+ * (observe == true) or sends a GET to the next target every pollInterval.
+ * Subclasses provide the targets and evaluate the time between a change and
+ * its arrival at the master, as well as the changes never seen by it.
+ */
+class CoapSensorTraffic : public cometos::Module, public CoAPListener {
+public:
+    static const char * RESOURCE_PATH;
+    static const char * const MODULE_NAME;
+
+    CoapSensorTraffic(const char * service_name = MODULE_NAME);
+    virtual ~CoapSensorTraffic();
+
+    virtual void initialize();
+
+    virtual void finish();
+
+    /**
+     * Called by CoAP on reception of a response or notification
+     */
+    virtual void incommingCoAPHandler(const CoAPMessage* message, const bool state);
+
+protected:
+    /**
+     * Read or create the node list to use, must be overwritten by subclass
+     */
+    virtual IPv6Address initializeTargetList() = 0;
+
+    /**
+     * Get the next target node.
+     *
+     * @param[out] addr contains the next target in the list
+     * @return true, if the end of the list was reached and the first
+     *         element is returned
+     */
+    virtual bool getNextTarget(IPv6Address * addr) = 0;
+
+    /**
+     * Called at the master for every sensor value received.
+     */
+    virtual void valueReceived(const IPv6Address& src, uint16_t seq,
+            time_ms_t changed) = 0;
+
+    const CoapSensorResource& getSensor() const { return sensor; }
+
+    uint16_t getNumChanges() const { return seq; }
+
+private:
+    void sensorChanged(cometos::Message * msg);
+
+    void requestNext(cometos::Message * msg);
+
+    CoAPLayer* coap;
+    CoapSensorResource sensor;
+
+    bool isMaster;
+    bool observe;
+    uint16_t localPort;
+    uint16_t changeInterval;
+    uint16_t pollInterval;
+    uint16_t minNotificationInterval;
+
+    IPv6Address currNode;
+    uint16_t seq;
+
+    uint16_t numRequests;
+    uint16_t numResponses;
+
+    cometos::Message changeMsg;
+    cometos::Message requestMsg;
+};
+
+} /* namespace cometos_v6 */
+
+#endif /* COAP_SENSOR_TRAFFIC_H_ */
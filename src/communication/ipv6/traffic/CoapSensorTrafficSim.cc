@@ -0,0 +1,139 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "CoapSensorTrafficSim.h"
+#include "TrafficGenSim.h"
+#include "XMLParseUtil.h"
+#include "NeighborDiscovery.h"
+#include "palId.h"
+
+namespace cometos_v6 {
+
+Define_Module(CoapSensorTrafficSim);
+
+CoapSensorTrafficSim::CoapSensorTrafficSim() :
+    CoapSensorTraffic(),
+    numMissed(0),
+    numUnchanged(0)
+{
+}
+
+CoapSensorTrafficSim::~CoapSensorTrafficSim() {
+}
+
+void CoapSensorTrafficSim::initialize() {
+    stalenessVector.setName("staleness");
+    CoapSensorTraffic::initialize();
+}
+
+void CoapSensorTrafficSim::finish() {
+    CoapSensorTraffic::finish();
+
+    double n = staleness.n();
+    double sum = staleness.getSum();
+    double sqrsum = staleness.getSqrSum();
+
+    uint32_t numValues = staleness.n();
+    double stalenessAvg = n > 0 ? sum / n : 0;
+    double stalenessVar = TrafficGenSim::getVarFromSqrSum(n, sum, sqrsum);
+    uint32_t stalenessMax = staleness.getMax();
+
+    uint16_t numChanges = getNumChanges();
+    uint32_t numNotifications = getSensor().getNumNotifications();
+    uint32_t numCoalesced = getSensor().getNumCoalesced();
+    uint16_t numPolled = getSensor().getNumRequests();
+
+    RECORD_SCALAR(numChanges);
+    RECORD_SCALAR(numNotifications);
+    RECORD_SCALAR(numCoalesced);
+    RECORD_SCALAR(numPolled);
+
+    RECORD_SCALAR(numValues);
+    RECORD_SCALAR(numMissed);
+    RECORD_SCALAR(numUnchanged);
+    RECORD_SCALAR(stalenessAvg);
+    RECORD_SCALAR(stalenessVar);
+    RECORD_SCALAR(stalenessMax);
+}
+
+IPv6Address CoapSensorTrafficSim::initializeTargetList() {
+    omnetpp::cXMLElement* targetsFile;
+    CONFIG_NED(targetsFile);
+    omnetpp::cXMLElementList xmlnodes = targetsFile->getElementsByTagName(MT_NODE_ID_NAME);
+    for (omnetpp::cXMLElementList::iterator itNodes = xmlnodes.begin(); itNodes != xmlnodes.end(); itNodes++) {
+           node_t currNode = XMLParseUtil::getAddressFromAttribute(*itNodes, "id");
+           if(palId_id() != currNode) {
+               IPv6Address addr(IP_NWK_PREFIX);
+               addr.setAddressPart(currNode, 7);
+               nodeList.push_front(addr);
+           }
+    }
+
+    active = nodeList.begin();
+    if (active != nodeList.end()) {
+        return *active;
+    } else {
+        return IPv6Address(0,0,0,0,0,0,0,0);
+    }
+}
+
+bool CoapSensorTrafficSim::getNextTarget(IPv6Address * addr) {
+    bool wrapAround = false;
+    active++;
+    if (active == nodeList.end()) {
+        active = nodeList.begin();
+        wrapAround = true;
+    }
+
+    *addr = *active;
+
+    return wrapAround;
+}
+
+void CoapSensorTrafficSim::valueReceived(const IPv6Address& src, uint16_t seq,
+        time_ms_t changed) {
+    uint16_t& last = lastSeq[src.getAddressPart(7)];
+    if ((int16_t) (seq - last) <= 0) {
+        // nothing new, e.g. polled again before the value changed
+        numUnchanged++;
+        return;
+    }
+
+    numMissed += (uint16_t) (seq - last - 1);
+    last = seq;
+
+    uint32_t delay = palLocalTime_get() - changed;
+    staleness.add(delay);
+    stalenessVector.record(delay);
+}
+
+} /* namespace cometos_v6 */
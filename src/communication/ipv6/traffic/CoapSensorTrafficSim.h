@@ -0,0 +1,81 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef COAP_SENSOR_TRAFFIC_SIM_H_
+#define COAP_SENSOR_TRAFFIC_SIM_H_
+
+#include "CoapSensorTraffic.h"
+#include "Statistics.h"
+#include <forward_list>
+#include <map>
+
+namespace cometos_v6 {
+
+/**
+ * Reads the targets from the targetsFile and records at the master how
+ * stale the values are on arrival and how many changes were missed.
+ */
+class CoapSensorTrafficSim : public CoapSensorTraffic {
+public:
+    typedef SumsMinMax<uint32_t, uint32_t, uint64_t, uint64_t> stalenessType;
+
+    CoapSensorTrafficSim();
+    virtual ~CoapSensorTrafficSim();
+
+private:
+    virtual void initialize();
+
+    virtual void finish();
+
+    virtual IPv6Address initializeTargetList();
+
+    virtual bool getNextTarget(IPv6Address * addr);
+
+    virtual void valueReceived(const IPv6Address& src, uint16_t seq,
+            time_ms_t changed);
+
+    std::forward_list<IPv6Address> nodeList;
+    std::forward_list<IPv6Address>::iterator active;
+
+    // last sequence number received from each target
+    std::map<uint16_t, uint16_t> lastSeq;
+
+    stalenessType staleness;
+    uint32_t numMissed;
+    uint32_t numUnchanged;
+
+    omnetpp::cOutVector stalenessVector;
+};
+
+} /* namespace cometos_v6 */
+
+#endif /* COAP_SENSOR_TRAFFIC_SIM_H_ */
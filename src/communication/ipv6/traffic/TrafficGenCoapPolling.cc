@@ -100,7 +100,6 @@ void TrafficGenStartSending::handleRequest(cometos_v6::CoAPMessage* request) {
                 NULL, 0,
                 getRepresentation(),
                 strlen(getRepresentation()),
-                false,
                 false);
     sendMessage(answer);
 
@@ -247,7 +246,6 @@ void TrafficGenCoapPolling::pollNext(cometos::Message * msg) {
                             NULL, 0,
                             a, SEQ_NUM_LEN,
                             false,
-                            false,
                             1);
     (void) error; // remove unused warning
     LOG_DEBUG("SEND msg; error=" << (uint16_t) error << "|expectedSeq=" << currCollection);
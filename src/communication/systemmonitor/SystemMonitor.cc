@@ -100,6 +100,28 @@ void unserialize(ByteVector& buffer, AssertShortInfo& value) {
     unserialize(buffer, value.fileId);
 }
 
+#ifdef SCHEDULER_PROFILING
+void serialize(ByteVector& buffer, const TaskProfileInfo& value) {
+    serialize(buffer, value.module);
+    serialize(buffer, value.type);
+    serialize(buffer, value.invocations);
+    serialize(buffer, value.runTime);
+    serialize(buffer, value.maxRunTime);
+    serialize(buffer, value.queueDelay);
+    serialize(buffer, value.maxQueueDelay);
+}
+
+void unserialize(ByteVector& buffer, TaskProfileInfo& value) {
+    unserialize(buffer, value.maxQueueDelay);
+    unserialize(buffer, value.queueDelay);
+    unserialize(buffer, value.maxRunTime);
+    unserialize(buffer, value.runTime);
+    unserialize(buffer, value.invocations);
+    unserialize(buffer, value.type);
+    unserialize(buffer, value.module);
+}
+#endif
+
 SystemMonitor::SystemMonitor(const char* service_name,
                              RemoteAccess* ra) :
         RemoteModule(service_name),
@@ -139,6 +161,11 @@ void SystemMonitor::initialize() {
     remoteDeclare(&SystemMonitor::assertTest, "at");
     remoteDeclare(&SystemMonitor::testAsync, "ta", "taD");
     remoteDeclare(&SystemMonitor::getFirmwareVersion, "fwv");
+#ifdef SCHEDULER_PROFILING
+    remoteDeclare(&SystemMonitor::getTaskProfile, "tp");
+    remoteDeclare(&SystemMonitor::resetTaskProfiles, "rtp");
+    remoteDeclare(&SystemMonitor::printTaskProfiles, "ptp");
+#endif
 
     schedule(new Message, &SystemMonitor::bootEvent, 0);
 
@@ -262,6 +289,34 @@ void SystemMonitor::bootEvent(Message * msg) {
     }  
 }
 
+#ifdef SCHEDULER_PROFILING
+TaskProfileInfo SystemMonitor::getTaskProfile(uint8_t & idx) {
+    TaskProfileInfo info;
+    SchedulerProfiler& profiler = getScheduler().getProfiler();
+    if (idx < profiler.getNumEntries()) {
+        const TaskProfile& entry = profiler.getEntry(idx);
+        if (entry.context != NULL) {
+            info.module.setStr(entry.context->getName());
+        }
+        info.type = (uint32_t)(uintptr_t) entry.type;
+        info.invocations = entry.invocations;
+        info.runTime = entry.runTime;
+        info.maxRunTime = entry.maxRunTime;
+        info.queueDelay = entry.queueDelay;
+        info.maxQueueDelay = entry.maxQueueDelay;
+    }
+    return info;
+}
+
+void SystemMonitor::resetTaskProfiles() {
+    getScheduler().getProfiler().reset();
+}
+
+void SystemMonitor::printTaskProfiles() {
+    getScheduler().getProfiler().print();
+}
+#endif
+
 #ifdef DEBUG_MESSAGE_ALLOCATION
 void SystemMonitor::msgAlloc() {
     Message::printAllocationCount();
@@ -41,6 +41,7 @@
 #include "firmwareVersion.h"
 #include "primitives.h"
 #include "RemoteAccess.h"
+#include "AirString.h"
 
 namespace cometos {
 
@@ -77,6 +78,30 @@ public:
 void serialize(ByteVector& buffer, const AssertShortInfo& value);
 void unserialize(ByteVector& buffer, AssertShortInfo& value);
 
+#ifdef SCHEDULER_PROFILING
+/**
+ * Remote representation of a TaskProfile, times are given in microseconds.
+ */
+class TaskProfileInfo {
+public:
+    TaskProfileInfo() :
+        type(0), invocations(0), runTime(0), maxRunTime(0), queueDelay(0),
+        maxQueueDelay(0)
+    {}
+
+    AirString module;
+    uint32_t type;
+    uint32_t invocations;
+    uint32_t runTime;
+    uint32_t maxRunTime;
+    uint32_t queueDelay;
+    uint32_t maxQueueDelay;
+};
+
+void serialize(ByteVector& buffer, const TaskProfileInfo& value);
+void unserialize(ByteVector& buffer, TaskProfileInfo& value);
+#endif
+
 /**
  * Monitoring module for CometOS. Following functionalities
  * are provided:
@@ -84,6 +109,7 @@ void unserialize(ByteVector& buffer, AssertShortInfo& value);
  * <li> memory allocation
  * <li> lists messages and message owners
  * <li> CPU utilization
+ * <li> per-module and per-task scheduler statistics (SCHEDULER_PROFILING)
  * <li> provides platform dependent services (e.g. returns identifier)
  */
 class SystemMonitor: public RemoteModule {
@@ -128,6 +154,18 @@ public:
 
 	firmwareVersion_t getFirmwareVersion();
 
+#ifdef SCHEDULER_PROFILING
+	/**
+	 * @return profile with the given index, the number of invocations
+	 *         is 0 for indices beyond the recorded entries
+	 */
+	TaskProfileInfo getTaskProfile(uint8_t & idx);
+
+	void resetTaskProfiles();
+
+	void printTaskProfiles();
+#endif
+
 #ifdef DEBUG_MESSAGE_ALLOCATION
 	void msgAlloc();
 #endif
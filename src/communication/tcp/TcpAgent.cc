@@ -36,11 +36,15 @@
 #include <string.h>
 #include "cometos.h"
 #include "OutputStream.h"
+#ifdef PAL_REACTOR
+#include "palReactor.h"
+#endif
 
 int TcpAgent::instCounter = 0;
 using namespace std;
 
-TcpAgent::TcpAgent() {
+TcpAgent::TcpAgent() :
+		readyTask(NULL) {
 
 	if (instCounter == 0) {
 		startSocketSession();
@@ -63,88 +67,127 @@ TcpAgent::~TcpAgent() {
 
 void TcpAgent::close(const socket_t& handler) {
 	cometos::getCout() << "closing " << (int32_t)handler << cometos::endl;
+	unwatch(handler);
 	conn.erase(handler);
+	rx.erase(handler);
 	shutdownAndCloseSocket(handler);
 }
 
-void TcpAgent::pollAll() {
-	uint8_t buffer[TCP_AGENT_BUFFER_SIZE];
-	std::set<socket_t> toRemove;
+bool TcpAgent::setReadyTask(cometos::Task* task) {
+#ifdef PAL_REACTOR
+	if (!palReactor_isAvailable()) {
+		return false;
+	}
+	readyTask = task;
 	if (server != INVALID_SOCKET) {
-		socket_t client = acceptClientSocket(server);
-		if (INVALID_SOCKET != client) {
-			setNonBlockingSocket(client);
-			cometos::getCout() << "Accepted client connection" << cometos::endl;
-			conn.insert(client);
-		}
+		watch(server);
 	}
-
 	for (std::set<socket_t>::iterator it = conn.begin(); it != conn.end();
 			it++) {
-
-		int c = receiveMessage((*it), buffer, 1);
-
-		if (c > 0) {
-
-			int max = (uint8_t) *buffer;
-			uint8_t offset = 0;
-			assert(max < TCP_AGENT_BUFFER_SIZE);
-			int timeout = 0;
-			while (1) {
-				c = 0;
-				c = receiveMessage((*it), buffer + offset, max - offset);
-				if (c > 0) {
-					assert(max>=c);
-					offset += c;
-					if (max == offset) {
-						receivedCallback((*it), buffer, (uint8_t) max);
-						break;
-					}
-				} else if (c == 0) {
-					cometos::getCout() << "c == 0" << cometos::endl;
-					toRemove.insert(*it);
-					break;
-				} else {
-					if (timeout > 100) {
-						cometos::getCout() << "timeout > 100ms" << cometos::endl;
-						toRemove.insert(*it);
-						break;
-					}
-					timeout++;
-#ifdef _WIN32
-					Sleep(1);
-#else
-#ifdef __linux__
-					usleep(1000);
+		watch(*it);
+	}
+	return true;
 #else
-					fnet_timer_delay(fnet_timer_ms2ticks(1));
+	return false;
 #endif
+}
+
+void TcpAgent::watch(const socket_t& handler) {
+#ifdef PAL_REACTOR
+	if (readyTask != NULL) {
+		palReactor_add(handler, readyTask);
+	}
 #endif
-				}
-			}
-		} else if (c < 0) {
+}
 
-		} else {
-#ifdef _WIN32
-            cometos::getCout() << "c == 0 outer loop" << cometos::endl;
-            toRemove.insert(*it);
-#else
-#ifdef __linux__
-            cometos::getCout() << "c == 0 outer loop" << cometos::endl;
-            toRemove.insert(*it);
-#else
-            // none
+void TcpAgent::unwatch(const socket_t& handler) {
+#ifdef PAL_REACTOR
+	if (readyTask != NULL) {
+		palReactor_remove(handler);
+	}
 #endif
+}
+
+bool TcpAgent::receive(const socket_t& handler) {
+	RxState& state = rx[handler];
+
+	while (1) {
+		if (state.expected == state.offset) {
+			state.expected = -1;
+			receivedCallback(handler, state.buffer, state.offset);
+			if (conn.count(handler) == 0) {
+				// closed during the callback
+				return true;
+			}
+		}
+
+		int c;
+		if (state.expected < 0) {
+			uint8_t length;
+			c = receiveMessage(handler, &length, 1);
+			if (c > 0) {
+				assert(length < TCP_AGENT_BUFFER_SIZE);
+				state.expected = length;
+				state.offset = 0;
+				continue;
+			}
+#if !defined _WIN32 && !defined __linux__
+			if (c == 0) {
+				// no data available
+				return true;
+			}
 #endif
+		} else {
+			c = receiveMessage(handler, state.buffer + state.offset,
+					state.expected - state.offset);
+			if (c > 0) {
+				assert(state.expected - state.offset >= c);
+				state.offset += c;
+				continue;
+			}
 		}
 
+		if (c == 0) {
+			cometos::getCout() << "c == 0" << cometos::endl;
+			return false;
+		}
+
+		// no data available, an incomplete frame is continued later
+		return true;
 	}
+}
 
-	while (!toRemove.empty()) {
-		close(*toRemove.begin());
-		toRemove.erase(toRemove.begin());
+void TcpAgent::pollAll() {
+	if (server != INVALID_SOCKET) {
+		socket_t client;
+		while (INVALID_SOCKET != (client = acceptClientSocket(server))) {
+			setNonBlockingSocket(client);
+			cometos::getCout() << "Accepted client connection" << cometos::endl;
+			conn.insert(client);
+			watch(client);
+		}
+	}
+
+	// callbacks may close connections, thus iterate over a copy
+	std::set<socket_t> current(conn);
+	for (std::set<socket_t>::iterator it = current.begin(); it != current.end();
+			it++) {
+		if (conn.count(*it) != 0 && !receive(*it)) {
+			close(*it);
+		}
 	}
 
+#ifdef PAL_REACTOR
+	if (readyTask != NULL) {
+		if (server != INVALID_SOCKET) {
+			palReactor_rearm(server);
+		}
+		for (std::set<socket_t>::iterator it = conn.begin(); it != conn.end();
+				it++) {
+			palReactor_rearm(*it);
+		}
+	}
+#endif
 }
 
 bool TcpAgent::listen(int port) {
@@ -156,6 +199,7 @@ bool TcpAgent::listen(int port) {
 	server = createServerSocket(port);
 	setNonBlockingSocket(server);
 	if (INVALID_SOCKET != server) {
+		watch(server);
 		return true;
 	}
 
@@ -165,12 +209,15 @@ bool TcpAgent::listen(int port) {
 void TcpAgent::shutdown() {
 	cometos::getCout() << "complete shutdown" << cometos::endl;
 	for (set<socket_t>::iterator it = conn.begin(); it != conn.end(); it++) {
+		unwatch(*it);
 		shutdownAndCloseSocket(*it);
 	}
 	conn.clear();
+	rx.clear();
 
 	if (server != INVALID_SOCKET) {
 		cometos::getCout() << "Shutdown server" << cometos::endl;
+		unwatch(server);
 		shutdownAndCloseSocket(server);
 		server = INVALID_SOCKET;
 	}
@@ -182,6 +229,7 @@ bool TcpAgent::connect(const char* addr, int port) {
 	if (INVALID_SOCKET != client) {
 		setNonBlockingSocket(client);
 		conn.insert(client);
+		watch(client);
 		//startThread();
 		return true;
 	}
@@ -195,9 +243,8 @@ bool TcpAgent::send(const socket_t& handler, uint8_t *buffer, uint8_t length) {
 	memcpy(buff+1,buffer,length);
 
 	if (sendMessage(handler, buff, length+1) == false) {
-		conn.erase(handler);
 		cometos::getCout() << "sendMessage failed" << cometos::endl;
-		shutdownAndCloseSocket(handler);
+		close(handler);
 		return false;
 	}
 	return true;
@@ -35,8 +35,13 @@
 
 #include <stdint.h>
 #include <set>
+#include <map>
 #include "netutils.h"
 
+namespace cometos {
+class Task;
+}
+
 
 #define  TCP_AGENT_BUFFER_SIZE	128
 
@@ -78,8 +83,19 @@ public:
 
 	void shutdown();
 
+	/**Accepts pending connections and reads all available data. Frames
+	 * that are only partially received are completed during later calls.
+	 */
 	void pollAll();
 
+	/**Lets the reactor add the task to the scheduler whenever one of the
+	 * sockets becomes readable. The task has to call pollAll().
+	 *
+	 * @return false if no reactor is available, pollAll() has to be
+	 *         called periodically in this case
+	 */
+	bool setReadyTask(cometos::Task* task);
+
 	bool connect(const char* addr, int port);
 
 	/**Contains all open connections*/
@@ -87,6 +103,25 @@ public:
 	socket_t server;
 
 private:
+	struct RxState {
+		RxState() : expected(-1), offset(0) {
+		}
+
+		/**length of the current frame, -1 if the length byte is pending*/
+		int16_t expected;
+		uint8_t offset;
+		uint8_t buffer[TCP_AGENT_BUFFER_SIZE];
+	};
+
+	/**@return false if the connection was closed by the remote side*/
+	bool receive(const socket_t& handler);
+
+	void watch(const socket_t& handler);
+	void unwatch(const socket_t& handler);
+
+	std::map<socket_t, RxState> rx;
+	cometos::Task* readyTask;
+
 	static int instCounter;
 
 };
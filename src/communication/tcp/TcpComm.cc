@@ -76,6 +76,10 @@ void TcpComm::run(cometos::Message* msg) {
 	schedule(msg, &TcpComm::run, TCP_COMM_POLL);
 }
 
+void TcpComm::poll() {
+	pollAll();
+}
+
 void TcpComm::handleRequest(cometos::DataRequest* msg) {
 	// add src and destination addresses to frame
 	// TODO could add well-defined header struct
@@ -161,7 +165,8 @@ void TcpComm::connect(cometos::Message* msg) {
 #endif
 
 TcpComm::TcpComm(node_t fallbackAddr) :
-		pTimer(NULL)
+		pTimer(NULL),
+		taskReady(*this)
 {
 }
 
@@ -185,6 +190,10 @@ void TcpComm::initialize() {
 #else
 	// for all other platforms (mainly python/local), we expect that listen or
 	// connect is called explicitly somewhere else (e.g. from the main function)
+	if (setReadyTask(&taskReady)) {
+		cometos::getCout() << "start TCPComm event-driven reception" << cometos::endl;
+		return;
+	}
 	pTimer = new cometos::Message;
 	cometos::getCout() << "start TCPComm socket polling" << cometos::endl;
 	schedule(pTimer, &TcpComm::run, TCP_COMM_POLL);
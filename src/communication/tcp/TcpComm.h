@@ -40,6 +40,7 @@
 #include <string.h>
 #include "LowerEndpoint.h"
 #include "TcpAgent.h"
+#include "Task.h"
 
 // frequency of polling (ms)
 #define TCP_COMM_POLL	5
@@ -67,7 +68,12 @@ public:
 
 private:
 	node_t getAddr();
+	void poll();
+
 	cometos::Message *pTimer;
+
+	/**added by the reactor if one of the sockets is readable*/
+	cometos::BoundedTask<TcpComm, &TcpComm::poll> taskReady;
 };
 
 #endif /* TCPCOMM_H_ */
@@ -36,12 +36,16 @@
 using namespace cometos;
 
 TcpForwarder::TcpForwarder() :
-		pTimer(NULL) {
+		pTimer(NULL),
+		taskReady(*this) {
 }
 
 void TcpForwarder::initialize() {
 	Endpoint::initialize();
 
+	if (setReadyTask(&taskReady)) {
+		return;
+	}
 	pTimer = new cometos::Message;
 	schedule(pTimer, &TcpForwarder::run, TCP_COMM_POLL);
 
@@ -52,6 +56,10 @@ void TcpForwarder::run(cometos::Message* msg) {
 	pollAll();
 }
 
+void TcpForwarder::poll() {
+	pollAll();
+}
+
 
 void TcpForwarder::handleIndication(cometos::DataIndication* msg) {
 	for (std::set<socket_t>::iterator it = conn.begin(); it != conn.end(); it++) {
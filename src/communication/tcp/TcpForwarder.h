@@ -57,7 +57,12 @@ public:
 			uint8_t length);
 
 private:
+	void poll();
+
 	cometos::Message *pTimer;
+
+	/**added by the reactor if one of the sockets is readable*/
+	cometos::BoundedTask<TcpForwarder, &TcpForwarder::poll> taskReady;
 };
 
 #endif /* TCPFORWARDER_H_ */
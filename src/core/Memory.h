@@ -205,9 +205,201 @@ public:
     }
 };
 
+/**
+ * Base class for objects managed by an intrusive_checked_ptr. The reference
+ * count is stored inside the object itself, which saves the additional heap
+ * allocation of the checked_object_wrapper for every managed instance.
+ *
+ * Copying an object never copies its reference count, a copy is always
+ * unowned until it is handed to an intrusive_checked_ptr.
+ */
+class CheckedObject {
+    template <typename T>
+    friend class intrusive_checked_ptr;
+
+protected:
+    CheckedObject() : reference_count{0} {
+    }
+
+    CheckedObject(const CheckedObject&) : reference_count{0} {
+    }
+
+    CheckedObject& operator=(const CheckedObject&) {
+        return *this;
+    }
+
+private:
+    int reference_count;
+};
+
+/**
+ * Same interface and ownership checks as checked_ptr, but for types derived
+ * from CheckedObject, which hold the reference count themselves.
+ */
+template <typename T>
+class intrusive_checked_ptr {
+private:
+    T* raw_instance;
+
+    void acquire() {
+        if(this->raw_instance) {
+            this->raw_instance->CheckedObject::reference_count++;
+        }
+    }
+
+public:
+    intrusive_checked_ptr() : raw_instance{nullptr} {
+    }
+
+    intrusive_checked_ptr(const intrusive_checked_ptr& other) : raw_instance{other.raw_instance} {
+        acquire();
+    }
+
+    explicit intrusive_checked_ptr(intrusive_checked_ptr&& other) : raw_instance{other.raw_instance} {
+        other.raw_instance = nullptr;
+    }
+
+    explicit intrusive_checked_ptr(T*&& raw) : raw_instance{raw} {
+        if(this->raw_instance) {
+            // an object must not be owned by two independent pointer groups
+            ASSERT(this->raw_instance->CheckedObject::reference_count == 0);
+            this->raw_instance->CheckedObject::reference_count = 1;
+        }
+    }
+
+    ~intrusive_checked_ptr() {
+        reset();
+    }
+
+    intrusive_checked_ptr& operator=(const intrusive_checked_ptr& other) {
+        ASSERT(this->raw_instance == nullptr);
+
+        if(this->raw_instance != other.raw_instance) {
+            this->raw_instance = other.raw_instance;
+            acquire();
+        }
+        return *this;
+    }
+
+    intrusive_checked_ptr& operator=(intrusive_checked_ptr&& other) {
+        ASSERT(this->raw_instance == nullptr);
+
+        this->raw_instance = other.raw_instance;
+        other.raw_instance = nullptr;
+        return *this;
+    }
+
+    bool operator==(const intrusive_checked_ptr& other) const {
+        return this->raw_instance == other.raw_instance;
+    }
+
+    bool operator!=(const intrusive_checked_ptr& other) const {
+        return this->raw_instance != other.raw_instance;
+    }
+
+    void reset() {
+        if(this->raw_instance) {
+            this->raw_instance->CheckedObject::reference_count--;
+            ASSERT(this->raw_instance->CheckedObject::reference_count > 0);
+
+            this->raw_instance = nullptr;
+        }
+        return;
+    }
+
+    /**
+     * This should only be used during deconstruction at the end of the runtime
+     */
+    void force_reset() {
+        if(this->raw_instance) {
+            this->raw_instance->CheckedObject::reference_count--;
+
+            if(this->raw_instance->CheckedObject::reference_count == 0) {
+                delete this->raw_instance;
+            }
+
+            this->raw_instance = nullptr;
+        }
+        return;
+    }
+
+    T* get() {
+        return this->raw_instance;
+    }
+
+    T* decapsulate() {
+        if(this->raw_instance) {
+            ASSERT(unique());
+
+            T* temp = this->raw_instance;
+
+            temp->CheckedObject::reference_count = 0;
+            this->raw_instance = nullptr;
+
+            return temp;
+        } else {
+            return nullptr;
+        }
+    }
+
+    T& operator*() {
+        ASSERT(this->raw_instance != nullptr);
+
+        return *(this->raw_instance);
+    }
+
+    T* operator->() {
+        ASSERT(this->raw_instance != nullptr);
+
+        return this->raw_instance;
+    }
+
+    const T* operator->() const {
+        ASSERT(this->raw_instance != nullptr);
+
+        return this->raw_instance;
+    }
+
+    long int use_count() const noexcept {
+        if(this->raw_instance) {
+            return this->raw_instance->CheckedObject::reference_count;
+        } else {
+            return 0;
+        }
+    }
+
+    explicit operator bool() const noexcept {
+        return this->raw_instance != nullptr;
+    }
+
+    bool unique() const noexcept {
+        return use_count() == 1;
+    }
+
+    void delete_object() {
+        ASSERT(unique());
+
+        if(this->raw_instance) {
+            this->raw_instance->CheckedObject::reference_count--;
+
+            delete this->raw_instance;
+            this->raw_instance = nullptr;
+        }
+    }
+};
+
+/**
+ * Selects the pointer type returned by make_checked. Types derived from
+ * CheckedObject specialize this to use intrusive_checked_ptr.
+ */
+template <typename T>
+struct checked_ptr_type {
+    typedef checked_ptr<T> type;
+};
+
 template <typename T, typename... A>
-checked_ptr<T> make_checked(A&&... arg) {
-    return checked_ptr<T>{new T{arg...}};
+typename checked_ptr_type<T>::type make_checked(A&&... arg) {
+    return typename checked_ptr_type<T>::type{new T{arg...}};
 }
 }
 
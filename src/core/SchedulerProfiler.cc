@@ -0,0 +1,167 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "SchedulerProfiler.h"
+#include "Task.h"
+#include "Module.h"
+#include "OutputStream.h"
+#include "cometosAssert.h"
+#ifdef PAL_TIME
+#include "palLocalTime.h"
+#endif
+
+uint32_t __attribute__((weak)) schedulerProfiler_getTimeUs() {
+#ifdef PAL_TIME
+    return palLocalTime_get() * 1000;
+#else
+    return 0;
+#endif
+}
+
+using namespace cometos;
+
+SchedulerProfiler::SchedulerProfiler() :
+        numEntries(0), dropped(0) {
+}
+
+const void* SchedulerProfiler::getType(const Task& task) {
+    // every class derived from Task has its own vtable, whose address is
+    // stored at the beginning of the object (no RTTI on embedded targets)
+    return *reinterpret_cast<const void* const *>(&task);
+}
+
+void SchedulerProfiler::record(const Module* context, const void* type,
+        uint32_t queueDelay, uint32_t runTime) {
+    TaskProfile* entry = NULL;
+    for (uint8_t i = 0; i < numEntries; i++) {
+        if (entries[i].context == context && entries[i].type == type) {
+            entry = &entries[i];
+            break;
+        }
+    }
+
+    if (entry == NULL) {
+        if (numEntries >= SCHEDULER_PROFILING_ENTRIES) {
+            dropped++;
+            return;
+        }
+        entry = &entries[numEntries++];
+        entry->context = context;
+        entry->type = type;
+    }
+
+    entry->invocations++;
+    entry->runTime += runTime;
+    if (runTime > entry->maxRunTime) {
+        entry->maxRunTime = runTime;
+    }
+    entry->queueDelay += queueDelay;
+    if (queueDelay > entry->maxQueueDelay) {
+        entry->maxQueueDelay = queueDelay;
+    }
+}
+
+uint8_t SchedulerProfiler::getNumEntries() const {
+    return numEntries;
+}
+
+const TaskProfile& SchedulerProfiler::getEntry(uint8_t idx) const {
+    ASSERT(idx < numEntries);
+    return entries[idx];
+}
+
+uint16_t SchedulerProfiler::getDropped() const {
+    return dropped;
+}
+
+void SchedulerProfiler::reset() {
+    for (uint8_t i = 0; i < numEntries; i++) {
+        entries[i] = TaskProfile();
+    }
+    numEntries = 0;
+    dropped = 0;
+}
+
+static const char* getContextName(const Module* context) {
+    if (context == NULL || context->getName()[0] == 0) {
+        return "-";
+    }
+    return context->getName();
+}
+
+void SchedulerProfiler::print() const {
+    getCout() << "module type invocations runTime maxRunTime queueDelay maxQueueDelay" << endl;
+
+    for (uint8_t i = 0; i < numEntries; i++) {
+        // entries of the same module are aggregated at its first occurrence
+        bool printed = false;
+        for (uint8_t j = 0; j < i; j++) {
+            if (entries[j].context == entries[i].context) {
+                printed = true;
+                break;
+            }
+        }
+        if (printed) {
+            continue;
+        }
+
+        TaskProfile total;
+        for (uint8_t j = i; j < numEntries; j++) {
+            const TaskProfile& e = entries[j];
+            if (e.context != entries[i].context) {
+                continue;
+            }
+            getCout() << getContextName(e.context) << " 0x" << hex
+                      << (uint32_t)(uintptr_t) e.type << dec << " "
+                      << e.invocations << " " << e.runTime << " "
+                      << e.maxRunTime << " " << e.queueDelay << " "
+                      << e.maxQueueDelay << endl;
+            total.invocations += e.invocations;
+            total.runTime += e.runTime;
+            total.queueDelay += e.queueDelay;
+            if (e.maxRunTime > total.maxRunTime) {
+                total.maxRunTime = e.maxRunTime;
+            }
+            if (e.maxQueueDelay > total.maxQueueDelay) {
+                total.maxQueueDelay = e.maxQueueDelay;
+            }
+        }
+        getCout() << getContextName(entries[i].context) << " total "
+                  << total.invocations << " " << total.runTime << " "
+                  << total.maxRunTime << " " << total.queueDelay << " "
+                  << total.maxQueueDelay << endl;
+    }
+
+    if (dropped > 0) {
+        getCout() << "dropped " << dropped << endl;
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef SCHEDULERPROFILER_H_
+#define SCHEDULERPROFILER_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "types.h"
+
+/**
+ * Maximum number of distinct (module, task type) pairs that are profiled.
+ * Invocations of further pairs are only counted as dropped.
+ */
+#ifndef SCHEDULER_PROFILING_ENTRIES
+#define SCHEDULER_PROFILING_ENTRIES 24
+#endif
+
+/**
+ * Returns a timestamp in microseconds used for profiling. The default
+ * implementation is based on palLocalTime and is overridden by platforms
+ * with a finer clock.
+ */
+uint32_t schedulerProfiler_getTimeUs();
+
+namespace cometos {
+
+class Module;
+class Task;
+
+/**
+ * Statistics of all invocations of one type of task in the context of
+ * one module. All times are given in microseconds.
+ */
+struct TaskProfile {
+    TaskProfile() :
+            context(NULL), type(NULL), invocations(0), runTime(0),
+            maxRunTime(0), queueDelay(0), maxQueueDelay(0) {
+    }
+
+    const Module* context;
+    /**identifies the class of the task, i.e., the address of its vtable*/
+    const void* type;
+    uint32_t invocations;
+    uint32_t runTime;
+    uint32_t maxRunTime;
+    /**time from becoming due until the invocation of the task*/
+    uint32_t queueDelay;
+    uint32_t maxQueueDelay;
+};
+
+/**
+ * Records invocation counts, run times and queueing delays of the tasks
+ * executed by the TaskScheduler. Only available if SCHEDULER_PROFILING is
+ * defined (scheduler_profiling=True in platform.conf).
+ */
+class SchedulerProfiler {
+public:
+    SchedulerProfiler();
+
+    /**
+     * Returns the value used to distinguish different classes of tasks.
+     */
+    static const void* getType(const Task& task);
+
+    /**
+     * Records a single invocation. The task itself is not passed, because it
+     * might already be deleted after its invocation.
+     */
+    void record(const Module* context, const void* type,
+            uint32_t queueDelay, uint32_t runTime);
+
+    uint8_t getNumEntries() const;
+
+    const TaskProfile& getEntry(uint8_t idx) const;
+
+    /**
+     * @return number of invocations not recorded because the table was full
+     */
+    uint16_t getDropped() const;
+
+    void reset();
+
+    /**
+     * Prints all entries, aggregated per module, to getCout().
+     */
+    void print() const;
+
+private:
+    TaskProfile entries[SCHEDULER_PROFILING_ENTRIES];
+    uint8_t numEntries;
+    uint16_t dropped;
+};
+
+}
+
+#endif /* SCHEDULERPROFILER_H_ */
@@ -46,9 +46,19 @@ class Module;
 
 class Task : public TaskBase {
 	friend class TaskScheduler;
+	friend class TimerWheel;
+	friend class SchedulerProfiler;
 public:
 	Task() :
-		next(this), expiration(0) {
+		next(this),
+#ifdef SCHEDULER_TIMER_WHEEL
+		prev(NULL),
+#endif
+		expiration(0)
+#ifdef SCHEDULER_PROFILING
+		, dueTime(0)
+#endif
+	{
 	}
 
 	virtual ~Task() {}
@@ -71,7 +81,16 @@ private:
     }
 
 	Task* next;
+#ifdef SCHEDULER_TIMER_WHEEL
+	Task* prev;
+#endif
+	/**relative expiration for the list scheduler, absolute expiration
+	 * for the timer wheel*/
 	time_ms_t expiration;
+#ifdef SCHEDULER_PROFILING
+	/**time the task became ready, see schedulerProfiler_getTimeUs()*/
+	uint32_t dueTime;
+#endif
 };
 
 class SimpleTask: public Task {
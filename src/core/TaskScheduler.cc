@@ -43,7 +43,10 @@
 using namespace cometos;
 
 TaskScheduler::TaskScheduler() :
-		next(NULL), stopSignal(false), currTask(NULL), currModule(NULL)
+#ifndef SCHEDULER_TIMER_WHEEL
+		next(NULL), ready(NULL), readyTail(NULL),
+#endif
+		stopSignal(false), currTask(NULL), currModule(NULL)
 #ifdef ENABLE_LOGGING
 		        , currLogLevel(LOG_LEVEL_INVALID)
 #endif
@@ -78,6 +81,12 @@ uint8_t TaskScheduler::getUtil() {
 }
 #endif
 
+#ifdef SCHEDULER_PROFILING
+SchedulerProfiler& TaskScheduler::getProfiler() {
+    return profiler;
+}
+#endif
+
 #ifdef ENABLE_LOGGING
 uint8_t TaskScheduler::getCurrentLogLevel() {
     return currLogLevel;
@@ -99,28 +108,59 @@ void TaskScheduler::updateExpiration() {
     palExec_atomicBegin();
     // UPDATE TASK LIST
     time_ms_t elapsed = elapsedMS();
+#ifdef SCHEDULER_TIMER_WHEEL
+    wheel.advance(elapsed);
+#else
     if (elapsed > 0) {
+        // move expired tasks to the ready queue, they are located at the
+        // front of the sorted list
+        while (next != NULL && next->expiration <= elapsed) {
+            Task* task = next;
+            next = next->next;
+            enqueueReady(*task, elapsed - task->expiration);
+        }
+
         Task *it = next;
         while (it != NULL) {
-            if (it->expiration > elapsed) {
-                it->expiration -= elapsed;
-            } else {
-                it->expiration = 0;
-            }
+            it->expiration -= elapsed;
             it = it->next;
         }
     }
+#endif
     palExec_atomicEnd();
 }
 
+#ifndef SCHEDULER_TIMER_WHEEL
+void TaskScheduler::enqueueReady(Task& task, time_ms_t overdue) {
+#ifdef SCHEDULER_PROFILING
+    // the task became due overdue milliseconds before it was noticed
+    task.dueTime = schedulerProfiler_getTimeUs() - overdue * 1000;
+#endif
+    task.expiration = 0;
+    task.next = NULL;
+    if (readyTail != NULL) {
+        readyTail->next = &task;
+    } else {
+        ready = &task;
+    }
+    readyTail = &task;
+}
+#endif
+
 time_ms_t TaskScheduler::getTimeUntilNextExecution()
 {
     // TRY TO SLEEP
     time_ms_t sleep = (time_ms_t)(-1);
     palExec_atomicBegin();
-    if (next) {
+#ifdef SCHEDULER_TIMER_WHEEL
+    sleep = wheel.getTimeUntilNext();
+#else
+    if (ready) {
+        sleep = 0;
+    } else if (next) {
         sleep = next->expiration;
     }
+#endif
     palExec_atomicEnd();
 
 #ifndef SCHEDULER_DISABLE_MONITORING
@@ -141,11 +181,18 @@ void TaskScheduler::setupNextTask()
     // GET AND INVOKE NEXT TASK
     currTask = NULL;
     palExec_atomicBegin();
-    if (next != NULL && next->expiration == 0) {
-        currTask = next;
-        next = next->next;
+#ifdef SCHEDULER_TIMER_WHEEL
+    currTask = wheel.pop();
+#else
+    if (ready != NULL) {
+        currTask = ready;
+        ready = ready->next;
+        if (ready == NULL) {
+            readyTail = NULL;
+        }
         currTask->next = currTask; // mark task as not scheduled
     }
+#endif
     palExec_atomicEnd();
 }
 
@@ -183,7 +230,17 @@ bool TaskScheduler::run(bool infinite) {
 	        }
 #endif
 	        currModule = currTask->getContext();
+#ifdef SCHEDULER_PROFILING
+	        // the task may be deleted during its invocation
+	        const void* type = SchedulerProfiler::getType(*currTask);
+	        uint32_t start = schedulerProfiler_getTimeUs();
+	        uint32_t queueDelay = start - currTask->dueTime;
 	        currTask->invoke();
+	        profiler.record(currModule, type, queueDelay,
+	                schedulerProfiler_getTimeUs() - start);
+#else
+	        currTask->invoke();
+#endif
 	        currModule = NULL;
 	        currTask=NULL;
 #ifdef ENABLE_LOGGING
@@ -208,8 +265,29 @@ void TaskScheduler::stop() {
 }
 
 void TaskScheduler::remove_unsafe(Task& task) {
+#ifdef SCHEDULER_TIMER_WHEEL
+	wheel.remove(task);
+#else
 	if (task.isScheduled()) {
-		if (next == &task) {
+		if (task.expiration == 0) {
+			// task is located in the ready queue
+			Task* prev = NULL;
+			Task* it = ready;
+			while (it != NULL && it != &task) {
+				prev = it;
+				it = it->next;
+			}
+			ASSERT(it != NULL);
+			if (prev == NULL) {
+				ready = task.next;
+			} else {
+				prev->next = task.next;
+			}
+			if (readyTail == &task) {
+				readyTail = prev;
+			}
+			task.next = &task; // mark task as not scheduled
+		} else if (next == &task) {
 			next = next->next;
 			task.next = &task; // mark task as not scheduled
 		} else {
@@ -225,10 +303,19 @@ void TaskScheduler::remove_unsafe(Task& task) {
 		}
 
 	}
+#endif
 }
 
 void TaskScheduler::add_unsafe(Task& task, time_ms_t expiration) {
 	if (!task.isScheduled()) {
+#ifdef SCHEDULER_TIMER_WHEEL
+		wheel.add(task, expiration);
+#else
+		if (expiration == 0) {
+			enqueueReady(task);
+			return;
+		}
+
 		task.expiration = expiration;
 		if (next == NULL) {
 			next = &task;
@@ -244,6 +331,7 @@ void TaskScheduler::add_unsafe(Task& task, time_ms_t expiration) {
 			task.next = it->next;
 			it->next = &task;
 		}
+#endif
 	} else {
 	    // we consider scheduling a scheduled task a critical failure ---
 	    // if the client really wanted to do this, he should have used
@@ -256,8 +344,13 @@ void TaskScheduler::add(Task& task, time_ms_t expiration) {
     // NOTE: we have to update all tasks' expiration, before we add any new
     // task to the scheduler; otherwise, this new task will
     // have its expiration decreased by the duration of the sleep period when
-    // updateExpiration is called again after task execution
-    updateExpiration();
+    // updateExpiration is called again after task execution.
+    // Tasks without delay are appended to the ready queue and can not be
+    // affected, thus the update is skipped for them. Timed tasks that
+    // expired in the meantime are still enqueued after the current task.
+    if (expiration != 0) {
+        updateExpiration();
+    }
     palExec_atomicBegin();
 	add_unsafe(task, expiration);
 	palExec_atomicEnd();
@@ -34,6 +34,12 @@
 #define TASKSCHEDULER_H_
 
 #include "Task.h"
+#ifdef SCHEDULER_TIMER_WHEEL
+#include "TimerWheel.h"
+#endif
+#ifdef SCHEDULER_PROFILING
+#include "SchedulerProfiler.h"
+#endif
 
 #define LOG_LEVEL_INVALID 0xFF
 
@@ -43,9 +49,19 @@ class TaskScheduler;
 TaskScheduler &getScheduler();
 
 /**
+ * Executes tasks in synchronous context after their expiration.
  *
+ * By default, pending tasks are kept in a list sorted by relative
+ * expiration, which is cheap in terms of RAM but makes adding a timed task
+ * linear in the number of pending tasks. Expired tasks and tasks added
+ * without delay (e.g., messages passed via gates) are kept in a separate
+ * FIFO, which is served in constant time. If SCHEDULER_TIMER_WHEEL is defined
+ * (scheduler='wheel' in platform.conf), a hierarchical timer wheel with
+ * absolute expiration times is used instead (see TimerWheel).
  */
 class TaskScheduler {
+	// runs the schedulers of several nodes per process (PAL_MULTI_NODE)
+	friend class NodePool;
 public:
 
 	/**Initializes the task scheduler in idle mode.
@@ -76,6 +92,13 @@ public:
 	uint8_t getUtil();
 #endif
 
+#ifdef SCHEDULER_PROFILING
+	/**Gives access to the per-module and per-task statistics. As for
+	 * getUtil(), this is only allowed from a task.
+	 */
+	SchedulerProfiler& getProfiler();
+#endif
+
 	/**Adds task to scheduler. A FIFO is used for tasks with same expiration
 	 * time. A task is called in synchronous context. This is thread-safe.
 	 * A pointer to the passed instance of task is internally stored. Hence,
@@ -119,12 +142,26 @@ protected:
 	void remove_unsafe(Task& task);
 	virtual void add_unsafe(Task& task, time_ms_t expiration = 0);
 
+#ifdef SCHEDULER_TIMER_WHEEL
+	TimerWheel wheel;
+#else
+	void enqueueReady(Task& task, time_ms_t overdue = 0);
+
+	/**sorted list of tasks with relative expiration > 0*/
 	Task* next;
+	/**FIFO of expired tasks, executed in order*/
+	Task* ready;
+	Task* readyTail;
+#endif
 	volatile bool stopSignal;
 	Task* currTask;
 	const Module* currModule;
 	uint8_t currLogLevel;
 
+#ifdef SCHEDULER_PROFILING
+	SchedulerProfiler profiler;
+#endif
+
 #ifndef SCHEDULER_DISABLE_MONITORING
 	time_ms_t mon_sleep;
 	time_ms_t mon_busy;
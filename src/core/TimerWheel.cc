@@ -0,0 +1,279 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "TimerWheel.h"
+#include "cometosAssert.h"
+#ifdef SCHEDULER_PROFILING
+#include "SchedulerProfiler.h"
+#endif
+
+using namespace cometos;
+
+/**
+ * Relative expiration times are clamped to this value, thus the difference
+ * between an expiration time and the current time can always be compared
+ * as signed value.
+ */
+#define TIMERWHEEL_MAX_EXPIRATION ((time_ms_t)0x7FFFFFFF)
+
+TimerWheel::TimerWheel() :
+        now(0), target(0), ready(NULL), overflow(NULL) {
+    for (uint8_t l = 0; l < SCHEDULER_WHEEL_LEVELS; l++) {
+        for (uint8_t s = 0; s < SLOTS; s++) {
+            slots[l][s] = NULL;
+        }
+        occupied[l] = 0;
+    }
+}
+
+uint8_t TimerWheel::getDigit(time_ms_t time, uint8_t level) {
+    return (time >> (SCHEDULER_WHEEL_SLOT_BITS * level)) & MASK;
+}
+
+/*
+ * Lists are linked by Task::next and terminated by NULL. The prev pointer of
+ * the head points to the tail of the list, thus a single pointer per slot
+ * suffices to append in constant time.
+ */
+void TimerWheel::append(Task*& list, Task& task) {
+    task.next = NULL;
+    if (list == NULL) {
+        task.prev = &task;
+        list = &task;
+    } else {
+        Task* tail = list->prev;
+        tail->next = &task;
+        task.prev = tail;
+        list->prev = &task;
+    }
+}
+
+void TimerWheel::unlink(Task*& list, Task& task) {
+    if (list == &task) {
+        list = task.next;
+        if (list != NULL) {
+            list->prev = task.prev;
+        }
+    } else {
+        task.prev->next = task.next;
+        if (task.next != NULL) {
+            task.next->prev = task.prev;
+        } else {
+            list->prev = task.prev;
+        }
+    }
+}
+
+void TimerWheel::splice(Task*& dst, Task*& src) {
+    if (src == NULL) {
+        return;
+    }
+    if (dst == NULL) {
+        dst = src;
+    } else {
+        Task* tail = dst->prev;
+        tail->next = src;
+        dst->prev = src->prev;
+        src->prev = tail;
+    }
+    src = NULL;
+}
+
+void TimerWheel::updateOccupied(Task*& list) {
+    if (&list == &ready || &list == &overflow) {
+        return;
+    }
+    uint16_t pos = &list - &slots[0][0];
+    uint64_t bit = ((uint64_t) 1) << (pos & MASK);
+    if (list != NULL) {
+        occupied[pos / SLOTS] |= bit;
+    } else {
+        occupied[pos / SLOTS] &= ~bit;
+    }
+}
+
+Task*& TimerWheel::getList(time_ms_t expiration) {
+    if ((int32_t)(expiration - now) <= 0) {
+        return ready;
+    }
+    time_ms_t diff = expiration ^ now;
+    for (uint8_t l = 0; l < SCHEDULER_WHEEL_LEVELS; l++) {
+        if ((diff >> (SCHEDULER_WHEEL_SLOT_BITS * (l + 1))) == 0) {
+            return slots[l][getDigit(expiration, l)];
+        }
+    }
+    return overflow;
+}
+
+void TimerWheel::insert(Task& task) {
+    Task*& list = getList(task.expiration);
+    append(list, task);
+    updateOccupied(list);
+#ifdef SCHEDULER_PROFILING
+    if (&list == &ready) {
+        // the task became due at its expiration, which might lie before
+        // the current time if it is inserted while advancing the wheel
+        task.dueTime = schedulerProfiler_getTimeUs()
+                - (target - task.expiration) * 1000;
+    }
+#endif
+}
+
+void TimerWheel::add(Task& task, time_ms_t expiration) {
+    ASSERT(!task.isScheduled());
+    if (expiration > TIMERWHEEL_MAX_EXPIRATION) {
+        expiration = TIMERWHEEL_MAX_EXPIRATION;
+    }
+    task.expiration = now + expiration;
+    insert(task);
+}
+
+void TimerWheel::remove(Task& task) {
+    if (!task.isScheduled()) {
+        return;
+    }
+
+    Task*& list = getList(task.expiration);
+    unlink(list, task);
+    task.next = &task; // mark task as not scheduled
+    updateOccupied(list);
+}
+
+Task* TimerWheel::pop() {
+    Task* task = ready;
+    if (task != NULL) {
+        unlink(ready, *task);
+        task->next = task; // mark task as not scheduled
+    }
+    return task;
+}
+
+void TimerWheel::redistribute(Task*& list) {
+    Task* it = list;
+    list = NULL;
+    while (it != NULL) {
+        Task* following = it->next;
+        insert(*it);
+        it = following;
+    }
+}
+
+void TimerWheel::cascade() {
+    // find the highest level whose digit changed with the current tick;
+    // higher levels are cascaded first, thus their tasks already reside in
+    // the lower levels when those are cascaded
+    uint8_t top = 1;
+    while (top < SCHEDULER_WHEEL_LEVELS && getDigit(now, top) == 0) {
+        top++;
+    }
+
+    if (top == SCHEDULER_WHEEL_LEVELS) {
+        redistribute(overflow);
+        top--;
+    }
+
+    for (uint8_t l = top; l > 0; l--) {
+        uint8_t slot = getDigit(now, l);
+        if (slots[l][slot] != NULL) {
+            redistribute(slots[l][slot]);
+            updateOccupied(slots[l][slot]);
+        }
+    }
+}
+
+void TimerWheel::advance(time_ms_t elapsed) {
+    target = now + elapsed;
+
+    while (now != target) {
+        uint8_t idx = now & MASK;
+        time_ms_t remaining = target - now;
+
+        // slots at or below the current index of the lowest level are
+        // always empty, thus the next set bit is the next expiring slot
+        uint64_t pending = 0;
+        if (idx < MASK) {
+            pending = occupied[0] & (~((uint64_t) 0) << (idx + 1));
+        }
+
+        if (pending != 0) {
+            uint8_t slot = __builtin_ctzll(pending);
+            if ((time_ms_t)(slot - idx) <= remaining) {
+                now += slot - idx;
+#ifdef SCHEDULER_PROFILING
+                uint32_t dueTime = schedulerProfiler_getTimeUs()
+                        - (target - now) * 1000;
+                for (Task* it = slots[0][slot]; it != NULL; it = it->next) {
+                    it->dueTime = dueTime;
+                }
+#endif
+                splice(ready, slots[0][slot]);
+                updateOccupied(slots[0][slot]);
+                continue;
+            }
+        }
+
+        time_ms_t toBoundary = SLOTS - idx;
+        if (toBoundary <= remaining) {
+            now += toBoundary;
+            cascade();
+        } else {
+            now = target;
+        }
+    }
+}
+
+time_ms_t TimerWheel::getTimeUntilNext() const {
+    if (ready != NULL) {
+        return 0;
+    }
+
+    for (uint8_t l = 0; l < SCHEDULER_WHEEL_LEVELS; l++) {
+        if (occupied[l] != 0) {
+            // the occupied slots of a level are always located after the
+            // current digit, thus the lowest set bit is the next one
+            uint8_t slot = __builtin_ctzll(occupied[l]);
+            uint8_t shift = SCHEDULER_WHEEL_SLOT_BITS * l;
+            time_ms_t start = ((now >> (shift + SCHEDULER_WHEEL_SLOT_BITS))
+                    << (shift + SCHEDULER_WHEEL_SLOT_BITS))
+                    | (((time_ms_t) slot) << shift);
+            return start - now;
+        }
+    }
+
+    if (overflow != NULL) {
+        // wake up at the next wrap-around of the top level
+        uint8_t shift = SCHEDULER_WHEEL_SLOT_BITS * SCHEDULER_WHEEL_LEVELS;
+        return ((((now >> shift) + 1) << shift) - now);
+    }
+
+    return (time_ms_t)(-1);
+}
@@ -0,0 +1,149 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include "Task.h"
+
+/**
+ * Number of bits of the absolute expiration time covered by one level of
+ * the wheel. Each level consists of 2^SCHEDULER_WHEEL_SLOT_BITS slots.
+ */
+#ifndef SCHEDULER_WHEEL_SLOT_BITS
+#define SCHEDULER_WHEEL_SLOT_BITS 6
+#endif
+
+/**
+ * Number of levels of the wheel. Tasks expiring further in the future than
+ * 2^(SCHEDULER_WHEEL_SLOT_BITS * SCHEDULER_WHEEL_LEVELS) ms are kept in an
+ * overflow list, which is only inspected when the top level wraps around.
+ */
+#ifndef SCHEDULER_WHEEL_LEVELS
+#define SCHEDULER_WHEEL_LEVELS 4
+#endif
+
+#if SCHEDULER_WHEEL_SLOT_BITS > 6
+#error "SCHEDULER_WHEEL_SLOT_BITS must not exceed 6 (64 slots per level)"
+#endif
+
+#if SCHEDULER_WHEEL_SLOT_BITS * SCHEDULER_WHEEL_LEVELS >= 32
+#error "The wheel must not cover the complete range of time_ms_t"
+#endif
+
+namespace cometos {
+
+/**
+ * Hierarchical timer wheel holding tasks with absolute expiration times.
+ *
+ * A task is stored in the slot of the lowest level at which its expiration
+ * time and the current time of the wheel share all higher order digits.
+ * Adding and removing a task is therefore independent of the number of
+ * pending tasks, and advancing the time only touches occupied slots and
+ * slot boundaries. Tasks with equal expiration times are always kept in the
+ * same list, thus they are executed in FIFO order like with the sorted list
+ * of the TaskScheduler.
+ *
+ * Expired tasks are moved into a ready list, from which they are taken in
+ * order of expiration.
+ *
+ * This class is not thread-safe, the TaskScheduler has to guard all calls
+ * with palExec_atomicBegin()/palExec_atomicEnd().
+ */
+class TimerWheel {
+public:
+    TimerWheel();
+
+    /**
+     * Adds a not yet scheduled task.
+     *
+     * @param expiration time until the task expires in milliseconds
+     */
+    void add(Task& task, time_ms_t expiration);
+
+    /**
+     * Removes a task if it is scheduled.
+     */
+    void remove(Task& task);
+
+    /**
+     * Advances the time of the wheel and moves all tasks that expire
+     * in the meantime into the ready list.
+     */
+    void advance(time_ms_t elapsed);
+
+    /**
+     * Removes and returns the first expired task.
+     *
+     * @return the task or NULL if no task is expired
+     */
+    Task* pop();
+
+    /**
+     * Returns the time until the next slot with pending tasks becomes due.
+     * This is a lower bound for the next expiration: if the next pending
+     * slot is not part of the lowest level, the scheduler wakes up at the
+     * beginning of the slot, cascades it and sleeps again.
+     *
+     * @return 0 if a task is expired, (time_ms_t)(-1) if no task is pending
+     */
+    time_ms_t getTimeUntilNext() const;
+
+private:
+    enum {
+        SLOTS = 1 << SCHEDULER_WHEEL_SLOT_BITS,
+        MASK = SLOTS - 1
+    };
+
+    Task*& getList(time_ms_t expiration);
+    void insert(Task& task);
+    void cascade();
+    void redistribute(Task*& list);
+    void updateOccupied(Task*& list);
+
+    static uint8_t getDigit(time_ms_t time, uint8_t level);
+    static void append(Task*& list, Task& task);
+    static void unlink(Task*& list, Task& task);
+    static void splice(Task*& dst, Task*& src);
+
+    time_ms_t now;
+    /**time up to which advance() currently proceeds, equals now otherwise*/
+    time_ms_t target;
+    Task* ready;
+    Task* overflow;
+    Task* slots[SCHEDULER_WHEEL_LEVELS][SLOTS];
+    uint64_t occupied[SCHEDULER_WHEEL_LEVELS];
+};
+
+}
+
+#endif /* TIMERWHEEL_H_ */
@@ -288,6 +288,36 @@ public:
 //	node_t id;
 };
 
+/**
+ * Typed reference to another module which resolves the name only once.
+ * The module structure of a simulation does not change at runtime.
+ */
+template<class T>
+class ModuleRef {
+public:
+	ModuleRef(Module* owner, const char* name) :
+			owner(owner), name(name), module(NULL) {
+	}
+
+	T* get() {
+		if (module == NULL) {
+			module = static_cast<T*>(owner->getModule(name));
+		}
+		return module;
+	}
+
+	T* operator->() {
+		T* m = get();
+		ASSERT(m != NULL);
+		return m;
+	}
+
+private:
+	Module* owner;
+	const char* name;
+	T* module;
+};
+
 }
 
 #endif /* MODULE_H_ */
@@ -44,6 +44,10 @@
 #include "Object.h"
 #include "cometos.h"
 
+/**Slots are not used in simulations, classes are identified by typeid.
+ */
+#define OBJECT_CONTAINER_SLOT(T, slot)
+
 /*PROTOTYPES-----------------------------------------------------------------*/
 
 namespace cometos {
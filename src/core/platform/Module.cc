@@ -39,6 +39,9 @@
 #include "Module.h"
 #include "string.h"
 #include "OutputStream.h"
+#ifdef PAL_MULTI_NODE
+#include "NodeContext.h"
+#endif
 #ifdef ENABLE_LOGGING
 #include "logging.h"
 #endif
@@ -57,7 +60,17 @@ namespace cometos {
 
 //}
 //using namespace cometos;
-Module* Module::first = NULL;
+static ModuleRegistry globalRegistry;
+
+ModuleRegistry& Module::currentRegistry() {
+#ifdef PAL_MULTI_NODE
+	NodeContext* node = NodeContext::current();
+	if (node != NULL) {
+		return node->getModules();
+	}
+#endif
+	return globalRegistry;
+}
 
 void Module::cancel(Message *msg) {
 	if (msg) {
@@ -66,25 +79,27 @@ void Module::cancel(Message *msg) {
 
 }
 
-int Module::numModules = 0;
-
 Module::Module(const char* service_name)
 #ifdef ENABLE_LOGGING
 : log_level(LOG_LEVEL_FATAL)
 #endif
 {
 	// build up module list
-	next = first;
-	first = this;
-	numModules++;
+	registry = &currentRegistry();
+	next = registry->first;
+	registry->first = this;
+	registry->numModules++;
+	name[0] = 0;
+	registerName();
 	setName(service_name);
 }
 
 Module::~Module() {
-    if (this == first) {
-        first = this->next;
+    unregisterName();
+    if (this == registry->first) {
+        registry->first = this->next;
     } else {
-        Module* curr = first;
+        Module* curr = registry->first;
         while(curr->next != NULL) {
             if (curr->next == this) {
                 curr->next = this->next;
@@ -93,16 +108,48 @@ Module::~Module() {
             curr = curr->next;
         }
     }
-    numModules--;
+    registry->numModules--;
 }
 
 void Module::setName(const char* service_name) {
+	unregisterName();
 	if (service_name) {
 		strncpy(name, service_name, MODULE_NAME_LENGTH - 1);
 		name[MODULE_NAME_LENGTH - 1] = 0;
 	} else {
 		name[0] = 0;
 	}
+	registerName();
+}
+
+uint8_t Module::hashName(const char* name) {
+	// only the stored prefix of a name is hashed
+	uint8_t hash = 0;
+	for (uint8_t i = 0; i < MODULE_NAME_LENGTH - 1 && name[i] != 0; i++) {
+		hash = (hash << 3) + (hash >> 5) + name[i];
+	}
+	return hash & (MODULE_REGISTRY_BUCKETS - 1);
+}
+
+void Module::registerName() {
+	// prepend, so that the latest module wins for duplicate names as
+	// with the module list
+	Module** bucket = &registry->buckets[hashName(name)];
+	nextInBucket = *bucket;
+	*bucket = this;
+	registry->version++;
+}
+
+void Module::unregisterName() {
+	Module** it = &registry->buckets[hashName(name)];
+	while (*it != NULL) {
+		if (*it == this) {
+			*it = nextInBucket;
+			break;
+		}
+		it = &(*it)->nextInBucket;
+	}
+	registry->version++;
 }
 
 bool Module::isScheduled(Message * msg) {
@@ -114,7 +161,7 @@ bool Module::isScheduled(Message * msg) {
 }
 
 void Module::initializeAll() {
-	Module* it = first;
+	Module* it = currentRegistry().first;
 	while (it != NULL) {
 		it->initialize();
 		it = it->next;
@@ -123,36 +170,24 @@ void Module::initializeAll() {
 
 
 Module* Module::getModule(const char* name, uint8_t idx) const {
+	return findModule(*registry, name);
+}
 
-	Module* it = first;
-//#if defined BOARD_devboard or defined BOARD_deRF2RCB
-//#ifdef SERIAL_PRINTF
-//	char tmp[MODULE_NAME_LENGTH] = {it->name[0], it->name[1], it->name[2], it->name[3], 0};
-//
-//	getCout() << tmp << "|" << (uintptr_t) it<< "\n";
-//#endif
-//#endif
-	int i = 0;
+Module* Module::findModule(const char* name) {
+	return findModule(currentRegistry(), name);
+}
+
+Module* Module::findModule(const ModuleRegistry& registry, const char* name) {
+	if (name == NULL) {
+		return NULL;
+	}
+
+	Module* it = registry.buckets[hashName(name)];
 	while (it != NULL) {
-		if (it->name != NULL && 0 == strcmp(it->name, name)) {
-//#if defined BOARD_devboard or defined BOARD_deRF2RCB
-//#ifdef SERIAL_PRINTF
-//		    getCout() << "!\n";
-//#endif
-//#endif
+		if (0 == strcmp(it->name, name)) {
 			return it;
 		}
-		i++;
-		if (i > numModules) {
-		    ASSERT(false);
-		}
-		it = it->next;
-//#if defined BOARD_devboard or defined BOARD_deRF2RCB
-//#ifdef SERIAL_PRINTF
-//		tmp[0] = it->name[0]; tmp[1] = it->name[1]; tmp[2] = it->name[2]; tmp[3]= it->name[3]; tmp[4] = 0;
-//		getCout() << tmp << "|" << (uintptr_t) it<< "\n";
-//#endif
-//#endif
+		it = it->nextInBucket;
 	}
 	return NULL;
 }
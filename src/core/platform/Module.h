@@ -39,6 +39,11 @@
 
 #define MODULE_NAME_LENGTH  5
 
+/**Number of hash buckets used to look up modules by name, power of two*/
+#ifndef MODULE_REGISTRY_BUCKETS
+#define MODULE_REGISTRY_BUCKETS 16
+#endif
+
 /*INCLUDES-------------------------------------------------------------------*/
 #include "Object.h"
 #include "Message.h"
@@ -61,6 +66,21 @@ template<class C>
 class Gate;
 
 class Message;
+class Module;
+
+/**
+ * Modules known by name. There is one registry per process, or one per node
+ * if several nodes are run within one process (PAL_MULTI_NODE).
+ * Zero initialization yields an empty registry.
+ */
+struct ModuleRegistry {
+	Module* first;
+	int numModules;
+	Module* buckets[MODULE_REGISTRY_BUCKETS];
+
+	/** Incremented whenever a module is added, removed or renamed */
+	uint16_t version;
+};
 
 /**
  * This class provides basic functionality for writing modules/protocols in CometOS.
@@ -144,6 +164,24 @@ public:
 	 */
 	static void initializeAll();
 
+	/**Looks up a module by its name in the module registry of the
+	 * current node.
+	 *
+	 * @return	pointer to module or NULL if no such module exists
+	 */
+	static Module* findModule(const char* name);
+
+	/**Incremented whenever a module is added to, removed from or renamed
+	 * in the registry of this module. Allows to cache the result of a lookup.
+	 */
+	uint16_t getRegistryVersion() const {
+		return registry->version;
+	}
+
+	/**Registry used for modules created by the calling thread
+	 */
+	static ModuleRegistry& currentRegistry();
+
 
 
 #ifdef ENABLE_LOGGING
@@ -155,9 +193,17 @@ public:
 
 
 private:
+	static uint8_t hashName(const char* name);
+	static Module* findModule(const ModuleRegistry& registry, const char* name);
+	void registerName();
+	void unregisterName();
+
+	ModuleRegistry* registry;
 	Module* next;
-	static Module* first;
-	static int numModules;
+
+	/** Next module in the same bucket of the registry
+	 */
+	Module* nextInBucket;
 
 	/** Name of service
 	 */
@@ -165,6 +211,38 @@ private:
 
 };
 
+/**
+ * Typed reference to another module which resolves the name only once and
+ * afterwards only if the set of modules has changed.
+ */
+template<class T>
+class ModuleRef {
+public:
+	ModuleRef(Module* owner, const char* name) :
+			owner(owner), name(name), module(NULL), version(0) {
+	}
+
+	T* get() {
+		if (module == NULL || version != owner->getRegistryVersion()) {
+			module = static_cast<T*>(owner->getModule(name));
+			version = owner->getRegistryVersion();
+		}
+		return module;
+	}
+
+	T* operator->() {
+		T* m = get();
+		ASSERT(m != NULL);
+		return m;
+	}
+
+private:
+	Module* owner;
+	const char* name;
+	T* module;
+	uint16_t version;
+};
+
 }
 
 #endif /* MODULE_H_ */
@@ -45,13 +45,45 @@
 #include "Object.h"
 #include "cometosAssert.h"
 
+/*MACROS---------------------------------------------------------------------*/
+
+/**Number of slots of a container, which hold the objects of the classes
+ * assigned to them with OBJECT_CONTAINER_SLOT and are accessed in constant
+ * time. Objects of other classes are kept in a linked list. Every container
+ * grows by a pointer per slot, thus it is disabled by default and enabled by
+ * the platform (object_container_slots).
+ */
+#ifndef OBJECT_CONTAINER_SLOTS
+#define OBJECT_CONTAINER_SLOTS 0
+#endif
+
+/**Assigns a slot (starting with 1) to a class, e.g., to metadata attached
+ * to every frame. Has to be used in the global namespace after the class
+ * is declared and before it is used with a container. Slots above
+ * OBJECT_CONTAINER_SLOTS are ignored.
+ */
+#define OBJECT_CONTAINER_SLOT(T, slot) \
+	namespace cometos { \
+	template<> struct ObjectContainerSlot<T> { enum { value = slot }; }; \
+	}
+
 /*PROTOTYPES-----------------------------------------------------------------*/
 
 namespace cometos {
 
+/**Slot of a class in an ObjectContainer, 0 if it has none
+ */
+template<class T>
+struct ObjectContainerSlot {
+	enum { value = 0 };
+};
+
 /**
  * This container allows an aggregation of arbitrary object. Note that from each class only
  * one occurrence can be stored. The access is done via the class names.
+ *
+ * Classes with a slot of their own are accessed in constant time, further
+ * classes are searched in a list.
  */
 class ObjectContainer: public Object {
 public:
@@ -64,6 +96,15 @@ public:
 	    if (&obj != this) {
             removeAll();
 
+#if OBJECT_CONTAINER_SLOTS > 0
+            for (uint8_t i = 0; i < OBJECT_CONTAINER_SLOTS; i++) {
+                if (obj.slots_[i] != NULL) {
+                    slots_[i] = obj.slots_[i]->getCopy();
+                    slots_[i]->id_ = obj.slots_[i]->id_;
+                }
+            }
+#endif
+
             // get pointer to object list
             Object* p = obj.next_;
 
@@ -81,15 +122,24 @@ public:
 	}
 
 	ObjectContainer() {
+		clearSlots();
 	}
 
 	/**Copy Constructor
 	 */
 	ObjectContainer(const ObjectContainer& p) {
+		clearSlots();
 		*this = p;
 	}
 
 	void removeAll() {
+#if OBJECT_CONTAINER_SLOTS > 0
+		for (uint8_t i = 0; i < OBJECT_CONTAINER_SLOTS; i++) {
+			delete slots_[i];
+		}
+#endif
+		clearSlots();
+
 		Object* p = next_;
 		while (p != NULL) {
 			Object* r = p;
@@ -105,6 +155,11 @@ public:
 
 	template<class T>
 	T* getUnsafe() const {
+		Object* const* slot = getSlot<T>();
+		if (slot != NULL) {
+			return (T*) *slot;
+		}
+
 		uint8_t id = UniqueClassId::get<T>();
 		Object* p = next_;
 
@@ -134,8 +189,14 @@ public:
 	    if (pointer != NULL && pointer != nullptr) {
             remove<T> (); // remove old object of class if present
             pointer->id_ = UniqueClassId::get<T>();
-            pointer->next_ = next_;
-            next_ = pointer;
+            Object** slot = getSlot<T>();
+            if (slot != NULL) {
+                pointer->next_ = NULL;
+                *slot = pointer;
+            } else {
+                pointer->next_ = next_;
+                next_ = pointer;
+            }
 	    }
 	}
 
@@ -146,6 +207,13 @@ public:
 	template<class T>
 	T* unset() {
 
+		Object** slot = getSlot<T>();
+		if (slot != NULL) {
+			T* p = (T*) *slot;
+			*slot = NULL;
+			return p;
+		}
+
 		uint8_t id = UniqueClassId::get<T>();
 		Object* p = next_;
 		Object* prev = this;
@@ -167,6 +235,37 @@ public:
 		if (p)
 			delete p;
 	}
+
+private:
+	/**@return slot of class T or NULL if it has none
+	 */
+	template<class T>
+	Object** getSlot() {
+#if OBJECT_CONTAINER_SLOTS > 0
+		const uint8_t slot = ObjectContainerSlot<T>::value;
+		if (slot > 0 && slot <= OBJECT_CONTAINER_SLOTS) {
+			return &slots_[slot - 1];
+		}
+#endif
+		return NULL;
+	}
+
+	template<class T>
+	Object* const* getSlot() const {
+		return const_cast<ObjectContainer*>(this)->getSlot<T>();
+	}
+
+	void clearSlots() {
+#if OBJECT_CONTAINER_SLOTS > 0
+		for (uint8_t i = 0; i < OBJECT_CONTAINER_SLOTS; i++) {
+			slots_[i] = NULL;
+		}
+#endif
+	}
+
+#if OBJECT_CONTAINER_SLOTS > 0
+	Object* slots_[OBJECT_CONTAINER_SLOTS];
+#endif
 };
 
 }
@@ -39,6 +39,9 @@
 
 
 #include "pal.h"
+#ifdef PAL_MULTI_NODE
+#include "NodeContext.h"
+#endif
 
 uint16_t intrand(uint16_t r)
 {
@@ -67,6 +70,12 @@ bool run_once() {
 
 // returns task scheduler
 TaskScheduler &getScheduler() {
+#ifdef PAL_MULTI_NODE
+    NodeContext* node = NodeContext::current();
+    if (node != NULL) {
+        return node->getScheduler();
+    }
+#endif
     static TaskScheduler scheduler;
     return scheduler;
 }
@@ -44,6 +44,7 @@
  *
  * <li> BlockAllocator: paging algorithm
  * <li> SurmAllocator: multiple pool allocation (dynamic pool management)
+ * <li> SlabAllocator: size classes with per-class free lists, O(1)
  *
  * Currently it is recommend to use the SurmAllocator.
  */
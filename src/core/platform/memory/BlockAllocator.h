@@ -137,10 +137,8 @@ public:
 			}
 		}
 
-		if (pointer == NULL) {
-			ASSERT(false);
-		}
-
+		// exhaustion is checked by the memory wrapper, which allows to
+		// disable it via MEMORY_NO_EXHAUSTION_CHECK
 		return pointer;
 	}
 
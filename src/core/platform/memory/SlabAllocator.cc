@@ -30,34 +30,33 @@
  * SUCH DAMAGE.
  */
 
-/**
- * @author: Marvin Burmeister, Martin Ringwelski
- */
+#ifdef MEMORY_THREAD_SAFE
+#include "atomic.h"
+#endif
+
+#include "SlabAllocator.h"
+#include "memory.h"
+
+namespace cometos {
 
-#include "CoAPMessageOption.h"
-
-namespace cometos_v6 {
-
-CoAPMessageOption::CoAPMessageOption(
-        CoAPBuffer_t* buffer, uint16_t optNr, const char* optData,
-        uint16_t optLen, uint8_t optOrder) :
-                bufferInfo(buffer->getBuffer(optLen + 3))
-{
-   /// this->buffer = buffer;
-    if(bufferInfo == NULL) {
-        return;
-    }
-    bufferInfo->copyToBuffer((uint8_t*) &optNr, 2, 0);
-    bufferInfo->copyToBuffer((uint8_t*) &optOrder, 1, 2);
-    bufferInfo->copyToBuffer((uint8_t*) optData, optLen, 3);
+// ensures that SlabAllocator is initialized
+static inline SlabAllocator<SLAB_PAGES, SLAB_PAGE_SIZE> &memory() {
+	static SlabAllocator<SLAB_PAGES, SLAB_PAGE_SIZE> mem;
+	return mem;
 }
 
+uint8_t heapGetUtilization() {
+	return ((uint32_t) memory().getUsedPages() * 100) / memory().getTotalPages();
+}
 
-CoAPMessageOption::~CoAPMessageOption()
-{
-    if(bufferInfo != NULL){
-        bufferInfo->free();
-    }
+uint8_t slabGetNumClasses() {
+	return memory().getNumClasses();
 }
 
+const SlabClassStats& slabGetStats(uint8_t sizeClass) {
+	return memory().getStats(sizeClass);
 }
+
+} // namespace
+
+#include "memory_wrapper.h"
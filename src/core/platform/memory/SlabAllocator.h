@@ -0,0 +1,323 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "cometosAssert.h"
+#include "memory.h"
+
+/*MACROS---------------------------------------------------------------------*/
+
+// the heap is divided into pages of SLAB_PAGE_SIZE bytes, each page is
+// assigned to a single size class on demand
+#ifndef SLAB_PAGE_SIZE
+#define SLAB_PAGE_SIZE		256
+#endif
+
+#ifndef SLAB_PAGES
+#define SLAB_PAGES			(MEMORY_HEAP_SIZE/SLAB_PAGE_SIZE)
+#endif
+
+#define SLAB_NUM_CLASSES	9
+#define SLAB_NONE			0xFFFF
+#define SLAB_FREE_PAGE		0xFF
+
+namespace cometos {
+
+/**
+ * Statistics of a single size class of the SlabAllocator.
+ */
+struct SlabClassStats {
+	SlabClassStats() :
+			size(0), objects(0), highWater(0), pages(0), failed(0) {
+	}
+
+	uint16_t size;
+	/**currently allocated objects*/
+	uint16_t objects;
+	/**maximum number of objects allocated at the same time*/
+	uint16_t highWater;
+	/**pages currently assigned to this class*/
+	uint16_t pages;
+	/**allocations failed because no page was left*/
+	uint16_t failed;
+};
+
+/**THIS CLASS IS NOT THREAD-SAFE, NEVER INVOKE MEMBERS
+ * INSIDE OF AN ISR
+ *
+ * Size-class (slab) allocator. Requests are rounded up to one of the
+ * size classes 8, 16, 24, 32, 48, 64, 96, 128 and 256 bytes. Every class
+ * keeps a list of pages with free objects, and every page keeps a list of
+ * its free objects. Pages are taken from a common pool when a class runs
+ * out of objects and are returned as soon as all their objects are freed.
+ *
+ * allocate O(1)  (O(objects per page) when a new page is assigned)
+ * deallocate O(1)
+ *
+ * No header is stored with the objects, the class of an object is derived
+ * from the page it is located in.
+ *
+ * Objects are 8-byte aligned. No stronger alignment is guaranteed, in
+ * particular objects of the 24, 48 and 96 byte classes are only 8-byte
+ * aligned, so they must not hold types requiring more.
+ */
+template<uint16_t PAGES = SLAB_PAGES, uint16_t PAGE_SIZE = SLAB_PAGE_SIZE>
+class SlabAllocator {
+public:
+	SlabAllocator() :
+			freePages(SLAB_NONE), usedPages(0) {
+		for (uint16_t i = 0; i < PAGES; i++) {
+			pages[i].cls = SLAB_FREE_PAGE;
+			pages[i].next = (i + 1 < PAGES) ? i + 1 : SLAB_NONE;
+		}
+		if (PAGES > 0) {
+			freePages = 0;
+		}
+		for (uint8_t c = 0; c < SLAB_NUM_CLASSES; c++) {
+			partial[c] = SLAB_NONE;
+			stats[c].size = getClassSize(c);
+		}
+	}
+
+	/**
+	 * Allocates memory.
+	 *
+	 * @param size	size of memory block, at most PAGE_SIZE bytes
+	 * @return pointer to memory or NULL if exhausted
+	 */
+	void* allocate(size_t size) {
+		uint8_t c = getClass(size);
+		if (c == SLAB_NUM_CLASSES) {
+			return NULL;
+		}
+
+		uint16_t p = partial[c];
+		if (p == SLAB_NONE) {
+			p = assignPage(c);
+			if (p == SLAB_NONE) {
+				stats[c].failed++;
+				return NULL;
+			}
+		}
+
+		Page& page = pages[p];
+		uint8_t* object = getPage(p) + page.freeHead;
+		page.freeHead = *((uint16_t*) object);
+		page.used++;
+		if (page.freeHead == SLAB_NONE) {
+			unlinkPartial(c, p);
+		}
+
+		stats[c].objects++;
+		if (stats[c].objects > stats[c].highWater) {
+			stats[c].highWater = stats[c].objects;
+		}
+		return object;
+	}
+
+	/**
+	 * Frees allocated memory.
+	 *
+	 * @param pointer	pointer to allocated memory or NULL
+	 */
+	void deallocate(void* pointer) {
+		if (pointer == NULL) {
+			return;
+		}
+
+		ASSERT((uint8_t*) pointer >= heap);
+		ASSERT((uint8_t*) pointer < heap + PAGES * PAGE_SIZE);
+
+		// the heap may exceed 64 KiB, only the offset in a page fits 16 bit
+		size_t heapOffset = (uint8_t*) pointer - heap;
+		uint16_t p = heapOffset / PAGE_SIZE;
+		uint16_t offset = heapOffset - (size_t) p * PAGE_SIZE;
+
+		Page& page = pages[p];
+		ASSERT(page.cls != SLAB_FREE_PAGE);
+		ASSERT(page.used > 0);
+		ASSERT(offset % getClassSize(page.cls) == 0);
+
+		uint8_t c = page.cls;
+		bool wasFull = (page.freeHead == SLAB_NONE);
+		*((uint16_t*) pointer) = page.freeHead;
+		page.freeHead = offset;
+		page.used--;
+		stats[c].objects--;
+
+		if (page.used == 0) {
+			if (!wasFull) {
+				unlinkPartial(c, p);
+			}
+			releasePage(p);
+		} else if (wasFull) {
+			pushPartial(c, p);
+		}
+	}
+
+	/**
+	 * @return number of size classes
+	 */
+	inline uint8_t getNumClasses() {
+		return SLAB_NUM_CLASSES;
+	}
+
+	/**
+	 * @return statistics of the given size class
+	 */
+	inline const SlabClassStats& getStats(uint8_t c) {
+		ASSERT(c < SLAB_NUM_CLASSES);
+		return stats[c];
+	}
+
+	/**
+	 * @return number of pages assigned to any size class
+	 */
+	inline uint16_t getUsedPages() {
+		return usedPages;
+	}
+
+	/**
+	 * @return number of total pages
+	 */
+	inline uint16_t getTotalPages() {
+		return PAGES;
+	}
+
+private:
+	struct Page {
+		uint16_t freeHead;
+		uint16_t next;
+		uint16_t prev;
+		uint16_t used;
+		uint8_t cls;
+	};
+
+	static uint16_t getClassSize(uint8_t c) {
+		static const uint16_t sizes[SLAB_NUM_CLASSES] =
+				{ 8, 16, 24, 32, 48, 64, 96, 128, 256 };
+		return sizes[c];
+	}
+
+	/**
+	 * @return smallest class fitting size or SLAB_NUM_CLASSES
+	 */
+	static uint8_t getClass(size_t size) {
+		for (uint8_t c = 0; c < SLAB_NUM_CLASSES; c++) {
+			if (size <= getClassSize(c)) {
+				return getClassSize(c) <= PAGE_SIZE ? c : SLAB_NUM_CLASSES;
+			}
+		}
+		return SLAB_NUM_CLASSES;
+	}
+
+	inline uint8_t* getPage(uint16_t p) {
+		return heap + p * PAGE_SIZE;
+	}
+
+	uint16_t assignPage(uint8_t c) {
+		uint16_t p = freePages;
+		if (p == SLAB_NONE) {
+			return SLAB_NONE;
+		}
+		freePages = pages[p].next;
+		usedPages++;
+
+		// link all objects of the page
+		uint16_t size = getClassSize(c);
+		uint16_t num = PAGE_SIZE / size;
+		uint8_t* base = getPage(p);
+		for (uint16_t i = 0; i < num; i++) {
+			*((uint16_t*) (base + i * size)) =
+					(i + 1 < num) ? (i + 1) * size : SLAB_NONE;
+		}
+
+		Page& page = pages[p];
+		page.cls = c;
+		page.used = 0;
+		page.freeHead = 0;
+		pushPartial(c, p);
+		stats[c].pages++;
+		return p;
+	}
+
+	void releasePage(uint16_t p) {
+		stats[pages[p].cls].pages--;
+		pages[p].cls = SLAB_FREE_PAGE;
+		pages[p].next = freePages;
+		freePages = p;
+		usedPages--;
+	}
+
+	void pushPartial(uint8_t c, uint16_t p) {
+		pages[p].prev = SLAB_NONE;
+		pages[p].next = partial[c];
+		if (partial[c] != SLAB_NONE) {
+			pages[partial[c]].prev = p;
+		}
+		partial[c] = p;
+	}
+
+	void unlinkPartial(uint8_t c, uint16_t p) {
+		if (pages[p].prev != SLAB_NONE) {
+			pages[pages[p].prev].next = pages[p].next;
+		} else {
+			partial[c] = pages[p].next;
+		}
+		if (pages[p].next != SLAB_NONE) {
+			pages[pages[p].next].prev = pages[p].prev;
+		}
+	}
+
+	uint8_t heap[PAGES * PAGE_SIZE] __attribute__((aligned(8)));
+	Page pages[PAGES];
+	uint16_t partial[SLAB_NUM_CLASSES];
+	uint16_t freePages;
+	uint16_t usedPages;
+	SlabClassStats stats[SLAB_NUM_CLASSES];
+};
+
+/**
+ * Access to the statistics of the allocator backing operator new,
+ * only available if the SlabAllocator is selected (allocator='slab').
+ */
+uint8_t slabGetNumClasses();
+
+const SlabClassStats& slabGetStats(uint8_t sizeClass);
+
+} // namespace
+
+#endif // SLAB_ALLOCATOR_H
@@ -103,7 +103,7 @@ CDataListElement* SurmAllocator::GetMainElement(CListElement* Element)
 	return (CDataListElement*) ((uint8_t*)Memory + Diff);
 }
 
-void* SurmAllocator::allocate(size_t size)
+void* SurmAllocator::allocate(size_t Size)
 {
     ASSERT(Size <=255);
 
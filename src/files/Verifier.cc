@@ -36,6 +36,7 @@
  */
 
 #include "Verifier.h"
+#include "crc16.h"
 
 Define_Module(cometos::Verifier);
 
@@ -62,16 +63,11 @@ Arbiter* Verifier::getArbiter()
  */
 uint16_t Verifier::updateCRC(uint16_t crc, const uint8_t* data, uint16_t length, bool addition)
 {
+    if(addition == false) {
+        return crc16xmodem_updateBlock(crc, data, length);
+    }
     for(uint16_t j = 0; j < length; j++) {
-        if(addition == true) {
-	    crc = crc + ((uint16_t)data[j]);
-	} else {
-	    crc = crc ^ ((uint16_t)data[j] << 8);
-            for (uint8_t i=0; i<8; i++) {
-                if (crc & 0x8000) crc = (crc << 1) ^ 0x1021;
-                else crc <<= 1;
-            }
-	}
+        crc = crc + ((uint16_t)data[j]);
     }
     return crc;
 }
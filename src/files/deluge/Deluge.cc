@@ -412,10 +412,7 @@ void Deluge::sendObjectProfile() {
     (*frame) << pInfo->getVersion();
 
     // Generate crc code
-    uint16_t crc = 0;
-    for (uint16_t i = 0; i < frame->getLength(); i++) {
-        crc = crc16_update(crc, frame->getData()[i]);
-    }
+    uint16_t crc = crc16_updateBlock(0, frame->getData(), frame->getLength());
     (*frame) << crc;
 
     // Insert msg type
@@ -435,10 +432,7 @@ void Deluge::handleObjectProfile() {
     (*frame) >> crc;
 
     // Generate crc code
-    uint16_t checkCRC = 0;
-    for (uint16_t i = 0; i < frame->getLength(); i++) {
-        checkCRC = crc16_update(checkCRC, frame->getData()[i]);
-    }
+    uint16_t checkCRC = crc16_updateBlock(0, frame->getData(), frame->getLength());
     ASSERT(checkCRC == crc);
 
     // Extract version number
@@ -0,0 +1,74 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**
+ * CometOS Platform Abstraction Layer for event driven I/O on hosted
+ * platforms (PAL_REACTOR). Instead of polling file descriptors from
+ * periodic tasks, a module registers a descriptor together with a task.
+ * palExec_sleep() blocks until the next timer expires or one of the
+ * registered descriptors becomes readable.
+ */
+
+#ifndef PALREACTOR_H_
+#define PALREACTOR_H_
+
+namespace cometos {
+class Task;
+}
+
+/**
+ * @return true if descriptors can be watched by the calling thread
+ */
+bool palReactor_isAvailable();
+
+/**
+ * Watches a file descriptor for incoming data. Once it is readable, the
+ * task is added to the scheduler and the descriptor is disabled until
+ * palReactor_rearm() is called, usually after the task has read all
+ * available data.
+ *
+ * @return false if the descriptor can not be watched, e.g., because the
+ *         host is not supported. The caller has to poll in this case.
+ */
+bool palReactor_add(int fd, cometos::Task* task);
+
+/**
+ * Enables a descriptor again after its task was added to the scheduler.
+ */
+void palReactor_rearm(int fd);
+
+/**
+ * Stops watching a descriptor, has to be called before closing it.
+ */
+void palReactor_remove(int fd);
+
+#endif /* PALREACTOR_H_ */
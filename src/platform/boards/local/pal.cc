@@ -39,6 +39,9 @@
 #include "palId.h"
 #include "palLed.h"
 #include "palLocalTime.h"
+#ifdef PAL_MULTI_NODE
+#include "NodeContext.h"
+#endif
 
 
 //#ifdef SERIAL_PRINTF
@@ -63,6 +66,12 @@ void __cxa_pure_virtual() {
 }
 
 node_t palId_id() {
+#ifdef PAL_MULTI_NODE
+	cometos::NodeContext* node = cometos::NodeContext::current();
+	if (node != NULL) {
+		return node->getId();
+	}
+#endif
 #ifdef BASESTATION_ADDR
 	return BASESTATION_ADDR;
 #else
@@ -46,6 +46,10 @@
 #include "Task.h"
 #include <map>
 
+#ifdef PAL_REACTOR
+#include "palReactor.h"
+#endif
+
 namespace cometos {
 
 #ifndef _WIN32
@@ -99,8 +103,48 @@ private:
     ,   txReadyCallback(NULL)
     ,   rxStartCallback(NULL)
     ,	port(port)
+    ,   rxTask(*this)
+    ,   eventDriven(false)
+    ,   rxStalled(false)
     {}
 
+    /**
+     * Fetches the data of the readable port into the rx buffer, the port is
+     * watched again as soon as the buffer has free space.
+     */
+    void receive() {
+        thread_lockMutex(rxMutex);
+        int numFree = RX_BUFFER_SIZE - rxLength;
+        int tillEnd = RX_BUFFER_SIZE - rxPos;
+        uint8_t toRead = tillEnd < numFree ? tillEnd : numFree;
+        int n = PollComport(hPort, rxBuffer + rxPos, toRead);
+        if (n > 0) {
+            rxPos = (rxPos + n) % RX_BUFFER_SIZE;
+            rxLength += n;
+        }
+        rxStalled = (rxLength >= RX_BUFFER_SIZE);
+        bool available = rxLength > 0;
+        thread_unlockMutex(rxMutex);
+
+        if (n < 0) {
+            getCout() << "Could not poll to port with handle " << hPort << ", aborting" << endl;
+            return;
+        }
+#ifdef PAL_REACTOR
+        if (!rxStalled) {
+            palReactor_rearm(hPort);
+        }
+#endif
+        if (available && rxStartCallback != NULL) {
+            rxStartCallback->invoke();
+        }
+    }
+
+    // reads the port if it is watched by the reactor instead of rxThread
+    BoundedTask<PalSerialImpl, &PalSerialImpl::receive> rxTask;
+    bool eventDriven;
+    bool rxStalled;
+
 
 public:
     void init(uint32_t baudrate, Task* rxStartCallback,
@@ -125,7 +169,13 @@ public:
             return;
         }
 
-        rxThread = thread_run(rxHandle, this);
+#ifdef PAL_REACTOR
+        // no thread has to wake up periodically to check for data
+        eventDriven = palReactor_add(hPort, &rxTask);
+#endif
+        if (!eventDriven) {
+            rxThread = thread_run(rxHandle, this);
+        }
         txThread = thread_run(txHandle, this);
     }
 
@@ -177,8 +227,18 @@ public:
 
         thread_lockMutex(rxMutex);
         rxLength -= length;
+        bool resume = rxStalled && length > 0;
+        if (resume) {
+            rxStalled = false;
+        }
         thread_unlockMutex(rxMutex);
 
+#ifdef PAL_REACTOR
+        if (resume) {
+            palReactor_rearm(hPort);
+        }
+#endif
+
         return length;
     }
 
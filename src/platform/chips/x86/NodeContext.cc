@@ -0,0 +1,98 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "NodeContext.h"
+#include "NodePool.h"
+
+namespace cometos {
+
+static thread_local NodeContext* currentNode = NULL;
+
+NodeContext::Scope::Scope(NodeContext& node)
+: previous(currentNode) {
+	currentNode = &node;
+}
+
+NodeContext::Scope::~Scope() {
+	currentNode = previous;
+}
+
+NodeContext::NodeContext(node_t id)
+: id(id),
+  modules(),
+  remainingUs(0),
+  pool(NULL),
+  state(IDLE),
+  wakeupPending(false),
+  timerGeneration(0) {
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE_NP);
+	pthread_mutex_init(&lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+	gettimeofday(&lastElapsed, NULL);
+}
+
+NodeContext::~NodeContext() {
+	pthread_mutex_destroy(&lock);
+}
+
+NodeContext* NodeContext::current() {
+	return currentNode;
+}
+
+void NodeContext::atomicBegin() {
+	pthread_mutex_lock(&lock);
+}
+
+void NodeContext::atomicEnd() {
+	pthread_mutex_unlock(&lock);
+}
+
+time_ms_t NodeContext::elapsed() {
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	long elapsedTime = (now.tv_sec - lastElapsed.tv_sec) * 1000000;
+	elapsedTime += (now.tv_usec - lastElapsed.tv_usec) + remainingUs;
+	long offset = elapsedTime / 1000;
+	remainingUs = elapsedTime - (offset * 1000); // remember remaining us for next call
+	lastElapsed = now;
+	return offset;
+}
+
+void NodeContext::wakeup() {
+	if (pool != NULL) {
+		pool->wakeup(*this);
+	}
+}
+
+}
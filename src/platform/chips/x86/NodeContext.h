@@ -0,0 +1,132 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef NODECONTEXT_H_
+#define NODECONTEXT_H_
+
+#include <pthread.h>
+#include <sys/time.h>
+#include "types.h"
+#include "TaskScheduler.h"
+#include "Module.h"
+
+namespace cometos {
+
+class NodePool;
+
+/**
+ * State of one CometOS node if several nodes are run within one process
+ * (PAL_MULTI_NODE). Each node has its own scheduler, module registry, id
+ * and lock for palExec_atomicBegin/End. getScheduler(), palId_id() and the
+ * module registry refer to the node that is current for the calling thread.
+ *
+ * Modules of a node have to be created while the node is current:
+ *
+ *   NodeContext* node = new NodeContext(id);
+ *   {
+ *       NodeContext::Scope scope(*node);
+ *       new MyModule();
+ *       Module::initializeAll();
+ *   }
+ *   pool.add(*node);
+ *
+ * Code that hands a task to another node (e.g. an emulated radio channel)
+ * has to make the target node current with a Scope while calling
+ * getScheduler().add(), so that the target's lock is taken and its worker
+ * is woken up.
+ */
+class NodeContext {
+	friend class NodePool;
+public:
+	/**Makes a node current for the calling thread during its lifetime
+	 */
+	class Scope {
+	public:
+		Scope(NodeContext& node);
+		~Scope();
+	private:
+		NodeContext* previous;
+	};
+
+	NodeContext(node_t id);
+	~NodeContext();
+
+	/**@return node of the calling thread or NULL if none is current
+	 */
+	static NodeContext* current();
+
+	node_t getId() const {
+		return id;
+	}
+
+	TaskScheduler& getScheduler() {
+		return scheduler;
+	}
+
+	ModuleRegistry& getModules() {
+		return modules;
+	}
+
+	void atomicBegin();
+	void atomicEnd();
+
+	/**@return milliseconds since the last call for this node
+	 */
+	time_ms_t elapsed();
+
+	/**Called if a task is added to the scheduler of this node
+	 */
+	void wakeup();
+
+private:
+	enum State {
+		IDLE, QUEUED, RUNNING, STOPPED
+	};
+
+	node_t id;
+	TaskScheduler scheduler;
+	ModuleRegistry modules;
+	pthread_mutex_t lock;
+
+	struct timeval lastElapsed;
+	long remainingUs;
+
+	// managed by the NodePool, protected by lock
+	NodePool* pool;
+	State state;
+	bool wakeupPending;
+	uint32_t timerGeneration;
+};
+
+}
+
+#endif /* NODECONTEXT_H_ */
@@ -0,0 +1,287 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "NodePool.h"
+#include "palLocalTime.h"
+#include "cometosAssert.h"
+#include <sys/time.h>
+
+namespace cometos {
+
+// node that is run by the worker of the calling thread
+static thread_local NodeContext* runningNode = NULL;
+
+NodePool::NodePool(uint8_t numWorkers)
+: nextWorker(0),
+  queued(0),
+  idleWorkers(0),
+  stopSignal(false),
+  timersPending(false),
+  nextDue(0) {
+	ASSERT(numWorkers > 0);
+	pthread_mutex_init(&lock, NULL);
+	pthread_cond_init(&cond, NULL);
+	for (uint8_t i = 0; i < numWorkers; i++) {
+		Worker* worker = new Worker;
+		worker->pool = this;
+		worker->index = i;
+		pthread_mutex_init(&worker->lock, NULL);
+		workers.push_back(worker);
+	}
+}
+
+NodePool::~NodePool() {
+	for (uint8_t i = 0; i < workers.size(); i++) {
+		pthread_mutex_destroy(&workers[i]->lock);
+		delete workers[i];
+	}
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&lock);
+}
+
+void NodePool::add(NodeContext& node) {
+	node.atomicBegin();
+	node.pool = this;
+	node.state = NodeContext::QUEUED;
+	enqueue(*workers[nextWorker++ % workers.size()], node);
+	node.atomicEnd();
+}
+
+void NodePool::run() {
+	stopSignal = false;
+
+	for (uint8_t i = 0; i < workers.size(); i++) {
+		pthread_create(&workers[i]->thread, NULL, workerMain, workers[i]);
+	}
+	for (uint8_t i = 0; i < workers.size(); i++) {
+		pthread_join(workers[i]->thread, NULL);
+	}
+}
+
+void NodePool::stop() {
+	pthread_mutex_lock(&lock);
+	stopSignal = true;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&lock);
+}
+
+void NodePool::wakeup(NodeContext& node) {
+	if (&node == runningNode) {
+		// the scheduler is checked anyway at the end of the slice
+		return;
+	}
+
+	node.atomicBegin();
+	if (node.state == NodeContext::IDLE) {
+		node.state = NodeContext::QUEUED;
+		node.timerGeneration++; // invalidates a pending timer
+		enqueue(*workers[nextWorker++ % workers.size()], node);
+	} else if (node.state == NodeContext::RUNNING) {
+		node.wakeupPending = true;
+	}
+	node.atomicEnd();
+}
+
+void* NodePool::workerMain(void* arg) {
+	Worker* worker = (Worker*) arg;
+	worker->pool->work(*worker);
+	return NULL;
+}
+
+// requires the lock of the node
+void NodePool::enqueue(Worker& worker, NodeContext& node) {
+	pthread_mutex_lock(&worker.lock);
+	worker.queue.push_back(&node);
+	pthread_mutex_unlock(&worker.lock);
+
+	// a worker going to sleep increments idleWorkers before it checks
+	// queued, thus either it sees the node or it is signaled here
+	queued++;
+	if (idleWorkers > 0) {
+		pthread_mutex_lock(&lock);
+		pthread_cond_signal(&cond);
+		pthread_mutex_unlock(&lock);
+	}
+}
+
+// requires the lock of the pool
+void NodePool::updateNextDue() {
+	timersPending = !timers.empty();
+	if (!timers.empty()) {
+		nextDue = timers.top().due;
+	}
+}
+
+NodeContext* NodePool::expire() {
+	time_ms_t now = palLocalTime_get();
+	if (!timersPending || (int32_t)(nextDue - now) > 0) {
+		return NULL;
+	}
+
+	while (true) {
+		pthread_mutex_lock(&lock);
+		if (timers.empty() || (int32_t)(timers.top().due - now) > 0) {
+			pthread_mutex_unlock(&lock);
+			return NULL;
+		}
+		Timer timer = timers.top();
+		timers.pop();
+		updateNextDue();
+		pthread_mutex_unlock(&lock);
+
+		NodeContext* node = timer.node;
+		node->atomicBegin();
+		bool valid = node->state == NodeContext::IDLE
+				&& node->timerGeneration == timer.generation;
+		if (valid) {
+			node->state = NodeContext::RUNNING;
+			node->wakeupPending = false;
+		}
+		node->atomicEnd();
+		if (valid) {
+			return node;
+		}
+	}
+}
+
+NodeContext* NodePool::take(Worker& worker) {
+	// nodes whose timer expired first, they would starve otherwise as long
+	// as the queues are not empty
+	NodeContext* node = expire();
+	if (node != NULL) {
+		return node;
+	}
+
+	// own queue, oldest node first
+	pthread_mutex_lock(&worker.lock);
+	if (!worker.queue.empty()) {
+		node = worker.queue.front();
+		worker.queue.pop_front();
+	}
+	pthread_mutex_unlock(&worker.lock);
+
+	// steal the most recently queued node of another worker
+	for (uint8_t i = 1; node == NULL && i < workers.size(); i++) {
+		Worker& victim = *workers[(worker.index + i) % workers.size()];
+		pthread_mutex_lock(&victim.lock);
+		if (!victim.queue.empty()) {
+			node = victim.queue.back();
+			victim.queue.pop_back();
+		}
+		pthread_mutex_unlock(&victim.lock);
+	}
+
+	if (node != NULL) {
+		queued--;
+		node->atomicBegin();
+		node->state = NodeContext::RUNNING;
+		node->wakeupPending = false;
+		node->atomicEnd();
+	}
+	return node;
+}
+
+void NodePool::work(Worker& worker) {
+	while (!stopSignal) {
+		NodeContext* node = take(worker);
+		if (node != NULL) {
+			runSlice(worker, *node);
+		} else {
+			sleep();
+		}
+	}
+}
+
+void NodePool::sleep() {
+	pthread_mutex_lock(&lock);
+	idleWorkers++;
+	if (queued == 0 && !stopSignal) {
+		if (timers.empty()) {
+			pthread_cond_wait(&cond, &lock);
+		} else {
+			time_ms_t wait = timers.top().due - palLocalTime_get();
+			if ((int32_t) wait > 0) {
+				struct timeval tp;
+				struct timespec ts;
+				gettimeofday(&tp, NULL);
+				tp.tv_usec += (long) wait * 1000;
+				ts.tv_sec = tp.tv_sec + tp.tv_usec / 1000000;
+				ts.tv_nsec = (tp.tv_usec % 1000000) * 1000;
+				pthread_cond_timedwait(&cond, &lock, &ts);
+			}
+		}
+	}
+	idleWorkers--;
+	pthread_mutex_unlock(&lock);
+}
+
+void NodePool::runSlice(Worker& worker, NodeContext& node) {
+	NodeContext::Scope scope(node);
+	runningNode = &node;
+
+	bool stopped = false;
+	for (uint8_t i = 0; i < TASKS_PER_SLICE && !stopped; i++) {
+		stopped = node.scheduler.run(false);
+		if (node.scheduler.getTimeUntilNextExecution() != 0) {
+			break;
+		}
+	}
+	time_ms_t next = node.scheduler.getTimeUntilNextExecution();
+
+	runningNode = NULL;
+
+	node.atomicBegin();
+	if (stopped) {
+		node.state = NodeContext::STOPPED;
+	} else if (next == 0 || node.wakeupPending) {
+		node.state = NodeContext::QUEUED;
+		enqueue(worker, node);
+	} else {
+		node.state = NodeContext::IDLE;
+		node.timerGeneration++;
+		if (next != (time_ms_t) -1) {
+			Timer timer;
+			timer.due = palLocalTime_get() + next;
+			timer.generation = node.timerGeneration;
+			timer.node = &node;
+			pthread_mutex_lock(&lock);
+			timers.push(timer);
+			updateNextDue();
+			// an idle worker may have to wait for a shorter period now
+			pthread_cond_signal(&cond);
+			pthread_mutex_unlock(&lock);
+		}
+	}
+	node.atomicEnd();
+}
+
+}
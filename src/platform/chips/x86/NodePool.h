@@ -0,0 +1,133 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef NODEPOOL_H_
+#define NODEPOOL_H_
+
+#include <pthread.h>
+#include <atomic>
+#include <deque>
+#include <queue>
+#include <vector>
+#include "NodeContext.h"
+
+namespace cometos {
+
+/**
+ * Runs the schedulers of many NodeContexts on a fixed number of worker
+ * threads. Every worker has its own queue of runnable nodes and steals
+ * from the other queues if it runs dry. A node that has nothing to do is
+ * parked until its next timer expires or a task is added to its scheduler.
+ *
+ * A node is run by at most one worker at a time, so the tasks of one node
+ * never run concurrently, but tasks of different nodes do.
+ *
+ * The state of a node is protected by the lock of the node, the queues by
+ * the lock of their worker. The lock of the pool only protects the timers
+ * of idle nodes and the sleeping of idle workers, thus it is not taken as
+ * long as all workers find runnable nodes. Locks are always acquired in
+ * the order node, worker, pool.
+ */
+class NodePool {
+public:
+	/**Number of tasks run for a node before the worker switches to
+	 * another node.
+	 */
+	static const uint8_t TASKS_PER_SLICE = 16;
+
+	NodePool(uint8_t numWorkers);
+	~NodePool();
+
+	/**Adds a node whose modules are already created and initialized.
+	 */
+	void add(NodeContext& node);
+
+	/**Runs all nodes until stop() is called.
+	 */
+	void run();
+
+	void stop();
+
+	/**Makes a node runnable, called by NodeContext::wakeup()
+	 */
+	void wakeup(NodeContext& node);
+
+private:
+	struct Worker {
+		NodePool* pool;
+		uint8_t index;
+		pthread_t thread;
+		pthread_mutex_t lock;
+		std::deque<NodeContext*> queue;
+	};
+
+	struct Timer {
+		time_ms_t due;
+		uint32_t generation;
+		NodeContext* node;
+
+		bool operator<(const Timer& other) const {
+			// priority_queue is a max heap
+			return (int32_t)(due - other.due) > 0;
+		}
+	};
+
+	static void* workerMain(void* arg);
+	void work(Worker& worker);
+	/**@return node to run, its state is already RUNNING*/
+	NodeContext* take(Worker& worker);
+	void runSlice(Worker& worker, NodeContext& node);
+	void enqueue(Worker& worker, NodeContext& node);
+
+	NodeContext* expire();
+	void updateNextDue();
+	void sleep();
+
+	std::vector<Worker*> workers;
+	std::atomic<uint32_t> nextWorker;
+	// number of nodes in all queues
+	std::atomic<uint32_t> queued;
+	std::atomic<uint8_t> idleWorkers;
+	std::atomic<bool> stopSignal;
+	// copy of the earliest timer, allows to check it without the lock
+	std::atomic<bool> timersPending;
+	std::atomic<time_ms_t> nextDue;
+
+	// protects the timers and the sleeping of idle workers
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	std::priority_queue<Timer> timers;
+};
+
+}
+
+#endif /* NODEPOOL_H_ */
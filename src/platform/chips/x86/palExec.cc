@@ -39,6 +39,25 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <sys/time.h>
+#ifdef SCHEDULER_PROFILING
+#include "SchedulerProfiler.h"
+#endif
+#ifdef PAL_MULTI_NODE
+#include "NodeContext.h"
+#endif
+#ifdef PAL_REACTOR
+#include "palReactor.h"
+#endif
+
+#if defined PAL_REACTOR && defined __linux__
+#define REACTOR_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <map>
+#include "cometos.h"
+
+#define REACTOR_MAX_EVENTS 16
+#endif
 
 
 
@@ -85,10 +104,37 @@ static pthread_mutex_t lock;
 static pthread_mutex_t lock2 = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
+#ifdef REACTOR_EPOLL
+static int epollFd = -1;
+// written by palExec_wakeup to abort epoll_wait
+static int wakeupFd = -1;
+static std::map<int, cometos::Task*> reactorTasks;
+static struct timeval lastReactorPoll;
+#endif
+
 void palExec_wakeup() {
+#ifdef PAL_MULTI_NODE
+	cometos::NodeContext* node = cometos::NodeContext::current();
+	if (node != NULL) {
+		node->wakeup();
+		return;
+	}
+#endif
 #ifdef _WIN32
 	stayAwake = true;
 	SetEvent(hEvent);
+#elif defined REACTOR_EPOLL
+	LOCK2();
+	if (isSleeping) {
+		uint64_t one = 1;
+		if (write(wakeupFd, &one, sizeof(one)) < 0) {
+			// counter is already pending
+		}
+	} else {
+		// abort the following call of palExec_sleep()
+		stayAwake = true;
+	}
+	UNLOCK2();
 #else
 	LOCK2();
 	if (isSleeping == false) {
@@ -156,6 +202,15 @@ void palExec_init() {
         pthread_mutexattr_init(&Attr);
         pthread_mutexattr_settype(&Attr, PTHREAD_MUTEX_RECURSIVE_NP);
         pthread_mutex_init(&lock, &Attr);
+#endif
+#ifdef REACTOR_EPOLL
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.ptr = NULL;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupFd, &ev);
+	gettimeofday(&lastReactorPoll, NULL);
 #endif
 	getOffset();
 	stayAwake = true;
@@ -165,10 +220,75 @@ void palExec_init() {
 }
 
 time_ms_t palExec_elapsed() {
+#ifdef PAL_MULTI_NODE
+	cometos::NodeContext* node = cometos::NodeContext::current();
+	if (node != NULL) {
+		return node->elapsed();
+	}
+#endif
 	return getOffset();
 }
 
+#ifdef REACTOR_EPOLL
+/**
+ * Adds the tasks of all readable descriptors to the scheduler. Waits at
+ * most ms milliseconds for an event, unless the sleep was aborted before.
+ */
+static void reactorWait(time_ms_t ms) {
+	LOCK2();
+	bool block = !stayAwake && ms != 0;
+	stayAwake = false;
+	isSleeping = block;
+	UNLOCK2();
+
+	if (!block) {
+		// busy scheduler, but still look for I/O once per millisecond
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		if (now.tv_sec == lastReactorPoll.tv_sec
+				&& now.tv_usec - lastReactorPoll.tv_usec < 1000) {
+			return;
+		}
+		lastReactorPoll = now;
+	}
+
+	struct epoll_event events[REACTOR_MAX_EVENTS];
+	int timeout = 0;
+	if (block) {
+		timeout = (ms == (time_ms_t) -1) ? -1 : (int) ms;
+	}
+	int n = epoll_wait(epollFd, events, REACTOR_MAX_EVENTS, timeout);
+
+	LOCK2();
+	isSleeping = false;
+	UNLOCK2();
+
+	for (int i = 0; i < n; i++) {
+		cometos::Task* task = (cometos::Task*) events[i].data.ptr;
+		if (task == NULL) {
+			uint64_t count;
+			if (read(wakeupFd, &count, sizeof(count)) < 0) {
+				// already drained
+			}
+		} else if (!task->isScheduled()) {
+			// several fds may share a task, e.g. those of a TcpAgent
+			cometos::getScheduler().add(*task);
+		}
+	}
+}
+#endif
+
 void palExec_sleep(time_ms_t ms) {
+#ifdef PAL_MULTI_NODE
+	if (cometos::NodeContext::current() != NULL) {
+		// idle nodes are parked by the NodePool
+		return;
+	}
+#endif
+#ifdef REACTOR_EPOLL
+	reactorWait(ms);
+	return;
+#endif
 	if (stayAwake || ms == 0) {
 		stayAwake = false;
 		return;
@@ -195,12 +315,28 @@ void palExec_sleep(time_ms_t ms) {
 }
 
 void palExec_atomicBegin() {
+#ifdef PAL_MULTI_NODE
+	cometos::NodeContext* node = cometos::NodeContext::current();
+	if (node != NULL) {
+		node->atomicBegin();
+		return;
+	}
+	// threads created by a node via thread_run() act for that node, thus
+	// only threads of the process itself get here
+#endif
         if(palExec_initialized) { // not valid and not needed before palExec_init
 	        LOCK();
         }
 }
 
 void palExec_atomicEnd() {
+#ifdef PAL_MULTI_NODE
+	cometos::NodeContext* node = cometos::NodeContext::current();
+	if (node != NULL) {
+		node->atomicEnd();
+		return;
+	}
+#endif
         if(palExec_initialized) { // not valid and not needed before palExec_init
 	        UNLOCK();
         }
@@ -262,6 +398,17 @@ time_ms_t palLocalTime_get() {
 #endif
 }
 
+#if defined SCHEDULER_PROFILING && !defined _WIN32
+/**
+ * @return microseconds used for profiling the scheduler
+ */
+uint32_t schedulerProfiler_getTimeUs() {
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return now.tv_sec * 1000000 + now.tv_usec;
+}
+#endif
+
 #if 0
 /**
  * @time sets current time
@@ -280,6 +427,66 @@ void palLocalTime_set(time_ms_t time) {
 }
 #endif
 
+#ifdef PAL_REACTOR
+bool palReactor_isAvailable() {
+#ifdef REACTOR_EPOLL
+#ifdef PAL_MULTI_NODE
+	if (cometos::NodeContext::current() != NULL) {
+		// nodes do not sleep in palExec_sleep(), thus they have to poll
+		return false;
+	}
+#endif
+	return epollFd >= 0;
+#else
+	return false;
+#endif
+}
+
+bool palReactor_add(int fd, cometos::Task* task) {
+#ifdef REACTOR_EPOLL
+	if (!palReactor_isAvailable() || task == NULL) {
+		return false;
+	}
+	struct epoll_event ev;
+	ev.events = EPOLLIN | EPOLLONESHOT;
+	ev.data.ptr = task;
+	LOCK();
+	bool success = (0 == epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev));
+	if (success) {
+		reactorTasks[fd] = task;
+	}
+	UNLOCK();
+	return success;
+#else
+	return false;
+#endif
+}
+
+void palReactor_rearm(int fd) {
+#ifdef REACTOR_EPOLL
+	LOCK();
+	std::map<int, cometos::Task*>::iterator it = reactorTasks.find(fd);
+	if (it != reactorTasks.end()) {
+		struct epoll_event ev;
+		ev.events = EPOLLIN | EPOLLONESHOT;
+		ev.data.ptr = it->second;
+		epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
+	}
+	UNLOCK();
+#endif
+}
+
+void palReactor_remove(int fd) {
+#ifdef REACTOR_EPOLL
+	LOCK();
+	if (reactorTasks.erase(fd) > 0) {
+		epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, NULL);
+	}
+	UNLOCK();
+#endif
+}
+#endif
+
 uint8_t palExec_getResetReason () {
     return 0;
 }
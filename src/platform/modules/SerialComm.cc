@@ -311,9 +311,7 @@ void SerialComm::tx() {
 		serial->write(data, len - 2);
 
 		// we calculate CRC checksum and...
-		for (uint8_t i = 0; i < len - 2; i++) {
-			crc = crc16_update(crc, data[i]);
-		}
+		crc = crc16_updateBlock(crc, data, len - 2);
 
 		// transmit CRC
 		uint8_t upper, lower;
@@ -435,9 +433,7 @@ void SerialComm::rx() {
 
 		length -= received;
 
-		for (uint8_t i = 0; i < received; i++) {
-			rxCrc = crc16_update(rxCrc, data[i]);
-		}
+		rxCrc = crc16_updateBlock(rxCrc, data, received);
 
 		// total frame is received, now ---
 		if (0 == length) {
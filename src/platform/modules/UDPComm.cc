@@ -40,6 +40,9 @@
 #include "OverwriteAddrData.h"
 #include <stdint.h>
 #include "palExec.h"
+#ifdef PAL_REACTOR
+#include "palReactor.h"
+#endif
 
 #include "palId.h"
 
@@ -54,6 +57,7 @@ UDPComm::UDPComm(int ownPort, const char* remoteAddress, int remotePort)
   ownPort(ownPort),
   dynamicRemote(false),
   remoteAddressInitialized(false),
+  eventDriven(false),
   taskRx(*this),
   remoteAddressStr(remoteAddress),
   remotePort(remotePort)
@@ -124,12 +128,31 @@ void UDPComm::initialize() {
 	initializeRemoteAddress();
 	palExec_atomicEnd();
 
-	cometos::getScheduler().add(taskRx, POLL_UDP_INTERVAL);
+#ifdef PAL_REACTOR
+	eventDriven = palReactor_add(fd, &taskRx);
+#endif
+	if (!eventDriven) {
+		cometos::getScheduler().add(taskRx, POLL_UDP_INTERVAL);
+	}
 }
 
 // RECEPTION ------------------------------------------------------------------
 
 void UDPComm::pollUDPSocket() {
+	if (eventDriven) {
+		// fetch all pending datagrams before the socket is watched again
+		while (receiveDatagram()) {
+		}
+#ifdef PAL_REACTOR
+		palReactor_rearm(fd);
+#endif
+	} else {
+		receiveDatagram();
+		cometos::getScheduler().add(taskRx, POLL_UDP_INTERVAL);
+	}
+}
+
+bool UDPComm::receiveDatagram() {
         struct sockaddr_in rxAddr;
 #ifdef FNET
         int addrlen = sizeof(rxAddr);
@@ -178,9 +201,10 @@ void UDPComm::pollUDPSocket() {
 			remoteAddressInitialized = true;
 			palExec_atomicEnd();
 		}
+		return true;
         }
 
-	cometos::getScheduler().add(taskRx, POLL_UDP_INTERVAL);
+	return false;
 }
 
 
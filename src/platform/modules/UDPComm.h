@@ -73,12 +73,18 @@ private:
     void confirm(cometos::DataRequest * req, bool result, bool addTxInfo, bool isValidTxTs);
     void initializeRemoteAddress();
 
+    /**@return true if a datagram was received*/
+    bool receiveDatagram();
+
     int ownPort;
     cometos::AirframePtr rxFrame;
     int fd;
 
     bool dynamicRemote;
     bool remoteAddressInitialized;
+
+    /**true if the socket is watched by the reactor instead of polled*/
+    bool eventDriven;
     BoundedTask<UDPComm, &UDPComm::pollUDPSocket> taskRx;
     std::string remoteAddressStr;
     int remotePort;
@@ -48,15 +48,24 @@ public:
 	static uint8_t get() {
 		static uint8_t id = 0;
 		if (!id) {
+#ifdef PAL_MULTI_NODE
+			// nodes on other threads may assign an id concurrently
+			__sync_bool_compare_and_swap(&id, 0, assign());
+#else
 			id = assign();
+#endif
 		}
 		return id;
 	}
 private:
 	static uint8_t assign() {
 		static uint8_t classCounter = 0;
+#ifdef PAL_MULTI_NODE
+		return __sync_add_and_fetch(&classCounter, 1);
+#else
 		classCounter++;
 		return classCounter;
+#endif
 	}
 };
 
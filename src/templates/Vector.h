@@ -174,6 +174,17 @@ public:
 		return element;
 	}
 
+protected:
+	/**Moves the array to another position within the storage of the
+	 * subclass without copying any element. Used to manage free space in
+	 * front of the array.
+	 */
+	void relocate(C* pBuffer, uint8_t size) {
+		ASSERT(size <= max_size);
+		this->pBuffer = pBuffer;
+		this->size = size;
+	}
+
 private:
 	C* pBuffer;
 	uint8_t size;
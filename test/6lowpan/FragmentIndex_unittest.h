@@ -0,0 +1,177 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef FRAGMENTINDEX_UNITTEST_H_
+#define FRAGMENTINDEX_UNITTEST_H_
+
+#include "gtest/gtest.h"
+#include "FragmentIndex.h"
+#include "Ieee802154MacAddress.h"
+#include <cstdlib>
+
+namespace {
+
+/**
+ * Handler as seen by the index, freed without notifying it.
+ */
+struct IndexedHandler {
+    cometos_v6::Ieee802154MacAddress srcMAC;
+    uint16_t tag;
+    uint16_t size;
+    bool used;
+
+    bool belongsTo(const cometos_v6::Ieee802154MacAddress& mac,
+            uint16_t t, uint16_t s) const {
+        return used && srcMAC == mac && tag == t && size == s;
+    }
+
+    uint16_t hash() const {
+        return cometos_v6::FragmentIndex::hash(srcMAC, tag, size);
+    }
+};
+
+class FragmentIndexTest : public ::testing::Test {
+public:
+    static const uint8_t NUM_HANDLERS = 50;
+    static const uint16_t NUM_SLOTS =
+            cometos_v6::FragmentIndexSize<NUM_HANDLERS>::value;
+
+    FragmentIndexTest() :
+        index(slots, NUM_SLOTS),
+        probes(0)
+    {
+        for (uint8_t i = 0; i < NUM_HANDLERS; i++) {
+            handlers[i].used = false;
+        }
+    }
+
+protected:
+    // same as AssemblyBufferBase::addToIndex()
+    void add(uint8_t id) {
+        if (index.insert(handlers[id].hash(), id)) {
+            return;
+        }
+        index.clear();
+        for (uint8_t i = 0; i < NUM_HANDLERS; i++) {
+            if (handlers[i].used) {
+                ASSERT_TRUE(index.insert(handlers[i].hash(), i));
+            }
+        }
+    }
+
+    // same as AssemblyBufferBase::findCorrespondingId()
+    uint8_t find(const cometos_v6::Ieee802154MacAddress& mac,
+            uint16_t tag, uint16_t size) {
+        uint16_t slot = index.first(cometos_v6::FragmentIndex::hash(mac, tag, size));
+        for (; index.get(slot) != cometos_v6::FragmentIndex::EMPTY;
+                slot = index.next(slot)) {
+            probes++;
+            uint8_t id = index.get(slot);
+            if (id < NUM_HANDLERS && handlers[id].belongsTo(mac, tag, size)) {
+                return id;
+            }
+        }
+        return cometos_v6::FragmentIndex::EMPTY;
+    }
+
+    uint8_t scan(const cometos_v6::Ieee802154MacAddress& mac,
+            uint16_t tag, uint16_t size) const {
+        for (uint8_t i = 0; i < NUM_HANDLERS; i++) {
+            if (handlers[i].belongsTo(mac, tag, size)) {
+                return i;
+            }
+        }
+        return cometos_v6::FragmentIndex::EMPTY;
+    }
+
+    uint8_t slots[NUM_SLOTS];
+    cometos_v6::FragmentIndex index;
+    IndexedHandler handlers[NUM_HANDLERS];
+    uint32_t probes;
+};
+
+TEST_F(FragmentIndexTest, numSlots) {
+    EXPECT_EQ(2, cometos_v6::FragmentIndex::numSlots(1));
+    EXPECT_EQ(8, cometos_v6::FragmentIndex::numSlots(3));
+    EXPECT_EQ(8, cometos_v6::FragmentIndex::numSlots(4));
+    EXPECT_EQ(128, cometos_v6::FragmentIndex::numSlots(50));
+    EXPECT_EQ(512, cometos_v6::FragmentIndex::numSlots(255));
+    EXPECT_EQ(cometos_v6::FragmentIndex::numSlots(NUM_HANDLERS), (int) NUM_SLOTS);
+    EXPECT_EQ(512, (int) cometos_v6::FragmentIndexSize<255>::value);
+}
+
+TEST_F(FragmentIndexTest, randomOperationsMatchScan) {
+    srand(1);
+    uint32_t lookups = 0;
+    for (uint32_t step = 0; step < 200000; step++) {
+        // few senders and sizes, so that keys collide in all but the tag
+        cometos_v6::Ieee802154MacAddress mac((uint16_t) (rand() % 4));
+        uint16_t tag = rand() % 64;
+        uint16_t size = 100 + rand() % 3;
+        uint8_t op = rand() % 4;
+
+        if (op == 0) {
+            if (scan(mac, tag, size) != cometos_v6::FragmentIndex::EMPTY) {
+                continue;
+            }
+            for (uint8_t i = 0; i < NUM_HANDLERS; i++) {
+                if (!handlers[i].used) {
+                    handlers[i].srcMAC = mac;
+                    handlers[i].tag = tag;
+                    handlers[i].size = size;
+                    handlers[i].used = true;
+                    add(i);
+                    break;
+                }
+            }
+        } else if (op == 1) {
+            // handlers are freed behind the back of the index
+            handlers[rand() % NUM_HANDLERS].used = false;
+        } else {
+            if (op == 3) {
+                // look up a datagram that is in reassembly
+                const IndexedHandler& h = handlers[rand() % NUM_HANDLERS];
+                mac = h.srcMAC;
+                tag = h.tag;
+                size = h.size;
+            }
+            lookups++;
+            ASSERT_EQ(scan(mac, tag, size), find(mac, tag, size));
+        }
+    }
+    // stale slots are cleaned up by rebuilds, probing stays short
+    EXPECT_LT(probes / lookups, 16u);
+}
+
+}
+
+#endif /* FRAGMENTINDEX_UNITTEST_H_ */
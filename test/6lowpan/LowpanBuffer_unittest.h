@@ -34,6 +34,9 @@
 #include "LowpanBuffer.h"
 #include "Airframe.h"
 #include "omnetppDummyEnv.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
 
 namespace {
 class LowpanBufferTest : public ::testing::Test {
@@ -222,5 +225,183 @@ TEST_F(LowpanBufferTest, populateFrame){
     EXPECT_EQ(0, third_frame.getLength());*/
 
 }
+
+/**
+ * Reference model of the buffer: allocated ranges sorted by address,
+ * allocation takes the lowest address with enough space.
+ */
+struct BufferModel {
+    struct Range {
+        uint16_t begin;
+        uint16_t size;
+        cometos_v6::BufferInformation* handler;
+        bool operator<(const Range& other) const {
+            return begin < other.begin;
+        }
+    };
+
+    BufferModel(uint16_t size, uint8_t numHandlers) :
+        size(size), numHandlers(numHandlers), used(0), peak(0),
+        failMemory(0), failHandlers(0)
+    {}
+
+    /** lowest address with enough space, regardless of the handlers */
+    int32_t firstFit(uint16_t request) const {
+        uint16_t pos = 0;
+        for (uint8_t i = 0; i < ranges.size(); i++) {
+            if (ranges[i].begin - pos >= request) {
+                return pos;
+            }
+            pos = ranges[i].begin + ranges[i].size;
+        }
+        return (size - pos >= request) ? pos : -1;
+    }
+
+    /** same order of checks as the buffer: memory first, then handlers */
+    int32_t allocate(uint16_t request) {
+        int32_t pos = firstFit(request);
+        if (pos < 0) {
+            failMemory++;
+            return -1;
+        }
+        if (ranges.size() >= numHandlers) {
+            failHandlers++;
+            return -1;
+        }
+        used += request;
+        peak = std::max(peak, used);
+        return pos;
+    }
+
+    uint16_t largestGap() const {
+        uint16_t gap = 0;
+        uint16_t pos = 0;
+        for (uint8_t i = 0; i < ranges.size(); i++) {
+            gap = std::max(gap, (uint16_t) (ranges[i].begin - pos));
+            pos = ranges[i].begin + ranges[i].size;
+        }
+        return std::max(gap, (uint16_t) (size - pos));
+    }
+
+    const Range* find(uint16_t pos) const {
+        for (uint8_t i = 0; i < ranges.size(); i++) {
+            if (pos >= ranges[i].begin &&
+                    pos < ranges[i].begin + ranges[i].size) {
+                return &ranges[i];
+            }
+        }
+        return NULL;
+    }
+
+    uint16_t size;
+    uint8_t numHandlers;
+    std::vector<Range> ranges;
+    uint16_t used;
+    uint16_t peak;
+    uint16_t failMemory;
+    uint16_t failHandlers;
+};
+
+/**
+ * Runs random allocations, frees, partial frees and lookups on a buffer
+ * and checks each result, and the statistics if enabled, against the model.
+ * Requests are up to maxRequest bytes, so that both memory and handlers
+ * run out from time to time.
+ */
+void checkRandomOperations(uint16_t size, uint8_t numHandlers,
+        uint16_t maxRequest) {
+    cometos_v6::DynLowpanBuffer buffer(size, numHandlers);
+    BufferModel model(size, numHandlers);
+    srand(1);
+
+    // the first buffer of an empty buffer starts at its lowest address
+    cometos_v6::BufferInformation* first = buffer.getBuffer(1);
+    ASSERT_FALSE(NULL == first);
+    const uint8_t* base = first->getContent();
+    first->free();
+    model.peak = 1;
+
+    for (uint32_t step = 0; step < 100000; step++) {
+        uint8_t op = rand() % 8;
+        if (op < 3 || model.ranges.empty()) {
+            uint16_t request = 1 + rand() % maxRequest;
+            int32_t expected = model.allocate(request);
+            cometos_v6::ManagedBuffer::MbRequestStatus result;
+            cometos_v6::BufferInformation* bi =
+                    buffer.getBuffer(request, result);
+            if (expected < 0) {
+                ASSERT_TRUE(NULL == bi);
+                EXPECT_NE(cometos_v6::ManagedBuffer::SUCCESS, result);
+            } else {
+                ASSERT_FALSE(NULL == bi);
+                EXPECT_EQ(cometos_v6::ManagedBuffer::SUCCESS, result);
+                ASSERT_EQ(base + expected, bi->getContent());
+                ASSERT_EQ(request, bi->getSize());
+                BufferModel::Range r = {(uint16_t) expected, request, bi};
+                model.ranges.insert(std::upper_bound(model.ranges.begin(),
+                        model.ranges.end(), r), r);
+            }
+        } else {
+            uint8_t i = rand() % model.ranges.size();
+            BufferModel::Range& r = model.ranges[i];
+            if (op < 5) {
+                r.handler->free();
+                EXPECT_FALSE(r.handler->isUsed());
+                model.used -= r.size;
+                model.ranges.erase(model.ranges.begin() + i);
+            } else {
+                if (op == 5 && r.size > 1) {
+                    uint16_t space = 1 + rand() % (r.size - 1);
+                    r.handler->freeBegin(space);
+                    r.begin += space;
+                    r.size -= space;
+                    model.used -= space;
+                } else if (op == 6 && r.size > 1) {
+                    uint16_t space = 1 + rand() % (r.size - 1);
+                    r.handler->freeEnd(space);
+                    r.size -= space;
+                    model.used -= space;
+                } else {
+                    uint16_t pos = rand() % size;
+                    const BufferModel::Range* expected = model.find(pos);
+                    ASSERT_EQ(expected == NULL ? NULL : expected->handler,
+                            buffer.getCorrespondingBuffer(base + pos));
+                }
+                ASSERT_EQ(base + r.begin, r.handler->getContent());
+                ASSERT_EQ(r.size, r.handler->getSize());
+            }
+        }
+
+#ifdef LOWPANBUFFER_ENABLESTATS
+        ASSERT_EQ(model.used, buffer.getUsedBufferSize());
+        ASSERT_EQ(model.ranges.size(), buffer.getNumBuffers());
+        ASSERT_EQ(model.peak, buffer.getPeakUsedBufferSize());
+        ASSERT_EQ(model.largestGap(), buffer.getLargestFreeExtent());
+        ASSERT_EQ(model.failMemory, buffer.getNumFailures(
+                cometos_v6::ManagedBuffer::FAIL_MEMORY));
+        ASSERT_EQ(model.failHandlers, buffer.getNumFailures(
+                cometos_v6::ManagedBuffer::FAIL_HANDLERS));
+#endif
+    }
+
+#ifdef LOWPANBUFFER_ENABLESTATS
+    // both kinds of failures have to be exercised
+    EXPECT_LT(0, model.failMemory);
+    EXPECT_LT(0, model.failHandlers);
+#endif
+
+    for (uint8_t i = 0; i < model.ranges.size(); i++) {
+        model.ranges[i].handler->free();
+    }
+    EXPECT_FALSE(NULL == buffer.getBuffer(size));
+}
+
+TEST_F(LowpanBufferTest, randomOperationsMatchModel) {
+    checkRandomOperations(4000, 40, 300);
+}
+
+TEST_F(LowpanBufferTest, randomOperationsMatchModelLargest) {
+    checkRandomOperations(65000, 255, 800);
+}
 }
 
@@ -0,0 +1,173 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef INTERNETCHECKSUM_UNITTEST_H_
+#define INTERNETCHECKSUM_UNITTEST_H_
+
+#include "gtest/gtest.h"
+#include "InternetChecksum.h"
+#include "FollowingHeader.h"
+#include "UDPPacket.h"
+#include <cstdlib>
+
+namespace {
+
+/**
+ * Byte-wise sum of big-endian 16 bit words as defined by RFC 1071, which
+ * the optimized implementations have to match.
+ */
+uint16_t referenceChecksumAdd(uint32_t sum, const uint8_t* data,
+        uint16_t length) {
+    for (uint16_t i = 0; i + 1 < length; i += 2) {
+        sum += ((uint16_t) data[i] << 8) | data[i + 1];
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    if (length & 1) {
+        sum += (uint16_t) data[length - 1] << 8;
+    }
+    return cometos_v6::checksumFold(sum);
+}
+
+uint8_t checksumData[1600];
+
+void fillRandom(uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        data[i] = rand();
+    }
+}
+
+TEST(InternetChecksumTest, addMatchesReference) {
+    srand(1);
+    for (uint32_t i = 0; i < 20000; i++) {
+        // misaligned data and all lengths, including odd ones
+        uint16_t offset = rand() % 32;
+        uint16_t length = rand() % (sizeof(checksumData) - 32);
+        uint32_t sum = rand() % 0x20000;
+        fillRandom(checksumData + offset, length);
+        ASSERT_EQ(referenceChecksumAdd(sum, checksumData + offset, length),
+                cometos_v6::checksumAdd(sum, checksumData + offset, length))
+                << "offset " << offset << " length " << length;
+    }
+}
+
+TEST(InternetChecksumTest, addExtremeValues) {
+    for (uint16_t length = 0; length < 300; length++) {
+        memset(checksumData, 0xFF, length);
+        EXPECT_EQ(referenceChecksumAdd(0, checksumData, length),
+                cometos_v6::checksumAdd(0, checksumData, length));
+        EXPECT_EQ(referenceChecksumAdd(0xFFFF, checksumData, length),
+                cometos_v6::checksumAdd(0xFFFF, checksumData, length));
+        memset(checksumData, 0, length);
+        EXPECT_EQ(0, cometos_v6::checksumAdd(0, checksumData, length));
+    }
+    memset(checksumData, 0xFF, sizeof(checksumData));
+    EXPECT_EQ(referenceChecksumAdd(0, checksumData, 0xFFFF % sizeof(checksumData)),
+            cometos_v6::checksumAdd(0, checksumData, 0xFFFF % sizeof(checksumData)));
+}
+
+TEST(InternetChecksumTest, chainedBlocks) {
+    srand(2);
+    for (uint32_t i = 0; i < 5000; i++) {
+        uint16_t length = rand() % sizeof(checksumData);
+        fillRandom(checksumData, length);
+        uint16_t expected = referenceChecksumAdd(0, checksumData, length);
+
+        // all but the last block have an even length
+        uint32_t sum = 0;
+        uint16_t pos = 0;
+        while (length - pos > 1) {
+            uint16_t block = 2 * (rand() % ((length - pos) / 2 + 1));
+            sum = cometos_v6::checksumAdd(sum, checksumData + pos, block);
+            pos += block;
+        }
+        sum = cometos_v6::checksumAdd(sum, checksumData + pos, length - pos);
+        ASSERT_EQ(expected, sum);
+    }
+}
+
+TEST(InternetChecksumTest, adjustMatchesRecomputation) {
+    srand(3);
+    for (uint32_t i = 0; i < 5000; i++) {
+        uint16_t length = 2 + 2 * (rand() % 100);
+        fillRandom(checksumData, length);
+        uint16_t checksum = ~referenceChecksumAdd(0, checksumData, length);
+
+        uint16_t pos = 2 * (rand() % (length / 2));
+        uint16_t oldWord = (checksumData[pos] << 8) | checksumData[pos + 1];
+        uint16_t newWord = rand();
+        checksumData[pos] = newWord >> 8;
+        checksumData[pos + 1] = newWord;
+        uint16_t expected = ~referenceChecksumAdd(0, checksumData, length);
+        uint16_t adjusted = cometos_v6::checksumAdjust(checksum, oldWord, newWord);
+
+        // +0 and -0 are the same in ones' complement
+        if (expected == 0xFFFF || expected == 0) {
+            EXPECT_TRUE(adjusted == 0xFFFF || adjusted == 0);
+        } else {
+            ASSERT_EQ(expected, adjusted);
+        }
+    }
+}
+
+TEST(InternetChecksumTest, adjustAddress) {
+    srand(4);
+    uint16_t length = 200;
+    fillRandom(checksumData, length);
+    for (uint32_t i = 0; i < 1000; i++) {
+        IPv6Address src(rand(), rand(), rand(), rand(),
+                rand(), rand(), rand(), rand());
+        IPv6Address dst(rand(), rand(), rand(), rand(),
+                rand(), rand(), rand(), rand());
+        IPv6Address newDst(rand(), rand(), rand(), rand(),
+                rand(), rand(), rand(), rand());
+        uint16_t checksum = cometos_v6::doingChecksum(0, checksumData, length,
+                src, dst, length, cometos_v6::UDPPacket::HeaderNumber);
+        uint16_t expected = cometos_v6::doingChecksum(0, checksumData, length,
+                src, newDst, length, cometos_v6::UDPPacket::HeaderNumber);
+
+        // the pseudo header sum can be computed once for several packets
+        EXPECT_EQ(checksum, cometos_v6::doingChecksum(
+                cometos_v6::checksumPseudoHeader(src, dst), checksumData,
+                length, length, cometos_v6::UDPPacket::HeaderNumber));
+
+        uint16_t adjusted = cometos_v6::checksumAdjust(checksum, dst, newDst);
+        if (expected == 0xFFFF || expected == 0) {
+            EXPECT_TRUE(adjusted == 0xFFFF || adjusted == 0);
+        } else {
+            ASSERT_EQ(expected, adjusted);
+        }
+    }
+}
+
+}
+
+#endif /* INTERNETCHECKSUM_UNITTEST_H_ */
@@ -37,6 +37,7 @@
 #include "6lowpan/IPHCDecompressor_unittest.h"
 #include "6lowpan/CompressingAndDecompressing_unittest.h"
 #include "6lowpan/AssemblyBuffer_unittest.h"
+#include "6lowpan/FragmentIndex_unittest.h"
 #include "6lowpan/QueueFrame_unittest.h"
 #include "6lowpan/FifoLowpanQueue_unittest.h"
 #include "6lowpan/DatagramOrderedLowpanQueue_unittest.h"
@@ -48,6 +49,9 @@
 
 #include "addressing/Addressing_unittest.h"
 #include "ipHeaders/IPv6Datagram_unittest.h"
+#include "ipHeaders/InternetChecksum_unittest.h"
+#include "routing/PrefixIndex_unittest.h"
+#include "routing/SourceRouteCache_unittest.h"
 
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,183 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef PREFIXINDEX_UNITTEST_H_
+#define PREFIXINDEX_UNITTEST_H_
+
+#include "gtest/gtest.h"
+#include "PrefixIndex.h"
+#include <cstdlib>
+
+namespace {
+
+class PrefixIndexTest : public ::testing::Test {
+public:
+    static const uint8_t CAPACITY = 64;
+    typedef cometos_v6::PrefixIndex<cometos_v6::route_key_t, CAPACITY> Index_t;
+
+    PrefixIndexTest() :
+        sequence(0)
+    {
+        for (uint8_t i = 0; i < CAPACITY; i++) {
+            routes[i] = NULL;
+        }
+    }
+
+    ~PrefixIndexTest() {
+        for (uint8_t i = 0; i < CAPACITY; i++) {
+            delete routes[i];
+        }
+    }
+
+protected:
+    static IPv6Address randomAddress() {
+        // few distinct values, so that prefixes overlap
+        return IPv6Address(0x2001, 0xdb8, rand() % 3, rand() % 3,
+                0, 0, rand() % 2, rand() % 8);
+    }
+
+    static uint8_t randomLength() {
+        static const uint8_t lengths[] = {128, 128, 128, 64, 64, 48, 32, 127};
+        uint8_t i = rand() % (sizeof(lengths) + 1);
+        return i < sizeof(lengths) ? lengths[i] : 1 + rand() % 128;
+    }
+
+    // same as RoutingTable::indexRoute() and RoutingTable::eraseRoute()
+    void add(cometos_v6::route_key_t key, const IPv6Address& prefix,
+            uint8_t length) {
+        routes[key] = new cometos_v6::IPv6Route(prefix, length,
+                cometos_v6::IPv6Route::STATIC);
+        added[key] = sequence++;
+        index.add(key, routes);
+    }
+
+    void remove(cometos_v6::route_key_t key) {
+        cometos_v6::IPv6Route* route = routes[key];
+        bool indexed = index.remove(key, routes);
+        routes[key] = NULL;
+        if (indexed) {
+            cometos_v6::route_key_t newest = Index_t::EMPTY;
+            for (uint8_t i = 0; i < CAPACITY; i++) {
+                if (isSamePrefix(i, route) &&
+                        (newest == Index_t::EMPTY || added[i] > added[newest])) {
+                    newest = i;
+                }
+            }
+            if (newest != Index_t::EMPTY) {
+                index.restore(newest, routes);
+            }
+        }
+        delete route;
+    }
+
+    bool isSamePrefix(uint8_t i, const cometos_v6::IPv6Route* route) const {
+        return routes[i] != NULL &&
+                routes[i]->getPrefixLength() == route->getPrefixLength() &&
+                routes[i]->getDestPrefix().matches(route->getDestPrefix(),
+                        route->getPrefixLength());
+    }
+
+    /**
+     * Linear longest prefix match, the newest of several routes with the
+     * same prefix wins.
+     */
+    cometos_v6::route_key_t scan(const IPv6Address& dest) const {
+        cometos_v6::route_key_t best = Index_t::EMPTY;
+        for (uint8_t i = 0; i < CAPACITY; i++) {
+            if (routes[i] == NULL ||
+                    !dest.matches(routes[i]->getDestPrefix(),
+                            routes[i]->getPrefixLength())) {
+                continue;
+            }
+            if (best == Index_t::EMPTY ||
+                    routes[i]->getPrefixLength() > routes[best]->getPrefixLength() ||
+                    (routes[i]->getPrefixLength() == routes[best]->getPrefixLength() &&
+                     added[i] > added[best])) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    Index_t index;
+    cometos_v6::IPv6Route* routes[CAPACITY];
+    uint32_t added[CAPACITY];
+    uint32_t sequence;
+};
+
+TEST_F(PrefixIndexTest, hostAndNetworkRoutes) {
+    IPv6Address host(0x2001, 0xdb8, 0, 1, 0, 0, 0, 5);
+    IPv6Address other(0x2001, 0xdb8, 0, 1, 0, 0, 0, 6);
+    IPv6Address outside(0x2001, 0xdb9, 0, 1, 0, 0, 0, 5);
+    const cometos_v6::route_key_t none = Index_t::EMPTY;
+
+    EXPECT_EQ(none, index.find(host, routes));
+    add(0, IPv6Address(0x2001, 0xdb8, 0, 1, 0, 0, 0, 0), 64);
+    add(1, host, 128);
+    EXPECT_EQ(1, index.find(host, routes));
+    EXPECT_EQ(0, index.find(other, routes));
+    EXPECT_EQ(none, index.find(outside, routes));
+    EXPECT_EQ(1, index.findExact(host, 128, routes));
+    EXPECT_EQ(none, index.findExact(other, 128, routes));
+
+    // a newer route for the same prefix displaces the older one
+    add(2, host, 128);
+    EXPECT_EQ(2, index.find(host, routes));
+    remove(2);
+    EXPECT_EQ(1, index.find(host, routes));
+    remove(1);
+    EXPECT_EQ(0, index.find(host, routes));
+    remove(0);
+    EXPECT_EQ(none, index.find(host, routes));
+}
+
+TEST_F(PrefixIndexTest, randomOperationsMatchScan) {
+    srand(1);
+    for (uint32_t step = 0; step < 100000; step++) {
+        cometos_v6::route_key_t key = rand() % CAPACITY;
+        uint8_t op = rand() % 4;
+        if (op == 0) {
+            if (routes[key] == NULL) {
+                add(key, randomAddress(), randomLength());
+            } else {
+                remove(key);
+            }
+        } else {
+            IPv6Address dest = randomAddress();
+            ASSERT_EQ(scan(dest), index.find(dest, routes));
+        }
+    }
+}
+
+}
+
+#endif /* PREFIXINDEX_UNITTEST_H_ */
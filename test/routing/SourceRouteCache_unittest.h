@@ -0,0 +1,191 @@
+/*
+ * CometOS --- a component-based, extensible, tiny operating system
+ *             for wireless networks
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef SOURCEROUTECACHE_UNITTEST_H_
+#define SOURCEROUTECACHE_UNITTEST_H_
+
+#include "gtest/gtest.h"
+#include "RPLSourceRoutingTable.h"
+#include "IPv6RoutingHeader.h"
+#include "omnetppDummyEnv.h"
+#include <string.h>
+#include <vector>
+
+namespace {
+
+/**
+ * Source routing table of a root without interface table, its own address
+ * is given directly.
+ */
+class RootRoutingTable : public cometos_v6::RPLSourceRoutingTable {
+public:
+    RootRoutingTable(const IPv6Address& root) :
+        root(root)
+    {}
+
+    virtual bool isLocalAddress(const IPv6Address& address) const {
+        return address == root;
+    }
+
+private:
+    IPv6Address root;
+};
+
+class SourceRouteCacheTest : public ::testing::Test {
+public:
+    static void SetUpTestCase() {
+        OmnetppDummyEnv::setup();
+    }
+
+    SourceRouteCacheTest() :
+        table(node(1))
+    {}
+
+protected:
+    static IPv6Address node(uint16_t id) {
+        return IPv6Address(0xfd00, 0, 0, 0, 0, 0, 0, id);
+    }
+
+    /** host route of a DAO of target with the given parent */
+    void dao(uint16_t target, uint16_t parent) {
+        IPv6Address t = node(target);
+        IPv6Address p = node(parent);
+        table.modifyRoute(&t, 128, &p, 0);
+    }
+
+    /**
+     * Hops the datagram visits after the root, following the routing
+     * header as the routers on the way do.
+     */
+    std::vector<IPv6Address> walk(const cometos_v6::SourceRoute* route) {
+        std::vector<IPv6Address> hops;
+        IPv6Address dst = route->firstHop;
+        hops.push_back(dst);
+        if (route->segments == 0) {
+            EXPECT_TRUE(route->header == NULL);
+            return hops;
+        }
+        // the RH3 has to end at a multiple of 8 bytes
+        EXPECT_EQ(0, (cometos_v6::IPv6RoutingHeader::FIXED_SIZE +
+                route->headerLength) % 8);
+
+        uint8_t* data = new uint8_t[route->headerLength];
+        memcpy(data, route->header, route->headerLength);
+        cometos_v6::IPv6RoutingHeader rh;
+        rh.setRoutingType(cometos_v6::IPv6RoutingHeader::SOURCE_ROUTING_TYPE);
+        rh.setData(data, route->headerLength);
+        rh.dataAdded = true;
+        rh.setSegmentsLeft(route->segments);
+        while (rh.getSegmentsLeft() > 0) {
+            EXPECT_TRUE(rh.nextSegment(dst));
+            hops.push_back(dst);
+        }
+        delete[] data;
+        return hops;
+    }
+
+    void expectPath(uint16_t target, const std::vector<uint16_t>& ids) {
+        const cometos_v6::SourceRoute* route =
+                table.getSourceRoute(node(target));
+        ASSERT_FALSE(route == NULL);
+        std::vector<IPv6Address> hops = walk(route);
+        ASSERT_EQ(ids.size(), hops.size());
+        for (uint8_t i = 0; i < ids.size(); i++) {
+            EXPECT_TRUE(node(ids[i]) == hops[i]) << "hop " << (int) i;
+        }
+    }
+
+    RootRoutingTable table;
+};
+
+TEST_F(SourceRouteCacheTest, pathsOfTheDodag) {
+    // 1 is the root, 2 <- 3 <- 4 and 2 <- 5
+    dao(2, 1);
+    dao(3, 2);
+    dao(4, 3);
+    dao(5, 2);
+
+    expectPath(2, {2});
+    expectPath(3, {2, 3});
+    expectPath(4, {2, 3, 4});
+    expectPath(5, {2, 5});
+
+    // only host routes are used
+    EXPECT_TRUE(table.getSourceRoute(node(6)) == NULL);
+
+    // kept until a route on the path changes
+    const cometos_v6::SourceRoute* route = table.getSourceRoute(node(4));
+    EXPECT_EQ(route, table.getSourceRoute(node(4)));
+}
+
+TEST_F(SourceRouteCacheTest, changedRoutes) {
+    dao(2, 1);
+    dao(3, 2);
+    dao(4, 3);
+    expectPath(4, {2, 3, 4});
+
+    // 3 moves below the root, its subtree follows
+    dao(3, 1);
+    expectPath(3, {3});
+    expectPath(4, {3, 4});
+
+    // the parent of 7 is not known yet and assumed to be a neighbor
+    dao(7, 6);
+    expectPath(7, {6, 7});
+    dao(6, 4);
+    expectPath(7, {3, 4, 6, 7});
+}
+
+TEST_F(SourceRouteCacheTest, invalidPaths) {
+    // parents that never reach the root
+    dao(2, 3);
+    dao(3, 2);
+    EXPECT_TRUE(table.getSourceRoute(node(2)) == NULL);
+
+    table.clearRouteList();
+    for (uint16_t i = 2; i < 2 + cometos_v6::RoutingTable::RT_ROUTING_TABLE_SIZE; i++) {
+        dao(i, i - 1);
+    }
+    // the longest path has SOURCE_ROUTE_MAX_HOPS hops after the first one
+    std::vector<uint16_t> ids;
+    for (uint16_t i = 2; i <= SOURCE_ROUTE_MAX_HOPS + 2; i++) {
+        ids.push_back(i);
+    }
+    expectPath(SOURCE_ROUTE_MAX_HOPS + 2, ids);
+    if (cometos_v6::RoutingTable::RT_ROUTING_TABLE_SIZE >= SOURCE_ROUTE_MAX_HOPS + 2) {
+        EXPECT_TRUE(table.getSourceRoute(node(SOURCE_ROUTE_MAX_HOPS + 3)) == NULL);
+    }
+}
+
+}
+
+#endif /* SOURCEROUTECACHE_UNITTEST_H_ */